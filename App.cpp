@@ -42,8 +42,15 @@ int App::Run()
 {
 	while (true)
 	{
+		// Every pass through the loop is timed, but only the passes that present are kept (see FrameTimeline)
+		FrameTimeline::BeginFrame();
+
 		// process all messages pending, but to not block for new messages
-		if (const auto ecode = WindowManager::ProcessMessages())
+		FrameTimeline::BeginStage(FrameStage::MESSAGE_PUMP);
+		const auto ecode = WindowManager::ProcessMessages();
+		FrameTimeline::EndStage(FrameStage::MESSAGE_PUMP);
+
+		if (ecode)
 		{
 			// Have to manually clear out pointers for the bonds
 			SimulationManager::DestroyBonds();
@@ -54,6 +61,13 @@ int App::Run()
 
 		// For each window: Update state, render, and present
 		WindowManager::UpdateRenderPresent();
+
+		// Nothing needs to be drawn - sleep until the next message instead of spinning
+		if (!RenderScheduler::FrameRequested())
+		{
+			FrameTimeline::Idle();
+			WaitMessage();
+		}
 	}
 
 	
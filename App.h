@@ -3,6 +3,8 @@
 
 #include "ContentWindow.h"
 #include "LayoutConfig.h"
+#include "RenderScheduler.h"
+#include "FrameTimeline.h"
 #include "ThemeManager.h"
 #include "WindowManager.h"
 #include "SimulationManager.h"
@@ -5,6 +5,7 @@
 #include "DeviceResources.h"
 #include "Enums.h"
 #include "HLSLStructures.h"
+#include "MeshBuffers.h"
 
 #include <memory>
 #include <vector>
@@ -14,63 +15,49 @@
 	The purpose of this class is to house the vertex and index
 	buffers that are required to render an arrow that consists of a cylinder and a cone
 
-	It also is responsible for computing the model (world) matrix for
-	the sphere and makes the Draw call to render it
+	Arrows are drawn instanced - InstancedArrowVertexShader builds the model matrix of each
+	part from the position, radius and velocity of the atom (see VelocityArrowPacker)
 	*/
 class ArrowMesh
 {
 private:
 	std::shared_ptr<DeviceResources>		m_deviceResources;
 
-	Microsoft::WRL::ComPtr<ID3D11Buffer>	m_cylinderVertexBuffer;
-	Microsoft::WRL::ComPtr<ID3D11Buffer>	m_cylinderIndexBuffer;
-	uint32_t								m_cylinderIndexCount;
-
-	Microsoft::WRL::ComPtr<ID3D11Buffer>	m_coneVertexBuffer;
-	Microsoft::WRL::ComPtr<ID3D11Buffer>	m_coneIndexBuffer;
-	uint32_t								m_coneIndexCount;
-
-	Microsoft::WRL::ComPtr<ID3D11Buffer>	m_modelViewProjectionBuffer;
-	ModelViewProjectionConstantBuffer		m_modelViewProjectionBufferData;
-
-	DirectX::XMMATRIX m_modelMatrix;
+	// One set of buffers per level of detail (level 0 is the most detailed)
+	MeshBuffers								m_cylinderLevels[MeshLevelOfDetail::LevelCount];
+	MeshBuffers								m_coneLevels[MeshLevelOfDetail::LevelCount];
 
 	float m_xyScaling;
 
-	void CreateModelViewProjectionBuffer();
-	void LoadCylinderVertexAndIndexBuffers();
-	void LoadConeVertexAndIndexBuffers();
-
-	void RenderCylinder(DirectX::XMFLOAT3 position, DirectX::XMFLOAT3 velocity, float radius, DirectX::XMMATRIX viewProjection);
-	void RenderCone(DirectX::XMFLOAT3 position, DirectX::XMFLOAT3 velocity, float radius, DirectX::XMMATRIX viewProjection);
+public:
+	// 'cylinderLevels'/'coneLevels' hold the unit cylinder and cone meshes for each level of detail (see MeshManager::CreateMeshes)
+	ArrowMesh(const std::shared_ptr<DeviceResources>& deviceResources,
+			  const std::vector<MeshData>& cylinderLevels, const std::vector<MeshData>& coneLevels);
 
-	DirectX::XMMATRIX ComputeRotationMatrix(DirectX::XMFLOAT3 velocity);
+	// Radius of the cylinder part of the arrow (the cone is twice as wide)
+	float Width() const { return m_xyScaling; }
 
-public:
-	ArrowMesh(const std::shared_ptr<DeviceResources>& deviceResources);
+	// IASetVertexBuffers and IASetIndexBuffer for one part of the arrow at the given level of detail
+	void BindCylinder(unsigned int level = 0);
+	void BindCone(unsigned int level = 0);
 
-	/* Render must be passed the following:
-		1. XMFLOAT3 position       - position of the atom   -> used for translating to compute the model matrix
-		2. float    radius         - radius of the atom     -> used for scaling to compute the model matrix
-		3. XMMATRIX viewProjection - view projection matrix -> used for computing the final modelviewprojection matrix
+	/* RenderCylinderInstanced/RenderConeInstanced draw one part of 'instanceCount' arrows at the given level of detail
 
 		Upstream:
-		1. Simulation Render should have already
+		1. The caller (see SimulationRenderer::SubmitCommands) should have already
+				BindCylinder/BindCone  <- The same level
 				IASetInputLayout
-				IASetPrimitiveTopology <- Only true as long as we are always rendered triangle lists
-				VSSetShader
+				IASetPrimitiveTopology
+				VSSetShader            <- InstancedArrowVertexShader
 				PSSetShader
-				PSSetConstantBuffers1  <- This will require a lookup for each atom to make sure the correct material is used
+				VSSetShaderResources   <- The arrow instances (see VelocityArrowPacker)
+				PSSetShaderResources   <- The material table (see MaterialTable)
+				VSSetConstantBuffers1  <- The view projection matrix, first instance and part of the arrow
 
 		Responsilities:
-		1. Render will perform the following
-				IASetVertexBuffers
-				ISSetIndexBuffer
-				VSSetConstantBuffers1
-				DrawIndexed
+		1. RenderCylinderInstanced/RenderConeInstanced will perform the following
+				DrawIndexedInstanced
 	*/
-	void Render(DirectX::XMFLOAT3 position, DirectX::XMFLOAT3 velocity, float radius, DirectX::XMMATRIX viewProjection);
-
-	DirectX::XMMATRIX ModelMatrix() { return m_modelMatrix; }
-
+	void RenderCylinderInstanced(unsigned int instanceCount, unsigned int level = 0);
+	void RenderConeInstanced(unsigned int instanceCount, unsigned int level = 0);
 };
\ No newline at end of file
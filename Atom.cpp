@@ -1,11 +1,12 @@
 #include "Atom.h"
 
 using DirectX::XMFLOAT3;
+using DirectX::XMFLOAT4X4;
 using DirectX::XMMATRIX;
 using DirectX::XMVECTOR;
 
 
-Atom::Atom(const std::shared_ptr<DeviceResources>& deviceResources, ELEMENT element, XMFLOAT3 position, XMFLOAT3 velocity) :
+Atom::Atom(const std::shared_ptr<HandleAllocator>& handleAllocator, ELEMENT element, XMFLOAT3 position, XMFLOAT3 velocity) :
 	m_element(element),
 	m_position(position),
 	m_velocity(velocity),
@@ -13,14 +14,16 @@ Atom::Atom(const std::shared_ptr<DeviceResources>& deviceResources, ELEMENT elem
 	m_radius(Constants::AtomicRadii[element]),
 	m_sphereMesh(nullptr),
 	m_arrowMesh(nullptr),
-	m_showVelocityArrow(false)
+	m_showVelocityArrow(false),
+	m_handleAllocator(handleAllocator),
+	m_handle(m_handleAllocator->Allocate())
 {
 	// Populate the electrons
 	for (int iii = 0; iii < element; ++iii)
 		m_electrons.push_back(std::shared_ptr<Electron>(new Electron()));
 }
 
-Atom::Atom(const std::shared_ptr<DeviceResources>& deviceResources, ELEMENT element, XMFLOAT3 position, XMFLOAT3 velocity, int neutronCount, int electronCount) :
+Atom::Atom(const std::shared_ptr<HandleAllocator>& handleAllocator, ELEMENT element, XMFLOAT3 position, XMFLOAT3 velocity, int neutronCount, int electronCount) :
 	m_element(element),
 	m_position(position),
 	m_velocity(velocity),
@@ -28,14 +31,16 @@ Atom::Atom(const std::shared_ptr<DeviceResources>& deviceResources, ELEMENT elem
 	m_radius(Constants::AtomicRadii[element]),
 	m_sphereMesh(nullptr),
 	m_arrowMesh(nullptr),
-	m_showVelocityArrow(false)
+	m_showVelocityArrow(false),
+	m_handleAllocator(handleAllocator),
+	m_handle(m_handleAllocator->Allocate())
 {
 	// Populate the electrons
 	for (int iii = 0; iii < electronCount; ++iii)
 		m_electrons.push_back(std::shared_ptr<Electron>(new Electron()));
 }
 
-Atom::Atom(const std::shared_ptr<DeviceResources>& deviceResources, ELEMENT element, XMFLOAT3 position, XMFLOAT3 velocity, int neutronCount, int electronCount, float radius) :
+Atom::Atom(const std::shared_ptr<HandleAllocator>& handleAllocator, ELEMENT element, XMFLOAT3 position, XMFLOAT3 velocity, int neutronCount, int electronCount, float radius) :
 	m_element(element),
 	m_position(position),
 	m_velocity(velocity),
@@ -43,7 +48,9 @@ Atom::Atom(const std::shared_ptr<DeviceResources>& deviceResources, ELEMENT elem
 	m_radius(radius),
 	m_sphereMesh(nullptr),
 	m_arrowMesh(nullptr),
-	m_showVelocityArrow(false)
+	m_showVelocityArrow(false),
+	m_handleAllocator(handleAllocator),
+	m_handle(m_handleAllocator->Allocate())
 {
 	// Populate the electrons
 	for (int iii = 0; iii < electronCount; ++iii)
@@ -51,23 +58,20 @@ Atom::Atom(const std::shared_ptr<DeviceResources>& deviceResources, ELEMENT elem
 }
 
 
-void Atom::Render(XMMATRIX viewProjectionMatrix)
+void Atom::Render(RenderCommandList& commands, const RenderStateBlock& state, uint32_t materialIndex)
 {
-	m_sphereMesh->Render(m_position, m_radius, viewProjectionMatrix);
+	RenderOutline(commands, state, 0.0f, materialIndex);
 }
 
-void Atom::RenderOutline(DirectX::XMMATRIX viewProjectionMatrix, float outlineWidth)
+void Atom::RenderOutline(RenderCommandList& commands, const RenderStateBlock& state, float outlineWidth, uint32_t materialIndex)
 {
-	m_sphereMesh->Render(m_position, m_radius + outlineWidth, viewProjectionMatrix);
+	// Always use the most detailed level - this is only used for the hovered/selected atoms
+	XMFLOAT4X4 model;
+	DirectX::XMStoreFloat4x4(&model, SphereMesh::ModelMatrix(m_position, m_radius + outlineWidth));
+	commands.Draw(state, RenderMesh::SPHERE, 0, model.m, materialIndex);
 }
 
 
-void Atom::RenderVelocityArrow(XMMATRIX viewProjectionMatrix)
-{
-	if (m_showVelocityArrow)
-		m_arrowMesh->Render(m_position, m_velocity, m_radius, viewProjectionMatrix);
-}
-
 std::wstring Atom::Name()
 {
 	// This will return something like "class Hydrogen"
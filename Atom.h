@@ -3,9 +3,10 @@
 
 #include "Bond.h"
 #include "Constants.h"
-#include "DeviceResources.h"
 #include "Electron.h"
 #include "Enums.h"
+#include "HandleAllocator.h"
+#include "RenderCommandList.h"
 #include "SphereMesh.h"
 #include "ArrowMesh.h"
 
@@ -20,44 +21,42 @@ class Atom
 {
 public:
 	// Constructors
-	Atom(const std::shared_ptr<DeviceResources>& deviceResources,
+	Atom(const std::shared_ptr<HandleAllocator>& handleAllocator,
 		ELEMENT element,
 		DirectX::XMFLOAT3 position, DirectX::XMFLOAT3 velocity);
 
-	Atom(const std::shared_ptr<DeviceResources>& deviceResources,
+	Atom(const std::shared_ptr<HandleAllocator>& handleAllocator,
 		ELEMENT element,
 		DirectX::XMFLOAT3 position, DirectX::XMFLOAT3 velocity,
 		int neutronCount, int electronCount);
 
 	// If you want to explicitly set the radius
-	Atom(const std::shared_ptr<DeviceResources>& deviceResources,
+	Atom(const std::shared_ptr<HandleAllocator>& handleAllocator,
 		ELEMENT element,
 		DirectX::XMFLOAT3 position, DirectX::XMFLOAT3 velocity,
 		int neutronCount, int electronCount,
 		float radius);
 
 	// Virtual destructor
-	virtual ~Atom() {}
-
-	// Update
-	virtual void Update(double timeDelta, const std::vector<std::shared_ptr<Atom>>& atoms, DirectX::XMFLOAT3 boxDimensions) = 0;
+	virtual ~Atom() { m_handleAllocator->Release(m_handle); }
 
 	// Show / hide velocity arrows
 	void ShowVelocityArrow() { m_showVelocityArrow = true; }
 	void HideVelocityArrow() { m_showVelocityArrow = false; }
 	void SwitchVelocityArrowVisibility() { m_showVelocityArrow = !m_showVelocityArrow; }
+	bool VelocityArrowIsVisible() { return m_showVelocityArrow; }
 
-	// Render
-	void Render(DirectX::XMMATRIX viewProjectionMatrix);
-	void RenderOutline(DirectX::XMMATRIX viewProjectionMatrix, float outlineWidth);
-	void RenderVelocityArrow(DirectX::XMMATRIX viewProjectionMatrix);
-	DirectX::XMMATRIX ModelMatrix() { return m_sphereMesh->ModelMatrix(); }
+	// Render - record the draws for the atom (see RenderCommandList). Velocity arrows are drawn instanced
+	// for all atoms at once (see VelocityArrowPacker)
+	void Render(RenderCommandList& commands, const RenderStateBlock& state, uint32_t materialIndex);
+	void RenderOutline(RenderCommandList& commands, const RenderStateBlock& state, float outlineWidth, uint32_t materialIndex);
 	DirectX::XMMATRIX TranslationMatrix() { return DirectX::XMMatrixTranslation(m_position.x, m_position.y, m_position.z); }
 
 	// Get
 	DirectX::XMFLOAT3 Position() { return m_position; };
 	DirectX::XMFLOAT3 Velocity() { return m_velocity; };
 	ELEMENT ElementType() { return m_element; }
+	uint32_t Handle() const { return m_handle; } // Small unique id, reused after the atom is destroyed (indexes the selection bitset)
 	float Mass() { return static_cast<float>(m_element + m_neutronCount); }
 	int ProtonsCount() { return m_element; }
 	int NeutronsCount() { return m_neutronCount; }
@@ -74,6 +73,7 @@ public:
 	std::shared_ptr<Bond> GetBondWithAtom(const std::shared_ptr<Atom>& atom);
 
 	// Set
+	void Position(DirectX::XMFLOAT3 position) { m_position = position; }
 	void Velocity(DirectX::XMFLOAT3 velocity) { m_velocity = velocity; }
 	void SetSphereMesh(const std::shared_ptr<SphereMesh>& mesh) { m_sphereMesh = mesh; }
 	void SetArrowMesh(const std::shared_ptr<ArrowMesh>& mesh) { m_arrowMesh = mesh; }
@@ -111,4 +111,9 @@ protected:
 	float			m_radius;
 
 	bool			m_showVelocityArrow;
+
+	// Handles are unique within the simulation that created the atom (see Simulation::AddNewAtom). The
+	// atom keeps the allocator alive so it can release its handle even if it outlives the simulation
+	std::shared_ptr<HandleAllocator>	m_handleAllocator;
+	uint32_t							m_handle;
 };
\ No newline at end of file
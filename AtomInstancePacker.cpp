@@ -0,0 +1,76 @@
+#include "AtomInstancePacker.h"
+#include "CameraSpace.h"
+#include "Frustum.h"
+#include "MeshGeometry.h"
+
+#include <cmath>
+
+
+void AtomInstancePacker::BuildBatches()
+{
+	m_batches.clear();
+	m_offsets.resize(m_counts.size());
+
+	uint32_t offset = 0;
+	for (uint32_t material = 0; material < m_counts.size(); ++material)
+	{
+		m_offsets[material] = offset;
+
+		if (m_counts[material] > 0)
+			m_batches.push_back({ material, offset, m_counts[material], 0 });
+
+		offset += m_counts[material];
+	}
+}
+
+void AtomInstancePacker::Rebase(const double origin[3])
+{
+	if (!m_instances.empty())
+		CameraSpace::Rebase(origin, m_instances[0].Position, sizeof(AtomInstance), m_instances.size());
+}
+
+void AtomInstancePacker::Cull(const Frustum& frustum)
+{
+	if (m_instances.empty())
+		return;
+
+	// Position and Radius are the first 4 floats of AtomInstance, so the frustum can test the packed array directly
+	m_visible.resize(m_instances.size());
+	frustum.IntersectsSpheres(m_instances[0].Position, sizeof(AtomInstance), m_instances.size(), m_visible.data());
+
+	// Compact each batch in place. Batches are in instance order, so the write position never passes the read position
+	uint32_t write = 0;
+	size_t batchWrite = 0;
+	for (const AtomInstanceBatch& batch : m_batches)
+	{
+		uint32_t first = write;
+		for (uint32_t read = batch.FirstInstance; read < batch.FirstInstance + batch.InstanceCount; ++read)
+		{
+			if (m_visible[read])
+				m_instances[write++] = m_instances[read];
+		}
+
+		if (write > first)
+			m_batches[batchWrite++] = { batch.MaterialIndex, first, write - first, batch.Level };
+	}
+
+	m_instances.resize(write);
+	m_batches.resize(batchWrite);
+}
+
+void AtomInstancePacker::AssignLevels(const float eye[3], float pixelsPerUnit)
+{
+	m_levels.resize(m_instances.size());
+	for (size_t iii = 0; iii < m_instances.size(); ++iii)
+	{
+		const AtomInstance& instance = m_instances[iii];
+		float dx = instance.Position[0] - eye[0];
+		float dy = instance.Position[1] - eye[1];
+		float dz = instance.Position[2] - eye[2];
+		float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+		m_levels[iii] = MeshLevelOfDetail::SelectLevel(MeshLevelOfDetail::ScreenRadius(instance.Radius, distance, pixelsPerUnit));
+	}
+
+	MeshLevelOfDetail::SplitBatches(m_instances, m_batches, m_levels, m_scratchInstances, m_scratchBatches);
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class Frustum;
+
+// Per-atom data for instanced rendering. This is the element type of the structured buffer read by
+// InstancedPhongVertexShader.hlsl, so the layout must match AtomInstance in that file exactly.
+// A sphere only needs a translation and a uniform scale, so the vertex shader builds the model
+// matrix from Position/Radius instead of uploading 3 full matrices per atom.
+struct AtomInstance
+{
+	float		Position[3];
+	float		Radius;
+	uint32_t	MaterialIndex;		// Index into the material table (currently the element number)
+	uint32_t	Outline;			// Selection outline ID written for the screen space outline pass (see SelectionOutline)
+	uint32_t	Padding[2];			// Keep the stride a multiple of 16 bytes
+};
+static_assert(sizeof(AtomInstance) == 32, "AtomInstance must match the HLSL structured buffer stride");
+
+// A contiguous range of instances that share a material and level of detail and are drawn with one DrawIndexedInstanced
+struct AtomInstanceBatch
+{
+	uint32_t	MaterialIndex;
+	uint32_t	FirstInstance;
+	uint32_t	InstanceCount;
+	uint32_t	Level;				// Sphere level of detail (see MeshLevelOfDetail)
+};
+
+// Packs atoms into a single instance array grouped by material (counting sort, so O(N) and stable).
+// The vectors are reused from frame to frame so packing does not allocate once the capacity has
+// grown to fit the largest simulation.
+//
+// Pack is a template so it works for any atom type (or pointer to one) with Position() returning
+// .x/.y/.z, Radius() and ElementType().
+class AtomInstancePacker
+{
+public:
+	template<typename TAtomPointer>
+	void Pack(const std::vector<TAtomPointer>& atoms)
+	{
+		Pack(atoms, [](const TAtomPointer&) { return 0u; });
+	}
+
+	// 'outline' is called for each atom and returns the selection outline ID to store in its instance
+	template<typename TAtomPointer, typename TOutline>
+	void Pack(const std::vector<TAtomPointer>& atoms, TOutline outline);
+
+	// Make the positions relative to 'origin' (see CameraSpace) - call before Cull
+	void Rebase(const double origin[3]);
+
+	// Remove the instances that are entirely outside the frustum. Instances stay grouped by material
+	// and batches that become empty are removed
+	void Cull(const Frustum& frustum);
+
+	// Pick a sphere level of detail for each instance from its radius on screen and split the batches so
+	// each one uses a single level. 'eye' is the camera position and 'pixelsPerUnit' is described in
+	// MeshLevelOfDetail::ScreenRadius
+	void AssignLevels(const float eye[3], float pixelsPerUnit);
+
+	const std::vector<AtomInstance>& Instances() const { return m_instances; }
+	const std::vector<AtomInstanceBatch>& Batches() const { return m_batches; }
+
+private:
+	// Turn m_counts into the starting offset of each material and build m_batches
+	void BuildBatches();
+
+	std::vector<AtomInstance>		m_instances;
+	std::vector<AtomInstanceBatch>	m_batches;
+	std::vector<uint32_t>			m_counts;
+	std::vector<uint32_t>			m_offsets;
+	std::vector<uint8_t>			m_visible;
+	std::vector<uint8_t>			m_levels;
+	std::vector<AtomInstance>		m_scratchInstances;
+	std::vector<AtomInstanceBatch>	m_scratchBatches;
+};
+
+template<typename TAtomPointer, typename TOutline>
+void AtomInstancePacker::Pack(const std::vector<TAtomPointer>& atoms, TOutline outline)
+{
+	// Pass 1 - count the atoms of each material
+	m_counts.clear();
+	for (const TAtomPointer& atom : atoms)
+	{
+		uint32_t material = static_cast<uint32_t>(atom->ElementType());
+		if (material >= m_counts.size())
+			m_counts.resize(material + 1, 0);
+
+		++m_counts[material];
+	}
+
+	BuildBatches();
+
+	// Pass 2 - write each atom into the next free slot of its material's range
+	m_instances.resize(atoms.size());
+	for (const TAtomPointer& atom : atoms)
+	{
+		uint32_t material = static_cast<uint32_t>(atom->ElementType());
+		AtomInstance& instance = m_instances[m_offsets[material]++];
+
+		auto position = atom->Position();
+		instance.Position[0] = position.x;
+		instance.Position[1] = position.y;
+		instance.Position[2] = position.z;
+		instance.Radius = atom->Radius();
+		instance.MaterialIndex = material;
+		instance.Outline = static_cast<uint32_t>(outline(atom));
+		instance.Padding[0] = instance.Padding[1] = 0;
+	}
+}
\ No newline at end of file
@@ -10,8 +10,5 @@ public:
 	// Constructors
 	// Most common isotope = Beryllium-9
 	// Most common charge  = +2
-	Beryllium(const std::shared_ptr<DeviceResources>& deviceResources, DirectX::XMFLOAT3 position, DirectX::XMFLOAT3 velocity, int neutronCount = 5, int charge = 2);
-
-	// Update
-	void Update(double timeDelta, const std::vector<std::shared_ptr<Atom>>& atoms, DirectX::XMFLOAT3 boxDimensions) override;
+	Beryllium(const std::shared_ptr<HandleAllocator>& handleAllocator, DirectX::XMFLOAT3 position, DirectX::XMFLOAT3 velocity, int neutronCount = 5, int charge = 2);
 };
\ No newline at end of file
@@ -2,20 +2,23 @@
 #include "Atom.h" // required because we call functions on Atom class which is forward declared in Bond.h
 
 using DirectX::XMFLOAT3;
+using DirectX::XMFLOAT4X4;
 using DirectX::XMMATRIX;
 using DirectX::XMVECTOR;
 
 
-Bond::Bond(const std::shared_ptr<Atom>& atom1, const std::shared_ptr<Atom>& atom2) :
+Bond::Bond(const std::shared_ptr<HandleAllocator>& handleAllocator, const std::shared_ptr<Atom>& atom1, const std::shared_ptr<Atom>& atom2) :
 	m_atom1(atom1),
 	m_atom2(atom2),
 	m_type(BondType::SINGLE),
 	m_cylinderMesh(MeshManager::GetCylinderMesh()),
-	m_springConstant(1.0f)
+	m_springConstant(1.0f),
+	m_handleAllocator(handleAllocator),
+	m_handle(m_handleAllocator->Allocate())
 {
 }
 
-void Bond::RenderAtom1ToMidPoint(XMMATRIX viewProjectionMatrix, DirectX::XMVECTOR eyeVector)
+void Bond::RenderAtom1ToMidPoint(RenderCommandList& commands, const RenderStateBlock& state, DirectX::XMVECTOR eyeVector, uint32_t materialIndex)
 {
 	// Set the radius of the cylinders
 	float radius = Constants::AtomicRadii[Element::HYDROGEN] / 3.0f;
@@ -32,10 +35,10 @@ void Bond::RenderAtom1ToMidPoint(XMMATRIX viewProjectionMatrix, DirectX::XMVECTO
 		midPoint = XMFLOAT3((p1.x + p2.x) / 2.0f, (p1.y + p2.y) / 2.0f, (p1.z + p2.z) / 2.0f);
 
 		// Render the first cylinder from p1 to midPoint
-		m_cylinderMesh->Render(p1, midPoint, radius, viewProjectionMatrix);
+		RenderCylinder(commands, state, p1, midPoint, radius, materialIndex);
 	}
 }
-void Bond::RenderOutline(DirectX::XMMATRIX viewProjectionMatrix, DirectX::XMVECTOR eyeVector, float radiusIncrease)
+void Bond::RenderOutline(RenderCommandList& commands, const RenderStateBlock& state, DirectX::XMVECTOR eyeVector, float radiusIncrease, uint32_t materialIndex)
 {
 	// Set the radius of the cylinders
 	float radius = Constants::AtomicRadii[Element::HYDROGEN] / 3.0f;
@@ -52,10 +55,10 @@ void Bond::RenderOutline(DirectX::XMMATRIX viewProjectionMatrix, DirectX::XMVECT
 		// midPoint = XMFLOAT3((p1.x + p2.x) / 2.0f, (p1.y + p2.y) / 2.0f, (p1.z + p2.z) / 2.0f);
 
 		// Render the first cylinder from p1 to midPoint
-		m_cylinderMesh->Render(p1, p2, radius + radiusIncrease, viewProjectionMatrix);
+		RenderCylinder(commands, state, p1, p2, radius + radiusIncrease, materialIndex);
 	}
 }
-void Bond::RenderMidPointToAtom2(XMMATRIX viewProjectionMatrix, DirectX::XMVECTOR eyeVector)
+void Bond::RenderMidPointToAtom2(RenderCommandList& commands, const RenderStateBlock& state, DirectX::XMVECTOR eyeVector, uint32_t materialIndex)
 {
 	// Set the radius of the cylinders
 	float radius = Constants::AtomicRadii[Element::HYDROGEN] / 3.0f;
@@ -72,9 +75,19 @@ void Bond::RenderMidPointToAtom2(XMMATRIX viewProjectionMatrix, DirectX::XMVECTO
 		midPoint = XMFLOAT3((p1.x + p2.x) / 2.0f, (p1.y + p2.y) / 2.0f, (p1.z + p2.z) / 2.0f);
 
 		// Render the first cylinder from p1 to midPoint
-		m_cylinderMesh->Render(midPoint, p2, radius, viewProjectionMatrix);
+		RenderCylinder(commands, state, midPoint, p2, radius, materialIndex);
 	}
 }
+void Bond::RenderCylinder(RenderCommandList& commands, const RenderStateBlock& state, XMFLOAT3 position1, XMFLOAT3 position2, float radius, uint32_t materialIndex)
+{
+	if (position1.x == position2.x && position1.y == position2.y && position1.z == position2.z)
+		return;
+
+	// Always use the most detailed level - this is only used for the hovered/selected bonds
+	XMFLOAT4X4 model;
+	DirectX::XMStoreFloat4x4(&model, m_cylinderMesh->ModelMatrix(position1, position2, radius));
+	commands.Draw(state, RenderMesh::CYLINDER, 0, model.m, materialIndex);
+}
 /*
 void Bond::RenderMidPointToAtom2Outline(DirectX::XMMATRIX viewProjectionMatrix, DirectX::XMVECTOR eyeVector, float radiusIncrease)
 {
@@ -4,6 +4,8 @@
 #include "CylinderMesh.h"
 #include "MeshManager.h"
 #include "Enums.h"
+#include "HandleAllocator.h"
+#include "RenderCommandList.h"
 
 #include <memory>
 
@@ -12,16 +14,18 @@ class Atom;
 class Bond
 {
 public:
-	Bond(const std::shared_ptr<Atom>& atom1, const std::shared_ptr<Atom>& atom2);
+	Bond(const std::shared_ptr<HandleAllocator>& handleAllocator, const std::shared_ptr<Atom>& atom1, const std::shared_ptr<Atom>& atom2);
+	~Bond() { m_handleAllocator->Release(m_handle); }
 
 	void DeleteBonds() {
 		m_atom1 = nullptr;
 		m_atom2 = nullptr;
 	}
 
-	void RenderAtom1ToMidPoint(DirectX::XMMATRIX viewProjectionMatrix, DirectX::XMVECTOR eyeVector);
-	void RenderOutline(DirectX::XMMATRIX viewProjectionMatrix, DirectX::XMVECTOR eyeVector, float radiusIncrease);
-	void RenderMidPointToAtom2(DirectX::XMMATRIX viewProjectionMatrix, DirectX::XMVECTOR eyeVector);
+	// Record the draws for the bond (see RenderCommandList)
+	void RenderAtom1ToMidPoint(RenderCommandList& commands, const RenderStateBlock& state, DirectX::XMVECTOR eyeVector, uint32_t materialIndex);
+	void RenderOutline(RenderCommandList& commands, const RenderStateBlock& state, DirectX::XMVECTOR eyeVector, float radiusIncrease, uint32_t materialIndex);
+	void RenderMidPointToAtom2(RenderCommandList& commands, const RenderStateBlock& state, DirectX::XMVECTOR eyeVector, uint32_t materialIndex);
 	//void RenderMidPointToAtom2Outline(DirectX::XMMATRIX viewProjectionMatrix, DirectX::XMVECTOR eyeVector, float radiusIncrease);
 
 
@@ -32,6 +36,8 @@ public:
 	std::shared_ptr<Atom> Atom1() { return m_atom1; }
 	std::shared_ptr<Atom> Atom2() { return m_atom2; }
 
+	uint32_t Handle() const { return m_handle; } // Small unique id, reused after the bond is destroyed (indexes the selection bitset)
+
 	float BondLength(); 
 	float EquilibriumLength();
 	float SpringConstant() { return m_springConstant; }
@@ -48,6 +54,9 @@ private:
 	DirectX::XMFLOAT3 BondStartPosition(DirectX::XMVECTOR eyeVector, int cylinderNumber = 1);
 	DirectX::XMFLOAT3 BondEndPosition(DirectX::XMVECTOR eyeVector, int cylinderNumber = 1);
 
+	// Record a single cylinder from position1 to position2 - zero length cylinders are skipped
+	void RenderCylinder(RenderCommandList& commands, const RenderStateBlock& state, DirectX::XMFLOAT3 position1, DirectX::XMFLOAT3 position2, float radius, uint32_t materialIndex);
+
 
 	std::shared_ptr<Atom> m_atom1;
 	std::shared_ptr<Atom> m_atom2;
@@ -57,4 +66,8 @@ private:
 	std::shared_ptr<CylinderMesh> m_cylinderMesh;
 
 	float m_springConstant;
+
+	// Unique within the simulation that created the bond (see Atom::m_handleAllocator)
+	std::shared_ptr<HandleAllocator> m_handleAllocator;
+	uint32_t m_handle;
 };
\ No newline at end of file
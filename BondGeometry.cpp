@@ -0,0 +1,231 @@
+#include "BondGeometry.h"
+#include "CameraSpace.h"
+#include "Frustum.h"
+#include "MeshGeometry.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+void BondGeometry::Clear()
+{
+	m_x1.clear(); m_y1.clear(); m_z1.clear(); m_r1.clear();
+	m_x2.clear(); m_y2.clear(); m_z2.clear(); m_r2.clear();
+	m_material1.clear();
+	m_material2.clear();
+	m_type.clear();
+	m_outline.clear();
+}
+
+void BondGeometry::AddBond(const float position1[3], float radius1, uint32_t material1,
+						   const float position2[3], float radius2, uint32_t material2, uint32_t bondType, uint32_t outline)
+{
+	m_x1.push_back(position1[0]);
+	m_y1.push_back(position1[1]);
+	m_z1.push_back(position1[2]);
+	m_r1.push_back(radius1);
+
+	m_x2.push_back(position2[0]);
+	m_y2.push_back(position2[1]);
+	m_z2.push_back(position2[2]);
+	m_r2.push_back(radius2);
+
+	m_material1.push_back(material1);
+	m_material2.push_back(material2);
+	m_type.push_back(std::min(bondType, 3u));
+	m_outline.push_back(outline);
+}
+
+void BondGeometry::Rebase(const double origin[3])
+{
+	// Structure of arrays, so one axis at a time
+	auto rebase = [](std::vector<float>& values, double offset) {
+		for (float& value : values)
+			value = static_cast<float>(static_cast<double>(value) - offset);
+	};
+
+	rebase(m_x1, origin[0]); rebase(m_y1, origin[1]); rebase(m_z1, origin[2]);
+	rebase(m_x2, origin[0]); rebase(m_y2, origin[1]); rebase(m_z2, origin[2]);
+}
+
+void BondGeometry::Generate(const float eye[3], float cylinderRadius)
+{
+	const size_t count = m_type.size();
+
+	// Pass 1 - count the half cylinders of each material so each material gets a contiguous range.
+	// Bonds between coincident atoms have no direction and are skipped (as in CylinderMesh::Render)
+	std::fill(m_offsets.begin(), m_offsets.end(), 0);
+	for (size_t iii = 0; iii < count; ++iii)
+	{
+		float dx = m_x2[iii] - m_x1[iii];
+		float dy = m_y2[iii] - m_y1[iii];
+		float dz = m_z2[iii] - m_z1[iii];
+		if (dx * dx + dy * dy + dz * dz == 0.0f)
+			continue;
+
+		uint32_t largest = std::max(m_material1[iii], m_material2[iii]);
+		if (largest >= m_offsets.size())
+			m_offsets.resize(largest + 1, 0);
+
+		m_offsets[m_material1[iii]] += m_type[iii];
+		m_offsets[m_material2[iii]] += m_type[iii];
+	}
+
+	// Turn the counts into starting offsets and build the batches
+	m_batches.clear();
+	uint32_t total = 0;
+	for (uint32_t material = 0; material < m_offsets.size(); ++material)
+	{
+		uint32_t materialCount = m_offsets[material];
+		m_offsets[material] = total;
+
+		if (materialCount > 0)
+			m_batches.push_back({ material, total, materialCount, 0 });
+
+		total += materialCount;
+	}
+
+	m_instances.resize(total);
+
+	// Offset of each cylinder along the separation direction for single, double and triple bonds
+	static const float offsets[4][3] = {
+		{ 0.0f, 0.0f, 0.0f },
+		{ 0.0f, 0.0f, 0.0f },
+		{ Separation, -Separation, 0.0f },
+		{ 1.5f * Separation, 0.0f, -1.5f * Separation }
+	};
+
+	// Pass 2 - compute the geometry
+	for (size_t iii = 0; iii < count; ++iii)
+	{
+		float dx = m_x2[iii] - m_x1[iii];
+		float dy = m_y2[iii] - m_y1[iii];
+		float dz = m_z2[iii] - m_z1[iii];
+		float lengthSquared = dx * dx + dy * dy + dz * dz;
+		if (lengthSquared == 0.0f)
+			continue;
+
+		// Bond direction
+		float inverseLength = 1.0f / std::sqrt(lengthSquared);
+		dx *= inverseLength;
+		dy *= inverseLength;
+		dz *= inverseLength;
+
+		// Separation direction = normalize(cross(eye, direction)). Only needed for double/triple bonds
+		float sx = 0.0f, sy = 0.0f, sz = 0.0f;
+		if (m_type[iii] > 1)
+		{
+			sx = eye[1] * dz - eye[2] * dy;
+			sy = eye[2] * dx - eye[0] * dz;
+			sz = eye[0] * dy - eye[1] * dx;
+
+			float separationLength = std::sqrt(sx * sx + sy * sy + sz * sz);
+			if (separationLength > 0.0f)
+			{
+				sx /= separationLength;
+				sy /= separationLength;
+				sz /= separationLength;
+			}
+		}
+
+		// Move the ends just inside the surface of each atom
+		float r1 = m_r1[iii] * RadiusFactor;
+		float r2 = m_r2[iii] * RadiusFactor;
+		float startX = m_x1[iii] + dx * r1, startY = m_y1[iii] + dy * r1, startZ = m_z1[iii] + dz * r1;
+		float endX = m_x2[iii] - dx * r2, endY = m_y2[iii] - dy * r2, endZ = m_z2[iii] - dz * r2;
+
+		// Half of the (shortened) bond
+		float halfX = (endX - startX) * 0.5f;
+		float halfY = (endY - startY) * 0.5f;
+		float halfZ = (endZ - startZ) * 0.5f;
+
+		for (uint32_t cylinder = 0; cylinder < m_type[iii]; ++cylinder)
+		{
+			float offset = offsets[m_type[iii]][cylinder];
+			float x = startX + sx * offset;
+			float y = startY + sy * offset;
+			float z = startZ + sz * offset;
+
+			// Start to midpoint uses atom 1's material
+			BondCylinderInstance& first = m_instances[m_offsets[m_material1[iii]]++];
+			first.Start[0] = x;
+			first.Start[1] = y;
+			first.Start[2] = z;
+			first.Radius = cylinderRadius;
+			first.Axis[0] = halfX;
+			first.Axis[1] = halfY;
+			first.Axis[2] = halfZ;
+			first.MaterialAndOutline = m_material1[iii] | (m_outline[iii] << 24);
+
+			// Midpoint to end uses atom 2's material
+			BondCylinderInstance& second = m_instances[m_offsets[m_material2[iii]]++];
+			second.Start[0] = x + halfX;
+			second.Start[1] = y + halfY;
+			second.Start[2] = z + halfZ;
+			second.Radius = cylinderRadius;
+			second.Axis[0] = halfX;
+			second.Axis[1] = halfY;
+			second.Axis[2] = halfZ;
+			second.MaterialAndOutline = m_material2[iii] | (m_outline[iii] << 24);
+		}
+	}
+}
+
+void BondGeometry::Cull(const Frustum& frustum)
+{
+	const size_t count = m_instances.size();
+
+	// Bounding sphere of each cylinder: centered halfway along the axis, enclosing both end caps
+	m_bounds.resize(4 * count);
+	for (size_t iii = 0; iii < count; ++iii)
+	{
+		const BondCylinderInstance& instance = m_instances[iii];
+		float halfX = instance.Axis[0] * 0.5f;
+		float halfY = instance.Axis[1] * 0.5f;
+		float halfZ = instance.Axis[2] * 0.5f;
+
+		m_bounds[4 * iii + 0] = instance.Start[0] + halfX;
+		m_bounds[4 * iii + 1] = instance.Start[1] + halfY;
+		m_bounds[4 * iii + 2] = instance.Start[2] + halfZ;
+		m_bounds[4 * iii + 3] = std::sqrt(halfX * halfX + halfY * halfY + halfZ * halfZ) + instance.Radius;
+	}
+
+	m_visible.resize(count);
+	frustum.IntersectsSpheres(m_bounds.data(), 4 * sizeof(float), count, m_visible.data());
+
+	// Compact each batch in place. Batches are in instance order, so the write position never passes the read position
+	uint32_t write = 0;
+	size_t batchWrite = 0;
+	for (const BondCylinderBatch& batch : m_batches)
+	{
+		uint32_t first = write;
+		for (uint32_t read = batch.FirstInstance; read < batch.FirstInstance + batch.InstanceCount; ++read)
+		{
+			if (m_visible[read])
+				m_instances[write++] = m_instances[read];
+		}
+
+		if (write > first)
+			m_batches[batchWrite++] = { batch.MaterialIndex, first, write - first, batch.Level };
+	}
+
+	m_instances.resize(write);
+	m_batches.resize(batchWrite);
+}
+
+void BondGeometry::AssignLevels(const float eye[3], float pixelsPerUnit)
+{
+	m_levels.resize(m_instances.size());
+	for (size_t iii = 0; iii < m_instances.size(); ++iii)
+	{
+		const BondCylinderInstance& instance = m_instances[iii];
+		float dx = instance.Start[0] + 0.5f * instance.Axis[0] - eye[0];
+		float dy = instance.Start[1] + 0.5f * instance.Axis[1] - eye[1];
+		float dz = instance.Start[2] + 0.5f * instance.Axis[2] - eye[2];
+		float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+		m_levels[iii] = MeshLevelOfDetail::SelectLevel(MeshLevelOfDetail::ScreenRadius(instance.Radius, distance, pixelsPerUnit));
+	}
+
+	MeshLevelOfDetail::SplitBatches(m_instances, m_batches, m_levels, m_scratchInstances, m_scratchBatches);
+}
\ No newline at end of file
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Frustum;
+
+// Per-cylinder data for instanced bond rendering. This is the element type of the structured buffer
+// read by InstancedCylinderVertexShader.hlsl, so the layout must match BondCylinderInstance in that
+// file exactly. The vertex shader builds the same model matrix as CylinderMesh::ModelMatrix from the
+// start point, the axis (end - start) and the radius.
+struct BondCylinderInstance
+{
+	float		Start[3];
+	float		Radius;
+	float		Axis[3];			// End - Start (not normalized - the length is the cylinder height)
+	uint32_t	MaterialAndOutline;	// Bits 0-23: index into the material table (currently the element number)
+									// Bits 24-31: selection outline ID (see SelectionOutline) - packed so the stride stays 32 bytes
+};
+static_assert(sizeof(BondCylinderInstance) == 32, "BondCylinderInstance must match the HLSL structured buffer stride");
+
+// A contiguous range of cylinders that share a material and level of detail and are drawn with one DrawIndexedInstanced
+struct BondCylinderBatch
+{
+	uint32_t	MaterialIndex;
+	uint32_t	FirstInstance;
+	uint32_t	InstanceCount;
+	uint32_t	Level;				// Cylinder level of detail (see MeshLevelOfDetail)
+};
+
+// Generates the half-bond cylinders for every bond in one pass. Each bond is drawn as 1, 2 or 3
+// parallel cylinders (single/double/triple) and each cylinder is split at its midpoint so the half
+// nearest each atom can use that atom's material. This is the same geometry as Bond::RenderAtom1ToMidPoint
+// and Bond::RenderMidPointToAtom2, but the normalize/cross product is done once per bond instead of
+// once per cylinder end, and everything is written to one array so it can be drawn instanced.
+//
+// The bonds are first packed into structure-of-arrays form so Generate is a straight loop over
+// contiguous floats that the compiler can vectorize.
+//
+// Pack is a template so it works for any bond type with Atom1()/Atom2() (providing Position(),
+// DisplayRadius(), ElementType()) and GetBondType().
+class BondGeometry
+{
+public:
+	template<typename TBondPointer>
+	void Pack(const std::vector<TBondPointer>& bonds)
+	{
+		Pack(bonds, [](const TBondPointer&) { return 0u; });
+	}
+
+	// 'outline' is called for each bond and returns the selection outline ID to store in its cylinders
+	template<typename TBondPointer, typename TOutline>
+	void Pack(const std::vector<TBondPointer>& bonds, TOutline outline);
+
+	// Clear the packed bonds and add them one at a time (bondType = number of cylinders: 1, 2 or 3)
+	void Clear();
+	void AddBond(const float position1[3], float radius1, uint32_t material1,
+				 const float position2[3], float radius2, uint32_t material2, uint32_t bondType, uint32_t outline = 0);
+
+	// Make the packed atom positions relative to 'origin' (see CameraSpace) - call before Generate, so the
+	// cylinders are computed from the small relative positions
+	void Rebase(const double origin[3]);
+
+	// Compute every half-bond cylinder, grouped by material. 'eye' is the camera position - multiple
+	// bonds are separated along cross(eye, bond direction) so they are side by side on screen. Only the
+	// direction of the eye from the world origin is used, so pass the world space eye even after Rebase
+	void Generate(const float eye[3], float cylinderRadius);
+
+	// Remove the cylinders that are entirely outside the frustum (call after Generate). Cylinders stay
+	// grouped by material and batches that become empty are removed
+	void Cull(const Frustum& frustum);
+
+	// Pick a cylinder level of detail for each cylinder from its radius on screen (at its midpoint) and
+	// split the batches so each one uses a single level. See AtomInstancePacker::AssignLevels
+	void AssignLevels(const float eye[3], float pixelsPerUnit);
+
+	size_t BondCount() const { return m_type.size(); }
+
+	const std::vector<BondCylinderInstance>& Instances() const { return m_instances; }
+	const std::vector<BondCylinderBatch>& Batches() const { return m_batches; }
+
+	// Distance between the cylinders of a double/triple bond (matches Bond::BondStartPosition)
+	static constexpr float Separation = 0.015f;
+
+	// Cylinders start/end slightly inside each atom so no gap is visible (matches Bond::BondStartPosition)
+	static constexpr float RadiusFactor = 0.88f;
+
+private:
+	// Packed bonds (structure of arrays)
+	std::vector<float>		m_x1, m_y1, m_z1, m_r1;
+	std::vector<float>		m_x2, m_y2, m_z2, m_r2;
+	std::vector<uint32_t>	m_material1, m_material2;
+	std::vector<uint32_t>	m_type;
+	std::vector<uint32_t>	m_outline;
+
+	// Output
+	std::vector<BondCylinderInstance>	m_instances;
+	std::vector<BondCylinderBatch>		m_batches;
+	std::vector<uint32_t>				m_offsets;
+	std::vector<float>					m_bounds;		// Bounding sphere (x, y, z, radius) of each cylinder
+	std::vector<uint8_t>				m_visible;
+	std::vector<uint8_t>				m_levels;
+	std::vector<BondCylinderInstance>	m_scratchInstances;
+	std::vector<BondCylinderBatch>		m_scratchBatches;
+};
+
+template<typename TBondPointer, typename TOutline>
+void BondGeometry::Pack(const std::vector<TBondPointer>& bonds, TOutline outline)
+{
+	Clear();
+
+	for (const TBondPointer& bond : bonds)
+	{
+		auto p1 = bond->Atom1()->Position();
+		auto p2 = bond->Atom2()->Position();
+		const float position1[3] = { p1.x, p1.y, p1.z };
+		const float position2[3] = { p2.x, p2.y, p2.z };
+
+		AddBond(position1, bond->Atom1()->DisplayRadius(), static_cast<uint32_t>(bond->Atom1()->ElementType()),
+				position2, bond->Atom2()->DisplayRadius(), static_cast<uint32_t>(bond->Atom2()->ElementType()),
+				static_cast<uint32_t>(bond->GetBondType()), static_cast<uint32_t>(outline(bond)));
+	}
+}
\ No newline at end of file
@@ -0,0 +1,319 @@
+#include "BoundingVolumeHierarchy.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <numeric>
+
+namespace
+{
+	// Distance along the ray to the box, or FLT_MAX if the ray misses it
+	float IntersectBox(const float origin[3], const float inverseDirection[3], const float min[3], const float max[3])
+	{
+		float tNear = 0.0f;
+		float tFar = FLT_MAX;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			float t1 = (min[axis] - origin[axis]) * inverseDirection[axis];
+			float t2 = (max[axis] - origin[axis]) * inverseDirection[axis];
+			tNear = std::max(tNear, std::min(t1, t2));
+			tFar = std::min(tFar, std::max(t1, t2));
+		}
+		return tNear <= tFar ? tNear : FLT_MAX;
+	}
+}
+
+
+void BoundingVolumeHierarchy::Clear()
+{
+	m_primitives.clear();
+	m_sphereCount = 0;
+	m_capsuleCount = 0;
+}
+
+void BoundingVolumeHierarchy::AddSphere(const float center[3], float radius)
+{
+	Primitive primitive;
+	std::copy(center, center + 3, primitive.A);
+	std::copy(center, center + 3, primitive.B);
+	primitive.Radius = radius;
+	primitive.Type = PrimitiveType::SPHERE;
+	primitive.Index = static_cast<uint32_t>(m_sphereCount++);
+	m_primitives.push_back(primitive);
+}
+
+void BoundingVolumeHierarchy::AddCapsule(const float start[3], const float end[3], float radius)
+{
+	Primitive primitive;
+	std::copy(start, start + 3, primitive.A);
+	std::copy(end, end + 3, primitive.B);
+	primitive.Radius = radius;
+	primitive.Type = PrimitiveType::CAPSULE;
+	primitive.Index = static_cast<uint32_t>(m_capsuleCount++);
+	m_primitives.push_back(primitive);
+}
+
+void BoundingVolumeHierarchy::Update()
+{
+	if (m_nodes.empty() || m_sphereCount != m_builtSphereCount || m_capsuleCount != m_builtCapsuleCount)
+	{
+		Build();
+		return;
+	}
+
+	Refit();
+
+	// Refitting keeps the tree valid but the boxes overlap more and more as the atoms move. Rebuild once
+	// the root has grown to twice its original size
+	if (SurfaceArea(m_nodes[0].Min, m_nodes[0].Max) > 2.0f * m_builtSurfaceArea)
+		Build();
+}
+
+void BoundingVolumeHierarchy::Build()
+{
+	const uint32_t count = static_cast<uint32_t>(m_primitives.size());
+
+	m_order.resize(count);
+	std::iota(m_order.begin(), m_order.end(), 0u);
+
+	// A binary tree with at least one primitive per leaf has fewer than 2N nodes. Reserving up front means
+	// Subdivide can hold indices into m_nodes without them being invalidated
+	m_nodes.clear();
+	m_nodes.reserve(2 * static_cast<size_t>(std::max(count, 1u)));
+	m_nodes.push_back(Node());
+	Subdivide(0, 0, count);
+
+	GatherLeafArrays();
+
+	m_builtSphereCount = m_sphereCount;
+	m_builtCapsuleCount = m_capsuleCount;
+	m_builtSurfaceArea = SurfaceArea(m_nodes[0].Min, m_nodes[0].Max);
+}
+
+void BoundingVolumeHierarchy::Subdivide(uint32_t node, uint32_t first, uint32_t count)
+{
+	ComputeBounds(first, count, m_nodes[node].Min, m_nodes[node].Max);
+
+	if (count <= LeafSize)
+	{
+		m_nodes[node].First = first;
+		m_nodes[node].Count = count;
+		return;
+	}
+
+	// Split at the median centroid along the longest axis of the centroids
+	float centroidMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+	float centroidMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for (uint32_t iii = first; iii < first + count; ++iii)
+	{
+		const Primitive& primitive = m_primitives[m_order[iii]];
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			float centroid = primitive.A[axis] + primitive.B[axis];
+			centroidMin[axis] = std::min(centroidMin[axis], centroid);
+			centroidMax[axis] = std::max(centroidMax[axis], centroid);
+		}
+	}
+
+	int axis = 0;
+	if (centroidMax[1] - centroidMin[1] > centroidMax[axis] - centroidMin[axis]) axis = 1;
+	if (centroidMax[2] - centroidMin[2] > centroidMax[axis] - centroidMin[axis]) axis = 2;
+
+	uint32_t half = count / 2;
+	std::nth_element(m_order.begin() + first, m_order.begin() + first + half, m_order.begin() + first + count,
+		[this, axis](uint32_t lhs, uint32_t rhs)
+		{
+			// Twice the centroid - only the order matters
+			return m_primitives[lhs].A[axis] + m_primitives[lhs].B[axis] < m_primitives[rhs].A[axis] + m_primitives[rhs].B[axis];
+		}
+	);
+
+	uint32_t left = static_cast<uint32_t>(m_nodes.size());
+	m_nodes.push_back(Node());
+	m_nodes.push_back(Node());
+	m_nodes[node].First = left;
+	m_nodes[node].Count = 0;
+
+	Subdivide(left, first, half);
+	Subdivide(left + 1, first + half, count - half);
+}
+
+void BoundingVolumeHierarchy::Refit()
+{
+	GatherLeafArrays();
+
+	for (size_t iii = m_nodes.size(); iii-- > 0;)
+	{
+		Node& node = m_nodes[iii];
+		if (node.Count > 0)
+		{
+			ComputeBounds(node.First, node.Count, node.Min, node.Max);
+			continue;
+		}
+
+		const Node& left = m_nodes[node.First];
+		const Node& right = m_nodes[node.First + 1];
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			node.Min[axis] = std::min(left.Min[axis], right.Min[axis]);
+			node.Max[axis] = std::max(left.Max[axis], right.Max[axis]);
+		}
+	}
+}
+
+void BoundingVolumeHierarchy::GatherLeafArrays()
+{
+	const size_t count = m_order.size();
+	m_x1.resize(count); m_y1.resize(count); m_z1.resize(count);
+	m_x2.resize(count); m_y2.resize(count); m_z2.resize(count);
+	m_radius.resize(count);
+
+	for (size_t iii = 0; iii < count; ++iii)
+	{
+		const Primitive& primitive = m_primitives[m_order[iii]];
+		m_x1[iii] = primitive.A[0];
+		m_y1[iii] = primitive.A[1];
+		m_z1[iii] = primitive.A[2];
+		m_x2[iii] = primitive.B[0];
+		m_y2[iii] = primitive.B[1];
+		m_z2[iii] = primitive.B[2];
+		m_radius[iii] = primitive.Radius;
+	}
+}
+
+void BoundingVolumeHierarchy::ComputeBounds(uint32_t first, uint32_t count, float min[3], float max[3]) const
+{
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		min[axis] = FLT_MAX;
+		max[axis] = -FLT_MAX;
+	}
+
+	for (uint32_t iii = first; iii < first + count; ++iii)
+	{
+		float primitiveMin[3], primitiveMax[3];
+		PrimitiveBounds(m_primitives[m_order[iii]], primitiveMin, primitiveMax);
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			min[axis] = std::min(min[axis], primitiveMin[axis]);
+			max[axis] = std::max(max[axis], primitiveMax[axis]);
+		}
+	}
+}
+
+void BoundingVolumeHierarchy::PrimitiveBounds(const Primitive& primitive, float min[3], float max[3]) const
+{
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		min[axis] = std::min(primitive.A[axis], primitive.B[axis]) - primitive.Radius;
+		max[axis] = std::max(primitive.A[axis], primitive.B[axis]) + primitive.Radius;
+	}
+}
+
+float BoundingVolumeHierarchy::SurfaceArea(const float min[3], const float max[3])
+{
+	float x = std::max(max[0] - min[0], 0.0f);
+	float y = std::max(max[1] - min[1], 0.0f);
+	float z = std::max(max[2] - min[2], 0.0f);
+	return 2.0f * (x * y + y * z + z * x);
+}
+
+bool BoundingVolumeHierarchy::Intersect(const float origin[3], const float direction[3], Hit& hit) const
+{
+	if (m_nodes.empty() || m_primitives.empty())
+		return false;
+
+	// Division by a zero component gives +/-infinity, which the slab test handles correctly
+	const float inverseDirection[3] = { 1.0f / direction[0], 1.0f / direction[1], 1.0f / direction[2] };
+
+	float closest = FLT_MAX;
+	const Primitive* closestPrimitive = nullptr;
+
+	// The tree is balanced (median splits) so its depth is about log2(N / LeafSize) - 64 is never reached
+	uint32_t stack[64];
+	int stackSize = 0;
+
+	if (IntersectBox(origin, inverseDirection, m_nodes[0].Min, m_nodes[0].Max) != FLT_MAX)
+		stack[stackSize++] = 0;
+
+	while (stackSize > 0)
+	{
+		const Node& node = m_nodes[stack[--stackSize]];
+
+		if (node.Count > 0)
+		{
+			// Test the whole leaf as one packet
+			const uint32_t first = node.First;
+			const CapsuleArrays capsules = {
+				m_x1.data() + first, m_y1.data() + first, m_z1.data() + first,
+				m_x2.data() + first, m_y2.data() + first, m_z2.data() + first, m_radius.data() + first
+			};
+
+			float distances[LeafSize];
+			IntersectionKernels::RayCapsules(origin, direction, capsules, node.Count, distances);
+
+			size_t nearest = IntersectionKernels::Closest(distances, node.Count);
+			if (nearest < node.Count && distances[nearest] < closest)
+			{
+				closest = distances[nearest];
+				closestPrimitive = &m_primitives[m_order[first + nearest]];
+			}
+			continue;
+		}
+
+		// Visit the nearer child first (pushed last) and skip children further away than the closest hit
+		float leftDistance = IntersectBox(origin, inverseDirection, m_nodes[node.First].Min, m_nodes[node.First].Max);
+		float rightDistance = IntersectBox(origin, inverseDirection, m_nodes[node.First + 1].Min, m_nodes[node.First + 1].Max);
+
+		uint32_t nearChild = node.First;
+		uint32_t farChild = node.First + 1;
+		if (rightDistance < leftDistance)
+		{
+			std::swap(nearChild, farChild);
+			std::swap(leftDistance, rightDistance);
+		}
+
+		if (rightDistance < closest)
+			stack[stackSize++] = farChild;
+		if (leftDistance < closest)
+			stack[stackSize++] = nearChild;
+	}
+
+	if (closestPrimitive == nullptr)
+		return false;
+
+	hit.Type = closestPrimitive->Type;
+	hit.Index = closestPrimitive->Index;
+	hit.Distance = closest;
+	return true;
+}
+
+void BoundingVolumeHierarchy::QuerySphereCenters(const Frustum& frustum, std::vector<uint32_t>& spheres) const
+{
+	if (m_nodes.empty() || m_primitives.empty())
+		return;
+
+	uint32_t stack[64];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while (stackSize > 0)
+	{
+		const Node& node = m_nodes[stack[--stackSize]];
+		if (!frustum.IntersectsBox(node.Min, node.Max))
+			continue;
+
+		if (node.Count == 0)
+		{
+			stack[stackSize++] = node.First;
+			stack[stackSize++] = node.First + 1;
+			continue;
+		}
+
+		for (uint32_t iii = node.First; iii < node.First + node.Count; ++iii)
+		{
+			const Primitive& primitive = m_primitives[m_order[iii]];
+			if (primitive.Type == PrimitiveType::SPHERE && frustum.IntersectsSphere(m_x1[iii], m_y1[iii], m_z1[iii], 0.0f))
+				spheres.push_back(primitive.Index);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "Frustum.h"
+#include "IntersectionKernels.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Bounding volume hierarchy over spheres (atoms) and capsules (bonds) used for mouse picking and
+// rubber band selection. A picking ray is tested against O(log N) boxes instead of every atom and bond,
+// and a selection frustum only visits the parts of the tree it overlaps.
+//
+// The primitives are re-added every time the scene is picked (Clear, AddSphere, AddCapsule, Update).
+// While the same number of spheres and capsules is added the tree topology is kept and only the boxes
+// are refit, which is a single O(N) pass. The tree is rebuilt when primitives are added/removed or when
+// refitting has made the root box much larger than it was when built (atoms have moved a long way).
+//
+// The primitives are also copied into structure-of-arrays form in leaf order, so each leaf is one packet
+// for IntersectionKernels::RayCapsules (a sphere is a capsule with both ends at its center).
+// Everything is in world space with float[3] vectors.
+class BoundingVolumeHierarchy
+{
+public:
+	enum class PrimitiveType : uint32_t
+	{
+		SPHERE,
+		CAPSULE
+	};
+
+	struct Hit
+	{
+		PrimitiveType	Type;
+		uint32_t		Index;		// Index in the order the spheres (or capsules) were added
+		float			Distance;	// Distance along the (normalized) ray
+	};
+
+	void Clear();
+	void AddSphere(const float center[3], float radius);
+	void AddCapsule(const float start[3], const float end[3], float radius);
+
+	// Rebuild or refit the tree for the primitives added since Clear
+	void Update();
+
+	// Find the closest primitive hit by the ray. 'direction' must be normalized. Returns false if
+	// nothing is hit
+	bool Intersect(const float origin[3], const float direction[3], Hit& hit) const;
+
+	// Append the index of every sphere whose center is inside the frustum to 'spheres' (in no particular order)
+	void QuerySphereCenters(const Frustum& frustum, std::vector<uint32_t>& spheres) const;
+
+	size_t PrimitiveCount() const { return m_primitives.size(); }
+	size_t NodeCount() const { return m_nodes.size(); }
+
+private:
+	struct Primitive
+	{
+		float			A[3];		// Sphere center or capsule start
+		float			Radius;
+		float			B[3];		// Capsule end (same as A for a sphere)
+		PrimitiveType	Type;
+		uint32_t		Index;
+	};
+
+	// Leaf nodes have Count > 0 and reference m_order[First, First + Count). Interior nodes have Count == 0
+	// and their children are at First and First + 1. Children are always stored after their parent, so
+	// walking the nodes backwards visits children before parents (used by Refit)
+	struct Node
+	{
+		float		Min[3];
+		uint32_t	First;
+		float		Max[3];
+		uint32_t	Count;
+	};
+
+	static constexpr uint32_t LeafSize = static_cast<uint32_t>(IntersectionKernels::PacketSize);
+
+	void Build();
+	void Refit();
+	void Subdivide(uint32_t node, uint32_t first, uint32_t count);
+	void ComputeBounds(uint32_t first, uint32_t count, float min[3], float max[3]) const;
+	void PrimitiveBounds(const Primitive& primitive, float min[3], float max[3]) const;
+	void GatherLeafArrays();
+
+	static float SurfaceArea(const float min[3], const float max[3]);
+
+	std::vector<Primitive>	m_primitives;
+	std::vector<uint32_t>	m_order;			// Primitive indices in leaf order
+	std::vector<Node>		m_nodes;
+
+	// Primitives in leaf order (m_order) as structure of arrays
+	std::vector<float>		m_x1, m_y1, m_z1, m_x2, m_y2, m_z2, m_radius;
+
+	// Primitive counts and root surface area when the tree was last built
+	size_t					m_builtSphereCount = 0;
+	size_t					m_builtCapsuleCount = 0;
+	float					m_builtSurfaceArea = 0.0f;
+	size_t					m_sphereCount = 0;
+	size_t					m_capsuleCount = 0;
+};
\ No newline at end of file
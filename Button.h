@@ -37,11 +37,11 @@ public:
 	void Click() { ClickMethod(); }
 	void Click(std::function<void()> method) { ClickMethod = method; }
 
-	void SetColorTheme(std::string name) {  m_colorTheme = std::static_pointer_cast<ColorTheme>(ThemeManager::GetTheme(name)); }
-	void SetBorderTheme(std::string name) { m_borderTheme = std::static_pointer_cast<BorderTheme>(ThemeManager::GetTheme(name)); }
+	void SetColorTheme(std::string name) {  m_colorTheme = std::static_pointer_cast<ColorTheme>(ThemeManager::GetTheme(name)); Invalidate(); }
+	void SetBorderTheme(std::string name) { m_borderTheme = std::static_pointer_cast<BorderTheme>(ThemeManager::GetTheme(name)); Invalidate(); }
 
-	void SetColorTheme(std::shared_ptr<ColorTheme> theme) { m_colorTheme = theme; }
-	void SetBorderTheme(std::shared_ptr<BorderTheme> theme) { m_borderTheme = theme; }
+	void SetColorTheme(std::shared_ptr<ColorTheme> theme) { m_colorTheme = theme; Invalidate(); }
+	void SetBorderTheme(std::shared_ptr<BorderTheme> theme) { m_borderTheme = theme; Invalidate(); }
 
 	std::shared_ptr<Layout> GetLayout() { return m_buttonLayout; }
 
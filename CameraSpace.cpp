@@ -0,0 +1,38 @@
+#include "CameraSpace.h"
+
+#include <cmath>
+#include <cstring>
+
+
+void CameraSpace::ReverseZPerspective(float fovAngleY, float aspectRatio, float nearPlane, float projection[4][4])
+{
+	float yScale = 1.0f / std::tan(0.5f * fovAngleY);
+	float xScale = yScale / aspectRatio;
+
+	// clip = (x * xScale, y * yScale, nearPlane, -z) for a view space point (x, y, z) - the view looks down -z
+	std::memset(projection, 0, sizeof(float) * 16);
+	projection[0][0] = xScale;
+	projection[1][1] = yScale;
+	projection[2][3] = -1.0f;
+	projection[3][2] = nearPlane;
+}
+
+void CameraSpace::Rebase(const double origin[3], float* points, size_t stride, size_t count)
+{
+	unsigned char* bytes = reinterpret_cast<unsigned char*>(points);
+
+	for (size_t iii = 0; iii < count; ++iii)
+	{
+		float* point = reinterpret_cast<float*>(bytes + iii * stride);
+		point[0] = static_cast<float>(static_cast<double>(point[0]) - origin[0]);
+		point[1] = static_cast<float>(static_cast<double>(point[1]) - origin[1]);
+		point[2] = static_cast<float>(static_cast<double>(point[2]) - origin[2]);
+	}
+}
+
+void CameraSpace::Rebase(const double origin[3], float model[4][4])
+{
+	// The translation is the last row - moving it by -origin is the same as post-multiplying by a translation
+	for (int axis = 0; axis < 3; ++axis)
+		model[3][axis] = static_cast<float>(static_cast<double>(model[3][axis]) - origin[axis] * model[3][3]);
+}
\ No newline at end of file
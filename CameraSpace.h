@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+
+// Depth and position conventions of the renderers, chosen so large boxes keep their precision:
+//
+//		Reverse Z - the projection maps the near plane to depth 1 and the (infinitely distant) far plane to
+//		depth 0, so the depth test is GREATER and depth is cleared to ClearDepth. A float depth buffer then has
+//		nearly uniform relative precision over the whole view instead of spending it all next to the near plane
+//
+//		Camera relative - positions are rebased on the eye (in double) before they are handed to the GPU, and
+//		the view matrix is only a rotation. Nothing large is ever added to or subtracted from a float on the
+//		GPU, so atoms far from the world origin don't jitter or z-fight as the camera moves
+namespace CameraSpace
+{
+	// Depth of the far plane - what depth buffers are cleared to
+	constexpr float ClearDepth = 0.0f;
+
+	// Right handed perspective projection (like XMMatrixPerspectiveFovRH, row-major for row vectors) with
+	// reverse Z and the far plane at infinity. depth = nearPlane / distance along the view direction
+	void ReverseZPerspective(float fovAngleY, float aspectRatio, float nearPlane, float projection[4][4]);
+
+	// point - origin for 'count' points of 3 consecutive floats, 'stride' bytes apart. The difference is
+	// taken in double and only the (small) result is rounded to float
+	void Rebase(const double origin[3], float* points, size_t stride, size_t count);
+
+	// Move the translation of an affine model matrix (row-major for row vectors) so it is relative to origin
+	void Rebase(const double origin[3], float model[4][4]);
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+#include "Collisions.h"
+
+#include <cmath>
+
+
+double Collisions::SphereSphereTimeOfImpact(const Float3& p1, const Float3& v1, float r1,
+											const Float3& p2, const Float3& v2, float r2)
+{
+	// Solve |d + w t| = R for the smallest t, where d is the separation and w the relative velocity
+	//     (w.w) t^2 + 2 (d.w) t + (d.d - R^2) = 0
+	double dx = static_cast<double>(p1.x) - p2.x;
+	double dy = static_cast<double>(p1.y) - p2.y;
+	double dz = static_cast<double>(p1.z) - p2.z;
+
+	double wx = static_cast<double>(v1.x) - v2.x;
+	double wy = static_cast<double>(v1.y) - v2.y;
+	double wz = static_cast<double>(v1.z) - v2.z;
+
+	double b = dx * wx + dy * wy + dz * wz;
+
+	// Moving apart or not moving relative to each other
+	if (b >= 0.0)
+		return Never;
+
+	double R = static_cast<double>(r1) + r2;
+	double c = dx * dx + dy * dy + dz * dz - R * R;
+
+	// Already overlapping and still approaching - collide immediately
+	if (c <= 0.0)
+		return 0.0;
+
+	double a = wx * wx + wy * wy + wz * wz;
+	double discriminant = b * b - a * c;
+
+	// Closest approach is farther apart than the sum of the radii
+	if (discriminant < 0.0)
+		return Never;
+
+	// Numerically stable form of (-b - sqrt(disc)) / a, since b < 0 here
+	return c / (-b + std::sqrt(discriminant));
+}
+
+double Collisions::SphereWallTimeOfImpact(float position, float velocity, float radius, float halfExtent)
+{
+	double t;
+
+	if (velocity > 0.0f)
+		t = (static_cast<double>(halfExtent) - radius - position) / velocity;
+	else if (velocity < 0.0f)
+		t = (-static_cast<double>(halfExtent) + radius - position) / velocity;
+	else
+		return Never;
+
+	return t > 0.0 ? t : 0.0;
+}
+
+void Collisions::ResolveSphereSphere(const Float3& p1, Float3& v1, float m1,
+									 const Float3& p2, Float3& v2, float m2)
+{
+	// See here for math explanation: https://exploratoria.github.io/exhibits/mechanics/elastic-collisions-in-3d/
+	double nx = static_cast<double>(p1.x) - p2.x;
+	double ny = static_cast<double>(p1.y) - p2.y;
+	double nz = static_cast<double>(p1.z) - p2.z;
+
+	double mag = std::sqrt(nx * nx + ny * ny + nz * nz);
+	if (mag == 0.0)
+		return;
+
+	nx /= mag;
+	ny /= mag;
+	nz /= mag;
+
+	// Relative velocity along the normal - only approaching pairs exchange momentum
+	double vreldotnorm = (static_cast<double>(v1.x) - v2.x) * nx + (static_cast<double>(v1.y) - v2.y) * ny + (static_cast<double>(v1.z) - v2.z) * nz;
+	if (vreldotnorm >= 0.0)
+		return;
+
+	// Impulse magnitude for an elastic collision (reduces to exchanging normal velocities when m1 == m2)
+	double j = 2.0 * vreldotnorm / (static_cast<double>(m1) + m2);
+
+	v1.x -= static_cast<float>(j * m2 * nx);
+	v1.y -= static_cast<float>(j * m2 * ny);
+	v1.z -= static_cast<float>(j * m2 * nz);
+
+	v2.x += static_cast<float>(j * m1 * nx);
+	v2.y += static_cast<float>(j * m1 * ny);
+	v2.z += static_cast<float>(j * m1 * nz);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "HardSphereState.h"
+
+#include <limits>
+
+// Hard-sphere collision math shared by the time-stepped (continuous collision detection) and the
+// event-driven simulation paths. All times are relative to the moment the positions were sampled.
+namespace Collisions
+{
+	// Returned when the objects will never collide
+	constexpr double Never = std::numeric_limits<double>::infinity();
+
+	// Access the x/y/z component of a vector by axis index (0, 1, 2) - used for the per-axis wall tests
+	inline float& Component(Float3& v, int axis) { return axis == 0 ? v.x : (axis == 1 ? v.y : v.z); }
+	inline float Component(const Float3& v, int axis) { return axis == 0 ? v.x : (axis == 1 ? v.y : v.z); }
+
+	// Swept-sphere test: earliest time t >= 0 at which two spheres moving with constant velocity come
+	// into contact. Spheres that are already overlapping but still approaching return 0. Spheres that
+	// are separating (or at rest relative to each other) never collide.
+	double SphereSphereTimeOfImpact(const Float3& p1, const Float3& v1, float r1,
+									const Float3& p2, const Float3& v2, float r2);
+
+	// Time at which a sphere moving along a single axis touches the wall it is moving towards. The
+	// walls are located at +/- halfExtent. A sphere already past the wall returns 0.
+	double SphereWallTimeOfImpact(float position, float velocity, float radius, float halfExtent);
+
+	// Elastic collision between two spheres that are in contact. Only the velocity component along the
+	// line of centers is changed, and the masses are used so both energy and momentum are conserved.
+	void ResolveSphereSphere(const Float3& p1, Float3& v1, float m1,
+							 const Float3& p2, Float3& v2, float m2);
+}
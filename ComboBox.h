@@ -48,9 +48,9 @@ public:
 	float GetDropDownItemHeight() { return m_dropDownItemHeight; }
 	void SetDropDownItemHeight(float height);
 
-	void SwitchDropDownIsOpen() { m_dropDownIsOpen = !m_dropDownIsOpen; }
-	void CollapseDropDown() { m_dropDownIsOpen = false; }
-	void ExpandDropDown() { m_dropDownIsOpen = true; }
+	void SwitchDropDownIsOpen() { m_dropDownIsOpen = !m_dropDownIsOpen; Invalidate(); }
+	void CollapseDropDown() { m_dropDownIsOpen = false; Invalidate(); }
+	void ExpandDropDown() { m_dropDownIsOpen = true; Invalidate(); }
 
 	// Event Method assignments
 	void SelectionChanged(std::function<void(std::wstring)> method) { SelectionChangedMethod = method; }
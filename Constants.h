@@ -18,4 +18,20 @@ namespace Constants
 		0.050f, // Flourine
 		0.160f  // Neon
 	};
+
+	// Neutrons in the most common isotope of every element - the neutronCount each element class
+	// (Hydrogen, Helium, ...) defaults to, so Atom::Mass() is element + DefaultNeutronCounts[element]
+	const int DefaultNeutronCounts[11] = {
+		0,		// Invalid value to take up the 0 index spot
+		0,		// Hydrogen
+		2,		// Helium
+		4,		// Lithium
+		5,		// Beryllium
+		6,		// Boron
+		6,		// Carbon
+		7,		// Nitrogen
+		8,		// Oxygen
+		10,		// Flourine
+		10		// Neon
+	};
 }
\ No newline at end of file
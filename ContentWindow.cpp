@@ -1,4 +1,9 @@
 #include "ContentWindow.h"
+#include "CameraSpace.h"
+
+#include <cstring>
+#include <iomanip>
+#include <sstream>
 
 using Microsoft::WRL::ComPtr;
 using DirectX::XMFLOAT3;
@@ -6,8 +11,10 @@ using DirectX::XMFLOAT3;
 ContentWindow::ContentWindow(int width, int height, const char* name) :
 	WindowBase(width, height, name),
 	m_stateBlock(nullptr),
+	m_uiLayer(nullptr),
 	m_layout(nullptr),
-	m_mouseState(nullptr)
+	m_mouseState(nullptr),
+	m_showTimeline(false)
 	//
 	//
 	//m_cursor(LoadCursor(NULL, ))
@@ -27,6 +34,26 @@ ContentWindow::ContentWindow(int width, int height, const char* name) :
 
 	// Create the mouse state object
 	m_mouseState = std::make_shared<MouseState>();
+
+	// Fixed width text and brushes for the frame timeline overlay
+	ThrowIfFailed(
+		m_deviceResources->DWriteFactory()->CreateTextFormat(
+			L"Consolas",
+			nullptr,
+			DWRITE_FONT_WEIGHT_NORMAL,
+			DWRITE_FONT_STYLE_NORMAL,
+			DWRITE_FONT_STRETCH_NORMAL,
+			12.0f,
+			L"en-us",
+			m_timelineTextFormat.ReleaseAndGetAddressOf()
+		)
+	);
+	ThrowIfFailed(
+		m_deviceResources->D2DDeviceContext()->CreateSolidColorBrush(D2D1::ColorF(1.0f, 1.0f, 1.0f), m_timelineTextBrush.ReleaseAndGetAddressOf())
+	);
+	ThrowIfFailed(
+		m_deviceResources->D2DDeviceContext()->CreateSolidColorBrush(D2D1::ColorF(0.0f, 0.0f, 0.0f, 0.7f), m_timelineBackgroundBrush.ReleaseAndGetAddressOf())
+	);
 }
 
 ContentWindow::~ContentWindow()
@@ -47,12 +74,16 @@ void ContentWindow::Update()
 	m_timer.Tick([&]() 
 		{
 			// Pass the Update call along to the layout, which will pass it along to each child control
+			FrameTimeline::BeginStage(FrameStage::LAYOUT_UPDATE);
 			m_layout->Update(m_timer);
+			FrameTimeline::EndStage(FrameStage::LAYOUT_UPDATE);
 
 			// There should only be a single simulation which is accessible via SimulationManager
 			// Because multiple controls may need to read from the simulation data, the update to the simulation
 			// must come from the main window, so that multiple controls don't try updating the simulation
-			SimulationManager::Update(m_timer);		
+			FrameTimeline::BeginStage(FrameStage::SIMULATION_STEP);
+			SimulationManager::Update(m_timer);
+			FrameTimeline::EndStage(FrameStage::SIMULATION_STEP);
 		}
 	);	
 }
@@ -68,11 +99,18 @@ bool ContentWindow::Render()
 
 	ID3D11DeviceContext4* context = m_deviceResources->D3DDeviceContext();
 
+	// Each stage is timed on the CPU and, with timestamp queries, on the GPU
+	GpuFrameTimer* gpuTimer = m_deviceResources->GpuTimer();
+	gpuTimer->BeginFrame();
+
+	FrameTimeline::BeginStage(FrameStage::RENDER_3D);
+	gpuTimer->BeginStage(FrameStage::RENDER_3D);
+
 	m_deviceResources->ResetViewport();
 
 	FLOAT background[4] = { 45.0f / 255.0f, 45.0f / 255.0f, 48.0f / 255.0f };
 	context->ClearRenderTargetView(m_deviceResources->GetBackBufferRenderTargetView(), background);
-	context->ClearDepthStencilView(m_deviceResources->GetDepthStencilView(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
+	context->ClearDepthStencilView(m_deviceResources->GetDepthStencilView(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, CameraSpace::ClearDepth, 0);
 
 	ID3D11RenderTargetView* const targets[1] = { m_deviceResources->GetBackBufferRenderTargetView() };
 	context->OMSetRenderTargets(1, targets, m_deviceResources->GetDepthStencilView());
@@ -82,19 +120,37 @@ bool ContentWindow::Render()
 	// Draw all 3D simulation controls first
 	m_layout->Render3DControls();
 
+	gpuTimer->EndStage(FrameStage::RENDER_3D);
+	FrameTimeline::EndStage(FrameStage::RENDER_3D);
+
 	// Draw all 2D / Menu controls next
+	FrameTimeline::BeginStage(FrameStage::RENDER_2D);
+	gpuTimer->BeginStage(FrameStage::RENDER_2D);
+
 	m_deviceResources->ResetViewport();
 
 	ID2D1DeviceContext* context2 = m_deviceResources->D2DDeviceContext();
 	context2->SaveDrawingState(m_stateBlock.Get());
+
+	// Only the parts of the 2D controls that have changed are redrawn into the cached layer
+	UpdateUILayer();
+
 	context2->BeginDraw();
-	context2->SetTransform(m_deviceResources->OrientationTransform2D());
 
-	m_layout->Render2DControls();
+	// Composite the cached layer over the 3D scene. It is the same size and DPI as the back buffer
+	if (m_uiLayer != nullptr)
+	{
+		context2->SetTransform(D2D1::Matrix3x2F::Identity());
+		context2->DrawBitmap(m_uiLayer.Get(), nullptr, 1.0f, D2D1_INTERPOLATION_MODE_NEAREST_NEIGHBOR, nullptr, nullptr);
+	}
+
+	context2->SetTransform(m_deviceResources->OrientationTransform2D());
 
 	// re-render the captured control to make sure it is on top of the UI
 	m_layout->Render2DCapturedControl();
 
+	if (m_showTimeline)
+		DrawTimelineOverlay();
 
 	HRESULT hr = context2->EndDraw();
 	if (FAILED(hr) || hr == D2DERR_RECREATE_TARGET)
@@ -104,13 +160,130 @@ bool ContentWindow::Render()
 
 	context2->RestoreDrawingState(m_stateBlock.Get());
 
+	gpuTimer->EndStage(FrameStage::RENDER_2D);
+	FrameTimeline::EndStage(FrameStage::RENDER_2D);
+	gpuTimer->EndFrame();
+
 	return true;
 }
 
+void ContentWindow::UpdateUILayer()
+{
+	ID2D1DeviceContext* context2 = m_deviceResources->D2DDeviceContext();
+	D2D1_SIZE_F size = m_deviceResources->D2DBitmap()->GetSize();
+
+	// (Re)create the layer to match the back buffer - all of it needs to be drawn
+	if (m_uiLayer == nullptr)
+	{
+		float dpiX, dpiY;
+		context2->GetDpi(&dpiX, &dpiY);
+
+		D2D1_BITMAP_PROPERTIES1 bitmapProperties =
+			D2D1::BitmapProperties1(
+				D2D1_BITMAP_OPTIONS_TARGET,
+				D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED),
+				dpiX,
+				dpiY
+			);
+
+		ThrowIfFailed(
+			context2->CreateBitmap(
+				m_deviceResources->D2DBitmap()->GetPixelSize(),
+				nullptr,
+				0,
+				&bitmapProperties,
+				m_uiLayer.ReleaseAndGetAddressOf()
+			)
+		);
+
+		m_deviceResources->InvalidateUI(D2D1::RectF(0.0f, 0.0f, size.width, size.height));
+	}
+
+	DirtyRegion& dirtyRegion = m_deviceResources->UIDirtyRegion();
+	dirtyRegion.Clip(DirtyRect{ 0.0f, 0.0f, size.width, size.height });
+	if (dirtyRegion.Empty())
+		return;
+
+	// Take the rects before drawing so anything invalidated while drawing is drawn next frame
+	std::vector<DirtyRect> dirtyRects = dirtyRegion.Rects();
+	dirtyRegion.Clear();
+
+	context2->SetTarget(m_uiLayer.Get());
+	context2->BeginDraw();
+
+	for (const DirtyRect& dirtyRect : dirtyRects)
+	{
+		D2D1_RECT_F rect = D2D1::RectF(dirtyRect.Left, dirtyRect.Top, dirtyRect.Right, dirtyRect.Bottom);
+
+		// Clear to transparent so the 3D scene shows through wherever no layout or control draws
+		context2->SetTransform(m_deviceResources->OrientationTransform2D());
+		context2->PushAxisAlignedClip(rect, D2D1_ANTIALIAS_MODE_ALIASED);
+		context2->Clear(D2D1::ColorF(0.0f, 0.0f, 0.0f, 0.0f));
+
+		m_layout->Render2DControls(rect);
+
+		context2->PopAxisAlignedClip();
+	}
+
+	HRESULT hr = context2->EndDraw();
+
+	context2->SetTarget(m_deviceResources->D2DBitmap());
+
+	// Recreate and redraw the whole layer next frame
+	if (FAILED(hr) || hr == D2DERR_RECREATE_TARGET)
+		m_uiLayer = nullptr;
+}
+
 void ContentWindow::Present()
 {
 	// Present the render target to the screen
+	FrameTimeline::BeginStage(FrameStage::PRESENT);
 	m_deviceResources->Present();
+	FrameTimeline::EndStage(FrameStage::PRESENT);
+}
+
+void ContentWindow::DrawTimelineOverlay()
+{
+	// One row per stage with the CPU and (for the stages that are measured on the GPU) GPU percentiles, then
+	// the frame as a whole. All times are in milliseconds over the last RollingSamples::WindowSize frames
+	std::wostringstream text;
+	text << std::fixed << std::setprecision(2);
+	text << L"Frame timeline (ms)   CPU p50   p99   GPU p50   p99";
+
+	auto row = [&text](const wchar_t* name, const RollingSamples& cpu, const RollingSamples* gpu)
+	{
+		text << L"\n" << std::left << std::setw(20) << name << std::right
+			 << std::setw(9) << cpu.Percentile(0.5f) << std::setw(8) << cpu.Percentile(0.99f);
+
+		if (gpu != nullptr && gpu->Count() > 0)
+			text << std::setw(10) << gpu->Percentile(0.5f) << std::setw(8) << gpu->Percentile(0.99f);
+	};
+
+	for (size_t iii = 0; iii < FrameTimeline::StageCount; ++iii)
+	{
+		FrameStage stage = static_cast<FrameStage>(iii);
+		const char* name = FrameTimeline::StageName(stage);
+		row(std::wstring(name, name + std::strlen(name)).c_str(), FrameTimeline::CpuStage(stage), &FrameTimeline::GpuStage(stage));
+	}
+
+	text << L"\n";
+	row(L"Frame (CPU)", FrameTimeline::FrameTime(), nullptr);
+	row(L"Present interval", FrameTimeline::FrameInterval(), nullptr);
+	row(L"Input latency", FrameTimeline::InputLatency(), nullptr);
+
+	ID2D1DeviceContext* context2 = m_deviceResources->D2DDeviceContext();
+	D2D1_SIZE_F size = context2->GetSize();
+
+	// Bottom left corner, clear of the menu bar
+	const float width = 420.0f;
+	const float height = 185.0f;
+	const float margin = 10.0f;
+	D2D1_RECT_F background = D2D1::RectF(margin, size.height - height - margin, margin + width, size.height - margin);
+	D2D1_RECT_F textRect = D2D1::RectF(background.left + 8.0f, background.top + 6.0f, background.right - 8.0f, background.bottom - 6.0f);
+
+	std::wstring overlay = text.str();
+	context2->FillRectangle(background, m_timelineBackgroundBrush.Get());
+	context2->DrawText(overlay.c_str(), static_cast<UINT32>(overlay.size()), m_timelineTextFormat.Get(), textRect, m_timelineTextBrush.Get());
 }
 
 
@@ -222,6 +395,9 @@ LRESULT ContentWindow::OnResize(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lPara
 	// Resize the device resources
 	m_deviceResources->OnResize();
 
+	// The cached 2D layer is recreated at the new size on the next render
+	m_uiLayer = nullptr;
+
 	// Update the Layout
 	m_layout->OnResize(0.0f, 0.0f, m_deviceResources->PixelsToDIPS(Height()), m_deviceResources->PixelsToDIPS(Width()));
 
@@ -335,6 +511,10 @@ LRESULT ContentWindow::OnKeyUp(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam
 }
 LRESULT ContentWindow::OnKeyDown(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) noexcept
 {
+	// F3 shows/hides the frame timeline. The key press already requested a new frame
+	if (wParam == VK_F3)
+		m_showTimeline = !m_showTimeline;
+
 	m_layout->OnKeyDown(static_cast<unsigned char>(wParam));
 
 	return DefWindowProc(hWnd, msg, wParam, lParam);
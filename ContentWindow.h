@@ -11,6 +11,7 @@
 #include "OnMessageResult.h"
 #include "StepTimer.h"
 #include "SimulationManager.h"
+#include "FrameTimeline.h"
 #include "Text.h"
 #include "TextInput.h"
 #include "ComboBox.h"
@@ -31,7 +32,7 @@ public:
 	float Height();
 	float Width();
 
-	void InitializeSimulation() { SimulationManager::CreateSimulation(m_deviceResources); }
+	void InitializeSimulation() { SimulationManager::CreateSimulation(); }
 	void InitializeThemes() { ThemeManager::Initialize(m_deviceResources); }
 	void InitializeMeshes() { MeshManager::CreateMeshes(m_deviceResources); }
 
@@ -69,6 +70,8 @@ protected:
 
 private:
 	void DiscardGraphicsResources();
+	void UpdateUILayer();
+	void DrawTimelineOverlay();
 
 	// Keep track of device resources for rendering to this window
 	std::shared_ptr<DeviceResources> m_deviceResources;
@@ -76,12 +79,21 @@ private:
 	// Keep a single instance of drawing state info that will be set for each draw call
 	Microsoft::WRL::ComPtr<ID2D1DrawingStateBlock1> m_stateBlock;
 
+	// The 2D controls are drawn into this bitmap and it is drawn over the 3D scene each frame. Only the
+	// rects in DeviceResources::UIDirtyRegion are redrawn (see Layout::Render2DControls(D2D1_RECT_F))
+	Microsoft::WRL::ComPtr<ID2D1Bitmap1> m_uiLayer;
+
 	// Keep a single layout for structuring the window content
 	std::shared_ptr<Layout> m_layout;
 
 	// Keep track off mouse details to pass to layout/controls
 	std::shared_ptr<MouseState> m_mouseState;
 
+	// Frame timeline overlay (toggled with F3) - percentiles of where the time of a frame goes (see FrameTimeline)
+	bool m_showTimeline;
+	Microsoft::WRL::ComPtr<IDWriteTextFormat> m_timelineTextFormat;
+	Microsoft::WRL::ComPtr<ID2D1SolidColorBrush> m_timelineTextBrush;
+	Microsoft::WRL::ComPtr<ID2D1SolidColorBrush> m_timelineBackgroundBrush;
 
 	StepTimer m_timer;
 };
\ No newline at end of file
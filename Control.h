@@ -77,6 +77,16 @@ public:
 
 	D2D1_RECT_F GetParentRect() { return m_parentLayout->GetRect(m_row, m_column, m_rowSpan, m_columnSpan); }
 
+	// Mark the control as needing to be redrawn in the cached 2D UI layer. Layouts do this for every control
+	// they pass a message to, so a control only needs to call it when it changes for some other reason
+	// (ex. its value is set by another control)
+	void Invalidate()
+	{
+		// Released controls are no longer drawn
+		if (m_deviceResources != nullptr && m_parentLayout != nullptr)
+			m_deviceResources->InvalidateUI(GetParentRect());
+	}
+
 protected:
 	
 
@@ -5,6 +5,7 @@
 #include "DeviceResources.h"
 #include "Enums.h"
 #include "HLSLStructures.h"
+#include "MeshBuffers.h"
 
 #include <memory>
 #include <vector>
@@ -15,48 +16,28 @@ class CylinderMesh
 private:
 	std::shared_ptr<DeviceResources>		m_deviceResources;
 
-	Microsoft::WRL::ComPtr<ID3D11Buffer>	m_cylinderVertexBuffer;
-	Microsoft::WRL::ComPtr<ID3D11Buffer>	m_cylinderIndexBuffer;
-	uint32_t								m_cylinderIndexCount;
-
-	Microsoft::WRL::ComPtr<ID3D11Buffer>	m_modelViewProjectionBuffer;
-	ModelViewProjectionConstantBuffer		m_modelViewProjectionBufferData;
-
-	void CreateModelViewProjectionBuffer();
-	void LoadCylinderVertexAndIndexBuffers();
+	// One set of buffers per level of detail (level 0 is the most detailed)
+	MeshBuffers								m_levels[MeshLevelOfDetail::LevelCount];
 
 	DirectX::XMMATRIX ComputeRotationMatrix(DirectX::XMFLOAT3 velocity);
 
 
 public:
-	CylinderMesh(const std::shared_ptr<DeviceResources>& deviceResources);
-
-	/* Render must be passed the following:
-		1. XMFLOAT3 position       - position of the atom   -> used for translating to compute the model matrix
-		2. float    radius         - radius of the atom     -> used for scaling to compute the model matrix
-		3. XMMATRIX viewProjection - view projection matrix -> used for computing the final modelviewprojection matrix
+	// 'levels' holds the unit cylinder mesh for each level of detail (see MeshManager::CreateMeshes)
+	CylinderMesh(const std::shared_ptr<DeviceResources>& deviceResources, const std::vector<MeshData>& levels);
 
-		Upstream:
-		1. Simulation Render should have already
-				IASetInputLayout
-				IASetPrimitiveTopology <- Only true as long as we are always rendered triangle lists
-				VSSetShader
-				PSSetShader
-				PSSetConstantBuffers1  <- This will require a lookup for each atom to make sure the correct material is used
+	// Set the vertex and index buffers of the given level of detail. The draw calls below do not, so consecutive
+	// draws of the same level only bind once (see SimulationRenderer::SubmitCommands)
+	void Bind(unsigned int level = 0);
 
-		Responsilities:
-		1. Render will perform the following
-				IASetVertexBuffers
-				ISSetIndexBuffer
-				VSSetConstantBuffers1
-				DrawIndexed
+	// Draw a single cylinder at the given level of detail. The caller must have already bound the level, set the
+	// shaders and bound the constant buffer holding the model matrices (see ModelMatrix)
+	void Render(unsigned int level = 0);
 
-		Returns: returns the computed model matrix. Because every bond will run Render and they all have a shared_ptr to the
-		         same CylinderMesh, each call will update the model matrix. However, each bond will want to keep track of the
-				 model matrix that was computed so we can easily test for mouse over the cylinder without re-computing the
-				 model matrix.
-	*/
-	void Render(DirectX::XMFLOAT3 position1, DirectX::XMFLOAT3 position2, float radius, DirectX::XMMATRIX viewProjection);
+	// Draw 'instanceCount' cylinders at the given level of detail with a single DrawIndexedInstanced call. The caller
+	// must have already bound the level, set the instanced vertex shader, bound the instance buffer (see BondGeometry)
+	// and set the view projection buffer
+	void RenderInstanced(unsigned int instanceCount, unsigned int level = 0);
 
 	//DirectX::XMMATRIX ModelMatrix() { return m_modelMatrix; }
 
@@ -1,5 +1,7 @@
 #include "DeviceResources.h"
 
+#include <cmath>
+
 
 using Microsoft::WRL::ComPtr;
 
@@ -145,6 +147,12 @@ void DeviceResources::CreateDeviceDependentResources()
 
 		ThrowIfFailed(context.As(&m_d3dDeviceContext));
 
+		// Ring buffer for per-draw constants
+		m_uploadRing = std::make_unique<UploadRingBuffer>(m_d3dDevice.Get(), m_d3dDeviceContext.Get());
+
+		// Timestamp queries for the frame timeline
+		m_gpuTimer = std::make_unique<GpuFrameTimer>(m_d3dDevice.Get(), m_d3dDeviceContext.Get());
+
 		// Create the Direct2D device object and a corresponding context
 		ComPtr<IDXGIDevice4> dxgiDevice;
 		ThrowIfFailed(m_d3dDevice.As(&dxgiDevice));
@@ -336,7 +344,7 @@ void DeviceResources::CreateWindowSizeDependentResources()
 
 	// Create a depth stencil view for use with 3D rendering if needed
 	CD3D11_TEXTURE2D_DESC1 depthStencilDesc(
-		DXGI_FORMAT_D24_UNORM_S8_UINT, // reserve 24 bits for the depth value and 8 bits for stencil value (used for outline effect)
+		DXGI_FORMAT_D32_FLOAT_S8X24_UINT, // float depth for reverse Z (see CameraSpace) and 8 bits for stencil value (used for outline effect)
 		static_cast<UINT>(width),
 		static_cast<UINT>(height),
 		1, // This depth stencil view has only one texture
@@ -355,7 +363,7 @@ void DeviceResources::CreateWindowSizeDependentResources()
 
 	CD3D11_DEPTH_STENCIL_VIEW_DESC depthStencilViewDesc(
 		D3D11_DSV_DIMENSION_TEXTURE2D,
-		DXGI_FORMAT_D24_UNORM_S8_UINT
+		DXGI_FORMAT_D32_FLOAT_S8X24_UINT
 		);
 	ThrowIfFailed(
 		m_d3dDevice->CreateDepthStencilView(
@@ -456,6 +464,19 @@ void DeviceResources::ResetViewport()
 	m_d3dDeviceContext->RSSetViewports(1, &m_viewport);
 }
 
+void DeviceResources::InvalidateUI(const D2D1_RECT_F& rect)
+{
+	// Round out to whole DIPs plus one so the anti-aliased edges just outside the rect are redrawn as well
+	m_uiDirtyRegion.Add(
+		std::floor(rect.left) - 1.0f,
+		std::floor(rect.top) - 1.0f,
+		std::ceil(rect.right) + 1.0f,
+		std::ceil(rect.bottom) + 1.0f
+	);
+
+	RenderScheduler::Invalidate();
+}
+
 
 // Recreate all device resources and set them back to the current state
 void DeviceResources::HandleDeviceLost()
@@ -467,6 +488,9 @@ void DeviceResources::HandleDeviceLost()
 
 void DeviceResources::Present()
 {
+	// Everything uploaded to the ring this frame has been submitted
+	m_uploadRing->EndFrame();
+
 	DXGI_PRESENT_PARAMETERS parameters = { 0 };
 	HRESULT hr = m_dxgiSwapChain->Present1(1, 0, &parameters);
 
@@ -1,6 +1,12 @@
 #pragma once
 #include "pch.h"
 #include "DirectXHelper.h"
+#include "UploadRingBuffer.h"
+#include "GpuFrameTimer.h"
+#include "DirtyRegion.h"
+#include "RenderScheduler.h"
+
+#include <memory>
 
 
 
@@ -31,6 +37,17 @@ public:
 
 	D3D_FEATURE_LEVEL D3DFeatureLevel() { return m_d3dFeatureLevel; }
 
+	// Per-draw constant buffer data is sub-allocated from this ring (see UploadRingBuffer)
+	UploadRingBuffer* UploadRing() const { return m_uploadRing.get(); }
+
+	// GPU time of the stages of a frame (see GpuFrameTimer)
+	GpuFrameTimer* GpuTimer() const { return m_gpuTimer.get(); }
+
+	// Parts of the window's cached 2D UI layer that are out of date (see ContentWindow::UpdateUILayer).
+	// InvalidateUI also requests a new frame
+	void InvalidateUI(const D2D1_RECT_F& rect);
+	DirtyRegion& UIDirtyRegion() { return m_uiDirtyRegion; }
+
 	DirectX::XMFLOAT4X4 OrientationTransform3D() const { return m_orientationTransform3D; }
 
 
@@ -82,6 +99,11 @@ private:
 	Microsoft::WRL::ComPtr<ID3D11Device5>		 m_d3dDevice;
 	Microsoft::WRL::ComPtr<ID3D11DeviceContext4> m_d3dDeviceContext;
 	Microsoft::WRL::ComPtr<IDXGISwapChain4>		 m_dxgiSwapChain;
+	std::unique_ptr<UploadRingBuffer>			 m_uploadRing;
+	std::unique_ptr<GpuFrameTimer>				 m_gpuTimer;
+
+	// Dirty rectangles (in DIPs) of the 2D UI layer
+	DirtyRegion m_uiDirtyRegion;
 
 	// Direct3D Rendering objects ------ THESE MAY END UP GETTING STORED PER WINDOW
 	Microsoft::WRL::ComPtr<ID3D11RenderTargetView1>	m_d3dRenderTargetView;
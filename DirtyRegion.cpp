@@ -0,0 +1,106 @@
+#include "DirtyRegion.h"
+
+#include <algorithm>
+
+
+void DirtyRegion::Add(const DirtyRect& rect)
+{
+	if (rect.Empty())
+		return;
+
+	// Grow the new rectangle by every rectangle it overlaps. A merged rectangle can reach ones that the
+	// original did not, so keep going until nothing overlaps
+	DirtyRect merged = rect;
+	bool mergedAny = true;
+	while (mergedAny)
+	{
+		mergedAny = false;
+		for (size_t iii = 0; iii < m_rects.size(); ++iii)
+		{
+			if (Overlaps(merged, m_rects[iii]))
+			{
+				merged = Union(merged, m_rects[iii]);
+				m_rects[iii] = m_rects.back();
+				m_rects.pop_back();
+				mergedAny = true;
+				break;
+			}
+		}
+	}
+
+	m_rects.push_back(merged);
+
+	if (m_rects.size() > MaxRects)
+		MergeClosestPair();
+}
+
+void DirtyRegion::MergeClosestPair()
+{
+	size_t first = 0;
+	size_t second = 1;
+	float leastWaste = -1.0f;
+	for (size_t iii = 0; iii < m_rects.size(); ++iii)
+	{
+		for (size_t jjj = iii + 1; jjj < m_rects.size(); ++jjj)
+		{
+			float waste = Union(m_rects[iii], m_rects[jjj]).Area() - m_rects[iii].Area() - m_rects[jjj].Area();
+			if (leastWaste < 0.0f || waste < leastWaste)
+			{
+				leastWaste = waste;
+				first = iii;
+				second = jjj;
+			}
+		}
+	}
+
+	// Re-add the union so it absorbs anything it now overlaps
+	DirtyRect merged = Union(m_rects[first], m_rects[second]);
+	m_rects.erase(m_rects.begin() + second);
+	m_rects.erase(m_rects.begin() + first);
+	Add(merged);
+}
+
+void DirtyRegion::Clip(const DirtyRect& bounds)
+{
+	for (DirtyRect& rect : m_rects)
+	{
+		rect.Left = std::max(rect.Left, bounds.Left);
+		rect.Top = std::max(rect.Top, bounds.Top);
+		rect.Right = std::min(rect.Right, bounds.Right);
+		rect.Bottom = std::min(rect.Bottom, bounds.Bottom);
+	}
+
+	m_rects.erase(
+		std::remove_if(m_rects.begin(), m_rects.end(), [](const DirtyRect& rect) { return rect.Empty(); }),
+		m_rects.end()
+	);
+}
+
+bool DirtyRegion::Intersects(const DirtyRect& rect) const
+{
+	if (rect.Empty())
+		return false;
+
+	for (const DirtyRect& dirty : m_rects)
+	{
+		if (Overlaps(rect, dirty))
+			return true;
+	}
+	return false;
+}
+
+bool DirtyRegion::Overlaps(const DirtyRect& a, const DirtyRect& b)
+{
+	// Rectangles that only touch do not overlap
+	return a.Left < b.Right && b.Left < a.Right && a.Top < b.Bottom && b.Top < a.Bottom;
+}
+
+DirtyRect DirtyRegion::Union(const DirtyRect& a, const DirtyRect& b)
+{
+	return DirtyRect{
+		std::min(a.Left, b.Left),
+		std::min(a.Top, b.Top),
+		std::max(a.Right, b.Right),
+		std::max(a.Bottom, b.Bottom)
+	};
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+struct DirtyRect
+{
+	float Left;
+	float Top;
+	float Right;
+	float Bottom;
+
+	bool Empty() const { return Right <= Left || Bottom <= Top; }
+	float Area() const { return Empty() ? 0.0f : (Right - Left) * (Bottom - Top); }
+};
+
+// The parts of the cached 2D UI layer that are out of date and must be redrawn before the layer is next
+// composited (see ContentWindow::UpdateUILayer). Controls and layouts add the rectangle they occupy when
+// their appearance changes; the window redraws only those rectangles and then clears the region.
+//
+// Rectangles that overlap are merged as they are added, so the region is always a list of
+// disjoint rectangles and a control that changes every frame does not grow the list. When there are more
+// than MaxRects rectangles the two whose union wastes the least area are merged - a few slightly larger
+// rectangles are cheaper to redraw than many small ones.
+// Units are whatever the caller uses (DIPs for the UI layer).
+class DirtyRegion
+{
+public:
+	static constexpr size_t MaxRects = 8;
+
+	void Add(const DirtyRect& rect);
+	void Add(float left, float top, float right, float bottom) { Add(DirtyRect{ left, top, right, bottom }); }
+
+	// Drop everything outside the bounds (e.g. the window) - rectangles entirely outside are removed
+	void Clip(const DirtyRect& bounds);
+
+	bool Intersects(const DirtyRect& rect) const;
+
+	bool Empty() const { return m_rects.empty(); }
+	const std::vector<DirtyRect>& Rects() const { return m_rects; }
+	void Clear() { m_rects.clear(); }
+
+	static bool Overlaps(const DirtyRect& a, const DirtyRect& b);
+	static DirtyRect Union(const DirtyRect& a, const DirtyRect& b);
+
+private:
+	void MergeClosestPair();
+
+	std::vector<DirtyRect> m_rects;
+};
\ No newline at end of file
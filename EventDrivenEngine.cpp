@@ -0,0 +1,340 @@
+#include "EventDrivenEngine.h"
+
+#include <algorithm>
+#include <cmath>
+
+using Collisions::Component;
+
+namespace
+{
+	// Keep the grid from growing unbounded for tiny atoms in a huge box
+	constexpr int MaxCellsPerAxis = 128;
+
+	// Small queues aren't worth rebuilding
+	constexpr size_t MinPruneThreshold = 1024;
+}
+
+
+EventDrivenEngine::EventDrivenEngine() :
+	m_halfExtents{ 0.0f, 0.0f, 0.0f },
+	m_cellsPerAxis{ 1, 1, 1 },
+	m_cellSize{ 0.0f, 0.0f, 0.0f },
+	m_pruneThreshold(MinPruneThreshold),
+	m_time(0.0),
+	m_eventCount(0),
+	m_collisionCount(0)
+{
+}
+
+void EventDrivenEngine::Initialize(const HardSphereState& state)
+{
+	const size_t count = state.Count();
+
+	m_positions.resize(count);
+	m_velocities.resize(count);
+	m_radii.resize(count);
+	m_masses.resize(count);
+	m_localTimes.assign(count, 0.0);
+	m_collisionCounts.assign(count, 0);
+
+	m_events.clear();
+	m_time = 0.0;
+	m_eventCount = 0;
+	m_collisionCount = 0;
+
+	float maxRadius = 0.0f;
+	for (size_t iii = 0; iii < count; ++iii)
+	{
+		m_positions[iii] = state.Positions[iii];
+		m_velocities[iii] = state.Velocities[iii];
+		m_radii[iii] = state.Radii[iii];
+		m_masses[iii] = state.Masses[iii];
+		maxRadius = std::max(maxRadius, m_radii[iii]);
+	}
+
+	// Build the cell grid
+	m_halfExtents[0] = state.BoxDimensions.x / 2.0f;
+	m_halfExtents[1] = state.BoxDimensions.y / 2.0f;
+	m_halfExtents[2] = state.BoxDimensions.z / 2.0f;
+
+	// Cells must be at least one diameter wide. Beyond that, smaller cells mean fewer collision
+	// predictions but more cell-crossing events, so aim for roughly one atom per cell
+	int cellsForDensity = std::max(static_cast<int>(std::cbrt(static_cast<double>(count))), 1);
+
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		float extent = 2.0f * m_halfExtents[axis];
+		int cells = maxRadius > 0.0f ? static_cast<int>(extent / (2.0f * maxRadius)) : 1;
+		m_cellsPerAxis[axis] = std::clamp(std::min(cells, cellsForDensity), 1, MaxCellsPerAxis);
+		m_cellSize[axis] = extent / m_cellsPerAxis[axis];
+		m_atomCells[axis].resize(count);
+	}
+
+	m_cells.assign(static_cast<size_t>(m_cellsPerAxis[0]) * m_cellsPerAxis[1] * m_cellsPerAxis[2], std::vector<int>());
+
+	for (size_t iii = 0; iii < count; ++iii)
+	{
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			int cell = static_cast<int>((Component(m_positions[iii], axis) + m_halfExtents[axis]) / m_cellSize[axis]);
+			m_atomCells[axis][iii] = std::clamp(cell, 0, m_cellsPerAxis[axis] - 1);
+		}
+
+		m_cells[CellIndex(m_atomCells[0][iii], m_atomCells[1][iii], m_atomCells[2][iii])].push_back(static_cast<int>(iii));
+	}
+
+	// Predict the initial events - each pair only needs to be predicted once
+	for (int iii = 0; iii < static_cast<int>(count); ++iii)
+	{
+		PredictWalls(iii);
+		PredictCellCrossing(iii);
+		PredictCollisions(iii, -1, true);
+	}
+
+	m_pruneThreshold = std::max(PruneFactor * m_events.size(), MinPruneThreshold);
+}
+
+void EventDrivenEngine::Advance(double timeDelta)
+{
+	double target = m_time + timeDelta;
+
+	while (!m_events.empty() && m_events.front().Time <= target)
+	{
+		Event e = PopEvent();
+
+		// Skip events that were predicted before one of the atoms changed velocity
+		if (IsStale(e))
+			continue;
+
+		++m_eventCount;
+
+		switch (e.Type)
+		{
+		case EventType::COLLISION:
+			MoveTo(e.Atom1, e.Time);
+			MoveTo(e.Atom2, e.Time);
+
+			Collisions::ResolveSphereSphere(m_positions[e.Atom1], m_velocities[e.Atom1], m_masses[e.Atom1],
+											m_positions[e.Atom2], m_velocities[e.Atom2], m_masses[e.Atom2]);
+
+			++m_collisionCounts[e.Atom1];
+			++m_collisionCounts[e.Atom2];
+			++m_collisionCount;
+
+			PredictWalls(e.Atom1);
+			PredictWalls(e.Atom2);
+			PredictCellCrossing(e.Atom1);
+			PredictCellCrossing(e.Atom2);
+			PredictCollisions(e.Atom1, e.Atom2);
+			PredictCollisions(e.Atom2, e.Atom1);
+			break;
+
+		case EventType::WALL:
+		{
+			MoveTo(e.Atom1, e.Time);
+
+			// Reflect the velocity and make sure rounding did not leave the atom outside the box
+			float limit = std::max(m_halfExtents[e.Axis] - m_radii[e.Atom1], 0.0f);
+			Component(m_positions[e.Atom1], e.Axis) = std::clamp(Component(m_positions[e.Atom1], e.Axis), -limit, limit);
+			Component(m_velocities[e.Atom1], e.Axis) *= -1;
+
+			++m_collisionCounts[e.Atom1];
+
+			PredictWalls(e.Atom1);
+			PredictCellCrossing(e.Atom1);
+			PredictCollisions(e.Atom1);
+			break;
+		}
+
+		case EventType::CELL_CROSSING:
+			MoveTo(e.Atom1, e.Time);
+
+			// Move the atom into the neighboring cell. The velocity did not change so none of the
+			// existing predictions are invalidated - only collisions with the new neighbors are added
+			RemoveFromCell(e.Atom1);
+			m_atomCells[e.Axis][e.Atom1] += Component(m_velocities[e.Atom1], e.Axis) > 0.0f ? 1 : -1;
+			m_cells[CellIndex(m_atomCells[0][e.Atom1], m_atomCells[1][e.Atom1], m_atomCells[2][e.Atom1])].push_back(e.Atom1);
+
+			PredictCellCrossing(e.Atom1);
+			PredictCollisions(e.Atom1);
+			break;
+		}
+
+		if (m_events.size() > m_pruneThreshold)
+			PruneEvents();
+	}
+
+	m_time = target;
+}
+
+void EventDrivenEngine::WriteBack(HardSphereState& state, SimulationObservables& observables)
+{
+	Float3 v;
+	double mass;
+
+	for (size_t iii = 0; iii < m_positions.size() && iii < state.Count(); ++iii)
+	{
+		state.Positions[iii] = PositionAt(static_cast<int>(iii), m_time);
+		state.Velocities[iii] = m_velocities[iii];
+
+		v = m_velocities[iii];
+		mass = m_masses[iii];
+		observables.KineticEnergy += 0.5 * mass * (static_cast<double>(v.x) * v.x + static_cast<double>(v.y) * v.y + static_cast<double>(v.z) * v.z);
+		observables.MomentumX += mass * v.x;
+		observables.MomentumY += mass * v.y;
+		observables.MomentumZ += mass * v.z;
+	}
+}
+
+void EventDrivenEngine::PushEvent(const Event& e)
+{
+	m_events.push_back(e);
+	std::push_heap(m_events.begin(), m_events.end(), std::greater<Event>());
+}
+
+EventDrivenEngine::Event EventDrivenEngine::PopEvent()
+{
+	std::pop_heap(m_events.begin(), m_events.end(), std::greater<Event>());
+	Event e = m_events.back();
+	m_events.pop_back();
+	return e;
+}
+
+bool EventDrivenEngine::IsStale(const Event& e)
+{
+	return e.Count1 != m_collisionCounts[e.Atom1] || (e.Type == EventType::COLLISION && e.Count2 != m_collisionCounts[e.Atom2]);
+}
+
+void EventDrivenEngine::PruneEvents()
+{
+	// Drop the events that would be skipped when popped anyway
+	m_events.erase(std::remove_if(m_events.begin(), m_events.end(), [this](const Event& e) { return IsStale(e); }), m_events.end());
+
+	// Re-predictions after a cell crossing duplicate live events (with the same counts). Only the earliest
+	// copy can be processed - it invalidates the others - so keep that one. The pair is stored in either
+	// order depending on which atom predicted it
+	auto key = [](const Event& e)
+	{
+		return std::make_tuple(e.Type, std::min(e.Atom1, e.Atom2), std::max(e.Atom1, e.Atom2), e.Axis,
+							   e.Atom1 < e.Atom2 ? e.Count1 : e.Count2, e.Atom1 < e.Atom2 ? e.Count2 : e.Count1);
+	};
+
+	std::sort(m_events.begin(), m_events.end(), [&key](const Event& a, const Event& b)
+	{
+		return key(a) < key(b) || (key(a) == key(b) && b > a);
+	});
+	m_events.erase(std::unique(m_events.begin(), m_events.end(), [&key](const Event& a, const Event& b) { return key(a) == key(b); }), m_events.end());
+
+	std::make_heap(m_events.begin(), m_events.end(), std::greater<Event>());
+	m_pruneThreshold = std::max(PruneFactor * m_events.size(), MinPruneThreshold);
+}
+
+Float3 EventDrivenEngine::PositionAt(int atom, double time)
+{
+	float dt = static_cast<float>(time - m_localTimes[atom]);
+	return Float3{
+		m_positions[atom].x + dt * m_velocities[atom].x,
+		m_positions[atom].y + dt * m_velocities[atom].y,
+		m_positions[atom].z + dt * m_velocities[atom].z
+	};
+}
+
+void EventDrivenEngine::MoveTo(int atom, double time)
+{
+	m_positions[atom] = PositionAt(atom, time);
+	m_localTimes[atom] = time;
+}
+
+void EventDrivenEngine::PredictWalls(int atom)
+{
+	// Only the earliest wall impact matters - hitting it changes the velocity which invalidates the rest
+	double earliest = Collisions::Never;
+	int earliestAxis = 0;
+
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		double t = Collisions::SphereWallTimeOfImpact(
+			Component(m_positions[atom], axis), Component(m_velocities[atom], axis), m_radii[atom], m_halfExtents[axis]);
+
+		if (t < earliest)
+		{
+			earliest = t;
+			earliestAxis = axis;
+		}
+	}
+
+	if (earliest != Collisions::Never)
+		PushEvent({ m_localTimes[atom] + earliest, EventType::WALL, atom, -1, earliestAxis, m_collisionCounts[atom], 0 });
+}
+
+void EventDrivenEngine::PredictCellCrossing(int atom)
+{
+	double earliest = Collisions::Never;
+	int earliestAxis = 0;
+
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		float p = Component(m_positions[atom], axis);
+		float v = Component(m_velocities[atom], axis);
+		int cell = m_atomCells[axis][atom];
+		double t = Collisions::Never;
+
+		// Atoms in the outermost cells will hit the wall, not cross into another cell
+		if (v > 0.0f && cell < m_cellsPerAxis[axis] - 1)
+			t = (-m_halfExtents[axis] + (cell + 1) * m_cellSize[axis] - p) / v;
+		else if (v < 0.0f && cell > 0)
+			t = (-m_halfExtents[axis] + cell * m_cellSize[axis] - p) / v;
+
+		if (t < earliest)
+		{
+			earliest = std::max(t, 0.0);
+			earliestAxis = axis;
+		}
+	}
+
+	if (earliest != Collisions::Never)
+		PushEvent({ m_localTimes[atom] + earliest, EventType::CELL_CROSSING, atom, -1, earliestAxis, m_collisionCounts[atom], 0 });
+}
+
+void EventDrivenEngine::PredictCollisions(int atom, int ignore, bool higherOnly)
+{
+	double now = m_localTimes[atom];
+	const Float3& p = m_positions[atom];
+	const Float3& v = m_velocities[atom];
+
+	int cx = m_atomCells[0][atom];
+	int cy = m_atomCells[1][atom];
+	int cz = m_atomCells[2][atom];
+
+	for (int z = std::max(cz - 1, 0); z <= std::min(cz + 1, m_cellsPerAxis[2] - 1); ++z)
+	{
+		for (int y = std::max(cy - 1, 0); y <= std::min(cy + 1, m_cellsPerAxis[1] - 1); ++y)
+		{
+			for (int x = std::max(cx - 1, 0); x <= std::min(cx + 1, m_cellsPerAxis[0] - 1); ++x)
+			{
+				for (int other : m_cells[CellIndex(x, y, z)])
+				{
+					if (other == atom || other == ignore || (higherOnly && other < atom))
+						continue;
+
+					double t = Collisions::SphereSphereTimeOfImpact(p, v, m_radii[atom], PositionAt(other, now), m_velocities[other], m_radii[other]);
+
+					if (t != Collisions::Never)
+						PushEvent({ now + t, EventType::COLLISION, atom, other, 0, m_collisionCounts[atom], m_collisionCounts[other] });
+				}
+			}
+		}
+	}
+}
+
+void EventDrivenEngine::RemoveFromCell(int atom)
+{
+	std::vector<int>& cell = m_cells[CellIndex(m_atomCells[0][atom], m_atomCells[1][atom], m_atomCells[2][atom])];
+
+	auto it = std::find(cell.begin(), cell.end(), atom);
+	if (it != cell.end())
+	{
+		*it = cell.back();
+		cell.pop_back();
+	}
+}
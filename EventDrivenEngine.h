@@ -0,0 +1,114 @@
+#pragma once
+
+#include "Collisions.h"
+#include "HardSphereState.h"
+#include "SimulationObservables.h"
+
+#include <tuple>
+#include <vector>
+
+// Event-driven hard-sphere molecular dynamics. Instead of stepping every atom by a fixed timeDelta,
+// the engine keeps a priority queue of predicted events (atom-atom collisions, atom-wall collisions
+// and atoms crossing into a neighboring cell) and jumps straight from one event to the next. Between
+// events atoms move in straight lines, so the trajectory is exact for hard spheres and the cost only
+// depends on the number of events, not on the size of the time step.
+//
+// Atom positions are updated lazily: each atom stores the time at which its position is valid, and
+// is only moved when it takes part in an event (or when the state is written back).
+//
+// Predictions are never removed from the queue when they go stale (an atom changed velocity) - they are
+// skipped when popped. Cell crossings also re-predict collisions that are already queued. So that the
+// queue doesn't grow without bound on long runs, it is rebuilt without the stale and duplicate events
+// whenever it grows past PruneFactor times the live events it held after the last rebuild.
+class EventDrivenEngine
+{
+public:
+	EventDrivenEngine();
+
+	// Copy the sphere state/box into the engine, build the cell grid and predict the initial events.
+	// Must be called again whenever spheres are added/removed/edited or the box changes.
+	void Initialize(const HardSphereState& state);
+
+	// Process every event up to (and including) Time() + timeDelta
+	void Advance(double timeDelta);
+
+	// Write the positions/velocities at Time() back to the state and accumulate the kinetic energy
+	// and momentum in the same pass
+	void WriteBack(HardSphereState& state, SimulationObservables& observables);
+
+	double Time() { return m_time; }
+	size_t AtomCount() { return m_positions.size(); }
+	unsigned long long EventCount() { return m_eventCount; }
+	unsigned long long CollisionCount() { return m_collisionCount; }
+	size_t QueuedEventCount() { return m_events.size(); }
+
+	static constexpr size_t PruneFactor = 3;
+
+private:
+	enum class EventType
+	{
+		COLLISION,
+		WALL,
+		CELL_CROSSING
+	};
+
+	struct Event
+	{
+		double Time;
+		EventType Type;
+		int Atom1;
+		int Atom2;				// COLLISION only
+		int Axis;				// WALL and CELL_CROSSING only
+		unsigned int Count1;	// Collision count of each atom at the time of prediction - used to discard stale events
+		unsigned int Count2;
+
+		// Ties are broken on the atoms, so the processing order doesn't depend on the layout of the heap
+		// (which changes when the queue is rebuilt)
+		bool operator>(const Event& rhs) const
+		{
+			return std::tie(Time, Atom1, Atom2, Type, Axis) > std::tie(rhs.Time, rhs.Atom1, rhs.Atom2, rhs.Type, rhs.Axis);
+		}
+	};
+
+	void PushEvent(const Event& e);
+	Event PopEvent();
+	bool IsStale(const Event& e);
+	void PruneEvents();
+
+	Float3 PositionAt(int atom, double time);
+	void MoveTo(int atom, double time);
+
+	void PredictWalls(int atom);
+	void PredictCellCrossing(int atom);
+	void PredictCollisions(int atom, int ignore = -1, bool higherOnly = false);
+
+	int CellIndex(int x, int y, int z) { return (z * m_cellsPerAxis[1] + y) * m_cellsPerAxis[0] + x; }
+	void RemoveFromCell(int atom);
+
+	// Atom state
+	std::vector<Float3>	m_positions;
+	std::vector<Float3>	m_velocities;
+	std::vector<float>				m_radii;
+	std::vector<float>				m_masses;
+	std::vector<double>				m_localTimes;		// Time at which m_positions[i] is valid
+	std::vector<unsigned int>		m_collisionCounts;	// Incremented whenever an atom changes velocity
+
+	// Box
+	float		m_halfExtents[3];
+
+	// Cell grid - cells are at least one (maximum) atom diameter wide, so an atom can only collide
+	// with atoms in its own or one of the 26 neighboring cells
+	int								m_cellsPerAxis[3];
+	float							m_cellSize[3];
+	std::vector<std::vector<int>>	m_cells;
+	std::vector<int>				m_atomCells[3];		// x, y, z cell coordinate of each atom
+
+	// Events - a min-heap on Time (std::push_heap/pop_heap with std::greater) rather than a
+	// std::priority_queue, so PruneEvents can get at the container
+	std::vector<Event>	m_events;
+	size_t				m_pruneThreshold;	// Queue size that triggers the next PruneEvents
+
+	double				m_time;
+	unsigned long long	m_eventCount;
+	unsigned long long	m_collisionCount;
+};
@@ -0,0 +1,230 @@
+#include "FrameExport.h"
+
+#include <algorithm>
+#include <cstring>
+
+
+std::vector<FrameTile> SplitFrame(unsigned int width, unsigned int height, unsigned int maxTileSize)
+{
+	maxTileSize = std::max(maxTileSize, 1u);
+
+	std::vector<FrameTile> tiles;
+	for (unsigned int y = 0; y < height; y += maxTileSize)
+	{
+		for (unsigned int x = 0; x < width; x += maxTileSize)
+			tiles.push_back({ x, y, std::min(maxTileSize, width - x), std::min(maxTileSize, height - y) });
+	}
+	return tiles;
+}
+
+void TileProjection(const FrameTile& tile, unsigned int width, unsigned int height, float matrix[4][4])
+{
+	// Scale the tile up to the whole of normalized device coordinates and move its center to the origin.
+	// Pixel rows go down while NDC y goes up
+	float scaleX = static_cast<float>(width) / tile.Width;
+	float scaleY = static_cast<float>(height) / tile.Height;
+	float centerX = (tile.X + 0.5f * tile.Width) / width * 2.0f - 1.0f;
+	float centerY = 1.0f - (tile.Y + 0.5f * tile.Height) / height * 2.0f;
+
+	std::memset(matrix, 0, sizeof(float) * 16);
+	matrix[0][0] = scaleX;
+	matrix[1][1] = scaleY;
+	matrix[2][2] = 1.0f;
+	matrix[3][3] = 1.0f;
+
+	// x' = (x - centerX * w) * scaleX, so the offset is scaled by w through the last row
+	matrix[3][0] = -centerX * scaleX;
+	matrix[3][1] = -centerY * scaleY;
+}
+
+
+FrameWriter::FrameWriter() :
+	m_format(FrameFileFormat::IMAGE_SEQUENCE),
+	m_width(0),
+	m_height(0),
+	m_video(nullptr),
+	m_submitted(0),
+	m_written(0),
+	m_frameBegun(false),
+	m_stopping(false),
+	m_failed(false)
+{
+}
+
+FrameWriter::~FrameWriter()
+{
+	Close();
+}
+
+bool FrameWriter::Open(const std::string& path, FrameFileFormat format, unsigned int width, unsigned int height, unsigned int framesPerSecond)
+{
+	Close();
+
+	if (width == 0 || height == 0)
+		return false;
+
+	m_path = path;
+	m_format = format;
+	m_width = width;
+	m_height = height;
+
+	if (format == FrameFileFormat::RAW_VIDEO)
+	{
+		m_video = std::fopen((path + ".y4m").c_str(), "wb");
+		if (m_video == nullptr)
+			return false;
+
+		std::fprintf(m_video, "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C444\n", width, height, std::max(framesPerSecond, 1u));
+		m_planes.resize(static_cast<size_t>(width) * height * 3);
+	}
+
+	for (std::vector<uint32_t>& buffer : m_buffers)
+		buffer.resize(static_cast<size_t>(width) * height);
+
+	m_submitted = 0;
+	m_written = 0;
+	m_frameBegun = false;
+	m_stopping = false;
+	m_failed = false;
+
+	m_worker = std::thread(&FrameWriter::WorkerLoop, this);
+	return true;
+}
+
+std::vector<uint32_t>& FrameWriter::BeginFrame()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_frameWritten.wait(lock, [this] { return m_submitted - m_written < QueueDepth; });
+
+	m_frameBegun = true;
+	return m_buffers[m_submitted % QueueDepth];
+}
+
+void FrameWriter::SubmitFrame()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_frameBegun)
+			return;
+
+		m_frameBegun = false;
+		++m_submitted;
+	}
+	m_frameQueued.notify_one();
+}
+
+bool FrameWriter::Close()
+{
+	if (!m_worker.joinable())
+		return !m_failed;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_frameQueued.notify_one();
+	m_worker.join();
+
+	if (m_video != nullptr)
+	{
+		if (std::fclose(m_video) != 0)
+			m_failed = true;
+		m_video = nullptr;
+	}
+
+	// Release the frame memory - high resolution frames are large
+	for (std::vector<uint32_t>& buffer : m_buffers)
+		std::vector<uint32_t>().swap(buffer);
+	std::vector<uint8_t>().swap(m_planes);
+
+	return !m_failed;
+}
+
+unsigned int FrameWriter::FramesWritten() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return static_cast<unsigned int>(m_written);
+}
+
+void FrameWriter::WorkerLoop()
+{
+	while (true)
+	{
+		size_t index;
+
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_frameQueued.wait(lock, [this] { return m_stopping || m_written < m_submitted; });
+
+			if (m_written == m_submitted)
+				return;
+
+			index = m_written;
+		}
+
+		// The caller doesn't touch a queued buffer until it has been written, so no lock is needed here
+		bool succeeded = WriteFrame(m_buffers[index % QueueDepth], static_cast<unsigned int>(index));
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (!succeeded)
+				m_failed = true;
+			++m_written;
+		}
+		m_frameWritten.notify_one();
+	}
+}
+
+bool FrameWriter::WriteFrame(const std::vector<uint32_t>& pixels, unsigned int index)
+{
+	if (m_format == FrameFileFormat::IMAGE_SEQUENCE)
+	{
+		char suffix[16];
+		std::snprintf(suffix, sizeof(suffix), "_%05u.ppm", index);
+		return WritePPM(m_path + suffix, pixels.data(), m_width, m_height);
+	}
+
+	// BT.601 studio range, the default players assume for YUV4MPEG2
+	const size_t planeSize = static_cast<size_t>(m_width) * m_height;
+	uint8_t* yPlane = m_planes.data();
+	uint8_t* uPlane = yPlane + planeSize;
+	uint8_t* vPlane = uPlane + planeSize;
+
+	for (size_t iii = 0; iii < planeSize; ++iii)
+	{
+		int r = static_cast<int>(pixels[iii] & 0xFF);
+		int g = static_cast<int>((pixels[iii] >> 8) & 0xFF);
+		int b = static_cast<int>((pixels[iii] >> 16) & 0xFF);
+
+		yPlane[iii] = static_cast<uint8_t>(16 + ((66 * r + 129 * g + 25 * b + 128) >> 8));
+		uPlane[iii] = static_cast<uint8_t>(128 + ((-38 * r - 74 * g + 112 * b + 128) >> 8));
+		vPlane[iii] = static_cast<uint8_t>(128 + ((112 * r - 94 * g - 18 * b + 128) >> 8));
+	}
+
+	std::fputs("FRAME\n", m_video);
+	return std::fwrite(m_planes.data(), 1, m_planes.size(), m_video) == m_planes.size();
+}
+
+bool FrameWriter::WritePPM(const std::string& path, const uint32_t* pixels, unsigned int width, unsigned int height)
+{
+	FILE* file = std::fopen(path.c_str(), "wb");
+	if (file == nullptr)
+		return false;
+
+	std::fprintf(file, "P6\n%u %u\n255\n", width, height);
+
+	std::vector<uint8_t> row(static_cast<size_t>(width) * 3);
+	for (unsigned int y = 0; y < height; ++y)
+	{
+		for (unsigned int x = 0; x < width; ++x)
+		{
+			uint32_t pixel = pixels[static_cast<size_t>(y) * width + x];
+			row[3 * x + 0] = static_cast<uint8_t>(pixel & 0xFF);
+			row[3 * x + 1] = static_cast<uint8_t>((pixel >> 8) & 0xFF);
+			row[3 * x + 2] = static_cast<uint8_t>((pixel >> 16) & 0xFF);
+		}
+		std::fwrite(row.data(), 1, row.size(), file);
+	}
+
+	return std::fclose(file) == 0;
+}
\ No newline at end of file
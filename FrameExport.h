@@ -0,0 +1,99 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Part of an exported frame that is rendered on its own. Frames larger than the largest texture the
+// device can create (or than is sensible to allocate at once) are rendered as a grid of tiles, each
+// with the projection narrowed to its part of the screen (see TileProjection)
+struct FrameTile
+{
+	unsigned int	X;
+	unsigned int	Y;
+	unsigned int	Width;
+	unsigned int	Height;
+};
+
+// Split a width x height frame into tiles of at most maxTileSize x maxTileSize pixels, in rows from the
+// top left
+std::vector<FrameTile> SplitFrame(unsigned int width, unsigned int height, unsigned int maxTileSize);
+
+// Matrix to post-multiply the projection (row-major for row vectors, see Frustum) with so that 'tile' of
+// a width x height frame fills the whole viewport. Only x and y are scaled and offset in clip space, so
+// depth and the perspective divide are the same as for the full frame and the tiles line up exactly
+void TileProjection(const FrameTile& tile, unsigned int width, unsigned int height, float matrix[4][4]);
+
+enum class FrameFileFormat
+{
+	IMAGE_SEQUENCE,		// One binary PPM per frame - <path>_00000.ppm, <path>_00001.ppm, ...
+	RAW_VIDEO			// A single uncompressed YUV4MPEG2 (4:4:4) stream - <path>.y4m, which ffmpeg and most players read
+};
+
+// Writes exported frames to disk on a worker thread, so rendering and reading back the next frame
+// overlaps with converting and writing the previous ones.
+//
+// The writer owns QueueDepth frame buffers. BeginFrame hands out a free one (waiting for the worker when
+// every buffer is queued, which keeps memory bounded when the disk is the bottleneck) and SubmitFrame
+// queues it. Frames are written in the order they were submitted.
+//
+// Pixels are top-down rows of RGBA8 (R in the lowest byte) - the layout of DXGI_FORMAT_R8G8B8A8_UNORM and
+// of SoftwareRasterizer::Pixels. Alpha is ignored.
+class FrameWriter
+{
+public:
+	static constexpr size_t QueueDepth = 3;
+
+	FrameWriter();
+	~FrameWriter();
+
+	FrameWriter(const FrameWriter&) = delete;
+	FrameWriter& operator=(const FrameWriter&) = delete;
+
+	// Returns false if the output can't be created. path is without the extension
+	bool Open(const std::string& path, FrameFileFormat format, unsigned int width, unsigned int height, unsigned int framesPerSecond);
+
+	// Buffer of Width() * Height() pixels to fill with the next frame. Must be followed by SubmitFrame
+	std::vector<uint32_t>& BeginFrame();
+	void SubmitFrame();
+
+	// Write every queued frame and close the output. Returns false if any frame failed to write
+	bool Close();
+
+	bool IsOpen() const { return m_worker.joinable(); }
+	unsigned int Width() const { return m_width; }
+	unsigned int Height() const { return m_height; }
+	unsigned int FramesWritten() const;
+
+	static bool WritePPM(const std::string& path, const uint32_t* pixels, unsigned int width, unsigned int height);
+
+private:
+	void WorkerLoop();
+	bool WriteFrame(const std::vector<uint32_t>& pixels, unsigned int index);
+
+	std::string				m_path;
+	FrameFileFormat			m_format;
+	unsigned int			m_width;
+	unsigned int			m_height;
+	FILE*					m_video;		// RAW_VIDEO only
+	std::vector<uint8_t>	m_planes;		// Y, U and V planes of the frame being written (worker only)
+
+	// Frame buffers cycle free -> filled by the caller -> queued -> written by the worker -> free. Buffers
+	// are handed out and written in order, so the ring only needs the counts
+	std::vector<uint32_t>	m_buffers[QueueDepth];
+	size_t					m_submitted;	// Frames queued by SubmitFrame
+	size_t					m_written;		// Frames the worker has finished with
+	bool					m_frameBegun;
+	bool					m_stopping;
+	bool					m_failed;
+
+	std::thread				m_worker;
+	mutable std::mutex		m_mutex;
+	std::condition_variable	m_frameQueued;
+	std::condition_variable	m_frameWritten;
+};
\ No newline at end of file
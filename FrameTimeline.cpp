@@ -0,0 +1,124 @@
+#include "FrameTimeline.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Have to define static member variables in .cpp file
+FrameTimeline::Clock::time_point FrameTimeline::m_frameBegin;
+std::array<FrameTimeline::Clock::time_point, FrameTimeline::StageCount> FrameTimeline::m_stageBegin;
+std::array<double, FrameTimeline::StageCount> FrameTimeline::m_stageTime = {};
+FrameTimeline::Clock::time_point FrameTimeline::m_oldestInput;
+bool FrameTimeline::m_inputPending = false;
+FrameTimeline::Clock::time_point FrameTimeline::m_lastPresent;
+bool FrameTimeline::m_lastPresentValid = false;
+bool FrameTimeline::m_frameEnded = false;
+std::array<RollingSamples, FrameTimeline::StageCount> FrameTimeline::m_cpuStages;
+std::array<RollingSamples, FrameTimeline::StageCount> FrameTimeline::m_gpuStages;
+RollingSamples FrameTimeline::m_frameTime;
+RollingSamples FrameTimeline::m_frameInterval;
+RollingSamples FrameTimeline::m_inputLatency;
+
+
+void RollingSamples::Add(float value)
+{
+	m_samples[m_next] = value;
+	m_next = (m_next + 1) % WindowSize;
+	m_count = std::min(m_count + 1, WindowSize);
+}
+
+float RollingSamples::Percentile(float percentile) const
+{
+	if (m_count == 0)
+		return 0.0f;
+
+	// The window is small enough to select from a copy every time the percentiles are drawn
+	std::array<float, WindowSize> sorted;
+	std::copy(m_samples.begin(), m_samples.begin() + m_count, sorted.begin());
+
+	size_t index = static_cast<size_t>(std::lround(std::clamp(percentile, 0.0f, 1.0f) * (m_count - 1)));
+	std::nth_element(sorted.begin(), sorted.begin() + index, sorted.begin() + m_count);
+	return sorted[index];
+}
+
+
+void FrameTimeline::BeginFrame()
+{
+	// The previous pass through the loop didn't present, so there is no interval to the next present
+	if (!m_frameEnded)
+		m_lastPresentValid = false;
+
+	m_frameEnded = false;
+	m_inputPending = false;
+	m_stageTime.fill(0.0);
+	m_frameBegin = Clock::now();
+}
+
+void FrameTimeline::EndFrame()
+{
+	Clock::time_point now = Clock::now();
+
+	for (size_t iii = 0; iii < StageCount; ++iii)
+		m_cpuStages[iii].Add(static_cast<float>(m_stageTime[iii]));
+
+	m_frameTime.Add(static_cast<float>(Milliseconds(m_frameBegin, now)));
+
+	if (m_lastPresentValid)
+		m_frameInterval.Add(static_cast<float>(Milliseconds(m_lastPresent, now)));
+
+	if (m_inputPending)
+		m_inputLatency.Add(static_cast<float>(Milliseconds(m_oldestInput, now)));
+
+	m_lastPresent = now;
+	m_lastPresentValid = true;
+	m_frameEnded = true;
+}
+
+void FrameTimeline::Idle()
+{
+	m_lastPresentValid = false;
+}
+
+void FrameTimeline::BeginStage(FrameStage stage)
+{
+	m_stageBegin[static_cast<size_t>(stage)] = Clock::now();
+}
+
+void FrameTimeline::EndStage(FrameStage stage)
+{
+	size_t index = static_cast<size_t>(stage);
+	m_stageTime[index] += Milliseconds(m_stageBegin[index], Clock::now());
+}
+
+void FrameTimeline::InputReceived(double ageMilliseconds)
+{
+	Clock::time_point posted = Clock::now() - std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(std::max(ageMilliseconds, 0.0)));
+
+	if (!m_inputPending || posted < m_oldestInput)
+		m_oldestInput = posted;
+
+	m_inputPending = true;
+}
+
+void FrameTimeline::RecordGpuStage(FrameStage stage, double milliseconds)
+{
+	m_gpuStages[static_cast<size_t>(stage)].Add(static_cast<float>(milliseconds));
+}
+
+const char* FrameTimeline::StageName(FrameStage stage)
+{
+	switch (stage)
+	{
+	case FrameStage::MESSAGE_PUMP:		return "Message pump";
+	case FrameStage::LAYOUT_UPDATE:		return "Layout update";
+	case FrameStage::SIMULATION_STEP:	return "Simulation step";
+	case FrameStage::RENDER_3D:			return "Render 3D";
+	case FrameStage::RENDER_2D:			return "Render 2D";
+	case FrameStage::PRESENT:			return "Present";
+	default:							return "";
+	}
+}
+
+double FrameTimeline::Milliseconds(Clock::time_point begin, Clock::time_point end)
+{
+	return std::chrono::duration<double, std::milli>(end - begin).count();
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+// Parts of a frame that are timed. App::Run pumps messages, then each window updates, renders and presents
+enum class FrameStage
+{
+	MESSAGE_PUMP,		// WindowManager::ProcessMessages
+	LAYOUT_UPDATE,		// Layout::Update (every fixed step of the frame)
+	SIMULATION_STEP,	// SimulationManager::Update (every fixed step of the frame)
+	RENDER_3D,			// Layout::Render3DControls
+	RENDER_2D,			// The cached UI layer, the captured control and the overlay
+	PRESENT,			// DeviceResources::Present - includes waiting for the swap chain
+	COUNT
+};
+
+// The last WindowSize values of a measurement, with percentiles over them
+class RollingSamples
+{
+public:
+	static constexpr size_t WindowSize = 240;
+
+	RollingSamples() : m_samples{}, m_next(0), m_count(0) {}
+
+	void Add(float value);
+	void Clear() { m_next = 0; m_count = 0; }
+
+	size_t Count() const { return m_count; }
+
+	// percentile is in [0, 1]. Returns 0 when there are no samples
+	float Percentile(float percentile) const;
+
+private:
+	std::array<float, WindowSize>	m_samples;
+	size_t							m_next;
+	size_t							m_count;
+};
+
+// Per-frame timeline of where the time goes, kept as rolling percentiles so a frame that is dropped under
+// load shows up in p99 even when p50 looks fine.
+//
+// A frame runs from BeginFrame (the top of App::Run) to EndFrame (after the windows have presented). Passes
+// through the loop that don't render are dropped, and Idle is called before App::Run waits for messages so
+// the interval across the wait isn't counted as a present interval either.
+// The CPU time of each stage is summed over the frame (the fixed timestep can update several times per frame).
+// GPU times are measured with timestamp queries that are only read back a few frames later (see
+// GpuFrameTimer), so they are recorded on their own with RecordGpuStage.
+//
+// Besides the stages, three measurements describe the frame as a whole:
+//		- CPU time from BeginFrame to EndFrame
+//		- Interval between the presents of consecutive frames - the frame pacing the user sees
+//		- Input latency from the oldest input message handled in the frame until its present
+class FrameTimeline
+{
+public:
+	static constexpr size_t StageCount = static_cast<size_t>(FrameStage::COUNT);
+
+	static void BeginFrame();
+	static void EndFrame();
+
+	// Nothing is rendered until the next message - the next present doesn't follow this one back to back
+	static void Idle();
+
+	static void BeginStage(FrameStage stage);
+	static void EndStage(FrameStage stage);
+
+	// An input message was handled. age is how long ago (in milliseconds) it was posted
+	static void InputReceived(double ageMilliseconds);
+
+	static void RecordGpuStage(FrameStage stage, double milliseconds);
+
+	static const RollingSamples& CpuStage(FrameStage stage) { return m_cpuStages[static_cast<size_t>(stage)]; }
+	static const RollingSamples& GpuStage(FrameStage stage) { return m_gpuStages[static_cast<size_t>(stage)]; }
+	static const RollingSamples& FrameTime() { return m_frameTime; }
+	static const RollingSamples& FrameInterval() { return m_frameInterval; }
+	static const RollingSamples& InputLatency() { return m_inputLatency; }
+
+	static const char* StageName(FrameStage stage);
+
+private:
+	// Disallow creation of a FrameTimeline object
+	FrameTimeline() {}
+
+	using Clock = std::chrono::steady_clock;
+
+	static double Milliseconds(Clock::time_point begin, Clock::time_point end);
+
+	// The frame being measured
+	static Clock::time_point						m_frameBegin;
+	static std::array<Clock::time_point, StageCount>	m_stageBegin;
+	static std::array<double, StageCount>			m_stageTime;
+	static Clock::time_point						m_oldestInput;
+	static bool										m_inputPending;
+
+	// Present of the previous frame. Only valid while frames are rendered back to back
+	static Clock::time_point						m_lastPresent;
+	static bool										m_lastPresentValid;
+	static bool										m_frameEnded;
+
+	static std::array<RollingSamples, StageCount>	m_cpuStages;
+	static std::array<RollingSamples, StageCount>	m_gpuStages;
+	static RollingSamples							m_frameTime;
+	static RollingSamples							m_frameInterval;
+	static RollingSamples							m_inputLatency;
+};
\ No newline at end of file
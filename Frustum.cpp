@@ -0,0 +1,86 @@
+#include "Frustum.h"
+
+#include <cmath>
+#include <cstring>
+
+
+Frustum::Frustum()
+{
+	// Default frustum contains everything (every plane is 0x + 0y + 0z + 1 >= 0)
+	for (int plane = 0; plane < 6; ++plane)
+	{
+		m_a[plane] = 0.0f;
+		m_b[plane] = 0.0f;
+		m_c[plane] = 0.0f;
+		m_d[plane] = 1.0f;
+	}
+}
+
+Frustum Frustum::FromViewProjection(const float m[4][4])
+{
+	return FromViewProjection(m, -1.0f, -1.0f, 1.0f, 1.0f);
+}
+
+Frustum Frustum::FromViewProjection(const float m[4][4], float left, float bottom, float right, float top)
+{
+	// With row vectors, clip = (x, y, z, 1) * M, so clip.x is the dot product of the point with column 0
+	// of M, clip.w with column 3, etc. Each clip condition (left * w <= x <= right * w, bottom * w <= y <= top * w,
+	// 0 <= z <= w) gives one plane as a combination of two columns (Gribb & Hartmann - the full screen is
+	// left = bottom = -1, right = top = 1)
+	auto column = [&m](int c, float out[4]) { out[0] = m[0][c]; out[1] = m[1][c]; out[2] = m[2][c]; out[3] = m[3][c]; };
+
+	float x[4], y[4], z[4], w[4];
+	column(0, x);
+	column(1, y);
+	column(2, z);
+	column(3, w);
+
+	float planes[6][4];
+	for (int iii = 0; iii < 4; ++iii)
+	{
+		planes[LEFT][iii]		= x[iii] - left * w[iii];
+		planes[RIGHT][iii]		= right * w[iii] - x[iii];
+		planes[BOTTOM][iii]		= y[iii] - bottom * w[iii];
+		planes[TOP][iii]		= top * w[iii] - y[iii];
+		planes[NEAR_PLANE][iii]	= z[iii];
+		planes[FAR_PLANE][iii]	= w[iii] - z[iii];
+	}
+
+	// Normalize so Distance() is a true distance and can be compared against a radius
+	Frustum frustum;
+	for (int plane = 0; plane < 6; ++plane)
+	{
+		float length = std::sqrt(planes[plane][0] * planes[plane][0] + planes[plane][1] * planes[plane][1] + planes[plane][2] * planes[plane][2]);
+		float scale = length > 0.0f ? 1.0f / length : 1.0f;
+
+		frustum.m_a[plane] = planes[plane][0] * scale;
+		frustum.m_b[plane] = planes[plane][1] * scale;
+		frustum.m_c[plane] = planes[plane][2] * scale;
+		frustum.m_d[plane] = planes[plane][3] * scale;
+	}
+
+	return frustum;
+}
+
+size_t Frustum::IntersectsSpheres(const float* spheres, size_t stride, size_t count, uint8_t* visible) const
+{
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(spheres);
+	size_t visibleCount = 0;
+
+	for (size_t iii = 0; iii < count; ++iii)
+	{
+		float sphere[4];
+		std::memcpy(sphere, bytes + iii * stride, sizeof(sphere));
+
+		// Evaluate all 6 planes without early outs - a fixed trip count with no branches lets the
+		// compiler keep this in SIMD registers
+		bool inside = true;
+		for (int plane = 0; plane < 6; ++plane)
+			inside &= (m_a[plane] * sphere[0] + m_b[plane] * sphere[1] + m_c[plane] * sphere[2] + m_d[plane]) >= -sphere[3];
+
+		visible[iii] = inside ? 1 : 0;
+		visibleCount += inside ? 1 : 0;
+	}
+
+	return visibleCount;
+}
\ No newline at end of file
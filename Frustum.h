@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// View frustum as 6 planes extracted from a view-projection matrix. Used to skip atoms, bonds and
+// velocity arrows that are entirely off screen before they are uploaded/drawn.
+//
+// The matrix is expected in the DirectXMath convention used by SimulationRenderer: row-major, row
+// vectors (clip = position * viewProjection) and a D3D clip volume (0 <= z <= w). With the reverse Z
+// projection of CameraSpace, NEAR_PLANE is the far plane - at infinity it has no normal and never culls.
+class Frustum
+{
+public:
+	Frustum();
+
+	// Build the frustum from a 4x4 view-projection matrix (e.g. XMFLOAT4X4::m)
+	static Frustum FromViewProjection(const float viewProjection[4][4]);
+
+	// Build the frustum for the part of the screen inside a rectangle given in normalized device
+	// coordinates (-1 <= x, y <= 1, y up). Used for rubber band selection
+	static Frustum FromViewProjection(const float viewProjection[4][4], float left, float bottom, float right, float top);
+
+	// Conservative sphere test - may report spheres just outside a corner of the frustum as visible,
+	// but never culls a sphere that is (partially) visible
+	bool IntersectsSphere(float x, float y, float z, float radius) const
+	{
+		for (int plane = 0; plane < 6; ++plane)
+		{
+			if (Distance(plane, x, y, z) < -radius)
+				return false;
+		}
+		return true;
+	}
+
+	// Test 'count' spheres at once. 'spheres' points at the first sphere's x, y, z, radius (4 consecutive
+	// floats) and 'stride' is the number of bytes from one sphere to the next, so this can run directly
+	// over packed instance arrays. visible[i] is set to 1 if sphere i intersects the frustum and 0 if not.
+	// Returns the number of visible spheres.
+	size_t IntersectsSpheres(const float* spheres, size_t stride, size_t count, uint8_t* visible) const;
+
+	// Conservative axis aligned box test (same caveat as IntersectsSphere)
+	bool IntersectsBox(const float min[3], const float max[3]) const
+	{
+		for (int plane = 0; plane < 6; ++plane)
+		{
+			// Test the corner furthest along the plane normal
+			float x = m_a[plane] >= 0.0f ? max[0] : min[0];
+			float y = m_b[plane] >= 0.0f ? max[1] : min[1];
+			float z = m_c[plane] >= 0.0f ? max[2] : min[2];
+			if (Distance(plane, x, y, z) < 0.0f)
+				return false;
+		}
+		return true;
+	}
+
+	// Signed distance from the point to the plane (positive = inside)
+	float Distance(int plane, float x, float y, float z) const
+	{
+		return m_a[plane] * x + m_b[plane] * y + m_c[plane] * z + m_d[plane];
+	}
+
+	enum Plane { LEFT = 0, RIGHT, BOTTOM, TOP, NEAR_PLANE, FAR_PLANE };
+
+private:
+	// Planes stored as structure of arrays so the batch test can vectorize over the 6 planes
+	float m_a[6];
+	float m_b[6];
+	float m_c[6];
+	float m_d[6];
+};
\ No newline at end of file
@@ -0,0 +1,10 @@
+// Full screen pass: a single triangle that covers the whole viewport, generated from SV_VertexID (3 vertices,
+// no vertex buffer or input layout). The triangle is larger than the viewport so no pixel is shaded twice
+// along a diagonal, which a two triangle quad would do.
+
+float4 main(uint vertexID : SV_VertexID) : SV_POSITION
+{
+	// (0, 0), (2, 0), (0, 2) in texture space -> (-1, 1), (3, 1), (-1, -3) in clip space
+	float2 texCoord = float2((vertexID << 1) & 2, vertexID & 2);
+	return float4(texCoord * float2(2.0f, -2.0f) + float2(-1.0f, 1.0f), 0.0f, 1.0f);
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "GoldenTrajectory.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <string>
+
+
+int GoldenTrajectory::FirstMismatch(const GoldenTrajectory& other) const
+{
+	if (TimeStep != other.TimeStep || Interval != other.Interval)
+		return 0;
+
+	size_t count = std::min(Checkpoints.size(), other.Checkpoints.size());
+	for (size_t iii = 0; iii < count; ++iii)
+	{
+		if (Checkpoints[iii] != other.Checkpoints[iii])
+			return static_cast<int>(iii);
+	}
+
+	if (Checkpoints.size() != other.Checkpoints.size())
+		return static_cast<int>(count);
+
+	return -1;
+}
+
+void GoldenTrajectory::Save(std::ostream& stream) const
+{
+	// The time step is written as hex-float so it round trips exactly
+	stream << "timestep " << std::hexfloat << TimeStep << std::defaultfloat << '\n';
+	stream << "interval " << Interval << '\n';
+	stream << "checkpoints " << Checkpoints.size() << '\n';
+
+	for (uint64_t hash : Checkpoints)
+		stream << std::hex << std::setw(16) << std::setfill('0') << hash << std::dec << '\n';
+}
+
+bool GoldenTrajectory::Load(std::istream& stream)
+{
+	std::string label, timeStep;
+	size_t count = 0;
+
+	if (!(stream >> label >> timeStep) || label != "timestep")
+		return false;
+
+	// operator>> does not reliably parse hex-float on all standard libraries, so use strtod
+	TimeStep = std::strtod(timeStep.c_str(), nullptr);
+
+	if (!(stream >> label >> Interval) || label != "interval")
+		return false;
+
+	if (!(stream >> label >> count) || label != "checkpoints")
+		return false;
+
+	Checkpoints.resize(count);
+	for (size_t iii = 0; iii < count; ++iii)
+	{
+		if (!(stream >> std::hex >> Checkpoints[iii] >> std::dec))
+			return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+// FNV-1a (64-bit) hash over raw bit patterns. Used to fingerprint the simulation state so that two
+// runs can be compared bit-for-bit without storing full trajectories.
+class StateHasher
+{
+public:
+	StateHasher() : m_hash(14695981039346656037ull) {}
+
+	void Add(const void* data, size_t bytes)
+	{
+		const unsigned char* p = static_cast<const unsigned char*>(data);
+		for (size_t iii = 0; iii < bytes; ++iii)
+		{
+			m_hash ^= p[iii];
+			m_hash *= 1099511628211ull;
+		}
+	}
+
+	void Add(float value) { uint32_t bits; std::memcpy(&bits, &value, sizeof(bits)); Add(&bits, sizeof(bits)); }
+	void Add(double value) { uint64_t bits; std::memcpy(&bits, &value, sizeof(bits)); Add(&bits, sizeof(bits)); }
+	void Add(uint32_t value) { Add(&value, sizeof(value)); }
+
+	uint64_t Value() const { return m_hash; }
+
+private:
+	uint64_t m_hash;
+};
+
+// A golden trajectory is the list of state hashes recorded every 'Interval' steps of a deterministic
+// run (fixed time step, seeded initial conditions). Re-running the same configuration after a change
+// and comparing against the golden file shows whether the change altered the results, and if so,
+// the first checkpoint where the trajectories diverged.
+class GoldenTrajectory
+{
+public:
+	GoldenTrajectory() : TimeStep(0.0), Interval(1) {}
+
+	// Run 'steps' steps of 'simulation' and record a hash every 'interval' steps (plus the initial
+	// state). TSimulation must provide Step(double) and uint64_t StateHash().
+	template<typename TSimulation>
+	static GoldenTrajectory Record(TSimulation& simulation, double timeStep, unsigned int steps, unsigned int interval);
+
+	// Returns the index of the first checkpoint that differs, or -1 if the trajectories match.
+	// Trajectories with different settings or lengths are reported as diverging at checkpoint 0
+	// or at the end of the shorter one respectively.
+	int FirstMismatch(const GoldenTrajectory& other) const;
+
+	void Save(std::ostream& stream) const;
+	bool Load(std::istream& stream);
+
+	double					TimeStep;
+	unsigned int			Interval;
+	std::vector<uint64_t>	Checkpoints;
+};
+
+template<typename TSimulation>
+GoldenTrajectory GoldenTrajectory::Record(TSimulation& simulation, double timeStep, unsigned int steps, unsigned int interval)
+{
+	GoldenTrajectory trajectory;
+	trajectory.TimeStep = timeStep;
+	trajectory.Interval = interval > 0 ? interval : 1;
+
+	trajectory.Checkpoints.push_back(simulation.StateHash());
+
+	for (unsigned int step = 1; step <= steps; ++step)
+	{
+		simulation.Step(timeStep);
+
+		if (step % trajectory.Interval == 0)
+			trajectory.Checkpoints.push_back(simulation.StateHash());
+	}
+
+	return trajectory;
+}
@@ -0,0 +1,97 @@
+#include "GpuFrameTimer.h"
+
+
+GpuFrameTimer::GpuFrameTimer(ID3D11Device* device, ID3D11DeviceContext* context) :
+	m_device(device),
+	m_context(context),
+	m_current(0),
+	m_frameOpen(false)
+{
+	CD3D11_QUERY_DESC disjointDesc(D3D11_QUERY_TIMESTAMP_DISJOINT);
+	CD3D11_QUERY_DESC timestampDesc(D3D11_QUERY_TIMESTAMP);
+
+	for (Frame& frame : m_frames)
+	{
+		ThrowIfFailed(m_device->CreateQuery(&disjointDesc, frame.Disjoint.ReleaseAndGetAddressOf()));
+
+		for (size_t iii = 0; iii < FrameTimeline::StageCount; ++iii)
+		{
+			ThrowIfFailed(m_device->CreateQuery(&timestampDesc, frame.Begin[iii].ReleaseAndGetAddressOf()));
+			ThrowIfFailed(m_device->CreateQuery(&timestampDesc, frame.End[iii].ReleaseAndGetAddressOf()));
+		}
+
+		frame.Timed.fill(false);
+		frame.InFlight = false;
+	}
+}
+
+void GpuFrameTimer::BeginFrame()
+{
+	Frame& frame = m_frames[m_current];
+
+	// The slot was last used FrameLatency frames ago - collect its results before reusing the queries
+	if (frame.InFlight)
+		ReadBack(frame);
+
+	frame.Timed.fill(false);
+	frame.InFlight = false;
+
+	m_context->Begin(frame.Disjoint.Get());
+	m_frameOpen = true;
+}
+
+void GpuFrameTimer::EndFrame()
+{
+	if (!m_frameOpen)
+		return;
+
+	Frame& frame = m_frames[m_current];
+	m_context->End(frame.Disjoint.Get());
+	frame.InFlight = true;
+
+	m_frameOpen = false;
+	m_current = (m_current + 1) % FrameLatency;
+}
+
+void GpuFrameTimer::BeginStage(FrameStage stage)
+{
+	if (m_frameOpen)
+		m_context->End(m_frames[m_current].Begin[static_cast<size_t>(stage)].Get());
+}
+
+void GpuFrameTimer::EndStage(FrameStage stage)
+{
+	if (!m_frameOpen)
+		return;
+
+	Frame& frame = m_frames[m_current];
+	size_t index = static_cast<size_t>(stage);
+
+	m_context->End(frame.End[index].Get());
+	frame.Timed[index] = true;
+}
+
+void GpuFrameTimer::ReadBack(Frame& frame)
+{
+	// S_FALSE = the GPU hasn't got there yet. Drop the frame instead of waiting for it
+	D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint;
+	if (m_context->GetData(frame.Disjoint.Get(), &disjoint, sizeof(disjoint), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+		return;
+
+	// The timestamps can't be compared if the GPU clock changed during the frame
+	if (disjoint.Disjoint || disjoint.Frequency == 0)
+		return;
+
+	for (size_t iii = 0; iii < FrameTimeline::StageCount; ++iii)
+	{
+		if (!frame.Timed[iii])
+			continue;
+
+		UINT64 begin, end;
+		if (m_context->GetData(frame.Begin[iii].Get(), &begin, sizeof(begin), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK ||
+			m_context->GetData(frame.End[iii].Get(), &end, sizeof(end), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+			continue;
+
+		FrameTimeline::RecordGpuStage(static_cast<FrameStage>(iii), static_cast<double>(end - begin) * 1000.0 / disjoint.Frequency);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+#include "pch.h"
+#include "DirectXHelper.h"
+
+#include "FrameTimeline.h"
+
+#include <array>
+
+
+/*
+	Measures how long the GPU spends on each stage of a frame with timestamp queries and records the
+	results in FrameTimeline.
+
+	Every frame is wrapped in a TIMESTAMP_DISJOINT query and each timed stage in a pair of TIMESTAMP queries.
+	The results aren't waited for - a frame's queries are read back (without flushing) when its slot in the
+	ring comes around again FrameLatency frames later. A frame whose queries still aren't done by then, or
+	whose timestamps are disjoint (the GPU clock changed), is dropped rather than stalling the CPU.
+
+	D2D draws on the same immediate context, so a stage that ends after ID2D1DeviceContext::EndDraw includes
+	the 2D work.
+*/
+class GpuFrameTimer
+{
+public:
+	// More than the frames the swap chain lets the CPU queue ahead, so results are normally ready
+	static constexpr size_t FrameLatency = 4;
+
+	GpuFrameTimer(ID3D11Device* device, ID3D11DeviceContext* context);
+
+	void BeginFrame();
+	void EndFrame();
+
+	void BeginStage(FrameStage stage);
+	void EndStage(FrameStage stage);
+
+private:
+	struct Frame
+	{
+		Microsoft::WRL::ComPtr<ID3D11Query>										Disjoint;
+		std::array<Microsoft::WRL::ComPtr<ID3D11Query>, FrameTimeline::StageCount>	Begin;
+		std::array<Microsoft::WRL::ComPtr<ID3D11Query>, FrameTimeline::StageCount>	End;
+		std::array<bool, FrameTimeline::StageCount>									Timed;
+		bool																	InFlight;
+	};
+
+	void ReadBack(Frame& frame);
+
+	Microsoft::WRL::ComPtr<ID3D11Device>			m_device;
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext>		m_context;
+
+	std::array<Frame, FrameLatency>					m_frames;
+	size_t											m_current;
+	bool											m_frameOpen;
+};
\ No newline at end of file
@@ -8,6 +8,54 @@ struct ModelViewProjectionConstantBuffer
     DirectX::XMFLOAT4X4 model;
     DirectX::XMFLOAT4X4 modelViewProjection;
     DirectX::XMFLOAT4X4 inverseTransposeModel;
+    uint32_t            materialIndex;      // Index into the MaterialTable
+    uint32_t            outline;            // Selection outline ID (see SelectionOutline)
+    uint32_t            padding[2];
+};
+
+// Used by InstancedPhongVertexShader - the per-atom data lives in a structured buffer (see AtomInstancePacker.h)
+struct InstancedViewProjectionConstantBuffer
+{
+    DirectX::XMFLOAT4X4 viewProjection;
+    uint32_t            firstInstance;      // SV_InstanceID always starts at 0, so pass in the batch offset
+    uint32_t            padding[3];
+};
+
+// Used by InstancedArrowVertexShader - the per-arrow data lives in a structured buffer (see VelocityArrowPacker.h)
+struct InstancedArrowConstantBuffer
+{
+    DirectX::XMFLOAT4X4 viewProjection;
+    uint32_t            firstInstance;      // SV_InstanceID always starts at 0, so pass in the batch offset
+    uint32_t            part;               // 0 = shaft (arrow cylinder mesh), 1 = head (arrow cone mesh)
+    float               width;              // Radius of the shaft (see ArrowMesh::Width)
+    uint32_t            materialIndex;      // Index into the MaterialTable
+};
+
+// Used by ImpostorVertexShader (b0) and ImpostorPixelShader (b2)
+struct ImpostorConstantBuffer
+{
+    DirectX::XMFLOAT4X4 viewProjection;
+    DirectX::XMFLOAT3   cameraPosition;
+    uint32_t            firstInstance;
+};
+
+// Selection outline IDs the scene writes to the outline ID target (SV_TARGET1) when the screen space
+// outline is used (see OutlineMode). Where outlines overlap the highest ID wins
+namespace SelectionOutline
+{
+    constexpr uint32_t NONE = 0;
+    constexpr uint32_t HOVERED = 1;
+    constexpr uint32_t PRIMARY_SELECTED = 2;
+    constexpr uint32_t GROUP_SELECTED = 3;
+    constexpr uint32_t COUNT = 4;
+}
+
+// Used by SelectionOutlinePixelShader (b0)
+struct SelectionOutlineConstantBuffer
+{
+    uint32_t            materialIndex[SelectionOutline::COUNT];     // Outline material for each ID (a uint4 in HLSL)
+    int32_t             radius;                                     // Outline width in pixels
+    uint32_t            padding[3];
 };
 
 struct VertexPositionNormal
@@ -16,6 +64,7 @@ struct VertexPositionNormal
     DirectX::XMFLOAT3 normal;
 };
 
+// One entry of the MaterialTable structured buffer
 struct _PhongMaterial
 {
     _PhongMaterial()
@@ -43,16 +92,6 @@ struct _PhongMaterial
     //----------------------------------- (16 byte boundary)
 }; // Total:                                80 bytes (5 * 16)
 
-struct PhongMaterialProperties
-{
-    _PhongMaterial   Material;
-};
-
-struct SolidMaterialProperties
-{
-    DirectX::XMFLOAT4   Color;
-};
-
 enum LightType
 {
     DirectionalLight = 0,
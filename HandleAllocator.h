@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Hands out small integer handles for long lived objects (atoms, bonds). Released handles are reused, so
+// the handles in use stay dense and can index bitsets and lookup tables directly (see SelectionSet).
+class HandleAllocator
+{
+public:
+	uint32_t Allocate()
+	{
+		if (m_free.empty())
+			return m_next++;
+
+		uint32_t handle = m_free.back();
+		m_free.pop_back();
+		return handle;
+	}
+
+	void Release(uint32_t handle) { m_free.push_back(handle); }
+
+	// One past the largest handle ever handed out
+	uint32_t Capacity() const { return m_next; }
+
+private:
+	std::vector<uint32_t>	m_free;
+	uint32_t				m_next = 0;
+};
\ No newline at end of file
@@ -0,0 +1,359 @@
+#include "HardSphereDynamics.h"
+#include "Collisions.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+
+using Collisions::Component;
+
+namespace
+{
+	double Dot(const Float3& a, const Float3& b)
+	{
+		return static_cast<double>(a.x) * b.x + static_cast<double>(a.y) * b.y + static_cast<double>(a.z) * b.z;
+	}
+
+	// Predicted impact used by the continuous collision detection step
+	struct CollisionEvent
+	{
+		// Atom2 holds one of these (negative) values when the event is a wall impact
+		static constexpr int WallX = -1;
+		static constexpr int WallY = -2;
+		static constexpr int WallZ = -3;
+
+		double Time;
+		int Atom1;
+		int Atom2;
+		unsigned int Count1;	// Collision count of each atom at the time of prediction
+		unsigned int Count2;
+
+		bool IsWall() const { return Atom2 < 0; }
+		bool operator>(const CollisionEvent& rhs) const { return Time > rhs.Time; }
+	};
+}
+
+
+HardSphereDynamics::HardSphereDynamics() :
+	m_updateMode(UpdateMode::CONTINUOUS),
+	m_time(0.0),
+	m_eventEngineNeedsReset(true)
+{
+}
+
+void HardSphereDynamics::Step(double timeDelta)
+{
+	// Observables are accumulated as a by-product of the integrate and collision passes
+	// so we never need a separate sweep over the spheres. All reductions run in sphere order
+	// so results are reproducible bit-for-bit.
+	SimulationObservables observables;
+
+	switch (m_updateMode)
+	{
+	case UpdateMode::DISCRETE:		StepDiscrete(timeDelta, observables); break;
+	case UpdateMode::CONTINUOUS:	StepContinuous(timeDelta, observables); break;
+	case UpdateMode::EVENT_DRIVEN:	StepEventDriven(timeDelta, observables); break;
+	}
+
+	m_time += timeDelta;
+
+	// Hard-sphere contacts carry no potential energy, so PotentialEnergy stays 0 until bonded/pair
+	// potentials are added to the collision pass
+	const size_t count = m_state.Count();
+	observables.Time = m_time;
+	observables.AtomCount = static_cast<unsigned int>(count);
+	observables.Temperature = count > 0 ? (2.0 * observables.KineticEnergy) / (3.0 * count) : 0.0;
+
+	m_observables = observables;
+}
+
+void HardSphereDynamics::StepDiscrete(double timeDelta, SimulationObservables& observables)
+{
+	std::vector<Float3>& positions = m_state.Positions;
+	std::vector<Float3>& velocities = m_state.Velocities;
+	const std::vector<float>& radii = m_state.Radii;
+	const std::vector<float>& masses = m_state.Masses;
+	const size_t count = m_state.Count();
+
+	const float halfExtents[3] = { m_state.BoxDimensions.x / 2.0f, m_state.BoxDimensions.y / 2.0f, m_state.BoxDimensions.z / 2.0f };
+
+	double mass;
+
+	for (size_t iii = 0; iii < count; ++iii)
+	{
+		Float3& p = positions[iii];
+		Float3& v = velocities[iii];
+
+		// Move the position
+		p.x += static_cast<float>(timeDelta * v.x);
+		p.y += static_cast<float>(timeDelta * v.y);
+		p.z += static_cast<float>(timeDelta * v.z);
+
+		// Bounce off the simulation wall - We can't just flip the velocity because when an atom is small enough and the velocity
+		// large enough, it is possible for the center of the atom to find itself outside the box
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			// Positive wall
+			float delta = (Component(p, axis) + radii[iii]) - halfExtents[axis];
+			if (delta > 0)
+			{
+				Component(p, axis) -= delta;
+				Component(v, axis) *= -1;
+			}
+			else
+			{
+				// Negative wall
+				delta = (Component(p, axis) - radii[iii]) + halfExtents[axis];
+				if (delta < 0)
+				{
+					Component(p, axis) -= delta;
+					Component(v, axis) *= -1;
+				}
+			}
+		}
+
+		// Accumulate kinetic energy and momentum using the post-integration velocity
+		mass = masses[iii];
+		observables.KineticEnergy += 0.5 * mass * Dot(v, v);
+		observables.MomentumX += mass * v.x;
+		observables.MomentumY += mass * v.y;
+		observables.MomentumZ += mass * v.z;
+	}
+
+	// The update procedure above only updates position and takes account of the simulation wall
+	// Here, we need to make updates to account for elastic collisions with other atoms
+	// This is temporary however, because we will need to move past elastic collisions to simulate
+	// real physics
+	// See here for math explanation: https://exploratoria.github.io/exhibits/mechanics/elastic-collisions-in-3d/
+
+	Float3 d; // distance between atoms
+	float mag;  // magnitude of the distance vector
+	Float3 n; // normal vector between balls
+	Float3 vrel; // relative velocity between the atoms
+	Float3 vnorm; // relative velocity along the normal direction
+	float vreldotnorm; // the dot product between vrel and vnorm
+	Float3 v1, v2; // velocity vectors pre-collision
+	Float3 newV1, newV2; // new velocity vectors post-collision
+	double m1, m2; // masses of the two atoms (only needed to correct the observables)
+	for (size_t iii = 0; iii < count; ++iii)
+	{
+		for (size_t jjj = iii + 1; jjj < count; ++jjj)
+		{
+			// check distance between the two atoms
+			d.x = positions[iii].x - positions[jjj].x;
+			d.y = positions[iii].y - positions[jjj].y;
+			d.z = positions[iii].z - positions[jjj].z;
+
+			mag = std::sqrt(d.x * d.x + d.y * d.y + d.z * d.z);
+			if (mag < radii[iii] + radii[jjj])
+			{
+				// compute a normalized normal vector between the atoms
+				n.x = d.x / mag;
+				n.y = d.y / mag;
+				n.z = d.z / mag;
+
+				// compute the relative velocity between the atoms
+				v1 = velocities[iii];
+				v2 = velocities[jjj];
+				vrel.x = v1.x - v2.x;
+				vrel.y = v1.y - v2.y;
+				vrel.z = v1.z - v2.z;
+
+				// compute the relative velocity along the normal direction;
+				vreldotnorm = vrel.x * n.x + vrel.y * n.y + vrel.z * n.z;
+				vnorm.x = vreldotnorm * n.x;
+				vnorm.y = vreldotnorm * n.y;
+				vnorm.z = vreldotnorm * n.z;
+
+				// exchange normal velocities
+				newV1.x = v1.x - vnorm.x;
+				newV1.y = v1.y - vnorm.y;
+				newV1.z = v1.z - vnorm.z;
+				velocities[iii] = newV1;
+
+				newV2.x = v2.x + vnorm.x;
+				newV2.y = v2.y + vnorm.y;
+				newV2.z = v2.z + vnorm.z;
+				velocities[jjj] = newV2;
+
+				// Correct the observables for the velocity change. The exchange above assumes identical
+				// masses, so for unlike atoms this is exactly where any energy/momentum drift shows up
+				m1 = masses[iii];
+				m2 = masses[jjj];
+				observables.KineticEnergy += 0.5 * m1 * (Dot(newV1, newV1) - Dot(v1, v1)) + 0.5 * m2 * (Dot(newV2, newV2) - Dot(v2, v2));
+				observables.MomentumX += m2 * vnorm.x - m1 * vnorm.x;
+				observables.MomentumY += m2 * vnorm.y - m1 * vnorm.y;
+				observables.MomentumZ += m2 * vnorm.z - m1 * vnorm.z;
+			}
+		}
+	}
+}
+
+void HardSphereDynamics::StepContinuous(double timeDelta, SimulationObservables& observables)
+{
+	// Continuous collision detection. Rather than moving every atom the full step and then testing for
+	// overlap (which misses collisions whenever timeDelta * velocity exceeds the atom diameter), predict
+	// the time of impact for every pair and every wall, then process the impacts in time order. After an
+	// impact, only the predictions for the atom(s) whose velocity changed are recomputed.
+	const size_t count = m_state.Count();
+	if (count == 0)
+		return;
+
+	std::vector<Float3>& positions = m_state.Positions;
+	std::vector<Float3>& velocities = m_state.Velocities;
+	const std::vector<float>& radii = m_state.Radii;
+	const std::vector<float>& masses = m_state.Masses;
+	std::vector<double> localTimes(count, 0.0);				// Time within the step at which positions[i] is valid
+	std::vector<unsigned int> collisionCounts(count, 0);	// Incremented on every impact so stale events can be skipped
+
+	const float halfExtents[3] = { m_state.BoxDimensions.x / 2.0f, m_state.BoxDimensions.y / 2.0f, m_state.BoxDimensions.z / 2.0f };
+
+	auto positionAt = [&](size_t index, double time) -> Float3
+	{
+		float dt = static_cast<float>(time - localTimes[index]);
+		return Float3{
+			positions[index].x + dt * velocities[index].x,
+			positions[index].y + dt * velocities[index].y,
+			positions[index].z + dt * velocities[index].z
+		};
+	};
+
+	std::priority_queue<CollisionEvent, std::vector<CollisionEvent>, std::greater<CollisionEvent>> events;
+
+	auto predictWalls = [&](size_t index, double now)
+	{
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			double t = now + Collisions::SphereWallTimeOfImpact(
+				Component(positions[index], axis), Component(velocities[index], axis), radii[index], halfExtents[axis]);
+			if (t <= timeDelta)
+				events.push({ t, static_cast<int>(index), CollisionEvent::WallX - axis, collisionCounts[index], 0 });
+		}
+	};
+
+	auto predictPair = [&](size_t index1, size_t index2, double now)
+	{
+		double t = now + Collisions::SphereSphereTimeOfImpact(
+			positionAt(index1, now), velocities[index1], radii[index1],
+			positionAt(index2, now), velocities[index2], radii[index2]);
+
+		if (t <= timeDelta)
+			events.push({ t, static_cast<int>(index1), static_cast<int>(index2), collisionCounts[index1], collisionCounts[index2] });
+	};
+
+	// Initial predictions - the pair loop is the same O(N^2) sweep the discrete overlap test performs
+	for (size_t iii = 0; iii < count; ++iii)
+	{
+		predictWalls(iii, 0.0);
+		for (size_t jjj = iii + 1; jjj < count; ++jjj)
+			predictPair(iii, jjj, 0.0);
+	}
+
+	// Guard against pathological configurations (ex. an atom wedged between two others) generating an
+	// unbounded number of impacts within a single step
+	size_t maxEvents = 64 * count + 1024;
+
+	auto isStale = [&](const CollisionEvent& e)
+	{
+		return e.Count1 != collisionCounts[e.Atom1] || (!e.IsWall() && e.Count2 != collisionCounts[e.Atom2]);
+	};
+
+	while (!events.empty())
+	{
+		CollisionEvent e = events.top();
+
+		// Skip events that were predicted before one of the atoms changed velocity
+		if (isStale(e))
+		{
+			events.pop();
+			continue;
+		}
+
+		if (maxEvents == 0)
+			break;
+
+		events.pop();
+		--maxEvents;
+
+		// Advance the atom(s) to the time of impact
+		positions[e.Atom1] = positionAt(e.Atom1, e.Time);
+		localTimes[e.Atom1] = e.Time;
+		++collisionCounts[e.Atom1];
+
+		if (e.IsWall())
+		{
+			// Reflect the velocity component normal to the wall and make sure the atom is not outside the box
+			int axis = CollisionEvent::WallX - e.Atom2;
+			float limit = std::max(halfExtents[axis] - radii[e.Atom1], 0.0f);
+			Component(positions[e.Atom1], axis) = std::clamp(Component(positions[e.Atom1], axis), -limit, limit);
+			Component(velocities[e.Atom1], axis) *= -1;
+		}
+		else
+		{
+			positions[e.Atom2] = positionAt(e.Atom2, e.Time);
+			localTimes[e.Atom2] = e.Time;
+			++collisionCounts[e.Atom2];
+
+			Collisions::ResolveSphereSphere(positions[e.Atom1], velocities[e.Atom1], masses[e.Atom1],
+											positions[e.Atom2], velocities[e.Atom2], masses[e.Atom2]);
+		}
+
+		// Re-predict the future of the atom(s) involved
+		predictWalls(e.Atom1, e.Time);
+		for (size_t jjj = 0; jjj < count; ++jjj)
+		{
+			if (jjj != static_cast<size_t>(e.Atom1))
+				predictPair(e.Atom1, jjj, e.Time);
+		}
+
+		if (!e.IsWall())
+		{
+			predictWalls(e.Atom2, e.Time);
+			for (size_t jjj = 0; jjj < count; ++jjj)
+			{
+				if (jjj != static_cast<size_t>(e.Atom1) && jjj != static_cast<size_t>(e.Atom2))
+					predictPair(e.Atom2, jjj, e.Time);
+			}
+		}
+	}
+
+	// Out of budget - the impacts still pending are not resolved this step. Overlapping pairs that are
+	// still approaching are predicted to collide immediately at the start of the next step, but an impact
+	// can also be missed entirely, so the count is reported rather than silently dropped
+	while (!events.empty())
+	{
+		if (!isStale(events.top()))
+			++observables.DeferredCollisions;
+		events.pop();
+	}
+
+	// Move every atom to the end of the step and accumulate the observables
+	Float3 v;
+	double mass;
+	for (size_t iii = 0; iii < count; ++iii)
+	{
+		positions[iii] = positionAt(iii, timeDelta);
+
+		v = velocities[iii];
+		mass = masses[iii];
+		observables.KineticEnergy += 0.5 * mass * Dot(v, v);
+		observables.MomentumX += mass * v.x;
+		observables.MomentumY += mass * v.y;
+		observables.MomentumZ += mass * v.z;
+	}
+}
+
+void HardSphereDynamics::StepEventDriven(double timeDelta, SimulationObservables& observables)
+{
+	// The engine keeps its own copy of the sphere state and event queue between steps. Rebuild it
+	// whenever the set of spheres may have changed underneath it
+	if (m_eventEngineNeedsReset || m_eventEngine.AtomCount() != m_state.Count())
+	{
+		m_eventEngine.Initialize(m_state);
+		m_eventEngineNeedsReset = false;
+	}
+
+	m_eventEngine.Advance(timeDelta);
+	m_eventEngine.WriteBack(m_state, observables);
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "EventDrivenEngine.h"
+#include "HardSphereState.h"
+#include "SimulationObservables.h"
+
+#include <cstdint>
+
+// How Step advances the spheres
+enum class UpdateMode
+{
+	DISCRETE,		// Move every atom, then resolve any overlapping pairs (can tunnel at large time steps)
+	CONTINUOUS,		// Swept-sphere continuous collision detection with time-of-impact ordering
+	EVENT_DRIVEN	// Exact event-driven hard-sphere dynamics (see EventDrivenEngine)
+};
+
+// The physics behind Simulation::Step. Advances a HardSphereState by exact time deltas in one of the
+// UpdateModes and accumulates the observables as a by-product of the integrate and collision passes.
+//
+// Nothing here depends on Atom, the renderer or the window, so the same code runs headless - it is what
+// the golden trajectory runner records and checks (see tests/GoldenTrajectoryRunner.cpp). It also
+// satisfies the TSimulation interface of GoldenTrajectory::Record.
+class HardSphereDynamics
+{
+public:
+	HardSphereDynamics();
+
+	// The spheres being simulated. Call Invalidate after changing them outside of Step so the event-driven
+	// engine starts over from the new state
+	HardSphereState& State() { return m_state; }
+	const HardSphereState& State() const { return m_state; }
+	void Invalidate() { m_eventEngineNeedsReset = true; }
+
+	UpdateMode GetUpdateMode() const { return m_updateMode; }
+	void SetUpdateMode(UpdateMode mode) { m_updateMode = mode; m_eventEngineNeedsReset = true; }
+
+	// Advance every sphere by exactly timeDelta
+	void Step(double timeDelta);
+
+	uint64_t StateHash() const { return m_state.Hash(); }
+
+	// Observables from the most recent step, and the total simulated time (sum of every step's timeDelta)
+	const SimulationObservables& Observables() const { return m_observables; }
+	double Time() const { return m_time; }
+
+private:
+	// Update steps - each advances every sphere by timeDelta and accumulates the kinetic energy/momentum
+	void StepDiscrete(double timeDelta, SimulationObservables& observables);
+	void StepContinuous(double timeDelta, SimulationObservables& observables);
+	void StepEventDriven(double timeDelta, SimulationObservables& observables);
+
+	HardSphereState			m_state;
+	UpdateMode				m_updateMode;
+	double					m_time;
+	SimulationObservables	m_observables;
+
+	// Event-driven engine state persists between steps (only used in UpdateMode::EVENT_DRIVEN)
+	EventDrivenEngine		m_eventEngine;
+	bool					m_eventEngineNeedsReset;
+};
\ No newline at end of file
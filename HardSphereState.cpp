@@ -0,0 +1,114 @@
+#include "HardSphereState.h"
+#include "Constants.h"
+#include "Enums.h"
+#include "GoldenTrajectory.h"
+
+#include <random>
+
+
+void HardSphereState::Clear()
+{
+	Resize(0);
+}
+
+void HardSphereState::Resize(size_t count)
+{
+	Elements.resize(count);
+	Positions.resize(count);
+	Velocities.resize(count);
+	Radii.resize(count);
+	Masses.resize(count);
+}
+
+size_t HardSphereState::Insert(uint32_t element, Float3 position, Float3 velocity, float radius, float mass)
+{
+	size_t index = 0;
+	while (index < Count() && Elements[index] < element)
+		++index;
+
+	Elements.insert(Elements.begin() + index, element);
+	Positions.insert(Positions.begin() + index, position);
+	Velocities.insert(Velocities.begin() + index, velocity);
+	Radii.insert(Radii.begin() + index, radius);
+	Masses.insert(Masses.begin() + index, mass);
+
+	return index;
+}
+
+void HardSphereState::AddRandom(unsigned int count, unsigned int seed, float maxSpeed,
+								const std::function<void(uint32_t element, Float3 position, Float3 velocity)>& added)
+{
+	// std::mt19937 produces the same sequence on every platform, but the std distributions do not,
+	// so convert the raw 32-bit output to floats manually
+	std::mt19937 rng(seed);
+	auto uniform = [&rng](float min, float max) -> float
+	{
+		return min + (max - min) * static_cast<float>(rng() >> 8) * (1.0f / 16777216.0f);
+	};
+
+	// Try a bounded number of times to place each sphere without overlapping an existing one
+	const unsigned int maxAttempts = 100;
+
+	for (unsigned int iii = 0; iii < count; ++iii)
+	{
+		uint32_t element = Element::HYDROGEN + rng() % Element::NEON;
+		float radius = Constants::AtomicRadii[element];
+
+		Float3 position;
+		bool placed = false;
+		for (unsigned int attempt = 0; attempt < maxAttempts && !placed; ++attempt)
+		{
+			position.x = uniform(-BoxDimensions.x / 2.0f + radius, BoxDimensions.x / 2.0f - radius);
+			position.y = uniform(-BoxDimensions.y / 2.0f + radius, BoxDimensions.y / 2.0f - radius);
+			position.z = uniform(-BoxDimensions.z / 2.0f + radius, BoxDimensions.z / 2.0f - radius);
+
+			placed = true;
+			for (size_t jjj = 0; jjj < Count(); ++jjj)
+			{
+				float dx = Positions[jjj].x - position.x;
+				float dy = Positions[jjj].y - position.y;
+				float dz = Positions[jjj].z - position.z;
+
+				float minDistance = Radii[jjj] + radius;
+				if (dx * dx + dy * dy + dz * dz < minDistance * minDistance)
+				{
+					placed = false;
+					break;
+				}
+			}
+		}
+
+		if (!placed)
+			continue;
+
+		Float3 velocity = { uniform(-maxSpeed, maxSpeed), uniform(-maxSpeed, maxSpeed), uniform(-maxSpeed, maxSpeed) };
+
+		Insert(element, position, velocity, radius, static_cast<float>(element + Constants::DefaultNeutronCounts[element]));
+
+		if (added)
+			added(element, position, velocity);
+	}
+}
+
+uint64_t HardSphereState::Hash() const
+{
+	StateHasher hasher;
+
+	hasher.Add(static_cast<uint32_t>(Count()));
+	hasher.Add(BoxDimensions.x);
+	hasher.Add(BoxDimensions.y);
+	hasher.Add(BoxDimensions.z);
+
+	for (size_t iii = 0; iii < Count(); ++iii)
+	{
+		hasher.Add(Elements[iii]);
+		hasher.Add(Positions[iii].x);
+		hasher.Add(Positions[iii].y);
+		hasher.Add(Positions[iii].z);
+		hasher.Add(Velocities[iii].x);
+		hasher.Add(Velocities[iii].y);
+		hasher.Add(Velocities[iii].z);
+	}
+
+	return hasher.Value();
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Three floats with the same layout as DirectX::XMFLOAT3, for the physics code that has to build
+// without DirectXMath
+struct Float3
+{
+	float x;
+	float y;
+	float z;
+};
+
+// The state the hard-sphere physics works on: every sphere as flat arrays (in atom order) plus the box.
+// Simulation copies its atoms in before each step and the results back out (see HardSphereDynamics),
+// so the physics never touches Atom objects and can run headless.
+struct HardSphereState
+{
+	HardSphereState() : BoxDimensions{ 2.0f, 2.0f, 2.0f } {}
+
+	size_t Count() const { return Positions.size(); }
+
+	void Clear();
+	void Resize(size_t count);
+
+	// Insert a sphere in front of the first sphere with the same or a higher element - the order
+	// Simulation::AddNewAtom keeps its atoms in. Returns the index of the new sphere
+	size_t Insert(uint32_t element, Float3 position, Float3 velocity, float radius, float mass);
+
+	// Insert 'count' spheres with random elements, positions and velocities generated from 'seed', each
+	// with the element's radius and default mass and placed so it doesn't overlap any other sphere.
+	// 'added' (if set) is called with each sphere that was placed. The same seed always produces the
+	// same spheres on every platform.
+	void AddRandom(unsigned int count, unsigned int seed, float maxSpeed,
+				   const std::function<void(uint32_t element, Float3 position, Float3 velocity)>& added = nullptr);
+
+	// FNV-1a hash of the sphere count, the box and each sphere's element, position and velocity bits in
+	// order (see StateHasher). Two states hash the same only if the runs that produced them agree bit-for-bit
+	uint64_t Hash() const;
+
+	std::vector<uint32_t>	Elements;
+	std::vector<Float3>		Positions;
+	std::vector<Float3>		Velocities;
+	std::vector<float>		Radii;
+	std::vector<float>		Masses;
+
+	Float3					BoxDimensions;	// Full size of the box, centered on the origin (ex. if x = 10, then x-axis = [-5, 5])
+};
\ No newline at end of file
@@ -0,0 +1,67 @@
+#include "PhongLighting.hlsli"
+
+// Ray traces the sphere for each pixel of the quad produced by ImpostorVertexShader. Pixels that miss
+// the sphere are discarded, and the depth of the hit point is written so impostors intersect correctly
+// with each other and with the mesh geometry (bonds, arrows, outlines).
+
+// Must match ImpostorConstantBuffer in HLSLStructures.h
+cbuffer ImpostorConstantBuffer : register(b2)
+{
+	matrix viewProjection;
+	float3 cameraPosition;
+	uint firstInstance;
+};
+
+struct ImpostorPixelShaderInput
+{
+	float4 position : SV_POSITION;
+	float3 positionWS : POS_WS;
+	nointerpolation float4 sphere : SPHERE;		// xyz = center, w = radius (world space)
+	nointerpolation uint materialIndex : MATERIAL;
+	nointerpolation uint outline : OUTLINE;
+};
+
+struct ImpostorPixelShaderOutput
+{
+	float4 color : SV_TARGET0;
+	uint outline : SV_TARGET1;		// Selection outline ID (see PhongPixelShader)
+	float depth : SV_DEPTH;
+};
+
+
+ImpostorPixelShaderOutput main(ImpostorPixelShaderInput input)
+{
+	// Intersect the ray from the camera through this pixel with the sphere:
+	//     |origin + t * direction - center|^2 = radius^2
+	float3 direction = normalize(input.positionWS - cameraPosition);
+	float3 originToCenter = input.sphere.xyz - cameraPosition;
+
+	float b = dot(direction, originToCenter);
+	float c = dot(originToCenter, originToCenter) - input.sphere.w * input.sphere.w;
+	float discriminant = b * b - c;
+
+	if (discriminant < 0.0f)
+		discard;
+
+	// Nearest hit
+	float t = b - sqrt(discriminant);
+	float4 hit = float4(cameraPosition + t * direction, 1.0f);
+	float3 normal = (hit.xyz - input.sphere.xyz) / input.sphere.w;
+
+	_MyMaterial material = Materials[input.materialIndex];
+	LightingResult lit = ComputeLighting(EyePosition, hit, normal, material.SpecularPower);
+
+	float4 emissive = material.Emissive;
+	float4 ambient = material.Ambient * GlobalAmbient;
+	float4 diffuse = material.Diffuse * lit.Diffuse;
+	float4 specular = material.Specular * lit.Specular;
+
+	float4 clipPosition = mul(viewProjection, hit);
+
+	ImpostorPixelShaderOutput output;
+	output.color = emissive + ambient + diffuse + specular;
+	output.outline = input.outline;
+	output.depth = clipPosition.z / clipPosition.w;
+
+	return output;
+}
\ No newline at end of file
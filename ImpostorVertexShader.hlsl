@@ -0,0 +1,65 @@
+// Sphere impostors: every atom is drawn as a single camera facing quad (4 vertex triangle strip,
+// no vertex buffer) and ImpostorPixelShader ray traces the sphere inside it. The per-atom data is
+// the same structured buffer used by InstancedPhongVertexShader.
+
+// Must match AtomInstance in AtomInstancePacker.h
+struct AtomInstance
+{
+	float3 position;
+	float radius;
+	uint materialIndex;
+	uint outline;
+	uint2 padding;
+};
+
+StructuredBuffer<AtomInstance> Instances : register(t0);
+
+// Must match ImpostorConstantBuffer in HLSLStructures.h
+cbuffer ImpostorConstantBuffer : register(b0)
+{
+	matrix viewProjection;
+	float3 cameraPosition;
+	uint firstInstance;
+};
+
+// Must match ImpostorPixelShaderInput in ImpostorPixelShader
+struct ImpostorPixelShaderInput
+{
+	float4 position : SV_POSITION;
+	float3 positionWS : POS_WS;
+	nointerpolation float4 sphere : SPHERE;		// xyz = center, w = radius (world space)
+	nointerpolation uint materialIndex : MATERIAL;
+	nointerpolation uint outline : OUTLINE;
+};
+
+
+ImpostorPixelShaderInput main(uint vertexID : SV_VertexID, uint instanceID : SV_InstanceID)
+{
+	AtomInstance instance = Instances[firstInstance + instanceID];
+
+	// Quad corner in [-1, 1] for vertex 0..3 of the triangle strip
+	float2 corner = float2((vertexID & 1) ? 1.0f : -1.0f, (vertexID & 2) ? 1.0f : -1.0f);
+
+	// Build the quad in the plane through the sphere center perpendicular to the ray from the camera.
+	// The silhouette of the sphere is the cross section of the cone from the camera that just touches
+	// the sphere, which in that plane is a circle of radius r * d / sqrt(d^2 - r^2)
+	float3 toCenter = instance.position - cameraPosition;
+	float distance = length(toCenter);
+	float3 forward = toCenter / distance;
+
+	float3 up = abs(forward.y) < 0.99f ? float3(0.0f, 1.0f, 0.0f) : float3(1.0f, 0.0f, 0.0f);
+	float3 right = normalize(cross(up, forward));
+	up = cross(forward, right);
+
+	float r = instance.radius;
+	float halfSize = distance > r ? r * distance / sqrt(distance * distance - r * r) : 0.0f;	// Camera inside the sphere -> draw nothing
+
+	ImpostorPixelShaderInput output;
+	output.positionWS = instance.position + halfSize * (corner.x * right + corner.y * up);
+	output.position = mul(viewProjection, float4(output.positionWS, 1.0f));
+	output.sphere = float4(instance.position, r);
+	output.materialIndex = instance.materialIndex;
+	output.outline = instance.outline;
+
+	return output;
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+// Instanced velocity arrows: every arrow is drawn with two instanced draws (the shaft with the arrow cylinder
+// mesh and the head with the arrow cone mesh) and the model matrix of each part is built here from the
+// position, radius and velocity of the atom (see VelocityArrowPacker.h).
+
+// Must match VelocityArrowInstance in VelocityArrowPacker.h
+struct VelocityArrowInstance
+{
+	float3 position;
+	float radius;
+	float3 velocity;
+	uint padding;
+};
+
+StructuredBuffer<VelocityArrowInstance> Instances : register(t0);
+
+// Must match InstancedArrowConstantBuffer in HLSLStructures.h
+cbuffer InstancedArrowConstantBuffer : register(b0)
+{
+	matrix viewProjection;
+	uint firstInstance;
+	uint part;				// 0 = shaft (cylinder mesh), 1 = head (cone mesh)
+	float width;			// Radius of the shaft - the head is twice as wide
+	uint materialIndex;
+};
+
+struct VertexShaderInput
+{
+	float3 position : POSITION;
+	float3 normal : NORMAL;
+};
+
+// Must match PixelShaderInput in PhongPixelShader
+struct PixelShaderInput
+{
+	float4 position : SV_POSITION;
+	float4 positionWS : POS_WS;
+	float3 normalWS : NORM_WS;
+	nointerpolation uint materialIndex : MATERIAL;
+	nointerpolation uint outline : OUTLINE;
+};
+
+// Length of the head along the velocity - must match VelocityArrowPacker::HeadLength
+static const float HeadLength = 0.1f;
+
+// Rotation of pi around the axis halfway between +z and the arrow direction (see InstancedCylinderVertexShader)
+float3 RotateZToDirection(float3 v, float3 direction)
+{
+	float3 halfway = float3(0.0f, 0.0f, 1.0f) + direction;
+	float halfwayLengthSquared = dot(halfway, halfway);
+
+	// Arrow pointing straight down -z: rotate around the x-axis instead
+	halfway = halfwayLengthSquared > 1e-12f ? halfway * rsqrt(halfwayLengthSquared) : float3(1.0f, 0.0f, 0.0f);
+
+	return 2.0f * dot(halfway, v) * halfway - v;
+}
+
+
+PixelShaderInput main(VertexShaderInput input, uint instanceID : SV_InstanceID)
+{
+	VelocityArrowInstance instance = Instances[firstInstance + instanceID];
+
+	float speed = length(instance.velocity);
+	float3 direction = instance.velocity / speed;
+	float shaftLength = speed / 100.0f;
+
+	// The arrow starts on the surface of the atom (a little inside it, otherwise there is a small gap)
+	float3 surfacePosition = instance.position + direction * (instance.radius - 0.005f);
+
+	// The shaft is the unit cylinder stretched to the length of the arrow. The head is the unit cone, twice
+	// as wide as the shaft and moved along z to the end of it
+	float3 scale = part == 0 ? float3(width, width, shaftLength) : float3(2.0f * width, 2.0f * width, HeadLength);
+	float offset = part == 0 ? 0.0f : shaftLength;
+
+	float3 local = input.position * scale + float3(0.0f, 0.0f, offset);
+
+	PixelShaderInput output;
+	output.positionWS = float4(RotateZToDirection(local, direction) + surfacePosition, 1.0f);	// World space position
+	output.position = mul(viewProjection, output.positionWS);									// Screen position
+
+	// Inverse transpose of rotation * scale = rotation * inverse scale (the translation doesn't affect normals)
+	output.normalWS = RotateZToDirection(input.normal / scale, direction);
+	output.materialIndex = materialIndex;
+	output.outline = 0;
+
+	return output;
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+// Instanced version of PhongVertexShader for drawing many bond cylinders with a single draw call.
+// The per-cylinder data comes from a structured buffer (see BondGeometry.h).
+
+// Must match BondCylinderInstance in BondGeometry.h
+struct BondCylinderInstance
+{
+	float3 start;
+	float radius;
+	float3 axis;
+	uint materialAndOutline;	// Bits 0-23: material index, bits 24-31: selection outline ID
+};
+
+StructuredBuffer<BondCylinderInstance> Instances : register(t0);
+
+// SV_InstanceID always starts at 0, even when StartInstanceLocation is not 0, so the offset of the
+// current batch in the instance buffer is passed in separately
+cbuffer InstancedViewProjectionConstantBuffer : register(b0)
+{
+	matrix viewProjection;
+	uint firstInstance;
+	uint3 padding;
+};
+
+struct VertexShaderInput
+{
+	float3 position : POSITION;
+	float3 normal : NORMAL;
+};
+
+// Must match PixelShaderInput in PhongPixelShader
+struct PixelShaderInput
+{
+	float4 position : SV_POSITION;
+	float4 positionWS : POS_WS;
+	float3 normalWS : NORM_WS;
+	nointerpolation uint materialIndex : MATERIAL;
+	nointerpolation uint outline : OUTLINE;
+};
+
+// Rotation of pi around the axis halfway between +z and the cylinder direction. This maps +z onto the
+// cylinder direction and is the same rotation CylinderMesh::ComputeRotationMatrix uses.
+float3 RotateZToDirection(float3 v, float3 direction)
+{
+	float3 halfway = float3(0.0f, 0.0f, 1.0f) + direction;
+	float halfwayLengthSquared = dot(halfway, halfway);
+
+	// Cylinder pointing straight down -z: rotate around the x-axis instead
+	halfway = halfwayLengthSquared > 1e-12f ? halfway * rsqrt(halfwayLengthSquared) : float3(1.0f, 0.0f, 0.0f);
+
+	return 2.0f * dot(halfway, v) * halfway - v;
+}
+
+
+PixelShaderInput main(VertexShaderInput input, uint instanceID : SV_InstanceID)
+{
+	BondCylinderInstance instance = Instances[firstInstance + instanceID];
+
+	float height = length(instance.axis);
+	float3 direction = instance.axis / height;
+
+	// The unit cylinder is scaled to (radius, radius, height), rotated onto the bond direction and
+	// translated to the start point
+	float3 scaled = input.position * float3(instance.radius, instance.radius, height);
+
+	PixelShaderInput output;
+	output.positionWS = float4(RotateZToDirection(scaled, direction) + instance.start, 1.0f);	// World space position
+	output.position = mul(viewProjection, output.positionWS);									// Screen position
+
+	// Inverse transpose of rotation * scale = rotation * inverse scale
+	output.normalWS = RotateZToDirection(input.normal / float3(instance.radius, instance.radius, height), direction);
+	output.materialIndex = instance.materialAndOutline & 0x00FFFFFF;
+	output.outline = instance.materialAndOutline >> 24;
+
+	return output;
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+// Instanced version of PhongVertexShader for drawing many spheres (atoms) with a single draw call.
+// The per-atom data comes from a structured buffer instead of a per-draw constant buffer.
+
+// Must match AtomInstance in AtomInstancePacker.h
+struct AtomInstance
+{
+	float3 position;
+	float radius;
+	uint materialIndex;
+	uint outline;
+	uint2 padding;
+};
+
+StructuredBuffer<AtomInstance> Instances : register(t0);
+
+// SV_InstanceID always starts at 0, even when StartInstanceLocation is not 0, so the offset of the
+// current batch in the instance buffer is passed in separately
+cbuffer InstancedViewProjectionConstantBuffer : register(b0)
+{
+	matrix viewProjection;
+	uint firstInstance;
+	uint3 padding;
+};
+
+struct VertexShaderInput
+{
+	float3 position : POSITION;
+	float3 normal : NORMAL;
+};
+
+// Must match PixelShaderInput in PhongPixelShader
+struct PixelShaderInput
+{
+	float4 position : SV_POSITION;
+	float4 positionWS : POS_WS;
+	float3 normalWS : NORM_WS;
+	nointerpolation uint materialIndex : MATERIAL;
+	nointerpolation uint outline : OUTLINE;
+};
+
+
+PixelShaderInput main(VertexShaderInput input, uint instanceID : SV_InstanceID)
+{
+	AtomInstance instance = Instances[firstInstance + instanceID];
+
+	PixelShaderInput output;
+
+	// Model matrix is a uniform scale followed by a translation, so the world space normal is just
+	// the object space normal (inverse transpose of a uniform scale only changes the length)
+	output.positionWS = float4(input.position * instance.radius + instance.position, 1.0f);	// World space position
+	output.position = mul(viewProjection, output.positionWS);								// Screen position
+	output.normalWS = input.normal;															// World space normal
+	output.materialIndex = instance.materialIndex;
+	output.outline = instance.outline;
+
+	return output;
+}
\ No newline at end of file
@@ -0,0 +1,184 @@
+#include "IntersectionKernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// The lane functions are written without branches so that, once inlined into the packet loops, every
+	// lane runs the same instructions and the loop can be vectorized. Conditions are combined with & rather
+	// than && because short circuiting is control flow
+
+	// Combine two distances where negative means miss - keep the nearest hit
+	inline float NearestHit(float a, float b)
+	{
+		return ((a >= 0.0f) & (b >= 0.0f)) ? std::min(a, b) : std::max(a, b);
+	}
+
+	inline float SphereLane(float ox, float oy, float oz, float dx, float dy, float dz,
+							float cx, float cy, float cz, float radius)
+	{
+		// |origin + t * direction - center|^2 = radius^2 with |direction| = 1
+		float ocx = ox - cx;
+		float ocy = oy - cy;
+		float ocz = oz - cz;
+		float b = ocx * dx + ocy * dy + ocz * dz;
+		float c = ocx * ocx + ocy * ocy + ocz * ocz - radius * radius;
+		float discriminant = b * b - c;
+
+		// Use the near intersection unless the origin is inside the sphere
+		float root = std::sqrt(std::max(discriminant, 0.0f));
+		float tNear = -b - root;
+		float t = tNear >= 0.0f ? tNear : -b + root;
+		return discriminant >= 0.0f ? t : -1.0f;
+	}
+
+	inline float CapsuleLane(float ox, float oy, float oz, float dx, float dy, float dz,
+							 float x1, float y1, float z1, float x2, float y2, float z2, float radius)
+	{
+		// A capsule is the union of a cylinder between the end points and a sphere at each end, so the
+		// first hit is the nearest of the three
+		float ends = NearestHit(SphereLane(ox, oy, oz, dx, dy, dz, x1, y1, z1, radius),
+								SphereLane(ox, oy, oz, dx, dy, dz, x2, y2, z2, radius));
+
+		// Infinite cylinder around the axis, limited to the part between the end points
+		float ax = x2 - x1, ay = y2 - y1, az = z2 - z1;
+		float sx = ox - x1, sy = oy - y1, sz = oz - z1;
+
+		float axisAxis = ax * ax + ay * ay + az * az;
+		float axisDirection = ax * dx + ay * dy + az * dz;
+		float axisOrigin = ax * sx + ay * sy + az * sz;
+
+		float a = axisAxis - axisDirection * axisDirection;
+		float b = axisAxis * (sx * dx + sy * dy + sz * dz) - axisOrigin * axisDirection;
+		float c = axisAxis * (sx * sx + sy * sy + sz * sz) - axisOrigin * axisOrigin - radius * radius * axisAxis;
+		float discriminant = b * b - a * c;
+
+		// a == 0 when the ray is parallel to the axis (or the capsule is a sphere) - then only the ends can
+		// be hit first. Dividing by a safe value keeps the unused lanes finite
+		float safeA = a > 0.0f ? a : 1.0f;
+		float t = (-b - std::sqrt(std::max(discriminant, 0.0f))) / safeA;
+		float y = axisOrigin + t * axisDirection;
+		bool bodyHit = (a > 0.0f) & (discriminant >= 0.0f) & (y > 0.0f) & (y < axisAxis) & (t >= 0.0f);
+
+		return NearestHit(ends, bodyHit ? t : -1.0f);
+	}
+}
+
+
+float IntersectionKernels::RaySphere(const float origin[3], const float direction[3], float x, float y, float z, float radius)
+{
+	return SphereLane(origin[0], origin[1], origin[2], direction[0], direction[1], direction[2], x, y, z, radius);
+}
+
+float IntersectionKernels::RayCapsule(const float origin[3], const float direction[3],
+									  float x1, float y1, float z1, float x2, float y2, float z2, float radius)
+{
+	return CapsuleLane(origin[0], origin[1], origin[2], direction[0], direction[1], direction[2], x1, y1, z1, x2, y2, z2, radius);
+}
+
+void IntersectionKernels::RaySpheres(const float origin[3], const float direction[3], const SphereArrays& spheres, size_t count, float* distances)
+{
+	const float ox = origin[0], oy = origin[1], oz = origin[2];
+	const float dx = direction[0], dy = direction[1], dz = direction[2];
+
+	// Full packets
+	size_t iii = 0;
+	for (; iii + PacketSize <= count; iii += PacketSize)
+	{
+		for (size_t lane = 0; lane < PacketSize; ++lane)
+		{
+			size_t jjj = iii + lane;
+			distances[jjj] = SphereLane(ox, oy, oz, dx, dy, dz, spheres.X[jjj], spheres.Y[jjj], spheres.Z[jjj], spheres.Radius[jjj]);
+		}
+	}
+
+	// Remainder
+	for (; iii < count; ++iii)
+		distances[iii] = SphereLane(ox, oy, oz, dx, dy, dz, spheres.X[iii], spheres.Y[iii], spheres.Z[iii], spheres.Radius[iii]);
+}
+
+void IntersectionKernels::RayCapsules(const float origin[3], const float direction[3], const CapsuleArrays& capsules, size_t count, float* distances)
+{
+	const float ox = origin[0], oy = origin[1], oz = origin[2];
+	const float dx = direction[0], dy = direction[1], dz = direction[2];
+
+	// Full packets
+	size_t iii = 0;
+	for (; iii + PacketSize <= count; iii += PacketSize)
+	{
+		for (size_t lane = 0; lane < PacketSize; ++lane)
+		{
+			size_t jjj = iii + lane;
+			distances[jjj] = CapsuleLane(ox, oy, oz, dx, dy, dz,
+				capsules.X1[jjj], capsules.Y1[jjj], capsules.Z1[jjj],
+				capsules.X2[jjj], capsules.Y2[jjj], capsules.Z2[jjj], capsules.Radius[jjj]);
+		}
+	}
+
+	// Remainder
+	for (; iii < count; ++iii)
+	{
+		distances[iii] = CapsuleLane(ox, oy, oz, dx, dy, dz,
+			capsules.X1[iii], capsules.Y1[iii], capsules.Z1[iii],
+			capsules.X2[iii], capsules.Y2[iii], capsules.Z2[iii], capsules.Radius[iii]);
+	}
+}
+
+size_t IntersectionKernels::Closest(const float* distances, size_t count)
+{
+	size_t closest = count;
+	float closestDistance = 0.0f;
+	for (size_t iii = 0; iii < count; ++iii)
+	{
+		if (distances[iii] >= 0.0f && (closest == count || distances[iii] < closestDistance))
+		{
+			closest = iii;
+			closestDistance = distances[iii];
+		}
+	}
+	return closest;
+}
+
+void IntersectionKernels::ProjectPoints(const float m[4][4], const float* x, const float* y, const float* z, size_t count,
+										float* ndcX, float* ndcY)
+{
+	const float offScreen = 1.0e30f;
+
+	for (size_t iii = 0; iii < count; ++iii)
+	{
+		float clipX = x[iii] * m[0][0] + y[iii] * m[1][0] + z[iii] * m[2][0] + m[3][0];
+		float clipY = x[iii] * m[0][1] + y[iii] * m[1][1] + z[iii] * m[2][1] + m[3][1];
+		float clipW = x[iii] * m[0][3] + y[iii] * m[1][3] + z[iii] * m[2][3] + m[3][3];
+
+		bool inFront = clipW > 0.0f;
+		float inverseW = 1.0f / (inFront ? clipW : 1.0f);
+		ndcX[iii] = inFront ? clipX * inverseW : offScreen;
+		ndcY[iii] = inFront ? clipY * inverseW : offScreen;
+	}
+}
+
+void IntersectionKernels::PointsInPolygon(const float* polygon, size_t vertexCount, const float* x, const float* y, size_t count, uint8_t* inside)
+{
+	std::fill(inside, inside + count, static_cast<uint8_t>(0));
+
+	// Count the polygon edges crossed by a ray from each point towards +x. The edge loop is outside so the
+	// inner loop runs over contiguous points with no branches and vectorizes
+	for (size_t edge = 0; edge < vertexCount; ++edge)
+	{
+		size_t next = (edge + 1 == vertexCount) ? 0 : edge + 1;
+		const float x1 = polygon[2 * edge], y1 = polygon[2 * edge + 1];
+		const float x2 = polygon[2 * next], y2 = polygon[2 * next + 1];
+
+		// Horizontal edges are never crossed (the first condition below is false), so the slope only needs
+		// to be finite
+		const float inverseSlope = (y2 != y1) ? (x2 - x1) / (y2 - y1) : 0.0f;
+
+		for (size_t iii = 0; iii < count; ++iii)
+		{
+			bool straddles = (y1 > y[iii]) != (y2 > y[iii]);
+			bool left = x[iii] < x1 + (y[iii] - y1) * inverseSlope;
+			inside[iii] ^= static_cast<uint8_t>(straddles & left);
+		}
+	}
+}
\ No newline at end of file
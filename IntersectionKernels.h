@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Structure-of-arrays views of sphere and capsule primitives. Each pointer refers to 'count' consecutive
+// floats (the caller owns the storage).
+struct SphereArrays
+{
+	const float*	X;
+	const float*	Y;
+	const float*	Z;
+	const float*	Radius;
+};
+
+struct CapsuleArrays
+{
+	const float*	X1;
+	const float*	Y1;
+	const float*	Z1;
+	const float*	X2;
+	const float*	Y2;
+	const float*	Z2;
+	const float*	Radius;
+};
+
+// Intersection tests used for picking and selection. The batch versions test one ray against many
+// primitives stored as structure of arrays. They work through the primitives in packets of PacketSize
+// with a fixed trip count and no branches (every miss/hit decision is a select), so the compiler can
+// vectorize each packet (8 lanes = one AVX register, two SSE/NEON registers) without intrinsics.
+// The single primitive versions compute exactly the same thing, so results match bit for bit.
+// (GCC/Clang only if-convert the selects with -fno-trapping-math -fno-math-errno.)
+//
+// Distances are measured along the ray, which must have a normalized direction. A negative distance
+// means the primitive was not hit (or is entirely behind the origin).
+class IntersectionKernels
+{
+public:
+	static constexpr size_t PacketSize = 8;
+
+	static float RaySphere(const float origin[3], const float direction[3], float x, float y, float z, float radius);
+	static float RayCapsule(const float origin[3], const float direction[3],
+							float x1, float y1, float z1, float x2, float y2, float z2, float radius);
+
+	// distances[i] = RaySphere/RayCapsule for primitive i
+	static void RaySpheres(const float origin[3], const float direction[3], const SphereArrays& spheres, size_t count, float* distances);
+	static void RayCapsules(const float origin[3], const float direction[3], const CapsuleArrays& capsules, size_t count, float* distances);
+
+	// Index of the smallest non-negative distance, or 'count' if every distance is negative
+	static size_t Closest(const float* distances, size_t count);
+
+	// Project points to normalized device coordinates with a row-major, row vector view-projection matrix
+	// (clip = (x, y, z, 1) * M). Points at or behind the eye (w <= 0) are placed far outside the screen
+	static void ProjectPoints(const float viewProjection[4][4], const float* x, const float* y, const float* z, size_t count,
+							  float* ndcX, float* ndcY);
+
+	// inside[i] = 1 if (x[i], y[i]) is inside the polygon and 0 if not (even-odd rule, so a self intersecting
+	// lasso works as expected). 'polygon' is 'vertexCount' x, y pairs; the last vertex connects to the first
+	static void PointsInPolygon(const float* polygon, size_t vertexCount, const float* x, const float* y, size_t count, uint8_t* inside);
+
+private:
+	// Disallow creation of an IntersectionKernels object
+	IntersectionKernels() {}
+};
\ No newline at end of file
@@ -38,6 +38,9 @@ void Layout::OnResize(D2D1_RECT_F rect)
 
 void Layout::OnResize(float top, float left, float height, float width) 
 { 
+	// Redraw the area the layout is leaving - UpdateLayout invalidates the area it moves to
+	Invalidate();
+
 	m_top = top; 
 	m_left = left; 
 	m_height = height;
@@ -161,6 +164,14 @@ void Layout::UpdateLayout()
 
 	// Now update any existing sublayouts
 	UpdateSubLayouts();
+
+	// Everything in the layout may have moved
+	Invalidate();
+}
+
+void Layout::Invalidate()
+{
+	m_deviceResources->InvalidateUI(D2D1::RectF(m_left, m_top, m_left + m_width, m_top + m_height));
 }
 
 std::shared_ptr<Layout> Layout::CreateSubLayout(int rowIndex, int columnIndex)
@@ -326,7 +337,10 @@ OnMessageResult Layout::OnLButtonDown(const std::shared_ptr<MouseState>& mouseSt
 
 	// Pass OnLButtonDown message to the control that has captured the mouse if it exists
 	if (m_mouseCapturedControl != nullptr)
+	{
+		m_mouseCapturedControl->Invalidate();
 		result = m_mouseCapturedControl->OnLButtonDown(mouseState);
+	}
 	else if (m_mouseCapturedLayout != nullptr)
 		result = m_mouseCapturedLayout->OnLButtonDown(mouseState);
 	
@@ -346,6 +360,7 @@ OnMessageResult Layout::OnLButtonDown(const std::shared_ptr<MouseState>& mouseSt
 		// Pass message only if mouse is over the control
 		if (control->MouseIsOver(mouseState->X(), mouseState->Y()))
 		{
+			control->Invalidate();
 			result = control->OnLButtonDown(mouseState);
 
 			// Capture the mouse if necessary
@@ -385,6 +400,7 @@ OnMessageResult Layout::OnLButtonUp(const std::shared_ptr<MouseState>& mouseStat
 	// Pass LButtonUp message to the control that has captured the mouse if it exists
 	if (m_mouseCapturedControl != nullptr)
 	{
+		m_mouseCapturedControl->Invalidate();
 		return m_mouseCapturedControl->OnLButtonUp(mouseState);
 	}
 	else if (m_mouseCapturedLayout != nullptr)
@@ -399,6 +415,7 @@ OnMessageResult Layout::OnLButtonDoubleClick(const std::shared_ptr<MouseState>&
 	// Pass OnLButtonDoubleClick message to the control that has captured the mouse if it exists
 	if (m_mouseCapturedControl != nullptr)
 	{
+		m_mouseCapturedControl->Invalidate();
 		return m_mouseCapturedControl->OnLButtonDoubleClick(mouseState);
 	}
 	else if (m_mouseCapturedLayout != nullptr)
@@ -415,7 +432,10 @@ OnMessageResult Layout::OnMouseMove(const std::shared_ptr<MouseState>& mouseStat
 
 	// If there is already a control within this layout that has been captured, immediately pass the message
 	if (m_mouseCapturedControl != nullptr)
+	{
+		m_mouseCapturedControl->Invalidate();
 		result = m_mouseCapturedControl->OnMouseMove(mouseState);
+	}
 	else if (m_mouseCapturedLayout != nullptr)
 		result = m_mouseCapturedLayout->OnMouseMove(mouseState);
 
@@ -439,6 +459,7 @@ OnMessageResult Layout::OnMouseMove(const std::shared_ptr<MouseState>& mouseStat
 		// Pass message only if mouse is over the control
 		if (control->MouseIsOver(mouseState->X(), mouseState->Y()))
 		{
+			control->Invalidate();
 			result = control->OnMouseMove(mouseState);
 
 			// Capture the mouse if necessary
@@ -484,7 +505,10 @@ OnMessageResult Layout::ForceOnMouseMove(const std::shared_ptr<MouseState>& mous
 	// Forcefully pass the OnMouseMove call to all child controls and sublayouts
 
 	for (std::shared_ptr<Control> control : m_controls)
+	{
+		control->Invalidate();
 		control->OnMouseMove(mouseState);
+	}
 
 	std::shared_ptr<Layout> layout;
 	for (std::tuple<std::shared_ptr<Layout>, int, int> subLayoutTuple : m_subLayouts)
@@ -501,7 +525,10 @@ OnMessageResult Layout::OnMouseLeave()
 
 	// If there is already a control within this layout that has been captured, immediately pass the message
 	if (m_mouseCapturedControl != nullptr)
+	{
+		m_mouseCapturedControl->Invalidate();
 		result = m_mouseCapturedControl->OnMouseLeave();
+	}
 	else if (m_mouseCapturedLayout != nullptr)
 		result = m_mouseCapturedLayout->OnMouseLeave();
 
@@ -521,6 +548,7 @@ OnMessageResult Layout::OnMouseLeave()
 	// Pass message along to all controls
 	for (std::shared_ptr<Control> control : m_controls)
 	{
+		control->Invalidate();
 		result = control->OnMouseLeave();
 
 		// Capture the mouse if necessary
@@ -560,6 +588,7 @@ OnMessageResult Layout::OnMouseWheel(int wheelDelta)
 	// Pass OnMouseWheel message to the control that has captured the mouse if it exists
 	if (m_mouseCapturedControl != nullptr)
 	{
+		m_mouseCapturedControl->Invalidate();
 		return m_mouseCapturedControl->OnMouseWheel(wheelDelta);
 	}
 	else if (m_mouseCapturedLayout != nullptr)
@@ -576,7 +605,10 @@ OnMessageResult Layout::OnKeyDown(unsigned char keycode)
 
 	// If there is already a control within this layout that has been captured, immediately pass the message
 	if (m_mouseCapturedControl != nullptr)
+	{
+		m_mouseCapturedControl->Invalidate();
 		result = m_mouseCapturedControl->OnKeyDown(keycode);
+	}
 	else if (m_mouseCapturedLayout != nullptr)
 		result = m_mouseCapturedLayout->OnKeyDown(keycode);
 
@@ -596,7 +628,10 @@ OnMessageResult Layout::OnKeyUp(unsigned char keycode)
 
 	// If there is already a control within this layout that has been captured, immediately pass the message
 	if (m_mouseCapturedControl != nullptr)
+	{
+		m_mouseCapturedControl->Invalidate();
 		result = m_mouseCapturedControl->OnKeyUp(keycode);
+	}
 	else if (m_mouseCapturedLayout != nullptr)
 		result = m_mouseCapturedLayout->OnKeyUp(keycode);
 
@@ -616,7 +651,10 @@ OnMessageResult Layout::OnChar(char key)
 
 	// If there is already a control within this layout that has been captured, immediately pass the message
 	if (m_mouseCapturedControl != nullptr)
+	{
+		m_mouseCapturedControl->Invalidate();
 		result = m_mouseCapturedControl->OnChar(key);
+	}
 	else if (m_mouseCapturedLayout != nullptr)
 		result = m_mouseCapturedLayout->OnChar(key);
 
@@ -692,7 +730,7 @@ bool Layout::Render3DControls()
 	return needsPresent;
 }
 
-bool Layout::Render2DControls()
+void Layout::Render2DBackground()
 {
 	// if the layout background color is not nullptr, then render it
 	if (m_colorTheme != nullptr)
@@ -710,6 +748,11 @@ bool Layout::Render2DControls()
 		// Just fill the layout with the default color (don't allow layouts to change color)
 		context->FillRectangle(rect, m_colorTheme->GetBrush(MouseOverDown::NONE));
 	}
+}
+
+bool Layout::Render2DControls()
+{
+	Render2DBackground();
 
 	// Pass the Render call along to each child control
 	// ONLY 2D rendering controls should react to this - other controls
@@ -735,25 +778,53 @@ bool Layout::Render2DControls()
 	return needsPresent;
 }
 
-bool Layout::Render2DControlsClipFirstAndLastSublayouts(D2D1_RECT_F renderWindow)
+bool Layout::Render2DControls(D2D1_RECT_F dirtyRect)
 {
-	// if the layout background color is not nullptr, then render it
-	if (m_colorTheme != nullptr)
+	// Skip everything that does not overlap the rect being redrawn
+	auto overlaps = [&dirtyRect](const D2D1_RECT_F& rect) {
+		return rect.left < dirtyRect.right && dirtyRect.left < rect.right && rect.top < dirtyRect.bottom && dirtyRect.top < rect.bottom;
+	};
+
+	if (!overlaps(D2D1::RectF(m_left, m_top, m_left + m_width, m_top + m_height)))
+		return false;
+
+	Render2DBackground();
+
+	ID2D1DeviceContext6* context = m_deviceResources->D2DDeviceContext();
+
+	bool needsPresent = false;
+	D2D1_RECT_F controlRect;
+	for (std::shared_ptr<Control> control : m_controls)
 	{
-		ID2D1DeviceContext6* context = m_deviceResources->D2DDeviceContext();
+		controlRect = control->GetParentRect();
+		if (!overlaps(controlRect))
+			continue;
 
+		// Keep each control inside its own rect. Anything a control draws outside of it (ex. an open drop down)
+		// belongs to the captured control, which is drawn on top every frame by Render2DCapturedControl, and
+		// must not be left behind in the cached layer once it closes
 		context->SetTransform(m_deviceResources->OrientationTransform2D());
+		context->PushAxisAlignedClip(controlRect, D2D1_ANTIALIAS_MODE_ALIASED);
 
-		D2D1_RECT_F rect = D2D1::RectF(
-			m_left + m_colorMarginLeft,
-			m_top + m_colorMarginTop,
-			m_left + m_width - m_colorMarginRight,
-			m_top + m_height - m_colorMarginBottom);
+		if (control->Render2D())
+			needsPresent = true;
 
-		// Just fill the layout with the default color (don't allow layouts to change color)
-		context->FillRectangle(rect, m_colorTheme->GetBrush(MouseOverDown::NONE));
+		context->PopAxisAlignedClip();
 	}
 
+	for (std::tuple<std::shared_ptr<Layout>, int, int> subLayoutTuple : m_subLayouts)
+	{
+		if (subLayoutTuple._Myfirst._Val->Render2DControls(dirtyRect))
+			needsPresent = true;
+	}
+
+	return needsPresent;
+}
+
+bool Layout::Render2DControlsClipFirstAndLastSublayouts(D2D1_RECT_F renderWindow)
+{
+	Render2DBackground();
+
 	// Pass the Render call along to each child control
 	// ONLY 2D rendering controls should react to this - other controls
 	// should NOT override Control::Render2D
@@ -782,22 +853,7 @@ bool Layout::Render2DControlsClipFirstAndLastSublayouts(D2D1_RECT_F renderWindow
 
 bool Layout::Render2DControlsWithClipping(D2D1_RECT_F renderWindow)
 {
-	// if the layout background color is not nullptr, then render it
-	if (m_colorTheme != nullptr)
-	{
-		ID2D1DeviceContext6* context = m_deviceResources->D2DDeviceContext();
-
-		context->SetTransform(m_deviceResources->OrientationTransform2D());
-
-		D2D1_RECT_F rect = D2D1::RectF(
-			m_left + m_colorMarginLeft,
-			m_top + m_colorMarginTop,
-			m_left + m_width - m_colorMarginRight,
-			m_top + m_height - m_colorMarginBottom);
-
-		// Just fill the layout with the default color (don't allow layouts to change color)
-		context->FillRectangle(rect, m_colorTheme->GetBrush(MouseOverDown::NONE));
-	}
+	Render2DBackground();
 
 	// Before rendering each control, check to see if its top is outside of the renderWindow
 	// If so, clip off the top. Otherwise, check if the bottom is below the renderWindow.
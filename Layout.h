@@ -45,13 +45,16 @@ public:
 	void OnResize(D2D1_RECT_F rect);
 
 	void Clear();
-	void ClearSubLayouts() { m_subLayouts.clear(); }
+	void ClearSubLayouts() { m_subLayouts.clear(); Invalidate(); }
 
 	std::shared_ptr<Layout> GetSubLayout(int rowIndex, int columnIndex);
 	std::shared_ptr<Layout> CreateSubLayout(int rowIndex, int columnIndex);
 	void SetSubLayout(std::shared_ptr<Layout> layout, int rowIndex, int columnIndex);
 	void UpdateSubLayouts();
 
+	// Mark the area covered by the layout as needing to be redrawn in the cached 2D UI layer
+	void Invalidate();
+
 	template<typename T>
 	std::shared_ptr<T> CreateControl();
 
@@ -68,7 +71,7 @@ public:
 
 
 	template<typename T>
-	void AddControl(std::shared_ptr<T> control) { m_controls.push_back(control); }
+	void AddControl(std::shared_ptr<T> control) { m_controls.push_back(control); Invalidate(); }
 
 	D2D1_RECT_F GetRect(int rowIndex, int columnIndex, int rowSpan = 1, int columnSpan = 1);
 
@@ -94,6 +97,10 @@ public:
 	bool Render2DControls();
 	bool Render2DCapturedControl();
 
+	// Only render the layouts and controls that overlap dirtyRect, each clipped to its own rect. Used to
+	// redraw the dirty parts of the cached 2D UI layer
+	bool Render2DControls(D2D1_RECT_F dirtyRect);
+
 	bool Render2DControlsClipFirstAndLastSublayouts(D2D1_RECT_F renderWindow);
 	bool Render2DControlsWithClipping(D2D1_RECT_F renderWindow);
 
@@ -110,15 +117,16 @@ public:
 
 
 	// Color Theme functions
-	void SetColorTheme(std::string name) { m_colorTheme = std::static_pointer_cast<ColorTheme>(ThemeManager::GetTheme(name)); }
-	void SetColorTheme(std::shared_ptr<ColorTheme> theme) { m_colorTheme = theme; }
-	void SetBackgroundColorMargins(float left, float top, float right, float bottom) { m_colorMarginLeft = left; m_colorMarginTop = top; m_colorMarginRight = right; m_colorMarginBottom = bottom; }
+	void SetColorTheme(std::string name) { m_colorTheme = std::static_pointer_cast<ColorTheme>(ThemeManager::GetTheme(name)); Invalidate(); }
+	void SetColorTheme(std::shared_ptr<ColorTheme> theme) { m_colorTheme = theme; Invalidate(); }
+	void SetBackgroundColorMargins(float left, float top, float right, float bottom) { m_colorMarginLeft = left; m_colorMarginTop = top; m_colorMarginRight = right; m_colorMarginBottom = bottom; Invalidate(); }
 
 	// Set the layout cleared event
 	void SetLayoutClearedEvent(std::function<void()> function) { LayoutClearedEvent = function; }
 
 private:
 	void UpdateLayout();
+	void Render2DBackground();
 
 	std::shared_ptr<DeviceResources> m_deviceResources;
 
@@ -12,8 +12,5 @@ public:
 	// Constructors
 	// Most common isotope = Lithium-7
 	// Most common charge  = +1
-	Lithium(const std::shared_ptr<DeviceResources>& deviceResources, DirectX::XMFLOAT3 position, DirectX::XMFLOAT3 velocity, int neutronCount = 4, int charge = 1);
-
-	// Update
-	void Update(double timeDelta, const std::vector<std::shared_ptr<Atom>>& atoms, DirectX::XMFLOAT3 boxDimensions) override;
+	Lithium(const std::shared_ptr<HandleAllocator>& handleAllocator, DirectX::XMFLOAT3 position, DirectX::XMFLOAT3 velocity, int neutronCount = 4, int charge = 1);
 };
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include "MaterialTable.h"
+
+static_assert(sizeof(_PhongMaterial) == 80, "_PhongMaterial must match _MyMaterial in PhongLighting.hlsli");
+
+
+MaterialTable::MaterialTable(const std::shared_ptr<DeviceResources>& deviceResources) :
+	m_deviceResources(deviceResources),
+	m_dirty(true)
+{
+}
+
+uint32_t MaterialTable::Add(const _PhongMaterial& material)
+{
+	m_materials.push_back(material);
+	m_dirty = true;
+	return static_cast<uint32_t>(m_materials.size() - 1);
+}
+
+uint32_t MaterialTable::AddSolidColor(DirectX::FXMVECTOR color)
+{
+	_PhongMaterial material;
+	DirectX::XMStoreFloat4(&material.Emissive, color);
+	return Add(material);
+}
+
+void MaterialTable::Bind(UINT slot)
+{
+	if (m_dirty)
+		CreateBuffer();
+
+	ID3D11ShaderResourceView* const views[] = { m_bufferView.Get() };
+	m_deviceResources->D3DDeviceContext()->PSSetShaderResources(slot, 1, views);
+}
+
+void MaterialTable::CreateBuffer()
+{
+	// The materials never change once the scene is set up, so the buffer is immutable
+	D3D11_SUBRESOURCE_DATA bufferData = { 0 };
+	bufferData.pSysMem = m_materials.data();
+	bufferData.SysMemPitch = 0;
+	bufferData.SysMemSlicePitch = 0;
+
+	CD3D11_BUFFER_DESC bufferDesc(
+		static_cast<UINT>(sizeof(_PhongMaterial) * m_materials.size()),
+		D3D11_BIND_SHADER_RESOURCE,
+		D3D11_USAGE_IMMUTABLE,
+		0,
+		D3D11_RESOURCE_MISC_BUFFER_STRUCTURED,
+		sizeof(_PhongMaterial)
+	);
+	ThrowIfFailed(
+		m_deviceResources->D3DDevice()->CreateBuffer(
+			&bufferDesc,
+			&bufferData,
+			m_buffer.ReleaseAndGetAddressOf()
+		)
+	);
+
+	CD3D11_SHADER_RESOURCE_VIEW_DESC viewDesc(D3D11_SRV_DIMENSION_BUFFER, DXGI_FORMAT_UNKNOWN, 0, static_cast<UINT>(m_materials.size()));
+	ThrowIfFailed(
+		m_deviceResources->D3DDevice()->CreateShaderResourceView(
+			m_buffer.Get(),
+			&viewDesc,
+			m_bufferView.ReleaseAndGetAddressOf()
+		)
+	);
+
+	m_dirty = false;
+}
\ No newline at end of file
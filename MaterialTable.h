@@ -0,0 +1,42 @@
+#pragma once
+#include "pch.h"
+
+#include "DeviceResources.h"
+#include "HLSLStructures.h"
+
+#include <memory>
+#include <vector>
+
+
+// Every material the renderer uses (elements, velocity arrow, box and the solid outline colors) in one
+// immutable structured buffer. Shaders read Materials[materialIndex], where the index comes from the
+// instance data (AtomInstance/BondCylinderInstance) or the per-draw ModelViewProjectionConstantBuffer,
+// so changing material never needs a constant buffer update or a separate draw call.
+//
+// Materials are added up front and the buffer is created on the first Bind after the last Add.
+class MaterialTable
+{
+public:
+	MaterialTable(const std::shared_ptr<DeviceResources>& deviceResources);
+
+	// Returns the index of the new material
+	uint32_t Add(const _PhongMaterial& material);
+
+	// Solid color for SolidPixelShader, which only reads the emissive color
+	uint32_t AddSolidColor(DirectX::FXMVECTOR color);
+
+	// PSSetShaderResources with the table
+	void Bind(UINT slot);
+
+	uint32_t Count() const { return static_cast<uint32_t>(m_materials.size()); }
+
+private:
+	void CreateBuffer();
+
+	std::shared_ptr<DeviceResources>					m_deviceResources;
+	std::vector<_PhongMaterial>							m_materials;
+	bool												m_dirty;	// Materials were added since the buffer was created
+
+	Microsoft::WRL::ComPtr<ID3D11Buffer>				m_buffer;
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>	m_bufferView;
+};
\ No newline at end of file
@@ -0,0 +1,56 @@
+#include "MeshBuffers.h"
+
+static_assert(sizeof(MeshVertex) == sizeof(VertexPositionNormal), "MeshVertex must match VertexPositionNormal");
+
+
+void MeshBuffers::Create(const std::shared_ptr<DeviceResources>& deviceResources, const MeshData& mesh)
+{
+	D3D11_SUBRESOURCE_DATA vertexBufferData = { 0 };
+	vertexBufferData.pSysMem = mesh.Vertices.data();
+	vertexBufferData.SysMemPitch = 0;
+	vertexBufferData.SysMemSlicePitch = 0;
+
+	CD3D11_BUFFER_DESC vertexBufferDesc(
+		static_cast<UINT>(sizeof(MeshVertex) * mesh.Vertices.size()),
+		D3D11_BIND_VERTEX_BUFFER
+	);
+
+	ThrowIfFailed(
+		deviceResources->D3DDevice()->CreateBuffer(
+			&vertexBufferDesc,
+			&vertexBufferData,
+			VertexBuffer.ReleaseAndGetAddressOf()
+		)
+	);
+
+	D3D11_SUBRESOURCE_DATA indexBufferData = { 0 };
+	indexBufferData.pSysMem = mesh.Indices.data();
+	indexBufferData.SysMemPitch = 0;
+	indexBufferData.SysMemSlicePitch = 0;
+
+	CD3D11_BUFFER_DESC indexBufferDesc(
+		static_cast<UINT>(sizeof(uint16_t) * mesh.Indices.size()),
+		D3D11_BIND_INDEX_BUFFER
+	);
+
+	ThrowIfFailed(
+		deviceResources->D3DDevice()->CreateBuffer(
+			&indexBufferDesc,
+			&indexBufferData,
+			IndexBuffer.ReleaseAndGetAddressOf()
+		)
+	);
+
+	IndexCount = static_cast<uint32_t>(mesh.Indices.size());
+}
+
+void MeshBuffers::Bind(ID3D11DeviceContext* context) const
+{
+	// Each vertex is one instance of the VertexPositionNormal struct.
+	UINT stride = sizeof(VertexPositionNormal);
+	UINT offset = 0;
+	ID3D11Buffer* const vertexBuffers[] = { VertexBuffer.Get() };
+	context->IASetVertexBuffers(0, 1, vertexBuffers, &stride, &offset);
+
+	context->IASetIndexBuffer(IndexBuffer.Get(), DXGI_FORMAT_R16_UINT, 0);
+}
\ No newline at end of file
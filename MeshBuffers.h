@@ -0,0 +1,22 @@
+#pragma once
+#include "pch.h"
+
+#include "DeviceResources.h"
+#include "MeshGeometry.h"
+
+#include <memory>
+
+
+// Vertex and index buffers for one mesh (one level of detail of a sphere, cylinder or cone)
+struct MeshBuffers
+{
+	Microsoft::WRL::ComPtr<ID3D11Buffer>	VertexBuffer;
+	Microsoft::WRL::ComPtr<ID3D11Buffer>	IndexBuffer;
+	uint32_t								IndexCount = 0;
+
+	// Upload the mesh to the device
+	void Create(const std::shared_ptr<DeviceResources>& deviceResources, const MeshData& mesh);
+
+	// IASetVertexBuffers + IASetIndexBuffer
+	void Bind(ID3D11DeviceContext* context) const;
+};
\ No newline at end of file
@@ -0,0 +1,139 @@
+#include "MeshGeometry.h"
+
+#include <cmath>
+
+namespace
+{
+	const float Pi = 3.14159265358979f;
+	const float TwoPi = 6.28318530717959f;
+
+	void SetVertex(MeshVertex& vertex, float px, float py, float pz, float nx, float ny, float nz)
+	{
+		vertex.Position[0] = px;
+		vertex.Position[1] = py;
+		vertex.Position[2] = pz;
+		vertex.Normal[0] = nx;
+		vertex.Normal[1] = ny;
+		vertex.Normal[2] = nz;
+	}
+
+	void AddTriangle(std::vector<uint16_t>& indices, unsigned int i1, unsigned int i2, unsigned int i3)
+	{
+		indices.push_back(static_cast<uint16_t>(i1));
+		indices.push_back(static_cast<uint16_t>(i2));
+		indices.push_back(static_cast<uint16_t>(i3));
+	}
+}
+
+
+MeshData MeshGeometry::Sphere(unsigned int segments)
+{
+	unsigned int slices = segments / 2;
+
+	MeshData mesh;
+	mesh.Vertices.resize((slices + 1) * (segments + 1));
+
+	// Each slice has 'segments + 1' vertices. The top and bottom vertices are all coincident
+	unsigned int p = 0;
+	for (unsigned int a = 0; a <= slices; ++a)
+	{
+		float angle1 = static_cast<float>(a) / static_cast<float>(slices) * Pi;
+		float z = std::cos(angle1);
+		float r = std::sin(angle1);
+		for (unsigned int b = 0; b <= segments; ++b)
+		{
+			float angle2 = static_cast<float>(b) / static_cast<float>(segments) * TwoPi;
+
+			// We are working with the unit sphere so the position and normal vectors are the same
+			float x = r * std::cos(angle2);
+			float y = r * std::sin(angle2);
+			SetVertex(mesh.Vertices[p++], x, y, z, x, y, z);
+		}
+	}
+
+	// Two triangles per segment, except at the poles where one of them would be degenerate
+	mesh.Indices.reserve(6 * segments * (slices - 1));
+	for (unsigned int a = 0; a < slices; ++a)
+	{
+		unsigned int p1 = a * (segments + 1);
+		unsigned int p2 = (a + 1) * (segments + 1);
+
+		for (unsigned int b = 0; b < segments; ++b)
+		{
+			if (a < slices - 1)
+				AddTriangle(mesh.Indices, b + p1, b + p2, b + p2 + 1);
+
+			if (a > 0)
+				AddTriangle(mesh.Indices, b + p1, b + p2 + 1, b + p1 + 1);
+		}
+	}
+
+	return mesh;
+}
+
+MeshData MeshGeometry::Cylinder(unsigned int slices)
+{
+	MeshData mesh;
+	mesh.Vertices.resize(2 * slices);
+
+	// Bottom circle (z = 0) followed by the top circle (z = 1). The radius is 1, so the normal is the
+	// position without its z component
+	for (unsigned int a = 0; a < slices; ++a)
+	{
+		float angle = static_cast<float>(a) / static_cast<float>(slices) * TwoPi;
+		float x = std::cos(angle);
+		float y = std::sin(angle);
+
+		SetVertex(mesh.Vertices[a], x, y, 0.0f, x, y, 0.0f);
+		SetVertex(mesh.Vertices[a + slices], x, y, 1.0f, x, y, 0.0f);
+	}
+
+	// Each slice is a rectangle between the bottom and top circles - the last one wraps back to vertex 0
+	mesh.Indices.reserve(6 * slices);
+	for (unsigned int iii = 0; iii < slices; ++iii)
+	{
+		unsigned int i_1 = iii;
+		unsigned int i_2 = (iii + 1) % slices;
+		unsigned int i_3 = i_1 + slices;
+		unsigned int i_4 = i_2 + slices;
+
+		AddTriangle(mesh.Indices, i_1, i_2, i_4);
+		AddTriangle(mesh.Indices, i_1, i_3, i_4);
+	}
+
+	return mesh;
+}
+
+MeshData MeshGeometry::Cone(unsigned int slices)
+{
+	MeshData mesh;
+	mesh.Vertices.resize(slices + 2);
+
+	// Center of the base first, then the base circle, then the tip
+	SetVertex(mesh.Vertices[0], 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f);
+	for (unsigned int a = 0; a < slices; ++a)
+	{
+		float angle = static_cast<float>(a) / static_cast<float>(slices) * TwoPi;
+		float x = std::cos(angle);
+		float y = std::sin(angle);
+
+		SetVertex(mesh.Vertices[a + 1], x, y, 0.0f, x, y, 0.0f);
+	}
+
+	unsigned int center = 0;
+	unsigned int tip = slices + 1;
+	SetVertex(mesh.Vertices[tip], 0.0f, 0.0f, 0.5f, 0.0f, 0.0f, 1.0f);
+
+	// Each slice has a triangle in the base and a triangle up to the tip
+	mesh.Indices.reserve(6 * slices);
+	for (unsigned int iii = 1; iii <= slices; ++iii)
+	{
+		unsigned int i_1 = iii;
+		unsigned int i_2 = (iii == slices) ? 1 : iii + 1;
+
+		AddTriangle(mesh.Indices, center, i_1, i_2);
+		AddTriangle(mesh.Indices, tip, i_1, i_2);
+	}
+
+	return mesh;
+}
\ No newline at end of file
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Vertex layout shared by every mesh. Must match VertexPositionNormal in HLSLStructures.h (the mesh
+// classes static_assert this) so the vertices can be uploaded without conversion.
+struct MeshVertex
+{
+	float	Position[3];
+	float	Normal[3];
+};
+
+// CPU side vertices and 16-bit indices (triangle list) for one mesh
+struct MeshData
+{
+	std::vector<MeshVertex>	Vertices;
+	std::vector<uint16_t>	Indices;
+
+	size_t TriangleCount() const { return Indices.size() / 3; }
+};
+
+// Generates the unit sphere, cylinder and cone meshes used by SphereMesh, CylinderMesh and ArrowMesh.
+// Each takes the tessellation so MeshManager can build a chain of levels of detail.
+class MeshGeometry
+{
+public:
+	// Unit sphere centered on the origin. 'segments' points around each slice and segments / 2 slices
+	// from pole to pole
+	static MeshData Sphere(unsigned int segments);
+
+	// Open cylinder of radius 1 from z = 0 to z = 1 with 'slices' points around each end
+	static MeshData Cylinder(unsigned int slices);
+
+	// Cone with a base of radius 1 at z = 0 (closed by a disk) and the tip at z = 0.5
+	static MeshData Cone(unsigned int slices);
+
+private:
+	// Disallow creation of a MeshGeometry object
+	MeshGeometry() {}
+};
+
+// Level of detail selection. Level 0 is the full detail mesh and each following level has fewer
+// triangles. The level is picked from the radius of the object on screen in pixels.
+class MeshLevelOfDetail
+{
+public:
+	static constexpr unsigned int LevelCount = 4;
+
+	// Tessellation of each level
+	static constexpr unsigned int SphereSegments[LevelCount] = { 26, 16, 10, 6 };
+	static constexpr unsigned int CylinderSlices[LevelCount] = { 40, 16, 8, 5 };
+	static constexpr unsigned int ConeSlices[LevelCount] = { 40, 16, 8, 5 };
+
+	// Smallest screen radius (pixels) that still uses each level. Anything smaller than the last
+	// threshold uses the last level
+	static constexpr float MinimumScreenRadius[LevelCount - 1] = { 40.0f, 12.0f, 4.0f };
+
+	// 'pixelsPerUnit' is the screen radius in pixels of an object of radius 1 at distance 1:
+	// viewport height / (2 * tan(vertical field of view / 2))
+	static float ScreenRadius(float radius, float distance, float pixelsPerUnit)
+	{
+		return distance > radius ? radius * pixelsPerUnit / distance : pixelsPerUnit;
+	}
+
+	static uint8_t SelectLevel(float screenRadius)
+	{
+		uint8_t level = 0;
+		while (level < LevelCount - 1 && screenRadius < MinimumScreenRadius[level])
+			++level;
+		return level;
+	}
+
+	// Split each batch into one batch per level. 'levels' holds the level of each instance. The
+	// instances of each batch are reordered (stably) so each level is contiguous, and the new batches
+	// are written in place of the old ones. TBatch must have MaterialIndex, FirstInstance, InstanceCount
+	// and Level members. 'scratch' is reused from call to call to avoid allocating.
+	template<typename TInstance, typename TBatch>
+	static void SplitBatches(std::vector<TInstance>& instances, std::vector<TBatch>& batches,
+							 const std::vector<uint8_t>& levels, std::vector<TInstance>& scratch, std::vector<TBatch>& scratchBatches);
+
+private:
+	// Disallow creation of a MeshLevelOfDetail object
+	MeshLevelOfDetail() {}
+};
+
+template<typename TInstance, typename TBatch>
+void MeshLevelOfDetail::SplitBatches(std::vector<TInstance>& instances, std::vector<TBatch>& batches,
+									 const std::vector<uint8_t>& levels, std::vector<TInstance>& scratch, std::vector<TBatch>& scratchBatches)
+{
+	scratch.resize(instances.size());
+	scratchBatches.clear();
+
+	for (const TBatch& batch : batches)
+	{
+		// Count the instances of each level, then turn the counts into offsets
+		uint32_t offsets[LevelCount] = {};
+		for (uint32_t iii = batch.FirstInstance; iii < batch.FirstInstance + batch.InstanceCount; ++iii)
+			++offsets[levels[iii]];
+
+		uint32_t offset = batch.FirstInstance;
+		for (uint32_t level = 0; level < LevelCount; ++level)
+		{
+			uint32_t count = offsets[level];
+			offsets[level] = offset;
+
+			if (count > 0)
+				scratchBatches.push_back({ batch.MaterialIndex, offset, count, level });
+
+			offset += count;
+		}
+
+		for (uint32_t iii = batch.FirstInstance; iii < batch.FirstInstance + batch.InstanceCount; ++iii)
+			scratch[offsets[levels[iii]]++] = instances[iii];
+	}
+
+	instances.swap(scratch);
+	batches.swap(scratchBatches);
+}
\ No newline at end of file
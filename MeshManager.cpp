@@ -3,4 +3,21 @@
 
 std::shared_ptr<SphereMesh> MeshManager::m_sphereMesh = nullptr;
 std::shared_ptr<ArrowMesh> MeshManager::m_arrowMesh = nullptr;
-std::shared_ptr<CylinderMesh> MeshManager::m_cylinderMesh = nullptr;
\ No newline at end of file
+std::shared_ptr<CylinderMesh> MeshManager::m_cylinderMesh = nullptr;
+
+void MeshManager::CreateMeshes(const std::shared_ptr<DeviceResources>& deviceResources)
+{
+	std::vector<MeshData> spheres;
+	std::vector<MeshData> cylinders;
+	std::vector<MeshData> cones;
+	for (unsigned int level = 0; level < MeshLevelOfDetail::LevelCount; ++level)
+	{
+		spheres.push_back(MeshGeometry::Sphere(MeshLevelOfDetail::SphereSegments[level]));
+		cylinders.push_back(MeshGeometry::Cylinder(MeshLevelOfDetail::CylinderSlices[level]));
+		cones.push_back(MeshGeometry::Cone(MeshLevelOfDetail::ConeSlices[level]));
+	}
+
+	m_sphereMesh = std::make_shared<SphereMesh>(deviceResources, spheres);
+	m_arrowMesh = std::make_shared<ArrowMesh>(deviceResources, cylinders, cones);
+	m_cylinderMesh = std::make_shared<CylinderMesh>(deviceResources, cylinders);
+}
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "SphereMesh.h"
 #include "ArrowMesh.h"
 #include "CylinderMesh.h"
+#include "MeshGeometry.h"
 
 #include <memory>
 
@@ -10,12 +11,8 @@
 class MeshManager
 {
 public:
-	static void CreateMeshes(const std::shared_ptr<DeviceResources>& deviceResources)
-	{
-		m_sphereMesh = std::make_shared<SphereMesh>(deviceResources);
-		m_arrowMesh = std::make_shared<ArrowMesh>(deviceResources);
-		m_cylinderMesh = std::make_shared<CylinderMesh>(deviceResources);
-	}
+	// Generate every level of detail of each mesh (see MeshLevelOfDetail) and upload them to the device
+	static void CreateMeshes(const std::shared_ptr<DeviceResources>& deviceResources);
 
 	static std::shared_ptr<SphereMesh> GetSphereMesh() { return m_sphereMesh; }
 	static std::shared_ptr<ArrowMesh> GetArrowMesh() { return m_arrowMesh; }
@@ -11,8 +11,5 @@ public:
 	// Constructors
 	// Most common isotope = Nitrogen-14
 	// Most common charge  = 0
-	Nitrogen(const std::shared_ptr<DeviceResources>& deviceResources, DirectX::XMFLOAT3 position, DirectX::XMFLOAT3 velocity, int neutronCount = 7, int charge = 0);
-
-	// Update
-	void Update(double timeDelta, const std::vector<std::shared_ptr<Atom>>& atoms, DirectX::XMFLOAT3 boxDimensions) override;
+	Nitrogen(const std::shared_ptr<HandleAllocator>& handleAllocator, DirectX::XMFLOAT3 position, DirectX::XMFLOAT3 velocity, int neutronCount = 7, int charge = 0);
 };
\ No newline at end of file
@@ -0,0 +1,181 @@
+// Phong material, lights and lighting functions shared by the Phong pixel shaders
+
+#define MAX_LIGHTS 8
+
+// Light types.
+#define DIRECTIONAL_LIGHT 0
+#define POINT_LIGHT 1
+#define SPOT_LIGHT 2
+
+struct _MyMaterial
+{
+    float4  Emissive;       // 16 bytes
+    //----------------------------------- (16 byte boundary)
+    float4  Ambient;        // 16 bytes
+    //------------------------------------(16 byte boundary)
+    float4  Diffuse;        // 16 bytes
+    //----------------------------------- (16 byte boundary)
+    float4  Specular;       // 16 bytes
+    //----------------------------------- (16 byte boundary)
+    float   SpecularPower;  // 4 bytes
+    bool    UseTexture;     // 4 bytes
+    float2  Padding;        // 8 bytes
+    //----------------------------------- (16 byte boundary)
+};  // Total:               // 80 bytes ( 5 * 16 )
+
+// Every material in one table (see MaterialTable.h). The vertex shaders pass the index of the
+// material to use through to the pixel shader
+StructuredBuffer<_MyMaterial> Materials : register(t0);
+
+struct MyLight
+{
+    float4      Position;               // 16 bytes
+    //----------------------------------- (16 byte boundary)
+    float4      Direction;              // 16 bytes
+    //----------------------------------- (16 byte boundary)
+    float4      Color;                  // 16 bytes
+    //----------------------------------- (16 byte boundary)
+    float       SpotAngle;              // 4 bytes
+    float       ConstantAttenuation;    // 4 bytes
+    float       LinearAttenuation;      // 4 bytes
+    float       QuadraticAttenuation;   // 4 bytes
+    //----------------------------------- (16 byte boundary)
+    int         LightType;              // 4 bytes
+    bool        Enabled;                // 4 bytes
+    int2        Padding;                // 8 bytes
+    //----------------------------------- (16 byte boundary)
+};  // Total:                           // 80 bytes (5 * 16 byte boundary)
+
+cbuffer MyLightProperties : register(b1)
+{
+    float4 EyePosition;                 // 16 bytes
+    //----------------------------------- (16 byte boundary)
+    float4 GlobalAmbient;               // 16 bytes
+    //----------------------------------- (16 byte boundary)
+    MyLight Lights[MAX_LIGHTS];           // 80 * 8 = 640 bytes
+};  // Total:                           // 672 bytes (42 * 16 byte boundary)
+
+struct LightingResult
+{
+    float4 Diffuse;
+    float4 Specular;
+};
+
+float4 DoDiffuse(MyLight light, float3 L, float3 N)
+{
+    float NdotL = max(0, dot(N, L));
+    return light.Color * NdotL;
+}
+
+float4 DoSpecular(MyLight light, float3 V, float3 L, float3 N, float specularPower)
+{
+    // Phong lighting.
+    float3 R = normalize(reflect(-L, N));
+    float RdotV = max(0, dot(R, V));
+
+    // Blinn-Phong lighting
+    float3 H = normalize(L + V);
+    float NdotH = max(0, dot(N, H));
+
+    return light.Color * pow(RdotV, specularPower);
+}
+
+LightingResult DoDirectionalLight(MyLight light, float3 V, float4 P, float3 N, float specularPower)
+{
+    LightingResult result;
+
+    float3 L = -light.Direction.xyz;
+
+    result.Diffuse = DoDiffuse(light, L, N);
+    result.Specular = DoSpecular(light, V, L, N, specularPower);
+
+    return result;
+}
+
+float DoAttenuation(MyLight light, float d)
+{
+    return 1.0f / (light.ConstantAttenuation + light.LinearAttenuation * d + light.QuadraticAttenuation * d * d);
+}
+
+LightingResult DoPointLight(MyLight light, float3 V, float4 P, float3 N, float specularPower)
+{
+    LightingResult result;
+
+    float3 L = (light.Position - P).xyz;
+    float distance = length(L);
+    L = L / distance;
+
+    float attenuation = DoAttenuation(light, distance);
+
+    result.Diffuse = DoDiffuse(light, L, N) * attenuation;
+    result.Specular = DoSpecular(light, V, L, N, specularPower) * attenuation;
+
+    return result;
+}
+
+float DoSpotCone(MyLight light, float3 L)
+{
+    float minCos = cos(light.SpotAngle);
+    float maxCos = (minCos + 1.0f) / 2.0f;
+    float cosAngle = dot(light.Direction.xyz, -L);
+    return smoothstep(minCos, maxCos, cosAngle);
+}
+
+LightingResult DoSpotLight(MyLight light, float3 V, float4 P, float3 N, float specularPower)
+{
+    LightingResult result;
+
+    float3 L = (light.Position - P).xyz;
+    float distance = length(L);
+    L = L / distance;
+
+    float attenuation = DoAttenuation(light, distance);
+    float spotIntensity = DoSpotCone(light, L);
+
+    result.Diffuse = DoDiffuse(light, L, N) * attenuation * spotIntensity;
+    result.Specular = DoSpecular(light, V, L, N, specularPower) * attenuation * spotIntensity;
+
+    return result;
+}
+
+// The specular power comes from the material, which each pixel shader looks up in the material table
+LightingResult ComputeLighting(float4 eye, float4 P, float3 N, float specularPower)
+{
+    float3 V = normalize(eye - P).xyz;
+
+    LightingResult totalResult = { {0, 0, 0, 0}, {0, 0, 0, 0} };
+
+    [unroll]
+    for (int i = 0; i < MAX_LIGHTS; ++i)
+    {
+        LightingResult result = { {0, 0, 0, 0}, {0, 0, 0, 0} };
+
+        if (!Lights[i].Enabled) continue;
+
+        switch (Lights[i].LightType)
+        {
+        case DIRECTIONAL_LIGHT:
+        {
+            result = DoDirectionalLight(Lights[i], V, P, N, specularPower);
+        }
+        break;
+        case POINT_LIGHT:
+        {
+            result = DoPointLight(Lights[i], V, P, N, specularPower);
+        }
+        break;
+        case SPOT_LIGHT:
+        {
+            result = DoSpotLight(Lights[i], V, P, N, specularPower);
+        }
+        break;
+        }
+        totalResult.Diffuse += result.Diffuse;
+        totalResult.Specular += result.Specular;
+    }
+
+    totalResult.Diffuse = saturate(totalResult.Diffuse);
+    totalResult.Specular = saturate(totalResult.Specular);
+
+    return totalResult;
+}
\ No newline at end of file
@@ -13,6 +13,9 @@ cbuffer ModelViewProjectionConstantBuffer : register(b0)
 	matrix model;
 	matrix modelViewProjection;
 	matrix inverseTransposeModel;
+	uint materialIndex;
+	uint outline;
+	uint2 padding;
 };
 
 
@@ -45,6 +48,8 @@ struct PixelShaderInput
 	float4 position : SV_POSITION;
 	float4 positionWS : POS_WS;
 	float3 normalWS : NORM_WS;
+	nointerpolation uint materialIndex : MATERIAL;
+	nointerpolation uint outline : OUTLINE;
 };
 
 
@@ -57,6 +62,8 @@ PixelShaderInput main(VertexShaderInput input)
 	output.position = mul(modelViewProjection, position);                 // Screen position
 	output.positionWS = mul(model, position);                               // World space position
 	output.normalWS = mul((float3x3)inverseTransposeModel, input.normal); // compute the world space normal
+	output.materialIndex = materialIndex;
+	output.outline = outline;
 
 	return output;
 }
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include "RenderCommandList.h"
+#include "CameraSpace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+
+void RenderCommandList::Clear()
+{
+	m_commands.clear();
+	m_transforms.clear();
+	std::fill(m_origin, m_origin + 3, 0.0);
+}
+
+void RenderCommandList::SetEye(const float eye[3], float farDistance)
+{
+	std::copy(eye, eye + 3, m_eye);
+	m_farDistance = farDistance;
+}
+
+void RenderCommandList::SetOrigin(const double origin[3])
+{
+	std::copy(origin, origin + 3, m_origin);
+}
+
+void RenderCommandList::Draw(const RenderStateBlock& state, RenderMesh mesh, uint8_t level, const float model[4][4], uint32_t materialIndex)
+{
+	RenderTransform transform;
+	std::memcpy(transform.Model, model, sizeof(transform.Model));
+	CameraSpace::Rebase(m_origin, transform.Model);
+	transform.MaterialIndex = materialIndex;
+
+	RenderCommand command;
+	command.Key = MakeKey(state, mesh, level, materialIndex, QuantizeDepth(transform.Model));
+	command.State = state;
+	command.Mesh = mesh;
+	command.Level = level;
+	command.FirstInstance = 0;
+	command.InstanceCount = 1;
+	command.Transform = static_cast<uint32_t>(m_transforms.size());
+
+	m_transforms.push_back(transform);
+	m_commands.push_back(command);
+}
+
+void RenderCommandList::DrawInstanced(const RenderStateBlock& state, RenderMesh mesh, uint8_t level, uint32_t firstInstance, uint32_t instanceCount)
+{
+	if (instanceCount == 0)
+		return;
+
+	RenderCommand command;
+	command.Key = MakeKey(state, mesh, level, 0, 0);
+	command.State = state;
+	command.Mesh = mesh;
+	command.Level = level;
+	command.FirstInstance = firstInstance;
+	command.InstanceCount = instanceCount;
+	command.Transform = NoTransform;
+
+	m_commands.push_back(command);
+}
+
+void RenderCommandList::Sort()
+{
+	const size_t count = m_commands.size();
+	if (count < 2)
+		return;
+
+	// Only sort on the bytes that differ between keys - most frames use a handful of states, so several
+	// of the eight passes are skipped
+	uint64_t differing = 0;
+	for (const RenderCommand& command : m_commands)
+		differing |= command.Key ^ m_commands[0].Key;
+
+	m_sortScratch.resize(count);
+
+	for (unsigned int shift = 0; shift < 64; shift += 8)
+	{
+		if (((differing >> shift) & 0xFF) == 0)
+			continue;
+
+		// Counting sort on one byte of the key
+		size_t offsets[256] = {};
+		for (const RenderCommand& command : m_commands)
+			++offsets[(command.Key >> shift) & 0xFF];
+
+		size_t total = 0;
+		for (size_t& offset : offsets)
+		{
+			size_t digitCount = offset;
+			offset = total;
+			total += digitCount;
+		}
+
+		for (const RenderCommand& command : m_commands)
+			m_sortScratch[offsets[(command.Key >> shift) & 0xFF]++] = command;
+
+		m_commands.swap(m_sortScratch);
+	}
+}
+
+uint64_t RenderCommandList::MakeKey(const RenderStateBlock& state, RenderMesh mesh, uint8_t level, uint32_t materialIndex, uint16_t depth)
+{
+	uint64_t key = static_cast<uint64_t>(state.Pass) << 62;
+
+	// Outlines are order dependent (see the class comment)
+	if (state.Pass == RenderPass::OUTLINE)
+		return key;
+
+	key |= static_cast<uint64_t>(static_cast<uint8_t>(state.Shader) & 0x7) << 59;
+	key |= static_cast<uint64_t>(static_cast<uint8_t>(state.Stencil) & 0x3) << 57;
+	key |= static_cast<uint64_t>(static_cast<uint8_t>(mesh) & 0x7) << 54;
+	key |= static_cast<uint64_t>(level & 0x7) << 51;
+	key |= static_cast<uint64_t>(materialIndex & 0xFFFF) << 35;
+	key |= static_cast<uint64_t>(depth) << 19;
+	return key;
+}
+
+uint16_t RenderCommandList::QuantizeDepth(const float model[4][4]) const
+{
+	// The translation is the last row of a row vector matrix
+	float dx = model[3][0] - m_eye[0];
+	float dy = model[3][1] - m_eye[1];
+	float dz = model[3][2] - m_eye[2];
+	float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+	float normalized = std::min(distance / m_farDistance, 1.0f);
+	return static_cast<uint16_t>(normalized * 65535.0f);
+}
+
+RenderTopology RenderCommandList::Topology(RenderMesh mesh)
+{
+	switch (mesh)
+	{
+	case RenderMesh::BOX:			return RenderTopology::LINE_LIST;
+	case RenderMesh::IMPOSTOR_QUAD:	return RenderTopology::TRIANGLE_STRIP;
+	default:						return RenderTopology::TRIANGLE_LIST;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Shaders a draw can use - the D3D11 backend maps each one to its vertex/pixel shader and input layout
+// (see SimulationRenderer::SetShaderMode)
+enum class ShaderMode : uint8_t
+{
+	PHONG,
+	PHONG_INSTANCED,			// Reads the atom instances
+	PHONG_INSTANCED_CYLINDER,	// Reads the bond cylinder instances
+	PHONG_INSTANCED_ARROW,		// Reads the velocity arrow instances
+	IMPOSTOR,					// Reads the atom instances
+	SOLID,
+	SELECTION_OUTLINE			// Full screen pass that reads the selection outline IDs written by the scene
+};
+
+enum class StencilMode : uint8_t
+{
+	NONE,
+	WRITE,
+	MASK,
+	DISABLED	// No depth or stencil test (full screen passes)
+};
+
+// Passes are submitted in this order
+enum class RenderPass : uint8_t
+{
+	SCENE,			// Everything that doesn't need special effects
+	STENCIL_MASK,	// Write the hovered/selected atoms and bonds to the stencil buffer
+	OUTLINE			// Draw the hovered/selected outlines where the stencil was not written, or the screen space
+					// outline pass (see OutlineMode)
+};
+
+enum class RenderMesh : uint8_t
+{
+	BOX,			// Simulation box edges - 24 vertex line list
+	SPHERE,
+	CYLINDER,
+	ARROW_CYLINDER,
+	ARROW_CONE,
+	IMPOSTOR_QUAD,			// 4 vertex strip generated in the vertex shader
+	FULLSCREEN_TRIANGLE		// 3 vertex triangle covering the viewport, generated in the vertex shader
+};
+
+enum class RenderTopology : uint8_t
+{
+	TRIANGLE_LIST,
+	TRIANGLE_STRIP,
+	LINE_LIST
+};
+
+// Pipeline state a command is drawn with
+struct RenderStateBlock
+{
+	RenderPass	Pass;
+	ShaderMode	Shader;
+	StencilMode	Stencil;
+};
+
+// Model matrix and material of a non-instanced draw. The matrix is row-major for row vectors (the
+// same layout as XMFLOAT4X4)
+struct RenderTransform
+{
+	float		Model[4][4];
+	uint32_t	MaterialIndex;
+};
+
+struct RenderCommand
+{
+	uint64_t			Key;
+	RenderStateBlock	State;
+	RenderMesh			Mesh;
+	uint8_t				Level;			// Level of detail (see MeshLevelOfDetail)
+
+	// Instanced draws - the range of the instance buffer the shader reads (atoms for PHONG_INSTANCED and
+	// IMPOSTOR, bond cylinders for PHONG_INSTANCED_CYLINDER, velocity arrows for PHONG_INSTANCED_ARROW)
+	uint32_t			FirstInstance;
+	uint32_t			InstanceCount;
+
+	// Non-instanced draws - index into Transforms(), NoTransform for instanced draws
+	uint32_t			Transform;
+};
+
+// Counted by the backend while it submits a frame, so the effect of sorting can be measured
+struct RenderStatistics
+{
+	uint32_t	Commands;
+	uint32_t	DrawCalls;
+	uint32_t	StateChanges;		// Shader, stencil, topology, mesh and instance buffer bindings that were applied
+	uint32_t	RedundantStates;	// ... that were skipped because they were already bound
+
+	bool operator==(const RenderStatistics& other) const
+	{
+		return Commands == other.Commands && DrawCalls == other.DrawCalls &&
+			StateChanges == other.StateChanges && RedundantStates == other.RedundantStates;
+	}
+	bool operator!=(const RenderStatistics& other) const { return !(*this == other); }
+};
+
+// The draws of one frame, recorded by the scene traversal and consumed by a backend (see
+// SimulationRenderer::SubmitCommands for the D3D11 one). Commands only refer to state by value and to
+// instance data by range, so the list has no dependency on the device and can be recorded or inspected
+// without one.
+//
+// Each command has a 64 bit key and Sort orders the commands by it, most significant field first:
+//		pass (2 bits) | shader (3) | stencil (2) | mesh (3) | level (3) | material (16) | depth (16) | unused (19)
+// so draws that share pipeline state, then mesh buffers, then material are adjacent, and within those
+// opaque draws go front to back. Depth is the distance from the eye (see SetEye) to the translation of
+// the model matrix - instanced draws have no single depth or material and use 0 for both.
+// The OUTLINE pass is drawn with depth testing off, so the last outline wins where two overlap - its
+// commands are only ordered by pass and keep the order they were recorded in.
+class RenderCommandList
+{
+public:
+	static constexpr uint32_t NoTransform = 0xFFFFFFFF;
+
+	void Clear();
+
+	// Eye position and far plane distance used to compute the depth field of the keys of Draw commands.
+	// Set this before recording. The eye is in the same space as the recorded model matrices (after SetOrigin)
+	void SetEye(const float eye[3], float farDistance);
+
+	// Draw rebases the translation of every model matrix on this origin (see CameraSpace), so commands can be
+	// recorded from world space model matrices and drawn camera relative. Cleared to the world origin by Clear
+	void SetOrigin(const double origin[3]);
+
+	void Draw(const RenderStateBlock& state, RenderMesh mesh, uint8_t level, const float model[4][4], uint32_t materialIndex);
+	void DrawInstanced(const RenderStateBlock& state, RenderMesh mesh, uint8_t level, uint32_t firstInstance, uint32_t instanceCount);
+
+	// Least significant digit radix sort - stable, so commands with the same key are submitted in the order
+	// they were recorded
+	void Sort();
+
+	const std::vector<RenderCommand>& Commands() const { return m_commands; }
+	const std::vector<RenderTransform>& Transforms() const { return m_transforms; }
+
+	static uint64_t MakeKey(const RenderStateBlock& state, RenderMesh mesh, uint8_t level, uint32_t materialIndex, uint16_t depth);
+	static RenderTopology Topology(RenderMesh mesh);
+
+private:
+	uint16_t QuantizeDepth(const float model[4][4]) const;
+
+	std::vector<RenderCommand>		m_commands;
+	std::vector<RenderCommand>		m_sortScratch;
+	std::vector<RenderTransform>	m_transforms;
+
+	float							m_eye[3] = { 0.0f, 0.0f, 0.0f };
+	double							m_origin[3] = { 0.0, 0.0, 0.0 };
+	float							m_farDistance = 1.0f;
+};
\ No newline at end of file
@@ -0,0 +1,4 @@
+#include "RenderScheduler.h"
+
+// Request the very first frame
+bool RenderScheduler::m_frameRequested = true;
\ No newline at end of file
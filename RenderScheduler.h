@@ -0,0 +1,32 @@
+#pragma once
+
+
+// Decides when a new frame is needed. Rendering and presenting is skipped unless something has called
+// Invalidate since the last frame, and App::Run sleeps in WaitMessage instead of spinning while nothing
+// needs to be drawn.
+//
+// The sources of change are:
+//		- Window messages that can change what is on screen (input, resizing, repainting) - see WindowBase::HandleMsg
+//		- The camera while it is moving - see SimulationRenderer::Update
+//		- The simulation while it is playing - see SimulationManager::Update
+//
+// Anything else that changes the screen outside of a window message (a timer, a worker thread, ...) must
+// call Invalidate itself. The 3D scene is redrawn in full when the frame is dirty; the 2D controls are
+// cached and only the parts in DeviceResources::UIDirtyRegion are redrawn.
+class RenderScheduler
+{
+public:
+	// Something visible changed - produce a new frame on the next pass through the render loop
+	static void Invalidate() { m_frameRequested = true; }
+
+	static bool FrameRequested() { return m_frameRequested; }
+
+	// Called right before rendering. Invalidations made while rendering request the following frame
+	static void BeginFrame() { m_frameRequested = false; }
+
+private:
+	// Disallow creation of a RenderScheduler object
+	RenderScheduler() {}
+
+	static bool m_frameRequested;
+};
\ No newline at end of file
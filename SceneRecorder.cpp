@@ -0,0 +1,145 @@
+#include "SceneRecorder.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+SceneRecorder::SceneRecorder() :
+	m_camera(),
+	m_viewProjection()
+{
+}
+
+float SceneRecorder::FarPlane(const double eye[3], const float boxDimensions[3])
+{
+	// Distance to the center plus half the diagonal bounds the distance to every corner. It is never 0, so
+	// the depth can always be divided by it (see RenderCommandList::QuantizeDepth)
+	double eyeDistance = std::sqrt(eye[0] * eye[0] + eye[1] * eye[1] + eye[2] * eye[2]);
+	double halfDiagonal = 0.5 * std::sqrt(static_cast<double>(boxDimensions[0]) * boxDimensions[0] +
+										  static_cast<double>(boxDimensions[1]) * boxDimensions[1] +
+										  static_cast<double>(boxDimensions[2]) * boxDimensions[2]);
+
+	return std::max(static_cast<float>(eyeDistance + halfDiagonal), 0.001f);
+}
+
+void SceneRecorder::Begin(const SceneCamera& camera)
+{
+	m_camera = camera;
+
+	// Everything is drawn relative to the eye, so the view-projection matrix has no translation
+	for (int row = 0; row < 4; ++row)
+	{
+		for (int column = 0; column < 4; ++column)
+		{
+			m_viewProjection[row][column] = camera.View[row][0] * camera.Projection[0][column] +
+											camera.View[row][1] * camera.Projection[1][column] +
+											camera.View[row][2] * camera.Projection[2][column] +
+											camera.View[row][3] * camera.Projection[3][column];
+		}
+	}
+
+	// Frustum used to skip atoms/bonds/arrows that are entirely off screen
+	m_frustum = Frustum::FromViewProjection(m_viewProjection);
+
+	// Nothing is drawn until the commands are submitted. The instances and model matrices are rebased on the
+	// eye as they are recorded, so the eye is the origin of the recorded draws
+	const float eyePosition[3] = { 0.0f, 0.0f, 0.0f };
+
+	m_commands.Clear();
+	m_commands.SetOrigin(m_camera.Eye);
+	m_commands.SetEye(eyePosition, m_camera.FarPlane);
+}
+
+void SceneRecorder::End()
+{
+	m_commands.Sort();
+}
+
+void SceneRecorder::DrawBox(const float dimensions[3], uint32_t materialIndex)
+{
+	const RenderStateBlock state = { RenderPass::SCENE, ShaderMode::PHONG, StencilMode::NONE };
+
+	// The unit box scaled to the box dimensions
+	float model[4][4] = {};
+	model[0][0] = dimensions[0];
+	model[1][1] = dimensions[1];
+	model[2][2] = dimensions[2];
+	model[3][3] = 1.0f;
+
+	m_commands.Draw(state, RenderMesh::BOX, 0, model, materialIndex);
+}
+
+void SceneRecorder::DrawScreenSpaceOutline()
+{
+	const RenderStateBlock state = { RenderPass::OUTLINE, ShaderMode::SELECTION_OUTLINE, StencilMode::DISABLED };
+	m_commands.DrawInstanced(state, RenderMesh::FULLSCREEN_TRIANGLE, 0, 0, 1);
+}
+
+void SceneRecorder::RecordAtoms(AtomRenderMode mode)
+{
+	// Drop the atoms that are off screen
+	m_atoms.Rebase(m_camera.Eye);
+	m_atoms.Cull(m_frustum);
+
+	if (mode == AtomRenderMode::IMPOSTOR)
+	{
+		// The quad vertices are generated in the vertex shader and the spheres are ray traced in the pixel shader.
+		// Impostors have no level of detail and the material index is part of the instance data, so every
+		// atom is drawn with a single draw
+		const RenderStateBlock state = { RenderPass::SCENE, ShaderMode::IMPOSTOR, StencilMode::NONE };
+		m_commands.DrawInstanced(state, RenderMesh::IMPOSTOR_QUAD, 0, 0, static_cast<uint32_t>(m_atoms.Instances().size()));
+		return;
+	}
+
+	// Impostors are exact at any size, so only the mesh path needs a level of detail. The instances are camera
+	// relative, so the eye is at the origin
+	const float eyePosition[3] = { 0.0f, 0.0f, 0.0f };
+	m_atoms.AssignLevels(eyePosition, m_camera.PixelsPerUnit);
+
+	// Do not write to the stencil buffer and use instanced Phong shading
+	const RenderStateBlock state = { RenderPass::SCENE, ShaderMode::PHONG_INSTANCED, StencilMode::NONE };
+
+	// One draw per element and level of detail. The material index is part of the instance data
+	for (const AtomInstanceBatch& batch : m_atoms.Batches())
+		m_commands.DrawInstanced(state, RenderMesh::SPHERE, static_cast<uint8_t>(batch.Level), batch.FirstInstance, batch.InstanceCount);
+}
+
+void SceneRecorder::RecordVelocityArrows()
+{
+	// Drop the arrows that are off screen. The orientation and length of each arrow are computed in the vertex
+	// shader from the atom's velocity. The arrows are camera relative, so the eye is at the origin
+	const float eyePosition[3] = { 0.0f, 0.0f, 0.0f };
+
+	m_arrows.Rebase(m_camera.Eye);
+	m_arrows.Cull(m_frustum);
+	m_arrows.AssignLevels(eyePosition, m_camera.PixelsPerUnit);
+
+	// Do not write to the stencil buffer and use instanced Phong shading
+	const RenderStateBlock state = { RenderPass::SCENE, ShaderMode::PHONG_INSTANCED_ARROW, StencilMode::NONE };
+
+	for (const VelocityArrowBatch& batch : m_arrows.Batches())
+	{
+		m_commands.DrawInstanced(state, RenderMesh::ARROW_CYLINDER, static_cast<uint8_t>(batch.Level), batch.FirstInstance, batch.InstanceCount);
+		m_commands.DrawInstanced(state, RenderMesh::ARROW_CONE, static_cast<uint8_t>(batch.Level), batch.FirstInstance, batch.InstanceCount);
+	}
+}
+
+void SceneRecorder::RecordBonds(float cylinderRadius)
+{
+	// Compute every half-bond cylinder in one pass, grouped by element. The bonds are separated using the
+	// world space eye, then everything else is camera relative
+	const float eyePosition[3] = { static_cast<float>(m_camera.Eye[0]), static_cast<float>(m_camera.Eye[1]), static_cast<float>(m_camera.Eye[2]) };
+	const float relativeEyePosition[3] = { 0.0f, 0.0f, 0.0f };
+
+	m_bonds.Rebase(m_camera.Eye);
+	m_bonds.Generate(eyePosition, cylinderRadius);
+	m_bonds.Cull(m_frustum);
+	m_bonds.AssignLevels(relativeEyePosition, m_camera.PixelsPerUnit);
+
+	// Do not write to the stencil buffer and use instanced Phong shading
+	const RenderStateBlock state = { RenderPass::SCENE, ShaderMode::PHONG_INSTANCED_CYLINDER, StencilMode::NONE };
+
+	// One draw per element and level of detail. The material index is part of the instance data
+	for (const BondCylinderBatch& batch : m_bonds.Batches())
+		m_commands.DrawInstanced(state, RenderMesh::CYLINDER, static_cast<uint8_t>(batch.Level), batch.FirstInstance, batch.InstanceCount);
+}
\ No newline at end of file
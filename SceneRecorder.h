@@ -0,0 +1,123 @@
+#pragma once
+
+#include "AtomInstancePacker.h"
+#include "BondGeometry.h"
+#include "Frustum.h"
+#include "RenderCommandList.h"
+#include "VelocityArrowPacker.h"
+
+#include <cstdint>
+#include <vector>
+
+// How atoms are drawn in the main render pass (hover/selection outlines always use the sphere mesh)
+enum class AtomRenderMode
+{
+	MESH,		// Instanced sphere mesh
+	IMPOSTOR	// Camera facing quad per atom, sphere is ray traced in the pixel shader
+};
+
+// Camera a frame is recorded for. Matrices are row-major for row vectors (the same layout as XMFLOAT4X4)
+struct SceneCamera
+{
+	double	Eye[3];					// World space - everything is recorded relative to it (see CameraSpace)
+	float	View[4][4];				// Camera relative view - the rotation of the view matrix only
+	float	Projection[4][4];		// Reverse Z (see CameraSpace::ReverseZPerspective)
+	float	PixelsPerUnit;			// See MeshLevelOfDetail::ScreenRadius
+	float	FarPlane;				// Not a clip plane - only used to quantize the depth of the draw keys (see FarPlane)
+};
+
+// Records the scene pass of a frame - the simulation box, the atoms, their velocity arrows and the bonds -
+// into a RenderCommandList, packing and culling the instances the commands refer to on the way. This is
+// the scene traversal of SimulationRenderer without the device, so it can be run against a software
+// backend (see SoftwareRasterizer), compared against golden images and timed on any platform.
+//
+// A frame is recorded between Begin and End. The Draw functions can be called in any order; End sorts the
+// commands (see RenderCommandList::Sort). Draws that are not part of the scene traversal (e.g. the stencil
+// outlines of SimulationRenderer) are recorded straight into Commands() with the same origin and eye.
+//
+// The Draw functions are templates so they work for any atom and bond types the packers accept (see
+// AtomInstancePacker, VelocityArrowPacker and BondGeometry).
+class SceneRecorder
+{
+public:
+	SceneRecorder();
+
+	// Distance from 'eye' (world space) to the farthest point a box of 'boxDimensions' centered on the world
+	// origin can have - the far plane that spreads the quantized depth of the draw keys over the whole box
+	static float FarPlane(const double eye[3], const float boxDimensions[3]);
+
+	// Clear the commands and set up the origin, eye, view-projection and frustum for 'camera'
+	void Begin(const SceneCamera& camera);
+
+	// Sort the commands so the backend can skip redundant state changes
+	void End();
+
+	// Edges of the simulation box, centered on the world origin
+	void DrawBox(const float dimensions[3], uint32_t materialIndex);
+
+	// One draw per element and level of detail (MESH) or a single draw for every atom (IMPOSTOR). 'outline'
+	// returns the selection outline ID of each atom (see SelectionOutline)
+	template<typename TAtomPointer>
+	void DrawAtoms(const std::vector<TAtomPointer>& atoms, AtomRenderMode mode)
+	{
+		m_atoms.Pack(atoms);
+		RecordAtoms(mode);
+	}
+	template<typename TAtomPointer, typename TOutline>
+	void DrawAtoms(const std::vector<TAtomPointer>& atoms, AtomRenderMode mode, TOutline outline)
+	{
+		m_atoms.Pack(atoms, outline);
+		RecordAtoms(mode);
+	}
+
+	// Two draws (shaft and head) per level of detail, however many arrows there are
+	template<typename TAtomPointer>
+	void DrawVelocityArrows(const std::vector<TAtomPointer>& atoms, uint32_t materialIndex)
+	{
+		m_arrows.Pack(atoms, materialIndex);
+		RecordVelocityArrows();
+	}
+
+	// One draw per element and level of detail. See DrawAtoms for 'outline'
+	template<typename TBondPointer>
+	void DrawBonds(const std::vector<TBondPointer>& bonds, float cylinderRadius)
+	{
+		m_bonds.Pack(bonds);
+		RecordBonds(cylinderRadius);
+	}
+	template<typename TBondPointer, typename TOutline>
+	void DrawBonds(const std::vector<TBondPointer>& bonds, float cylinderRadius, TOutline outline)
+	{
+		m_bonds.Pack(bonds, outline);
+		RecordBonds(cylinderRadius);
+	}
+
+	// The full screen pass that draws the outlines from the IDs written by the scene (see OutlineMode)
+	void DrawScreenSpaceOutline();
+
+	RenderCommandList& Commands() { return m_commands; }
+	const RenderCommandList& Commands() const { return m_commands; }
+
+	// The instances the commands refer to, relative to Origin()
+	const AtomInstancePacker& Atoms() const { return m_atoms; }
+	const BondGeometry& Bonds() const { return m_bonds; }
+	const VelocityArrowPacker& Arrows() const { return m_arrows; }
+
+	const double* Origin() const { return m_camera.Eye; }
+	const float (*ViewProjection() const)[4] { return m_viewProjection; }
+	const Frustum& ViewFrustum() const { return m_frustum; }
+
+private:
+	void RecordAtoms(AtomRenderMode mode);
+	void RecordVelocityArrows();
+	void RecordBonds(float cylinderRadius);
+
+	SceneCamera				m_camera;
+	float					m_viewProjection[4][4];
+	Frustum					m_frustum;
+
+	RenderCommandList		m_commands;
+	AtomInstancePacker		m_atoms;
+	BondGeometry			m_bonds;
+	VelocityArrowPacker		m_arrows;
+};
\ No newline at end of file
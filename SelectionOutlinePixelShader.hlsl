@@ -0,0 +1,54 @@
+#include "PhongLighting.hlsli"
+
+// Screen space selection outline. The scene writes the selection outline ID of every pixel to an R8_UINT
+// target (see SelectionOutline in HLSLStructures.h), and this pass draws the outline in a single full screen
+// pass: every pixel that is not part of an outlined object looks for outlined pixels within the outline
+// radius, and takes the color of the highest ID it finds. Pixels with nothing nearby are discarded.
+
+// Must match SelectionOutlineConstantBuffer in HLSLStructures.h
+cbuffer SelectionOutlineConstantBuffer : register(b0)
+{
+	uint4 outlineMaterialIndex;		// Indexed by outline ID (0 is unused)
+	int radius;						// Pixels
+	uint3 padding;
+};
+
+Texture2D<uint> OutlineIDs : register(t1);
+
+
+float4 main(float4 position : SV_POSITION) : SV_TARGET
+{
+	int2 pixel = int2(position.xy);
+
+	// The outline is drawn around the object, never on top of it
+	if (OutlineIDs.Load(int3(pixel, 0)) != 0)
+		discard;
+
+	uint width, height;
+	OutlineIDs.GetDimensions(width, height);
+	int2 maxPixel = int2(width, height) - 1;
+
+	uint outline = 0;
+	int radiusSquared = radius * radius;
+
+	[loop]
+	for (int y = -radius; y <= radius; ++y)
+	{
+		[loop]
+		for (int x = -radius; x <= radius; ++x)
+		{
+			// Search a disc so the outline has round corners and the same width in every direction
+			if (x * x + y * y > radiusSquared)
+				continue;
+
+			int2 neighbor = clamp(pixel + int2(x, y), int2(0, 0), maxPixel);
+			outline = max(outline, OutlineIDs.Load(int3(neighbor, 0)));
+		}
+	}
+
+	if (outline == 0)
+		discard;
+
+	// Solid colors are stored in the material table as the emissive color (see MaterialTable::AddSolidColor)
+	return Materials[outlineMaterialIndex[outline]].Emissive;
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Set of selected objects keyed by their handle (T::Handle(), see HandleAllocator).
+//
+// Membership is a bitset over the handles, so Contains/Insert/Erase are O(1) no matter how many objects
+// are selected. The selected objects are also kept in a vector so they can be iterated (for drawing
+// outlines). Erase swaps the last item into the hole using a handle -> position table, so the order of
+// Items() is not the selection order.
+//
+// The set holds a shared_ptr to each item, so an item's handle cannot be released and reused while the
+// item is still selected.
+template<typename T>
+class SelectionSet
+{
+public:
+	bool Contains(const std::shared_ptr<T>& item) const
+	{
+		if (item == nullptr)
+			return false;
+
+		uint32_t handle = item->Handle();
+		size_t word = handle / 64;
+		return word < m_bits.size() && ((m_bits[word] >> (handle % 64)) & 1) != 0;
+	}
+
+	// Returns false if the item was already selected
+	bool Insert(const std::shared_ptr<T>& item)
+	{
+		if (item == nullptr || Contains(item))
+			return false;
+
+		uint32_t handle = item->Handle();
+		if (handle / 64 >= m_bits.size())
+			m_bits.resize(handle / 64 + 1, 0);
+		if (handle >= m_positions.size())
+			m_positions.resize(static_cast<size_t>(handle) + 1, 0);
+
+		m_bits[handle / 64] |= uint64_t(1) << (handle % 64);
+		m_positions[handle] = static_cast<uint32_t>(m_items.size());
+		m_items.push_back(item);
+		return true;
+	}
+
+	// Returns false if the item was not selected
+	bool Erase(const std::shared_ptr<T>& item)
+	{
+		if (!Contains(item))
+			return false;
+
+		uint32_t handle = item->Handle();
+		uint32_t position = m_positions[handle];
+
+		m_items[position] = std::move(m_items.back());
+		m_positions[m_items[position]->Handle()] = position;
+		m_items.pop_back();
+
+		m_bits[handle / 64] &= ~(uint64_t(1) << (handle % 64));
+		return true;
+	}
+
+	void Clear()
+	{
+		// Only the words that have a bit set need to be cleared
+		for (const std::shared_ptr<T>& item : m_items)
+			m_bits[item->Handle() / 64] = 0;
+		m_items.clear();
+	}
+
+	size_t Count() const { return m_items.size(); }
+	bool Empty() const { return m_items.empty(); }
+
+	const std::vector<std::shared_ptr<T>>& Items() const { return m_items; }
+
+private:
+	std::vector<uint64_t>			m_bits;			// Bit h is set if the item with handle h is selected
+	std::vector<uint32_t>			m_positions;	// Position in m_items of the item with handle h (only valid if selected)
+	std::vector<std::shared_ptr<T>>	m_items;
+};
\ No newline at end of file
@@ -1,15 +1,18 @@
 #include "Simulation.h"
 
-using DirectX::XMFLOAT3;
+#include <algorithm>
 
+using DirectX::XMFLOAT3;
 
 
-Simulation::Simulation(const std::shared_ptr<DeviceResources>& deviceResources) :
+Simulation::Simulation() :
 	m_boxDimensions({ 2.0f, 2.0f, 2.0f }),
 	m_boxVisible(true),
 	m_elapsedTime(0.0f),
-	m_paused(true),
-	m_deviceResources(deviceResources)
+	m_fixedTimeStep(0.0),
+	m_atomHandleAllocator(std::make_shared<HandleAllocator>()),
+	m_bondHandleAllocator(std::make_shared<HandleAllocator>()),
+	m_paused(true)
 {
 }
 
@@ -90,7 +93,7 @@ void Simulation::RemoveAllAtoms()
 
 std::shared_ptr<Bond> Simulation::CreateBond(const std::shared_ptr<Atom>& atom1, const std::shared_ptr<Atom>& atom2)
 {
-	std::shared_ptr<Bond> bond = std::make_shared<Bond>(atom1, atom2);
+	std::shared_ptr<Bond> bond = std::make_shared<Bond>(m_bondHandleAllocator, atom1, atom2);
 	m_bonds.push_back(bond);
 	atom1->AddBond(bond);
 	atom2->AddBond(bond);
@@ -184,78 +187,99 @@ void Simulation::Update(StepTimer const& timer)
 		// if the elapsed time is -1, then the simulation was just unpaused
 		// and we need to refresh the time
 		if (m_elapsedTime == -1.0f)
+		{
 			m_elapsedTime = static_cast<float>(timer.GetTotalSeconds());
 
+			// Atoms may have been edited while paused, so the event-driven engine must start over
+			m_dynamics.Invalidate();
+		}
+
 		double currentTime = timer.GetTotalSeconds();
 		double timeDelta = currentTime - m_elapsedTime;
 
-		// We probably don't want to simply run the update method without
-		// passing along knowledge of the locations of other atoms
-		// You probably want a read only buffer of all atom locations that
-		// gets passed to the update call for each atom and is later updated
-		// once all atoms have been updated
-
-		for (std::shared_ptr<Atom> atom : m_atoms)
-			atom->Update(timeDelta, m_atoms, m_boxDimensions);
-
-		// The update procedure currently only updates position and takes account of the simulation wall
-		// Here, we need to make updates to account for elastic collisions with other atoms
-		// This is temporary however, because we will need to move past elastic collisions to simulate
-		// real physics
-		// See here for math explanation: https://exploratoria.github.io/exhibits/mechanics/elastic-collisions-in-3d/
-
-		XMFLOAT3 d; // distance between atoms
-		float mag;  // magnitude of the distance vector
-		XMFLOAT3 n; // normal vector between balls
-		XMFLOAT3 vrel; // relative velocity between the atoms
-		XMFLOAT3 vnorm; // relative velocity along the normal direction
-		float vreldotnorm; // the dot product between vrel and vnorm
-		XMFLOAT3 newV1, newV2; // new velocity vectors post-collision
-		for (unsigned int iii = 0; iii < m_atoms.size(); ++iii)
+		// In deterministic mode, ignore the wall clock and always advance by exactly the fixed step
+		// so every run produces the same trajectory regardless of frame rate
+		if (m_fixedTimeStep > 0.0)
+			timeDelta = m_fixedTimeStep;
+
+		Step(timeDelta);
+
+		m_elapsedTime = static_cast<float>(currentTime);
+	}
+}
+
+void Simulation::Step(double timeDelta)
+{
+	GatherState();
+	m_dynamics.Step(timeDelta);
+	ScatterState();
+
+	m_observables = m_dynamics.Observables();
+	m_observablesHistory.Push(m_observables);
+}
+
+uint64_t Simulation::StateHash()
+{
+	GatherState();
+	return m_dynamics.StateHash();
+}
+
+void Simulation::AddRandomAtoms(unsigned int count, unsigned int seed, float maxSpeed)
+{
+	// The state generates the atoms (so headless runs get exactly the same ones) and each atom it
+	// places is mirrored here at the same index
+	GatherState();
+	m_dynamics.State().AddRandom(count, seed, maxSpeed, [this](uint32_t element, Float3 p, Float3 v)
+	{
+		XMFLOAT3 position(p.x, p.y, p.z);
+		XMFLOAT3 velocity(v.x, v.y, v.z);
+
+		switch (element)
 		{
-			for (unsigned int jjj = iii + 1; jjj < m_atoms.size(); ++jjj)
-			{
-				// check distance between the two atoms
-				// currently assuming a radius of 1 and identical masses
-				d.x = m_atoms[iii]->Position().x - m_atoms[jjj]->Position().x;
-				d.y = m_atoms[iii]->Position().y - m_atoms[jjj]->Position().y;
-				d.z = m_atoms[iii]->Position().z - m_atoms[jjj]->Position().z;
-
-				mag = std::sqrt(d.x * d.x + d.y * d.y + d.z * d.z);
-				if (mag < m_atoms[iii]->Radius() + m_atoms[jjj]->Radius()) // assume radius for each atom is 1
-				{
-					// compute a normalized normal vector between the atoms
-					n.x = d.x / mag;
-					n.y = d.y / mag;
-					n.z = d.z / mag;
-
-					// compute the relative velocity between the atoms
-					vrel.x = m_atoms[iii]->Velocity().x - m_atoms[jjj]->Velocity().x;
-					vrel.y = m_atoms[iii]->Velocity().y - m_atoms[jjj]->Velocity().y;
-					vrel.z = m_atoms[iii]->Velocity().z - m_atoms[jjj]->Velocity().z;
-
-					// compute the relative velocity along the normal direction;
-					vreldotnorm = vrel.x * n.x + vrel.y * n.y + vrel.z * n.z;
-					vnorm.x = vreldotnorm * n.x;
-					vnorm.y = vreldotnorm * n.y;
-					vnorm.z = vreldotnorm * n.z;
-
-					// exchange normal velocities
-					newV1.x = m_atoms[iii]->Velocity().x - vnorm.x;
-					newV1.y = m_atoms[iii]->Velocity().y - vnorm.y;
-					newV1.z = m_atoms[iii]->Velocity().z - vnorm.z;
-					m_atoms[iii]->Velocity(newV1);
-
-					newV2.x = m_atoms[jjj]->Velocity().x + vnorm.x;
-					newV2.y = m_atoms[jjj]->Velocity().y + vnorm.y;
-					newV2.z = m_atoms[jjj]->Velocity().z + vnorm.z;
-					m_atoms[jjj]->Velocity(newV2);
-				}
-			}
+		case Element::HYDROGEN:		AddNewAtom<Hydrogen>(position, velocity); break;
+		case Element::HELIUM:		AddNewAtom<Helium>(position, velocity); break;
+		case Element::LITHIUM:		AddNewAtom<Lithium>(position, velocity); break;
+		case Element::BERYLLIUM:	AddNewAtom<Beryllium>(position, velocity); break;
+		case Element::BORON:		AddNewAtom<Boron>(position, velocity); break;
+		case Element::CARBON:		AddNewAtom<Carbon>(position, velocity); break;
+		case Element::NITROGEN:		AddNewAtom<Nitrogen>(position, velocity); break;
+		case Element::OXYGEN:		AddNewAtom<Oxygen>(position, velocity); break;
+		case Element::FLOURINE:		AddNewAtom<Flourine>(position, velocity); break;
+		case Element::NEON:			AddNewAtom<Neon>(position, velocity); break;
 		}
+	});
 
-		m_elapsedTime = static_cast<float>(currentTime);
+	m_dynamics.Invalidate();
+}
+
+void Simulation::GatherState()
+{
+	HardSphereState& state = m_dynamics.State();
+	state.Resize(m_atoms.size());
+	state.BoxDimensions = Float3{ m_boxDimensions.x, m_boxDimensions.y, m_boxDimensions.z };
 
+	XMFLOAT3 p, v;
+	for (size_t iii = 0; iii < m_atoms.size(); ++iii)
+	{
+		p = m_atoms[iii]->Position();
+		v = m_atoms[iii]->Velocity();
+
+		state.Elements[iii] = static_cast<uint32_t>(m_atoms[iii]->ElementType());
+		state.Positions[iii] = Float3{ p.x, p.y, p.z };
+		state.Velocities[iii] = Float3{ v.x, v.y, v.z };
+		state.Radii[iii] = m_atoms[iii]->Radius();
+		state.Masses[iii] = m_atoms[iii]->Mass();
+	}
+}
+
+void Simulation::ScatterState()
+{
+	const HardSphereState& state = m_dynamics.State();
+
+	for (size_t iii = 0; iii < m_atoms.size(); ++iii)
+	{
+		m_atoms[iii]->Position(XMFLOAT3(state.Positions[iii].x, state.Positions[iii].y, state.Positions[iii].z));
+		m_atoms[iii]->Velocity(XMFLOAT3(state.Velocities[iii].x, state.Velocities[iii].y, state.Velocities[iii].z));
 	}
 }
 
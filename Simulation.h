@@ -4,18 +4,19 @@
 #include "Atom.h"
 #include "Bond.h"
 #include "Elements.h"
+#include "HardSphereDynamics.h"
 #include "MeshManager.h"
+#include "SimulationObservables.h"
 #include "StepTimer.h"
 
 #include <cmath>
 #include <vector>
 #include <memory>
 
-
 class Simulation
 {
 public:
-	Simulation(const std::shared_ptr<DeviceResources>& deviceResources);
+	Simulation();
 
 	void DestroyBonds()
 	{
@@ -52,6 +53,17 @@ public:
 	void ResetSimulation(); // Reset the simulation state to where it was before ever pressing Play
 
 	void Update(StepTimer const& timer);
+
+	// Advance the simulation by exactly timeDelta, independent of any timer. Used by Update and by
+	// deterministic/batch runs (see GoldenTrajectory). The physics itself lives in HardSphereDynamics
+	void Step(double timeDelta);
+
+	// Hash of the full atom state (element, position, velocity bits in atom order) and the box
+	uint64_t StateHash();
+
+	// Add 'count' atoms with random elements, positions and velocities generated from 'seed'. The
+	// same seed always produces the same atoms on every platform.
+	void AddRandomAtoms(unsigned int count, unsigned int seed, float maxSpeed);
 	void SwitchPlayPause() { m_paused = !m_paused; if (m_paused) m_elapsedTime = -1.0f; }
 
 	int GetAtomIndex(std::shared_ptr<Atom> atom);
@@ -82,7 +94,18 @@ public:
 
 	bool		BoxVisible() { return m_boxVisible; }
 
+	UpdateMode	GetUpdateMode() { return m_dynamics.GetUpdateMode(); }
+
 	float		ElapsedTime() { return m_elapsedTime; }
+	double		SimulationTime() { return m_dynamics.Time(); }
+
+	// Deterministic mode: when > 0, Update ignores the timer and advances by exactly this much
+	double		FixedTimeStep() { return m_fixedTimeStep; }
+
+	// Observables from the most recent step and the rolling history of previous steps
+	const SimulationObservables& Observables() { return m_observables; }
+	const ObservablesHistory& GetObservablesHistory() { return m_observablesHistory; }
+	void ClearObservablesHistory() { m_observablesHistory.Clear(); }
 
 	// SET
 	void BoxDimensions(DirectX::XMFLOAT3 dimensions) { m_boxDimensions = dimensions; }
@@ -90,13 +113,17 @@ public:
 
 	void BoxVisible(bool visible) { m_boxVisible = visible; }
 
+	void SetUpdateMode(UpdateMode mode) { m_dynamics.SetUpdateMode(mode); }
+
 	void ElapsedTime(float time) { m_elapsedTime = time; }
+	void FixedTimeStep(double timeStep) { m_fixedTimeStep = timeStep; }
 
 
 
 private:
-
-	std::shared_ptr<DeviceResources> m_deviceResources;
+	// Copy the atoms and the box into the physics state, and the stepped positions/velocities back out
+	void GatherState();
+	void ScatterState();
 
 	// Box
 	DirectX::XMFLOAT3	m_boxDimensions;		// 3 floats to hold the MAX x,y,z dimensions for the simulation box (ex. if x = 10, then x-axis = [-10, 10])
@@ -104,6 +131,11 @@ private:
 
 	// Time
 	float		m_elapsedTime;
+	double		m_fixedTimeStep;	// 0 -> use the timer
+
+	// Observables (energy, temperature, momentum)
+	SimulationObservables	m_observables;
+	ObservablesHistory		m_observablesHistory;
 
 	// Atoms
 	std::vector<std::shared_ptr<Atom>> m_atoms;			// List of Atoms active in the simulation
@@ -111,17 +143,25 @@ private:
 	// Keep separate list of bonds so they can be rendered without having to go through the atoms
 	std::vector<std::shared_ptr<Bond>> m_bonds;
 
+	// Handles for this simulation's atoms and bonds. Owned per simulation (not static) so simulations
+	// in an ensemble can create atoms on different threads
+	std::shared_ptr<HandleAllocator> m_atomHandleAllocator;
+	std::shared_ptr<HandleAllocator> m_bondHandleAllocator;
+
 
 	// State
 	bool m_paused;
 
+	// Physics - works on a flat copy of the atoms so it can also run headless (see HardSphereDynamics)
+	HardSphereDynamics	m_dynamics;
+
 
 };
 
 template<typename T>
 std::shared_ptr<T> Simulation::AddNewAtom(DirectX::XMFLOAT3 position, DirectX::XMFLOAT3 velocity)
 {
-	std::shared_ptr<T> atom = std::make_shared<T>(m_deviceResources, position, velocity);
+	std::shared_ptr<T> atom = std::make_shared<T>(m_atomHandleAllocator, position, velocity);
 	atom->SetSphereMesh(MeshManager::GetSphereMesh());
 	atom->SetArrowMesh(MeshManager::GetArrowMesh());
 	
@@ -0,0 +1,51 @@
+#include "SimulationEnsemble.h"
+
+
+SimulationEnsemble::SimulationEnsemble(unsigned int threadCount) :
+	m_threadPool(threadCount)
+{
+}
+
+void SimulationEnsemble::AddSimulations(unsigned int count, const std::function<void(HardSphereDynamics&, unsigned int)>& configure)
+{
+	size_t first = m_simulations.size();
+
+	// Allocate up front so the workers never resize the vector
+	m_simulations.reserve(first + count);
+	for (unsigned int iii = 0; iii < count; ++iii)
+		m_simulations.push_back(std::make_unique<HardSphereDynamics>());
+
+	m_threadPool.ParallelFor(count, [this, first, &configure](size_t iii)
+	{
+		configure(*m_simulations[first + iii], static_cast<unsigned int>(first + iii));
+	});
+}
+
+void SimulationEnsemble::Run(double timeStep, unsigned int steps)
+{
+	m_threadPool.ParallelFor(m_simulations.size(), [this, timeStep, steps](size_t iii)
+	{
+		HardSphereDynamics& simulation = *m_simulations[iii];
+		for (unsigned int step = 0; step < steps; ++step)
+			simulation.Step(timeStep);
+	});
+}
+
+void SimulationEnsemble::ForEach(const std::function<void(HardSphereDynamics&, unsigned int)>& function)
+{
+	m_threadPool.ParallelFor(m_simulations.size(), [this, &function](size_t iii)
+	{
+		function(*m_simulations[iii], static_cast<unsigned int>(iii));
+	});
+}
+
+std::vector<SimulationObservables> SimulationEnsemble::Observables()
+{
+	std::vector<SimulationObservables> observables;
+	observables.reserve(m_simulations.size());
+
+	for (const std::unique_ptr<HardSphereDynamics>& simulation : m_simulations)
+		observables.push_back(simulation->Observables());
+
+	return observables;
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "HardSphereDynamics.h"
+#include "SimulationObservables.h"
+#include "ThreadPool.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+// A set of independent simulations (parameter sweeps, replica runs, ...) that are stepped in parallel
+// on a thread pool. Each simulation is usually far too small to be worth parallelizing internally,
+// so instead every simulation runs single threaded and the pool spreads whole simulations across the
+// cores.
+//
+// The members are HardSphereDynamics - the physics of Simulation without the atoms, the renderer or the
+// window - so an ensemble runs headless. Simulations in an ensemble never touch each other and the only
+// state they share is the read-only element tables in Constants, so every member ends up in the same
+// state (see StateHash) however many threads the ensemble runs on.
+class SimulationEnsemble
+{
+public:
+	// threadCount = 0 -> one worker per hardware thread
+	SimulationEnsemble(unsigned int threadCount = 0);
+
+	// Create 'count' new simulations and call configure(simulation, index) on each of them in
+	// parallel, where index is the position of the simulation in the ensemble
+	void AddSimulations(unsigned int count, const std::function<void(HardSphereDynamics&, unsigned int)>& configure);
+	void Clear() { m_simulations.clear(); }
+
+	// Advance every simulation by 'steps' steps of exactly 'timeStep'
+	void Run(double timeStep, unsigned int steps);
+
+	// Call function(simulation, index) on every simulation in parallel (e.g. to collect results)
+	void ForEach(const std::function<void(HardSphereDynamics&, unsigned int)>& function);
+
+	// Latest observables of every simulation, in ensemble order
+	std::vector<SimulationObservables> Observables();
+
+	unsigned int Size() { return static_cast<unsigned int>(m_simulations.size()); }
+	HardSphereDynamics& At(unsigned int index) { return *m_simulations[index]; }
+	unsigned int ThreadCount() { return m_threadPool.ThreadCount(); }
+
+private:
+	std::vector<std::unique_ptr<HardSphereDynamics>>	m_simulations;
+	ThreadPool											m_threadPool;
+};
\ No newline at end of file
@@ -14,8 +14,8 @@ bool SimulationManager::m_bondAlreadyExisted = false;
 std::shared_ptr<Atom> SimulationManager::m_primarySelectedAtom = nullptr;
 std::shared_ptr<Bond> SimulationManager::m_primarySelectedBond = nullptr;
 
-std::vector<std::shared_ptr<Atom>> SimulationManager::m_selectedAtoms = std::vector<std::shared_ptr<Atom>>();
-std::vector<std::shared_ptr<Bond>> SimulationManager::m_selectedBonds = std::vector<std::shared_ptr<Bond>>();
+SelectionSet<Atom> SimulationManager::m_selectedAtoms = SelectionSet<Atom>();
+SelectionSet<Bond> SimulationManager::m_selectedBonds = SelectionSet<Bond>();
 
 std::function<void(bool)> SimulationManager::PlayPauseChangedEvent = [](bool value) {};
 std::function<void(std::shared_ptr<Atom>)> SimulationManager::AtomHoveredOverChangedEvent = [](std::shared_ptr<Atom> atom) {};
@@ -274,70 +274,40 @@ void SimulationManager::SetPrimarySelectedBond(std::shared_ptr<Bond> bond)
 
 bool SimulationManager::AtomIsSelected(std::shared_ptr<Atom> atom)
 {
-	for (std::shared_ptr<Atom> a : m_selectedAtoms)
-	{
-		if (a == atom)
-			return true;
-	}
-	return false;
+	return m_selectedAtoms.Contains(atom);
 }
 bool SimulationManager::BondIsSelected(std::shared_ptr<Bond> bond)
 {
-	for (std::shared_ptr<Bond> b : m_selectedBonds)
-	{
-		if (b == bond)
-			return true;
-	}
-	return false;
+	return m_selectedBonds.Contains(bond);
 }
 
 void SimulationManager::SelectAtom(std::shared_ptr<Atom> atom)
 {
-	if (!SimulationManager::AtomIsSelected(atom))
-		m_selectedAtoms.push_back(atom);
+	m_selectedAtoms.Insert(atom);
 }
 void SimulationManager::SelectBond(std::shared_ptr<Bond> bond)
 {
-	if (!SimulationManager::BondIsSelected(bond))
-		m_selectedBonds.push_back(bond);
+	m_selectedBonds.Insert(bond);
 }
 
 void SimulationManager::UnselectAtom(std::shared_ptr<Atom> atom)
 {
-	for (unsigned int iii = 0; iii < m_selectedAtoms.size(); ++iii)
-	{
-		if (m_selectedAtoms[iii] == atom)
-		{
-			m_selectedAtoms.erase(m_selectedAtoms.begin() + iii);
-			return;
-		}
-	}
+	m_selectedAtoms.Erase(atom);
 }
 void SimulationManager::UnselectBond(std::shared_ptr<Bond> bond)
 {
-	for (unsigned int iii = 0; iii < m_selectedBonds.size(); ++iii)
-	{
-		if (m_selectedBonds[iii] == bond)
-		{
-			m_selectedBonds.erase(m_selectedBonds.begin() + iii);
-			return;
-		}
-	}
+	m_selectedBonds.Erase(bond);
 }
 
 void SimulationManager::SwitchAtomSelectedUnselected(std::shared_ptr<Atom> atom)
 {
-	if (SimulationManager::AtomIsSelected(atom))
-		SimulationManager::UnselectAtom(atom);
-	else
-		m_selectedAtoms.push_back(atom);
+	if (!m_selectedAtoms.Erase(atom))
+		m_selectedAtoms.Insert(atom);
 }
 void SimulationManager::SwitchBondSelectedUnselected(std::shared_ptr<Bond> bond)
 {
-	if (SimulationManager::BondIsSelected(bond))
-		SimulationManager::UnselectBond(bond);
-	else
-		m_selectedBonds.push_back(bond);
+	if (!m_selectedBonds.Erase(bond))
+		m_selectedBonds.Insert(bond);
 }
 
 void SimulationManager::RemoveAllAtoms()
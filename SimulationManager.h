@@ -2,6 +2,8 @@
 #include "pch.h"
 
 #include "Bond.h"
+#include "RenderScheduler.h"
+#include "SelectionSet.h"
 #include "Simulation.h"
 
 #include <functional>
@@ -21,9 +23,9 @@ enum class UserState
 class SimulationManager
 {
 public:
-	static void CreateSimulation(const std::shared_ptr<DeviceResources>& deviceResources)
+	static void CreateSimulation()
 	{
-		m_simulation = std::make_unique<Simulation>(deviceResources);
+		m_simulation = std::make_unique<Simulation>();
 	}
 
 	static void DestroyBonds() { m_simulation->DestroyBonds(); }
@@ -33,7 +35,8 @@ public:
 
 	static std::vector<std::shared_ptr<Bond>> Bonds() { return m_simulation->Bonds(); }
 
-	static void Update(StepTimer const& timer) { m_simulation->Update(timer); }
+	// The atoms move every update while the simulation is playing, so every update needs a new frame
+	static void Update(StepTimer const& timer) { m_simulation->Update(timer); if (!m_simulation->IsPaused()) RenderScheduler::Invalidate(); }
 
 	// Pause the simulation and trigger the event - parameter = true -> simulation is playing
 	static void Pause() { m_simulation->PauseSimulation(); PlayPauseChangedEvent(false); }
@@ -44,6 +47,17 @@ public:
 
 	static DirectX::XMFLOAT3 BoxDimensions() { return m_simulation->BoxDimensions(); }
 
+	static const SimulationObservables& Observables() { return m_simulation->Observables(); }
+	static const ObservablesHistory& GetObservablesHistory() { return m_simulation->GetObservablesHistory(); }
+	static void ClearObservablesHistory() { m_simulation->ClearObservablesHistory(); }
+
+	static double FixedTimeStep() { return m_simulation->FixedTimeStep(); }
+	static void FixedTimeStep(double timeStep) { m_simulation->FixedTimeStep(timeStep); }
+	static uint64_t StateHash() { return m_simulation->StateHash(); }
+
+	// Advance by exactly timeDelta whether or not the simulation is playing (see SimulationRenderer::ExportFrames)
+	static void Step(double timeDelta) { m_simulation->Step(timeDelta); }
+
 	static std::shared_ptr<Bond> CreateBond(const std::shared_ptr<Atom>& atom1, const std::shared_ptr<Atom>& atom2) { return m_simulation->CreateBond(atom1, atom2); }
 	static void DeleteBond(const std::shared_ptr<Bond>& bond);
 
@@ -119,11 +133,15 @@ public:
 	static void SwitchAtomSelectedUnselected(std::shared_ptr<Atom> atom);
 	static void SwitchBondSelectedUnselected(std::shared_ptr<Bond> bond);
 
-	static void ClearSelectedAtoms() { m_selectedAtoms.clear(); }
-	static void ClearSelectedBonds() { m_selectedBonds.clear(); }
+	static void ClearSelectedAtoms() { m_selectedAtoms.Clear(); }
+	static void ClearSelectedBonds() { m_selectedBonds.Clear(); }
+
+	static size_t SelectedAtomCount() { return m_selectedAtoms.Count(); }
+	static size_t SelectedBondCount() { return m_selectedBonds.Count(); }
 
-	static std::vector<std::shared_ptr<Atom>> GetSelectedAtoms() { return m_selectedAtoms; }
-	static std::vector<std::shared_ptr<Bond>> GetSelectedBonds() { return m_selectedBonds; }
+	// NOTE: The order of the selected atoms/bonds is not the order they were selected in
+	static const std::vector<std::shared_ptr<Atom>>& GetSelectedAtoms() { return m_selectedAtoms.Items(); }
+	static const std::vector<std::shared_ptr<Bond>>& GetSelectedBonds() { return m_selectedBonds.Items(); }
 
 
 
@@ -156,8 +174,9 @@ private:
 	static std::shared_ptr<Atom> m_primarySelectedAtom;
 	static std::shared_ptr<Bond> m_primarySelectedBond;
 
-	static std::vector<std::shared_ptr<Atom>> m_selectedAtoms;
-	static std::vector<std::shared_ptr<Bond>> m_selectedBonds;
+	// Group selected atoms/bonds (bitsets over the atom/bond handles, so membership tests are O(1))
+	static SelectionSet<Atom> m_selectedAtoms;
+	static SelectionSet<Bond> m_selectedBonds;
 
 
 
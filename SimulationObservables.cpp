@@ -0,0 +1,56 @@
+#include "SimulationObservables.h"
+
+#include <cmath>
+
+
+double SimulationObservables::MomentumMagnitude() const
+{
+	return std::sqrt(MomentumX * MomentumX + MomentumY * MomentumY + MomentumZ * MomentumZ);
+}
+
+
+ObservablesHistory::ObservablesHistory(size_t capacity) :
+	m_samples(capacity > 0 ? capacity : 1),
+	m_start(0),
+	m_size(0)
+{
+}
+
+void ObservablesHistory::Push(const SimulationObservables& sample)
+{
+	if (m_size < m_samples.size())
+	{
+		m_samples[(m_start + m_size) % m_samples.size()] = sample;
+		++m_size;
+	}
+	else
+	{
+		// Buffer is full - overwrite the oldest sample and advance the start
+		m_samples[m_start] = sample;
+		m_start = (m_start + 1) % m_samples.size();
+	}
+}
+
+std::vector<double> ObservablesHistory::Series(double SimulationObservables::* member) const
+{
+	std::vector<double> series;
+	series.reserve(m_size);
+
+	for (size_t iii = 0; iii < m_size; ++iii)
+		series.push_back(At(iii).*member);
+
+	return series;
+}
+
+void ObservablesHistory::WriteCSV(std::ostream& stream) const
+{
+	stream << "time,atoms,kinetic,potential,total,temperature,px,py,pz,deferred\n";
+
+	for (size_t iii = 0; iii < m_size; ++iii)
+	{
+		const SimulationObservables& s = At(iii);
+		stream << s.Time << ',' << s.AtomCount << ',' << s.KineticEnergy << ',' << s.PotentialEnergy << ','
+			<< s.TotalEnergy() << ',' << s.Temperature << ','
+			<< s.MomentumX << ',' << s.MomentumY << ',' << s.MomentumZ << ',' << s.DeferredCollisions << '\n';
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+// Global observables for a single simulation step. These are accumulated while Simulation::Update
+// walks the atoms (integrate pass) and the atom pairs (collision/force pass) so they never require
+// an extra sweep over the atoms.
+struct SimulationObservables
+{
+	SimulationObservables() :
+		Time(0.0),
+		KineticEnergy(0.0),
+		PotentialEnergy(0.0),
+		Temperature(0.0),
+		MomentumX(0.0),
+		MomentumY(0.0),
+		MomentumZ(0.0),
+		AtomCount(0),
+		DeferredCollisions(0)
+	{}
+
+	double TotalEnergy() const { return KineticEnergy + PotentialEnergy; }
+	double MomentumMagnitude() const;
+
+	double Time;				// Simulation time at the end of the step
+	double KineticEnergy;		// Sum of 1/2 m v^2
+	double PotentialEnergy;		// Sum of pair/bond potentials (hard-sphere contacts contribute 0)
+	double Temperature;			// Equipartition temperature in simulation units (k_B = 1): 2 KE / (3 N)
+	double MomentumX;
+	double MomentumY;
+	double MomentumZ;
+	unsigned int AtomCount;
+	unsigned int DeferredCollisions;	// Impacts left unresolved because the step ran out of its event budget (UpdateMode::CONTINUOUS)
+};
+
+// Fixed-capacity ring buffer of SimulationObservables. Once full, the oldest sample is overwritten
+// so the memory footprint is constant no matter how long the simulation runs. Index 0 is always the
+// oldest sample still held and Size() - 1 is the newest.
+class ObservablesHistory
+{
+public:
+	ObservablesHistory(size_t capacity = 4096);
+
+	void Push(const SimulationObservables& sample);
+	void Clear() { m_start = 0; m_size = 0; }
+
+	size_t Size() const { return m_size; }
+	size_t Capacity() const { return m_samples.size(); }
+	bool Empty() const { return m_size == 0; }
+
+	const SimulationObservables& At(size_t index) const { return m_samples[(m_start + index) % m_samples.size()]; }
+	const SimulationObservables& Latest() const { return At(m_size - 1); }
+
+	// Copy a single observable into a contiguous array (oldest first) so that it can be handed
+	// directly to a plotting control. Example: history.Series(&SimulationObservables::KineticEnergy)
+	std::vector<double> Series(double SimulationObservables::* member) const;
+
+	// Write the held samples as CSV (with a header row) so batch runs can log them
+	void WriteCSV(std::ostream& stream) const;
+
+private:
+	std::vector<SimulationObservables> m_samples;
+	size_t m_start;
+	size_t m_size;
+};
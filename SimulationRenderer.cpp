@@ -1,5 +1,9 @@
 #include "SimulationRenderer.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
 
 using Microsoft::WRL::ComPtr;
 using DirectX::XMMATRIX;
@@ -9,6 +13,16 @@ using DirectX::XMFLOAT3;
 using DirectX::XMFLOAT4;
 using DirectX::XMVECTORF32;
 
+namespace
+{
+	// Reverse Z with the far plane at infinity (see CameraSpace)
+	XMMATRIX PerspectiveProjection(float fovAngleY, float aspectRatio)
+	{
+		XMFLOAT4X4 projection;
+		CameraSpace::ReverseZPerspective(fovAngleY, aspectRatio, 0.01f, projection.m);
+		return DirectX::XMLoadFloat4x4(&projection);
+	}
+}
 
 SimulationRenderer::SimulationRenderer(const std::shared_ptr<DeviceResources>& deviceResources,
 									   const std::shared_ptr<Layout>& parentLayout) :
@@ -20,12 +34,31 @@ SimulationRenderer::SimulationRenderer(const std::shared_ptr<DeviceResources>& d
 SimulationRenderer::SimulationRenderer(const std::shared_ptr<DeviceResources>& deviceResources,
 									   const std::shared_ptr<Layout>& parentLayout, int row, int column, int rowSpan, int columnSpan) :
 	Control(deviceResources, parentLayout, row, column, rowSpan, columnSpan),
-	m_velocityArrowMaterial(nullptr),
-	m_d3dDepthStencilState(nullptr),
+	m_atomInstanceBufferCapacity(0),
+	m_bondInstanceBufferCapacity(0),
+	m_arrowInstanceBufferCapacity(0),
+	m_instancedArrowBufferData(),
+	m_atomRenderMode(AtomRenderMode::MESH),
+	m_pixelsPerUnit(1.0f),
+	m_recordingState({ RenderPass::SCENE, ShaderMode::PHONG, StencilMode::NONE }),
+	m_frameStatistics(),
+	m_stencilReferenceValues(),
+	m_velocityArrowMaterial(0),
+	m_boxMaterial(0),
+	m_hoveredOutlineMaterial(0),
+	m_primarySelectedOutlineMaterial(0),
+	m_groupSelectedOutlineMaterial(0),
+	m_outlineMode(OutlineMode::STENCIL),
+	m_outlineIDWidth(0),
+	m_outlineIDHeight(0),
+	m_selectionOutlineBufferData(),
+	m_exportWidth(0),
+	m_exportHeight(0),
 	m_testCylinder(MeshManager::GetCylinderMesh()),
 	m_rayOrigin(XMVECTOR()),
 	m_rayEnd(XMVECTOR()),
-	m_hoveredOver(false)
+	m_hoveredOver(false),
+	m_selectionShape(SelectionShape::NONE)
 {
 	// Create resources that will not change on window resizing and not device dependent
 	// -- Must call this first because it will create the MoveLookController which will be used later
@@ -42,6 +75,12 @@ SimulationRenderer::SimulationRenderer(const std::shared_ptr<DeviceResources>& d
 		D2D1::ColorF(D2D1::ColorF::CornflowerBlue, 1.0f), 
 		m_backgroundColorBrush.ReleaseAndGetAddressOf()
 	);
+
+	// Create the brush for the selection rectangle/lasso
+	m_deviceResources->D2DDeviceContext()->CreateSolidColorBrush(
+		D2D1::ColorF(D2D1::ColorF::White, 1.0f),
+		m_selectionBrush.ReleaseAndGetAddressOf()
+	);
 }
 
 void SimulationRenderer::CreateDeviceDependentResources()
@@ -50,6 +89,21 @@ void SimulationRenderer::CreateDeviceDependentResources()
 	CreatePixelShader();
 	CreateBuffers();
 	CreateBox();
+
+	CreateDepthStencilState(StencilMode::NONE);
+	CreateDepthStencilState(StencilMode::WRITE);
+	CreateDepthStencilState(StencilMode::MASK);
+	CreateDepthStencilState(StencilMode::DISABLED);
+
+	// The outline ID target is created on first use, at the size of the color target
+	m_outlineIDTexture = nullptr;
+	m_outlineIDWidth = 0;
+	m_outlineIDHeight = 0;
+
+	// Export targets are created by ExportFrames
+	m_exportTexture = nullptr;
+	m_exportWidth = 0;
+	m_exportHeight = 0;
 }
 
 void SimulationRenderer::CreateWindowSizeDependentResources()
@@ -81,12 +135,7 @@ void SimulationRenderer::CreateWindowSizeDependentResources()
 	// this transform should not be applied.
 
 	// This sample makes use of a right-handed coordinate system using row-major matrices.
-	XMMATRIX perspectiveMatrix = DirectX::XMMatrixPerspectiveFovRH(
-		fovAngleY,
-		aspectRatio,
-		0.01f,
-		100.0f
-	);
+	XMMATRIX perspectiveMatrix = PerspectiveProjection(fovAngleY, aspectRatio);
 
 	XMFLOAT4X4 orientation = m_deviceResources->OrientationTransform3D();
 	XMMATRIX orientationMatrix = XMLoadFloat4x4(&orientation);
@@ -94,6 +143,9 @@ void SimulationRenderer::CreateWindowSizeDependentResources()
 	// Projection Matrix (No Transpose)
 	m_projectionMatrix = perspectiveMatrix * orientationMatrix;
 
+	// Used to convert a radius/distance into a radius on screen when picking the level of detail
+	m_pixelsPerUnit = m_viewport.Height / (2.0f * std::tan(fovAngleY / 2.0f));
+
 	// Set the view matrix
 	m_viewMatrix = m_moveLookController->ViewMatrix();
 }
@@ -107,114 +159,129 @@ void SimulationRenderer::CreateStaticResources()
 
 	// Sphere Material
 
-	// Load vector of material properties
-	PhongMaterialProperties* dummy = new PhongMaterialProperties(); // Set a dummy property so that each element is at the index of its element type
-	m_phongMaterialProperties.push_back(dummy);
-
-	PhongMaterialProperties* hydrogen = new PhongMaterialProperties();
-	hydrogen->Material.Emissive = XMFLOAT4(0.15f, 0.15f, 0.15f, 1.0f);
-	hydrogen->Material.Ambient = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
-	hydrogen->Material.Diffuse = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
-	hydrogen->Material.Specular = XMFLOAT4(0.5f, 0.5f, 0.5f, 1.0f);
-	hydrogen->Material.SpecularPower = 6.0f;
-
-	m_phongMaterialProperties.push_back(hydrogen);
-
-	PhongMaterialProperties* helium = new PhongMaterialProperties();
-	helium->Material.Emissive = XMFLOAT4(0.4f, 0.14f, 0.14f, 1.0f);
-	helium->Material.Ambient = XMFLOAT4(1.0f, 0.75f, 0.75f, 1.0f);
-	helium->Material.Diffuse = XMFLOAT4(1.0f, 0.6f, 0.6f, 1.0f);
-	helium->Material.Specular = XMFLOAT4(0.5f, 0.5f, 0.5f, 1.0f);
-	helium->Material.SpecularPower = 6.0f;
-
-	m_phongMaterialProperties.push_back(helium);
-
-	PhongMaterialProperties* lithium = new PhongMaterialProperties();
-	lithium->Material.Emissive = XMFLOAT4(0.15f, 0.0f, 0.15f, 1.0f);
-	lithium->Material.Ambient = XMFLOAT4(1.0f, 0.0f, 1.0f, 1.0f);
-	lithium->Material.Diffuse = XMFLOAT4(1.0f, 0.6f, 0.6f, 1.0f);
-	lithium->Material.Specular = XMFLOAT4(0.5f, 0.5f, 0.5f, 1.0f);
-	lithium->Material.SpecularPower = 6.0f;
-
-	m_phongMaterialProperties.push_back(lithium);
-
-	PhongMaterialProperties* beryllium = new PhongMaterialProperties();
-	beryllium->Material.Emissive = XMFLOAT4(0.15f, 0.15f, 0.0f, 1.0f);
-	beryllium->Material.Ambient = XMFLOAT4(1.0f, 1.0f, 0.0f, 1.0f);
-	beryllium->Material.Diffuse = XMFLOAT4(1.0f, 1.0f, 0.0f, 1.0f);
-	beryllium->Material.Specular = XMFLOAT4(0.5f, 0.5f, 0.5f, 1.0f);
-	beryllium->Material.SpecularPower = 6.0f;
-
-	m_phongMaterialProperties.push_back(beryllium);
-
-	PhongMaterialProperties* boron = new PhongMaterialProperties();
-	boron->Material.Emissive = XMFLOAT4(0.45f, 0.22f, 0.22f, 1.0f);
-	boron->Material.Ambient = XMFLOAT4(1.0f, 0.45f, 0.45f, 1.0f);
-	boron->Material.Diffuse = XMFLOAT4(1.0f, 0.8f, 0.8f, 1.0f);
-	boron->Material.Specular = XMFLOAT4(0.5f, 0.5f, 0.5f, 1.0f);
-	boron->Material.SpecularPower = 6.0f;
-
-	m_phongMaterialProperties.push_back(boron);
-
-	PhongMaterialProperties* carbon = new PhongMaterialProperties();
-	carbon->Material.Emissive = XMFLOAT4(0.1f, 0.1f, 0.1f, 1.0f);
-	carbon->Material.Ambient = XMFLOAT4(0.12f, 0.12f, 0.12f, 1.0f);
-	carbon->Material.Diffuse = XMFLOAT4(0.8f, 0.8f, 0.8f, 1.0f);
-	carbon->Material.Specular = XMFLOAT4(0.5f, 0.5f, 0.5f, 1.0f);
-	carbon->Material.SpecularPower = 6.0f;
-
-	m_phongMaterialProperties.push_back(carbon);
-
-	PhongMaterialProperties* nitrogen = new PhongMaterialProperties();
-	nitrogen->Material.Emissive = XMFLOAT4(0.0f, 0.0f, 0.3f, 1.0f);
-	nitrogen->Material.Ambient = XMFLOAT4(0.0f, 0.0f, 1.0f, 1.0f);
-	nitrogen->Material.Diffuse = XMFLOAT4(0.0f, 0.0f, 1.0f, 1.0f);
-	nitrogen->Material.Specular = XMFLOAT4(0.5f, 0.5f, 0.5f, 1.0f);
-	nitrogen->Material.SpecularPower = 6.0f;
-
-	m_phongMaterialProperties.push_back(nitrogen);
-
-	PhongMaterialProperties* oxygen = new PhongMaterialProperties();
-	oxygen->Material.Emissive = XMFLOAT4(0.3f, 0.0f, 0.0f, 1.0f);
-	oxygen->Material.Ambient = XMFLOAT4(1.0f, 0.0f, 0.0f, 1.0f);
-	oxygen->Material.Diffuse = XMFLOAT4(1.0f, 0.0f, 0.0f, 1.0f);
-	oxygen->Material.Specular = XMFLOAT4(0.5f, 0.5f, 0.5f, 1.0f);
-	oxygen->Material.SpecularPower = 6.0f;
-
-	m_phongMaterialProperties.push_back(oxygen);
-
-	PhongMaterialProperties* flourine = new PhongMaterialProperties();
-	flourine->Material.Emissive = XMFLOAT4(0.0f, 0.12f, 0.12f, 1.0f);
-	flourine->Material.Ambient = XMFLOAT4(0.0f, 0.5f, 0.5f, 1.0f);
-	flourine->Material.Diffuse = XMFLOAT4(0.0f, 0.2f, 1.0f, 1.0f);
-	flourine->Material.Specular = XMFLOAT4(0.5f, 0.5f, 0.5f, 1.0f);
-	flourine->Material.SpecularPower = 6.0f;
-
-	m_phongMaterialProperties.push_back(flourine);
-
-	PhongMaterialProperties* neon = new PhongMaterialProperties();
-	neon->Material.Emissive = XMFLOAT4(0.1f, 0.3f, 0.3f, 1.0f);
-	neon->Material.Ambient = XMFLOAT4(0.3f, 1.0f, 0.0f, 1.0f);
-	neon->Material.Diffuse = XMFLOAT4(0.0f, 1.0f, 1.0f, 1.0f);
-	neon->Material.Specular = XMFLOAT4(0.5f, 0.5f, 0.5f, 1.0f);
-	neon->Material.SpecularPower = 6.0f;
-
-	m_phongMaterialProperties.push_back(neon);
+	// Load the material table. Every material is added here and packed into one GPU buffer on first use
+	m_materials = std::make_unique<MaterialTable>(m_deviceResources);
+	m_materials->Add(_PhongMaterial()); // Add a dummy material so that each element is at the index of its element type
+
+	_PhongMaterial hydrogen;
+	hydrogen.Emissive = XMFLOAT4(0.15f, 0.15f, 0.15f, 1.0f);
+	hydrogen.Ambient = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+	hydrogen.Diffuse = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+	hydrogen.Specular = XMFLOAT4(0.5f, 0.5f, 0.5f, 1.0f);
+	hydrogen.SpecularPower = 6.0f;
+
+	m_materials->Add(hydrogen);
+
+	_PhongMaterial helium;
+	helium.Emissive = XMFLOAT4(0.4f, 0.14f, 0.14f, 1.0f);
+	helium.Ambient = XMFLOAT4(1.0f, 0.75f, 0.75f, 1.0f);
+	helium.Diffuse = XMFLOAT4(1.0f, 0.6f, 0.6f, 1.0f);
+	helium.Specular = XMFLOAT4(0.5f, 0.5f, 0.5f, 1.0f);
+	helium.SpecularPower = 6.0f;
+
+	m_materials->Add(helium);
+
+	_PhongMaterial lithium;
+	lithium.Emissive = XMFLOAT4(0.15f, 0.0f, 0.15f, 1.0f);
+	lithium.Ambient = XMFLOAT4(1.0f, 0.0f, 1.0f, 1.0f);
+	lithium.Diffuse = XMFLOAT4(1.0f, 0.6f, 0.6f, 1.0f);
+	lithium.Specular = XMFLOAT4(0.5f, 0.5f, 0.5f, 1.0f);
+	lithium.SpecularPower = 6.0f;
+
+	m_materials->Add(lithium);
+
+	_PhongMaterial beryllium;
+	beryllium.Emissive = XMFLOAT4(0.15f, 0.15f, 0.0f, 1.0f);
+	beryllium.Ambient = XMFLOAT4(1.0f, 1.0f, 0.0f, 1.0f);
+	beryllium.Diffuse = XMFLOAT4(1.0f, 1.0f, 0.0f, 1.0f);
+	beryllium.Specular = XMFLOAT4(0.5f, 0.5f, 0.5f, 1.0f);
+	beryllium.SpecularPower = 6.0f;
+
+	m_materials->Add(beryllium);
+
+	_PhongMaterial boron;
+	boron.Emissive = XMFLOAT4(0.45f, 0.22f, 0.22f, 1.0f);
+	boron.Ambient = XMFLOAT4(1.0f, 0.45f, 0.45f, 1.0f);
+	boron.Diffuse = XMFLOAT4(1.0f, 0.8f, 0.8f, 1.0f);
+	boron.Specular = XMFLOAT4(0.5f, 0.5f, 0.5f, 1.0f);
+	boron.SpecularPower = 6.0f;
+
+	m_materials->Add(boron);
+
+	_PhongMaterial carbon;
+	carbon.Emissive = XMFLOAT4(0.1f, 0.1f, 0.1f, 1.0f);
+	carbon.Ambient = XMFLOAT4(0.12f, 0.12f, 0.12f, 1.0f);
+	carbon.Diffuse = XMFLOAT4(0.8f, 0.8f, 0.8f, 1.0f);
+	carbon.Specular = XMFLOAT4(0.5f, 0.5f, 0.5f, 1.0f);
+	carbon.SpecularPower = 6.0f;
+
+	m_materials->Add(carbon);
+
+	_PhongMaterial nitrogen;
+	nitrogen.Emissive = XMFLOAT4(0.0f, 0.0f, 0.3f, 1.0f);
+	nitrogen.Ambient = XMFLOAT4(0.0f, 0.0f, 1.0f, 1.0f);
+	nitrogen.Diffuse = XMFLOAT4(0.0f, 0.0f, 1.0f, 1.0f);
+	nitrogen.Specular = XMFLOAT4(0.5f, 0.5f, 0.5f, 1.0f);
+	nitrogen.SpecularPower = 6.0f;
+
+	m_materials->Add(nitrogen);
+
+	_PhongMaterial oxygen;
+	oxygen.Emissive = XMFLOAT4(0.3f, 0.0f, 0.0f, 1.0f);
+	oxygen.Ambient = XMFLOAT4(1.0f, 0.0f, 0.0f, 1.0f);
+	oxygen.Diffuse = XMFLOAT4(1.0f, 0.0f, 0.0f, 1.0f);
+	oxygen.Specular = XMFLOAT4(0.5f, 0.5f, 0.5f, 1.0f);
+	oxygen.SpecularPower = 6.0f;
+
+	m_materials->Add(oxygen);
+
+	_PhongMaterial flourine;
+	flourine.Emissive = XMFLOAT4(0.0f, 0.12f, 0.12f, 1.0f);
+	flourine.Ambient = XMFLOAT4(0.0f, 0.5f, 0.5f, 1.0f);
+	flourine.Diffuse = XMFLOAT4(0.0f, 0.2f, 1.0f, 1.0f);
+	flourine.Specular = XMFLOAT4(0.5f, 0.5f, 0.5f, 1.0f);
+	flourine.SpecularPower = 6.0f;
+
+	m_materials->Add(flourine);
+
+	_PhongMaterial neon;
+	neon.Emissive = XMFLOAT4(0.1f, 0.3f, 0.3f, 1.0f);
+	neon.Ambient = XMFLOAT4(0.3f, 1.0f, 0.0f, 1.0f);
+	neon.Diffuse = XMFLOAT4(0.0f, 1.0f, 1.0f, 1.0f);
+	neon.Specular = XMFLOAT4(0.5f, 0.5f, 0.5f, 1.0f);
+	neon.SpecularPower = 6.0f;
+
+	m_materials->Add(neon);
 
 	// Velocity Arrow Material =================================================
-	m_velocityArrowMaterial = std::make_unique<PhongMaterialProperties>();
-	m_velocityArrowMaterial->Material.Emissive = XMFLOAT4(0.15f, 0.15f, 0.15f, 1.0f);
-	m_velocityArrowMaterial->Material.Ambient = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
-	m_velocityArrowMaterial->Material.Diffuse = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
-	m_velocityArrowMaterial->Material.Specular = XMFLOAT4(0.5f, 0.5f, 0.5f, 1.0f);
-	m_velocityArrowMaterial->Material.SpecularPower = 6.0f;
+	_PhongMaterial velocityArrow;
+	velocityArrow.Emissive = XMFLOAT4(0.15f, 0.15f, 0.15f, 1.0f);
+	velocityArrow.Ambient = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+	velocityArrow.Diffuse = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+	velocityArrow.Specular = XMFLOAT4(0.5f, 0.5f, 0.5f, 1.0f);
+	velocityArrow.SpecularPower = 6.0f;
+
+	m_velocityArrowMaterial = m_materials->Add(velocityArrow);
 
 	// Box Material ============================================================
-	m_boxMaterialProperties = PhongMaterialProperties();
-	m_boxMaterialProperties.Material.Ambient = XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f);
-	m_boxMaterialProperties.Material.Diffuse = XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f);
-	m_boxMaterialProperties.Material.Specular = XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f);
-	m_boxMaterialProperties.Material.SpecularPower = 10.0f;
+	_PhongMaterial box;
+	box.Ambient = XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f);
+	box.Diffuse = XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f);
+	box.Specular = XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f);
+	box.SpecularPower = 10.0f;
+
+	m_boxMaterial = m_materials->Add(box);
+
+	// Outline Materials =======================================================
+	m_hoveredOutlineMaterial = m_materials->AddSolidColor(DirectX::Colors::Purple);
+	m_primarySelectedOutlineMaterial = m_materials->AddSolidColor(DirectX::Colors::Red);
+	m_groupSelectedOutlineMaterial = m_materials->AddSolidColor(DirectX::Colors::Blue);
+
+	// The screen space outline looks the materials up by outline ID
+	m_selectionOutlineBufferData.materialIndex[SelectionOutline::NONE] = 0;
+	m_selectionOutlineBufferData.materialIndex[SelectionOutline::HOVERED] = m_hoveredOutlineMaterial;
+	m_selectionOutlineBufferData.materialIndex[SelectionOutline::PRIMARY_SELECTED] = m_primarySelectedOutlineMaterial;
+	m_selectionOutlineBufferData.materialIndex[SelectionOutline::GROUP_SELECTED] = m_groupSelectedOutlineMaterial;
 
 	// Lighting ============================================================
 	m_lightProperties = LightProperties();
@@ -341,6 +408,75 @@ void SimulationRenderer::CreateVertexShaderAndInputLayout()
 			m_phongInputLayout.ReleaseAndGetAddressOf()
 		)
 	);
+
+	// PHONG INSTANCED shader =============================================================
+	// The vertex input is identical to the Phong shader, so it shares m_phongInputLayout
+	ComPtr<ID3DBlob> instancedBlob;
+	ThrowIfFailed(
+		D3DReadFileToBlob(L"InstancedPhongVertexShader.cso", instancedBlob.ReleaseAndGetAddressOf())
+	);
+	ThrowIfFailed(
+		m_deviceResources->D3DDevice()->CreateVertexShader(
+			instancedBlob->GetBufferPointer(),
+			instancedBlob->GetBufferSize(),
+			nullptr,
+			m_phongInstancedVertexShader.ReleaseAndGetAddressOf()
+		)
+	);
+
+	ComPtr<ID3DBlob> instancedCylinderBlob;
+	ThrowIfFailed(
+		D3DReadFileToBlob(L"InstancedCylinderVertexShader.cso", instancedCylinderBlob.ReleaseAndGetAddressOf())
+	);
+	ThrowIfFailed(
+		m_deviceResources->D3DDevice()->CreateVertexShader(
+			instancedCylinderBlob->GetBufferPointer(),
+			instancedCylinderBlob->GetBufferSize(),
+			nullptr,
+			m_phongInstancedCylinderVertexShader.ReleaseAndGetAddressOf()
+		)
+	);
+
+	ComPtr<ID3DBlob> instancedArrowBlob;
+	ThrowIfFailed(
+		D3DReadFileToBlob(L"InstancedArrowVertexShader.cso", instancedArrowBlob.ReleaseAndGetAddressOf())
+	);
+	ThrowIfFailed(
+		m_deviceResources->D3DDevice()->CreateVertexShader(
+			instancedArrowBlob->GetBufferPointer(),
+			instancedArrowBlob->GetBufferSize(),
+			nullptr,
+			m_phongInstancedArrowVertexShader.ReleaseAndGetAddressOf()
+		)
+	);
+
+	// IMPOSTOR shader ====================================================================
+	ComPtr<ID3DBlob> impostorBlob;
+	ThrowIfFailed(
+		D3DReadFileToBlob(L"ImpostorVertexShader.cso", impostorBlob.ReleaseAndGetAddressOf())
+	);
+	ThrowIfFailed(
+		m_deviceResources->D3DDevice()->CreateVertexShader(
+			impostorBlob->GetBufferPointer(),
+			impostorBlob->GetBufferSize(),
+			nullptr,
+			m_impostorVertexShader.ReleaseAndGetAddressOf()
+		)
+	);
+
+	// FULL SCREEN TRIANGLE shader ========================================================
+	ComPtr<ID3DBlob> fullScreenBlob;
+	ThrowIfFailed(
+		D3DReadFileToBlob(L"FullScreenTriangleVertexShader.cso", fullScreenBlob.ReleaseAndGetAddressOf())
+	);
+	ThrowIfFailed(
+		m_deviceResources->D3DDevice()->CreateVertexShader(
+			fullScreenBlob->GetBufferPointer(),
+			fullScreenBlob->GetBufferSize(),
+			nullptr,
+			m_fullScreenTriangleVertexShader.ReleaseAndGetAddressOf()
+		)
+	);
 }
 
 void SimulationRenderer::CreatePixelShader()
@@ -373,58 +509,97 @@ void SimulationRenderer::CreatePixelShader()
 			m_phongPixelShader.ReleaseAndGetAddressOf()
 		)
 	);
-}
 
-void SimulationRenderer::CreateBuffers()
-{
-	CD3D11_BUFFER_DESC constantBufferDesc(sizeof(ModelViewProjectionConstantBuffer), D3D11_BIND_CONSTANT_BUFFER);
+	// IMPOSTOR shader ====================================================================
+	ComPtr<ID3DBlob> impostorBlob;
 	ThrowIfFailed(
-		m_deviceResources->D3DDevice()->CreateBuffer(
-			&constantBufferDesc,
+		D3DReadFileToBlob(L"ImpostorPixelShader.cso", impostorBlob.ReleaseAndGetAddressOf())
+	);
+	ThrowIfFailed(
+		m_deviceResources->D3DDevice()->CreatePixelShader(
+			impostorBlob->GetBufferPointer(),
+			impostorBlob->GetBufferSize(),
 			nullptr,
-			m_modelViewProjectionBuffer.ReleaseAndGetAddressOf()
+			m_impostorPixelShader.ReleaseAndGetAddressOf()
 		)
 	);
 
-	// Phong Material constant buffer (Pixel Shader)
-	CD3D11_BUFFER_DESC phongMaterialConstantBufferDesc(sizeof(PhongMaterialProperties), D3D11_BIND_CONSTANT_BUFFER);
+	// SELECTION OUTLINE shader ===========================================================
+	ComPtr<ID3DBlob> selectionOutlineBlob;
 	ThrowIfFailed(
-		m_deviceResources->D3DDevice()->CreateBuffer(
-			&phongMaterialConstantBufferDesc,
+		D3DReadFileToBlob(L"SelectionOutlinePixelShader.cso", selectionOutlineBlob.ReleaseAndGetAddressOf())
+	);
+	ThrowIfFailed(
+		m_deviceResources->D3DDevice()->CreatePixelShader(
+			selectionOutlineBlob->GetBufferPointer(),
+			selectionOutlineBlob->GetBufferSize(),
 			nullptr,
-			m_phongMaterialPropertiesConstantBuffer.ReleaseAndGetAddressOf()
+			m_selectionOutlinePixelShader.ReleaseAndGetAddressOf()
 		)
 	);
+}
+
+void SimulationRenderer::CreateBuffers()
+{
+	// Constant buffer data is written to the device's upload ring (see UploadRingBuffer), so only the atom,
+	// bond and velocity arrow instance buffers (Vertex Shader) are created here - these grow as needed in SubmitCommands
+	m_atomInstanceBufferCapacity = 256;
+	CreateInstanceBuffer(sizeof(AtomInstance), m_atomInstanceBufferCapacity, m_atomInstanceBuffer, m_atomInstanceBufferView);
+
+	m_bondInstanceBufferCapacity = 256;
+	CreateInstanceBuffer(sizeof(BondCylinderInstance), m_bondInstanceBufferCapacity, m_bondInstanceBuffer, m_bondInstanceBufferView);
 
-	// Solid material constant buffer (Pixel Shader)
-	CD3D11_BUFFER_DESC solidMaterialConstantBufferDesc(sizeof(SolidMaterialProperties), D3D11_BIND_CONSTANT_BUFFER);
+	m_arrowInstanceBufferCapacity = 256;
+	CreateInstanceBuffer(sizeof(VelocityArrowInstance), m_arrowInstanceBufferCapacity, m_arrowInstanceBuffer, m_arrowInstanceBufferView);
+}
+
+void SimulationRenderer::CreateInstanceBuffer(unsigned int stride, unsigned int capacity, ComPtr<ID3D11Buffer>& buffer, ComPtr<ID3D11ShaderResourceView>& view)
+{
+	// Dynamic structured buffer that is rewritten (WRITE_DISCARD) every frame
+	CD3D11_BUFFER_DESC instanceBufferDesc(
+		stride * capacity,
+		D3D11_BIND_SHADER_RESOURCE,
+		D3D11_USAGE_DYNAMIC,
+		D3D11_CPU_ACCESS_WRITE,
+		D3D11_RESOURCE_MISC_BUFFER_STRUCTURED,
+		stride
+	);
 	ThrowIfFailed(
 		m_deviceResources->D3DDevice()->CreateBuffer(
-			&solidMaterialConstantBufferDesc,
+			&instanceBufferDesc,
 			nullptr,
-			m_solidMaterialPropertiesConstantBuffer.ReleaseAndGetAddressOf()
+			buffer.ReleaseAndGetAddressOf()
 		)
 	);
 
-	// Box Material constant buffer (Pixel Shader)
-	CD3D11_BUFFER_DESC boxMaterialConstantBufferDesc(sizeof(PhongMaterialProperties), D3D11_BIND_CONSTANT_BUFFER);
+	CD3D11_SHADER_RESOURCE_VIEW_DESC viewDesc(D3D11_SRV_DIMENSION_BUFFER, DXGI_FORMAT_UNKNOWN, 0, capacity);
 	ThrowIfFailed(
-		m_deviceResources->D3DDevice()->CreateBuffer(
-			&boxMaterialConstantBufferDesc,
-			nullptr,
-			m_boxMaterialPropertiesConstantBuffer.ReleaseAndGetAddressOf()
+		m_deviceResources->D3DDevice()->CreateShaderResourceView(
+			buffer.Get(),
+			&viewDesc,
+			view.ReleaseAndGetAddressOf()
 		)
 	);
+}
 
-	// Lights constant buffer (Pixel Shader)
-	CD3D11_BUFFER_DESC lightsConstantBufferDesc(sizeof(LightProperties), D3D11_BIND_CONSTANT_BUFFER);
+void SimulationRenderer::UploadInstances(const void* data, unsigned int stride, unsigned int count, unsigned int& capacity, ComPtr<ID3D11Buffer>& buffer, ComPtr<ID3D11ShaderResourceView>& view)
+{
+	ID3D11DeviceContext4* context = m_deviceResources->D3DDeviceContext();
+
+	// Grow the instance buffer if necessary (doubling so this rarely happens)
+	if (count > capacity)
+	{
+		capacity = std::max(count, 2 * capacity);
+		CreateInstanceBuffer(stride, capacity, buffer, view);
+	}
+
+	// Upload all instances at once
+	D3D11_MAPPED_SUBRESOURCE mapped;
 	ThrowIfFailed(
-		m_deviceResources->D3DDevice()->CreateBuffer(
-			&lightsConstantBufferDesc,
-			nullptr,
-			m_lightPropertiesConstantBuffer.ReleaseAndGetAddressOf()
-		)
+		context->Map(buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped)
 	);
+	memcpy(mapped.pData, data, static_cast<size_t>(stride) * count);
+	context->Unmap(buffer.Get(), 0);
 }
 
 void SimulationRenderer::CreateBox()
@@ -513,67 +688,256 @@ void SimulationRenderer::Update(StepTimer const& stepTimer)
 
 	m_moveLookController->Update(stepTimer, rect);
 
-	// If the move look controller is actively moving, update the view matrix
+	// If the move look controller is actively moving, update the view matrix and request a new frame
 	if (m_moveLookController->IsMoving())
+	{
 		m_viewMatrix = m_moveLookController->ViewMatrix();
+		RenderScheduler::Invalidate();
+	}
 }
 
 bool SimulationRenderer::Render3D()
 {
-	// Compute the view-projection matrix at the beginning of each render
-	m_viewProjectionMatrix = m_viewMatrix * m_projectionMatrix;
-
 	// Fill in the background of the area to hold the 3D scene
 	DrawBackground();
 
-	// Set up pipeline configurations that will not change
- 	ID3D11DeviceContext4* context = m_deviceResources->D3DDeviceContext();
-	context->UpdateSubresource(m_lightPropertiesConstantBuffer.Get(), 0, nullptr, &m_lightProperties, 0, 0);
-	context->RSSetViewports(1, &m_viewport);
-	this->SetShaderMode(ShaderMode::PHONG);
+	RecordFrame();
+	SubmitCommands(m_deviceResources->GetBackBufferRenderTargetView(), m_deviceResources->GetDepthStencilView(), m_viewport);
+
+	return true;
+}
+
+void SimulationRenderer::RecordFrame()
+{
+	// Everything is drawn relative to the eye, so the view-projection matrix has no translation and the
+	// instances and model matrices are rebased on the eye as they are recorded
+	XMFLOAT3 eye;
+	DirectX::XMStoreFloat3(&eye, m_moveLookController->Position());
+
+	XMFLOAT3 dims = SimulationManager::BoxDimensions();
+	const float boxDimensions[3] = { dims.x, dims.y, dims.z };
+
+	// The far plane follows the eye and the box, so the depth of the draw keys always covers the whole scene
+	SceneCamera camera = {};
+	camera.Eye[0] = eye.x;
+	camera.Eye[1] = eye.y;
+	camera.Eye[2] = eye.z;
+	camera.PixelsPerUnit = m_pixelsPerUnit;
+	camera.FarPlane = SceneRecorder::FarPlane(camera.Eye, boxDimensions);
 
-	// Draw the box first as everything else will have triangle topology
-	DrawBox();
+	XMFLOAT4X4 view, projection;
+	DirectX::XMStoreFloat4x4(&view, CameraRelativeViewMatrix());
+	DirectX::XMStoreFloat4x4(&projection, m_projectionMatrix);
+	std::memcpy(camera.View, view.m, sizeof(camera.View));
+	std::memcpy(camera.Projection, projection.m, sizeof(camera.Projection));
 
-	context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	// Record the frame - nothing is drawn until SubmitCommands
+	m_scene.Begin(camera);
+
+	XMFLOAT4X4 viewProjection(&m_scene.ViewProjection()[0][0]);
+	m_viewProjectionMatrix = DirectX::XMLoadFloat4x4(&viewProjection);
 
 	// FIRST RENDER PASS - Draw everything that doesn't need special effects (ex. stenciling)
+	m_scene.DrawBox(boxDimensions, m_boxMaterial);
+
 	DrawAtoms();
-	DrawAtomVelocityArrows();
+	m_scene.DrawVelocityArrows(SimulationManager::Atoms(), m_velocityArrowMaterial);
 	DrawBonds();
 
-	// SECOND RENDER PASS - Draw hovered/selected items with stencil effects (outlining)
-	DrawStencilMask();
-	DrawHoveredAndSelectedAtomsAndBonds();
+	// SECOND RENDER PASS - Draw hovered/selected items with stencil effects (outlining). The screen space
+	// outline IDs were already written by the first pass, so that only needs the single full screen pass
+	if (m_outlineMode == OutlineMode::SCREEN_SPACE)
+	{
+		DrawScreenSpaceOutline();
+	}
+	else
+	{
+		DrawStencilMask();
+		DrawHoveredAndSelectedAtomsAndBonds();
+	}
+
+	// Group the draws by state so the backend can skip redundant state changes
+	m_scene.End();
+}
+
+XMMATRIX SimulationRenderer::CameraRelativeViewMatrix() const
+{
+	XMMATRIX view = m_viewMatrix;
+	view.r[3] = DirectX::g_XMIdentityR3;
+	return view;
+}
+
+bool SimulationRenderer::Render2D()
+{
+	if (m_selectionShape == SelectionShape::NONE || m_selectionPoints.size() < 2)
+		return false;
+
+	ID2D1DeviceContext6* context = m_deviceResources->D2DDeviceContext();
+	context->SetTransform(m_deviceResources->OrientationTransform2D());
+
+	// The selection points are in pixels, D2D draws in DIPs
+	auto toDIPS = [this](const D2D1_POINT_2F& point) {
+		return D2D1::Point2F(m_deviceResources->PixelsToDIPS(point.x), m_deviceResources->PixelsToDIPS(point.y));
+	};
+
+	if (m_selectionShape == SelectionShape::RECTANGLE)
+	{
+		D2D1_POINT_2F p1 = toDIPS(m_selectionPoints[0]);
+		D2D1_POINT_2F p2 = toDIPS(m_selectionPoints[1]);
+		context->DrawRectangle(
+			D2D1::RectF(std::min(p1.x, p2.x), std::min(p1.y, p2.y), std::max(p1.x, p2.x), std::max(p1.y, p2.y)),
+			m_selectionBrush.Get(),
+			1.0f
+		);
+		return true;
+	}
+
+	// Draw the lasso closed so it is clear the last point connects to the first
+	for (size_t iii = 0; iii < m_selectionPoints.size(); ++iii)
+	{
+		const D2D1_POINT_2F& next = m_selectionPoints[(iii + 1) % m_selectionPoints.size()];
+		context->DrawLine(toDIPS(m_selectionPoints[iii]), toDIPS(next), m_selectionBrush.Get(), 1.0f);
+	}
 
 	return true;
 }
 
+bool SimulationRenderer::ExportFrames(const FrameExportSettings& settings)
+{
+	FrameWriter writer;
+	if (settings.FrameCount == 0 || !writer.Open(settings.Path, settings.Format, settings.Width, settings.Height, settings.FramesPerSecond))
+		return false;
+
+	// Tiles can't be larger than the largest texture the device supports
+	unsigned int maxTileSize = std::min(std::max(settings.MaxTileSize, 1u), static_cast<unsigned int>(D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION));
+	std::vector<FrameTile> tiles = SplitFrame(settings.Width, settings.Height, maxTileSize);
+	CreateExportTargets(std::min(settings.Width, maxTileSize), std::min(settings.Height, maxTileSize));
+
+	// Put the window's projection back however the export ends
+	struct WindowProjection
+	{
+		SimulationRenderer*	Renderer;
+		XMMATRIX			Projection;
+		float				PixelsPerUnit;
+
+		~WindowProjection()
+		{
+			Renderer->m_projectionMatrix = Projection;
+			Renderer->m_pixelsPerUnit = PixelsPerUnit;
+		}
+	} windowProjection = { this, m_projectionMatrix, m_pixelsPerUnit };
+
+	// Projection for the aspect ratio of the export (see CreateWindowSizeDependentResources). The export target is
+	// never presented, so the display orientation is not applied. The level of detail is picked for the export
+	// resolution rather than the window's
+	float aspectRatio = static_cast<float>(settings.Width) / settings.Height;
+	float fovAngleY = aspectRatio < 1.0f ? DirectX::XM_PI / 2 : DirectX::XM_PI / 4;
+	m_projectionMatrix = PerspectiveProjection(fovAngleY, aspectRatio);
+	m_pixelsPerUnit = settings.Height / (2.0f * std::tan(fovAngleY / 2.0f));
+
+	ID3D11DeviceContext4* context = m_deviceResources->D3DDeviceContext();
+
+	D2D1_COLOR_F background = m_backgroundColorBrush->GetColor();
+	const FLOAT clearColor[4] = { background.r, background.g, background.b, 1.0f };
+
+	// Each tile is read back only once the next tile has been queued, so the GPU renders one tile while the CPU
+	// waits on the copy of the previous one. The last tile of a frame is read back once the next frame has been
+	// simulated and recorded, and the finished frame is then converted and written by the writer's thread
+	bool tilePending = false;
+	unsigned int pendingSlot = 0;
+	FrameTile pendingTile = {};
+	unsigned int slot = 0;
+	std::vector<uint32_t>* frame = nullptr;
+
+	for (unsigned int frameIndex = 0; frameIndex < settings.FrameCount; ++frameIndex)
+	{
+		if (frameIndex > 0 && settings.TimeStep > 0.0)
+		{
+			for (unsigned int step = 0; step < settings.StepsPerFrame; ++step)
+				SimulationManager::Step(settings.TimeStep);
+		}
+
+		RecordFrame();
+
+		if (tilePending)
+		{
+			ReadBackExportTile(pendingSlot, pendingTile, settings.Width, *frame);
+			writer.SubmitFrame();
+			tilePending = false;
+		}
+
+		frame = &writer.BeginFrame();
+
+		// The frame is recorded (and culled) once for the whole view - each tile only narrows the projection
+		XMMATRIX viewProjection = m_viewProjectionMatrix;
+
+		for (const FrameTile& tile : tiles)
+		{
+			XMFLOAT4X4 tileProjection;
+			TileProjection(tile, settings.Width, settings.Height, tileProjection.m);
+			m_viewProjectionMatrix = viewProjection * DirectX::XMLoadFloat4x4(&tileProjection);
+
+			context->ClearRenderTargetView(m_exportTargetView.Get(), clearColor);
+			context->ClearDepthStencilView(m_exportDepthStencilView.Get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, CameraSpace::ClearDepth, 0);
+
+			ID3D11RenderTargetView* const exportTarget[] = { m_exportTargetView.Get() };
+			context->OMSetRenderTargets(1, exportTarget, m_exportDepthStencilView.Get());
+
+			CD3D11_VIEWPORT viewport(0.0f, 0.0f, static_cast<float>(tile.Width), static_cast<float>(tile.Height));
+			SubmitCommands(m_exportTargetView.Get(), m_exportDepthStencilView.Get(), viewport);
+
+			// Edge tiles only cover part of the target
+			D3D11_BOX box = { 0, 0, 0, tile.Width, tile.Height, 1 };
+			context->CopySubresourceRegion(m_exportStagingTextures[slot].Get(), 0, 0, 0, 0, m_exportTexture.Get(), 0, &box);
+
+			// Nothing is presented during the export, so each tile closes its own upload ring frame. Otherwise
+			// the constants of every tile stay in flight and the ring keeps growing (see UploadRingBuffer)
+			m_deviceResources->UploadRing()->EndFrame();
+
+			if (tilePending)
+				ReadBackExportTile(pendingSlot, pendingTile, settings.Width, *frame);
+
+			tilePending = true;
+			pendingSlot = slot;
+			pendingTile = tile;
+			slot ^= 1;
+		}
+	}
+
+	ReadBackExportTile(pendingSlot, pendingTile, settings.Width, *frame);
+	writer.SubmitFrame();
+
+	// Put the window's targets back
+	ID3D11RenderTargetView* const backBufferTarget[] = { m_deviceResources->GetBackBufferRenderTargetView() };
+	context->OMSetRenderTargets(1, backBufferTarget, m_deviceResources->GetDepthStencilView());
+
+	// The simulation has moved on if it was stepped
+	RenderScheduler::Invalidate();
+
+	return writer.Close();
+}
+
+void SimulationRenderer::ExportCurrentView()
+{
+	FrameExportSettings settings;
+	settings.Path = "simulation_export";
+	ExportFrames(settings);
+}
+
 
 void SimulationRenderer::DrawStencilMask()
 {
 	// Set up the pipeline to write to the stencil mask
 	//		Set the stencil to mode to write so that we write 1's to the stencil buffer for the pixels that will be masked
-	this->SetStencilMode(StencilMode::WRITE);
-	this->SetShaderMode(ShaderMode::PHONG);		// Use Phong shading
+	//		and use Phong shading
+	m_recordingState = { RenderPass::STENCIL_MASK, ShaderMode::PHONG, StencilMode::WRITE };
 
 	// 1: Draw stencil for the hovered atom ==========================================================
 	DrawIfNotNull(SimulationManager::AtomHoveredOver());
 
 	// 2: Draw stencil for primary selected atom =====================================================
-	switch (SimulationManager::GetUserState())
-	{
-	// In the view, edit bond, and edit velocity state, only draw the stencil if shift is held down
-	case UserState::VIEW:
-	case UserState::EDIT_BONDS:
-	case UserState::EDIT_VELOCITY_ARROWS:
-		if (m_moveLookController->ShiftIsDown())
-			DrawIfNotNull(SimulationManager::GetPrimarySelectedAtom());
-		break;
-
-	default:
+	if (PrimarySelectedAtomIsOutlined())
 		DrawIfNotNull(SimulationManager::GetPrimarySelectedAtom());
-	}
 
 	// 3: Draw stencil for all group selected atoms ==================================================
 	for (std::shared_ptr<Atom> a : SimulationManager::GetSelectedAtoms())
@@ -581,35 +945,12 @@ void SimulationRenderer::DrawStencilMask()
 
 
 	// 4: Draw stencil for hovered bond ==============================================================
-	switch (SimulationManager::GetUserState())
-	{
-	// In the view and edit velocity arrows state, only draw the hovered bond if CTRL is down
-	case UserState::VIEW:
-	case UserState::EDIT_VELOCITY_ARROWS:
-		if (m_moveLookController->CTRLIsDown())
-			DrawIfNotNull(SimulationManager::BondHoveredOver());
-		break;
-
-	default:
+	if (HoveredBondIsOutlined())
 		DrawIfNotNull(SimulationManager::BondHoveredOver());
-	}
 
 	// 5: Draw stencil for primary selected bond =====================================================
-	switch (SimulationManager::GetUserState())
-	{
-	// Don't draw the outline for the primary selected bond in the VIEW state
-	case UserState::VIEW:
-		break;
-
-	// Draw the outline for the primary selected bond when shift is down
-	case UserState::EDIT_BONDS:
-		if (m_moveLookController->ShiftIsDown())
-			DrawIfNotNull(SimulationManager::GetPrimarySelectedBond());
-		break;
-
-	default:
+	if (PrimarySelectedBondIsOutlined())
 		DrawIfNotNull(SimulationManager::GetPrimarySelectedBond());
-	}
 
 	// 6: Draw stencil for all group selected bonds ==================================================
 	for (std::shared_ptr<Bond> b : SimulationManager::GetSelectedBonds())
@@ -620,102 +961,118 @@ void SimulationRenderer::DrawStencilMask()
 void SimulationRenderer::DrawHoveredAndSelectedAtomsAndBonds()
 {
 	// Set the stencil to mode to mask so that we don't render to pixels where the stencil buffer value is 1
-	this->SetStencilMode(StencilMode::MASK);
-
-	// Set the shader mode to solid so we can draw solid color
-	this->SetShaderMode(ShaderMode::SOLID);
+	// and set the shader mode to solid so we can draw solid color
+	m_recordingState = { RenderPass::OUTLINE, ShaderMode::SOLID, StencilMode::MASK };
 
 	// 1: Draw outline for the hovered atom =============================================================
-	DrawOutlineIfNotNull(SimulationManager::AtomHoveredOver(), DirectX::Colors::Purple, 0.01f);
+	DrawOutlineIfNotNull(SimulationManager::AtomHoveredOver(), m_hoveredOutlineMaterial, 0.01f);
 
 
 	// 2: Draw outline for primary selected atom ========================================================
-	switch (SimulationManager::GetUserState())
-	{
-	// In the view, edit bond, and edit velocity state, only draw the outline if shift is held down
-	case UserState::VIEW:
-	case UserState::EDIT_BONDS:
-	case UserState::EDIT_VELOCITY_ARROWS:
-		if (m_moveLookController->ShiftIsDown())
-			DrawOutlineIfNotNull(SimulationManager::GetPrimarySelectedAtom(), DirectX::Colors::Red, 0.01f);
-		break;
-
-	default:
-		DrawOutlineIfNotNull(SimulationManager::GetPrimarySelectedAtom(), DirectX::Colors::Red, 0.01f);
-	}
+	if (PrimarySelectedAtomIsOutlined())
+		DrawOutlineIfNotNull(SimulationManager::GetPrimarySelectedAtom(), m_primarySelectedOutlineMaterial, 0.01f);
 
 
 	// 3: Draw outline for all group selected atoms =====================================================
 	for (std::shared_ptr<Atom> a : SimulationManager::GetSelectedAtoms())
-		DrawOutline(a, DirectX::Colors::Blue, 0.005f);
+		DrawOutline(a, m_groupSelectedOutlineMaterial, 0.005f);
 
 
 
 
 	// 4: Draw outline for hovered bond =================================================================
+	if (HoveredBondIsOutlined())
+		DrawOutlineIfNotNull(SimulationManager::BondHoveredOver(), m_hoveredOutlineMaterial, 0.01f);
+	
+
+	// 5: Draw outline for primary selected bond =========================================================
+	if (PrimarySelectedBondIsOutlined())
+		DrawOutlineIfNotNull(SimulationManager::GetPrimarySelectedBond(), m_primarySelectedOutlineMaterial, 0.01f);
+
+
+	// 6: Draw outline for all group selected bonds ======================================================
+	for (std::shared_ptr<Bond> b : SimulationManager::GetSelectedBonds())
+	{
+		DrawOutline(b, m_groupSelectedOutlineMaterial, 0.005f);
+	}
+}
+
+void SimulationRenderer::DrawScreenSpaceOutline()
+{
+	// The outline IDs were assigned to the atom and bond instances when they were packed (see DrawAtoms and
+	// DrawBonds). Skip the pass entirely when nothing is outlined
+	if (SimulationManager::AtomHoveredOver() == nullptr && SimulationManager::GetSelectedAtoms().empty() &&
+		SimulationManager::GetSelectedBonds().empty() &&
+		(SimulationManager::BondHoveredOver() == nullptr || !HoveredBondIsOutlined()) &&
+		(SimulationManager::GetPrimarySelectedAtom() == nullptr || !PrimarySelectedAtomIsOutlined()) &&
+		(SimulationManager::GetPrimarySelectedBond() == nullptr || !PrimarySelectedBondIsOutlined()))
+		return;
+
+	m_scene.DrawScreenSpaceOutline();
+}
+
+bool SimulationRenderer::PrimarySelectedAtomIsOutlined()
+{
 	switch (SimulationManager::GetUserState())
 	{
-		// In the view and edit velocity arrows state, only draw the hovered bond if CTRL is down
+	// In the view, edit bond, and edit velocity state, only outline it if shift is held down
 	case UserState::VIEW:
+	case UserState::EDIT_BONDS:
 	case UserState::EDIT_VELOCITY_ARROWS:
-		if (m_moveLookController->CTRLIsDown())
-			DrawOutlineIfNotNull(SimulationManager::BondHoveredOver(), DirectX::Colors::Purple, 0.01f);
-		break;
+		return m_moveLookController->ShiftIsDown();
 
 	default:
-		DrawOutlineIfNotNull(SimulationManager::BondHoveredOver(), DirectX::Colors::Purple, 0.01f);
+		return true;
 	}
-	
+}
+bool SimulationRenderer::HoveredBondIsOutlined()
+{
+	switch (SimulationManager::GetUserState())
+	{
+	// In the view and edit velocity arrows state, only outline the hovered bond if CTRL is down
+	case UserState::VIEW:
+	case UserState::EDIT_VELOCITY_ARROWS:
+		return m_moveLookController->CTRLIsDown();
 
-	// 5: Draw outline for primary selected bond =========================================================
+	default:
+		return true;
+	}
+}
+bool SimulationRenderer::PrimarySelectedBondIsOutlined()
+{
 	switch (SimulationManager::GetUserState())
 	{
-		// Don't draw the outline for the primary bond in the VIEW state
+	// Don't outline the primary selected bond in the VIEW state
 	case UserState::VIEW:
-		break;
+		return false;
 
-		// Draw the outline for the primary selected bond when shift is down
+	// Outline the primary selected bond when shift is down
 	case UserState::EDIT_BONDS:
-		if (m_moveLookController->ShiftIsDown())
-			DrawOutlineIfNotNull(SimulationManager::GetPrimarySelectedBond(), DirectX::Colors::Red, 0.01f);
-		break;
+		return m_moveLookController->ShiftIsDown();
 
 	default:
-		DrawOutlineIfNotNull(SimulationManager::GetPrimarySelectedBond(), DirectX::Colors::Red, 0.01f);
-	}	
-
-
-	// 6: Draw outline for all group selected bonds ======================================================
-	for (std::shared_ptr<Bond> b : SimulationManager::GetSelectedBonds())
-	{
-		DrawOutline(b, DirectX::Colors::Blue, 0.005f);
+		return true;
 	}
 }
 
 void SimulationRenderer::Draw(std::shared_ptr<Atom> atom)
 {
-	this->SetMaterialProperties(atom);
-	atom->Render(m_viewProjectionMatrix);
+	// Element materials are at the index of their element type
+	atom->Render(m_scene.Commands(), m_recordingState, atom->ElementType());
 }
-void SimulationRenderer::DrawOutline(std::shared_ptr<Atom> atom, DirectXColor color, float width)
+void SimulationRenderer::DrawOutline(std::shared_ptr<Atom> atom, uint32_t material, float width)
 {
-	this->SetMaterialProperties(color);
-	atom->RenderOutline(m_viewProjectionMatrix, width);
+	atom->RenderOutline(m_scene.Commands(), m_recordingState, width, material);
 }
 void SimulationRenderer::Draw(std::shared_ptr<Bond> bond)
 {
-	// Set material property for first atom & Render atom1 to midpoint
-	this->SetMaterialProperties(bond->Atom1());
-	bond->RenderAtom1ToMidPoint(m_viewProjectionMatrix, m_moveLookController->Position());
-
-	// Set material property for second atom & Render midpoint to atom2
-	this->SetMaterialProperties(bond->Atom2());
-	bond->RenderMidPointToAtom2(m_viewProjectionMatrix, m_moveLookController->Position());
+	// Render atom1 to midpoint with the material of the first atom and midpoint to atom2 with the material of the second
+	bond->RenderAtom1ToMidPoint(m_scene.Commands(), m_recordingState, m_moveLookController->Position(), bond->Atom1()->ElementType());
+	bond->RenderMidPointToAtom2(m_scene.Commands(), m_recordingState, m_moveLookController->Position(), bond->Atom2()->ElementType());
 }
-void SimulationRenderer::DrawOutline(std::shared_ptr<Bond> bond, DirectXColor color, float width)
+void SimulationRenderer::DrawOutline(std::shared_ptr<Bond> bond, uint32_t material, float width)
 {
-	this->SetMaterialProperties(color); // Change the color to a solid color
-	bond->RenderOutline(m_viewProjectionMatrix, m_moveLookController->Position(), width);
+	bond->RenderOutline(m_scene.Commands(), m_recordingState, m_moveLookController->Position(), width, material);
 }
 
 
@@ -735,93 +1092,343 @@ void SimulationRenderer::DrawBackground()
 }
 void SimulationRenderer::DrawAtoms()
 {
-	// Set up the pipeline for drawing atoms
-	this->SetStencilMode(StencilMode::NONE);	// Do not write to the stencil buffer
-	this->SetShaderMode(ShaderMode::PHONG);		// Use Phong shading
-
-	// Set the current element to invalid so that the first atom will set the material properties
-	ELEMENT currentElement = Element::INVALID;
-
-	for (std::shared_ptr<Atom> atom : SimulationManager::Atoms())
+	if (m_outlineMode != OutlineMode::SCREEN_SPACE)
 	{
-		// Update the material type if necessary
-		if (atom->ElementType() != currentElement)
-		{
-			currentElement = atom->ElementType();
-			this->SetMaterialProperties(atom);
-		}
-		
-		atom->Render(m_viewProjectionMatrix);
+		m_scene.DrawAtoms(SimulationManager::Atoms(), m_atomRenderMode);
+		return;
 	}
+
+	// Outline IDs are written by the scene itself, so each instance carries its own. Where an atom has more
+	// than one the highest wins, which is the outline the stencil path draws last
+	std::shared_ptr<Atom> hovered = SimulationManager::AtomHoveredOver();
+	std::shared_ptr<Atom> primary = PrimarySelectedAtomIsOutlined() ? SimulationManager::GetPrimarySelectedAtom() : nullptr;
+	bool anySelected = !SimulationManager::GetSelectedAtoms().empty();
+
+	m_scene.DrawAtoms(SimulationManager::Atoms(), m_atomRenderMode, [&](const std::shared_ptr<Atom>& atom) {
+		if (anySelected && SimulationManager::AtomIsSelected(atom))
+			return SelectionOutline::GROUP_SELECTED;
+		if (atom == primary)
+			return SelectionOutline::PRIMARY_SELECTED;
+		if (atom == hovered)
+			return SelectionOutline::HOVERED;
+		return SelectionOutline::NONE;
+	});
 }
-void SimulationRenderer::DrawAtomVelocityArrows()
+void SimulationRenderer::DrawBonds()
 {
-	// Set up the pipeline for drawing the velocity arrows
-	this->SetStencilMode(StencilMode::NONE);					// Do not write to the stencil buffer
-	this->SetShaderMode(ShaderMode::PHONG);						// Use Phong shading
-	this->SetMaterialProperties(m_velocityArrowMaterial.get()); // Set the velocity arrow material
+	const float cylinderRadius = Constants::AtomicRadii[Element::HYDROGEN] / 3.0f;
 
-	for (std::shared_ptr<Atom> atom : SimulationManager::Atoms())
+	if (m_outlineMode != OutlineMode::SCREEN_SPACE)
 	{
-		atom->RenderVelocityArrow(m_viewProjectionMatrix);
+		m_scene.DrawBonds(SimulationManager::Bonds(), cylinderRadius);
+		return;
 	}
+
+	// See DrawAtoms
+	std::shared_ptr<Bond> hovered = HoveredBondIsOutlined() ? SimulationManager::BondHoveredOver() : nullptr;
+	std::shared_ptr<Bond> primary = PrimarySelectedBondIsOutlined() ? SimulationManager::GetPrimarySelectedBond() : nullptr;
+	bool anySelected = !SimulationManager::GetSelectedBonds().empty();
+
+	m_scene.DrawBonds(SimulationManager::Bonds(), cylinderRadius, [&](const std::shared_ptr<Bond>& bond) {
+		if (anySelected && SimulationManager::BondIsSelected(bond))
+			return SelectionOutline::GROUP_SELECTED;
+		if (bond == primary)
+			return SelectionOutline::PRIMARY_SELECTED;
+		if (bond == hovered)
+			return SelectionOutline::HOVERED;
+		return SelectionOutline::NONE;
+	});
 }
-void SimulationRenderer::DrawBonds()
+
+void SimulationRenderer::SubmitCommands(ID3D11RenderTargetView* target, ID3D11DepthStencilView* depthStencil, const D3D11_VIEWPORT& viewport)
 {
-	// Set up the pipeline for drawing bonds
-	this->SetStencilMode(StencilMode::NONE);	// Do not write to the stencil buffer
-	this->SetShaderMode(ShaderMode::PHONG);		// Use Phong shading
+	ID3D11DeviceContext4* context = m_deviceResources->D3DDeviceContext();
+	UploadRingBuffer* uploadRing = m_deviceResources->UploadRing();
+
+	// Set up pipeline configurations that will not change
+	context->RSSetViewports(1, &viewport);
 
-	for (std::shared_ptr<Bond> bond : SimulationManager::Bonds())
+	// Every pixel shader reads its material from the table (t0) and the Phong shaders read the lights (b1).
+	// Neither is rebound for the rest of the frame
+	m_materials->Bind(0);
+
+	// The lights are placed in world space - move them into the camera relative space the scene is drawn in
+	LightProperties lightProperties = m_lightProperties;
+	CameraSpace::Rebase(m_scene.Origin(), &lightProperties.EyePosition.x, sizeof(DirectX::XMFLOAT4), 1);
+	CameraSpace::Rebase(m_scene.Origin(), &lightProperties.Lights[0].Position.x, sizeof(Light), MAX_LIGHTS);
+	uploadRing->PSSetConstants(1, lightProperties);
+
+	// Upload the instances the instanced commands refer to
+	const std::vector<AtomInstance>& atomInstances = m_scene.Atoms().Instances();
+	if (!atomInstances.empty())
 	{
-		// Set material property for first atom
-		this->SetMaterialProperties(bond->Atom1());
+		UploadInstances(atomInstances.data(), sizeof(AtomInstance), static_cast<unsigned int>(atomInstances.size()),
+			m_atomInstanceBufferCapacity, m_atomInstanceBuffer, m_atomInstanceBufferView);
+	}
 
-		// Render atom1 to midpoint
-		bond->RenderAtom1ToMidPoint(m_viewProjectionMatrix, m_moveLookController->Position());
+	const std::vector<BondCylinderInstance>& bondInstances = m_scene.Bonds().Instances();
+	if (!bondInstances.empty())
+	{
+		UploadInstances(bondInstances.data(), sizeof(BondCylinderInstance), static_cast<unsigned int>(bondInstances.size()),
+			m_bondInstanceBufferCapacity, m_bondInstanceBuffer, m_bondInstanceBufferView);
+	}
 
-		// Set material property for second atom
-		this->SetMaterialProperties(bond->Atom2());
+	const std::vector<VelocityArrowInstance>& arrowInstances = m_scene.Arrows().Instances();
+	if (!arrowInstances.empty())
+	{
+		UploadInstances(arrowInstances.data(), sizeof(VelocityArrowInstance), static_cast<unsigned int>(arrowInstances.size()),
+			m_arrowInstanceBufferCapacity, m_arrowInstanceBuffer, m_arrowInstanceBufferView);
+	}
 
-		// Render midpoint to atom2
-		bond->RenderMidPointToAtom2(m_viewProjectionMatrix, m_moveLookController->Position());
+	DirectX::XMStoreFloat4x4(&m_instancedViewProjectionBufferData.viewProjection, m_viewProjectionMatrix);
+	DirectX::XMStoreFloat4x4(&m_impostorBufferData.viewProjection, m_viewProjectionMatrix);
+	m_impostorBufferData.cameraPosition = XMFLOAT3(0.0f, 0.0f, 0.0f);		// Camera relative
+
+	std::shared_ptr<SphereMesh> sphereMesh = MeshManager::GetSphereMesh();
+	std::shared_ptr<CylinderMesh> cylinderMesh = MeshManager::GetCylinderMesh();
+	std::shared_ptr<ArrowMesh> arrowMesh = MeshManager::GetArrowMesh();
+
+	DirectX::XMStoreFloat4x4(&m_instancedArrowBufferData.viewProjection, m_viewProjectionMatrix);
+	m_instancedArrowBufferData.width = arrowMesh->Width();
+	m_instancedArrowBufferData.materialIndex = m_velocityArrowMaterial;
+
+	// Screen space outlines - the scene pass also writes the outline ID of each pixel (SV_TARGET1). The color
+	// target alone is bound again once the scene is drawn, so the outline pass can read the IDs
+	ID3D11RenderTargetView* const colorTarget[] = { target };
+	bool outlineIDTargetBound = false;
+	if (m_outlineMode == OutlineMode::SCREEN_SPACE)
+	{
+		CreateOutlineIDTarget(target);
+
+		const FLOAT noOutline[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		context->ClearRenderTargetView(m_outlineIDTargetView.Get(), noOutline);
+
+		ID3D11RenderTargetView* const sceneTargets[] = { target, m_outlineIDTargetView.Get() };
+		context->OMSetRenderTargets(2, sceneTargets, depthStencil);
+		outlineIDTargetBound = true;
+
+		m_selectionOutlineBufferData.radius = static_cast<int32_t>(std::lround(m_deviceResources->DIPSToPixels(2.0f)));
 	}
-}
-void SimulationRenderer::DrawBox()
-{
-	ID3D11DeviceContext4* context = m_deviceResources->D3DDeviceContext();
 
-	UINT stride = sizeof(VertexPositionNormal);
-	UINT offset = 0;
-	ID3D11Buffer* const boxVertexBuffers[] = { m_boxVertexBuffer.Get() };
-	context->IASetVertexBuffers(0, 1, boxVertexBuffers, &stride, &offset);
-	context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_LINELIST);
+	const RenderCommandList& commands = m_scene.Commands();
+	const std::vector<RenderTransform>& transforms = commands.Transforms();
 
-	// Scale the box according to the current box dimensions
-	XMFLOAT3 dims = SimulationManager::BoxDimensions();
-	XMMATRIX model = DirectX::XMMatrixScaling(dims.x, dims.y, dims.z);
+	// Redundant state elimination - each piece of state is only applied when the next command needs something
+	// different from what is bound. The commands are sorted by state, so this happens a handful of times per frame
+	RenderStatistics statistics = {};
+	statistics.Commands = static_cast<uint32_t>(commands.Commands().size());
+
+	auto changed = [&statistics](bool different) {
+		if (different)
+			++statistics.StateChanges;
+		else
+			++statistics.RedundantStates;
+		return different;
+	};
+
+	bool first = true;
+	RenderStateBlock state = {};
+	RenderTopology topology = RenderTopology::TRIANGLE_LIST;
+	ID3D11ShaderResourceView* boundInstanceView = nullptr;
+	bool meshBound = false;
+	RenderMesh boundMesh = RenderMesh::BOX;
+	uint8_t boundLevel = 0;
+
+	for (const RenderCommand& command : commands.Commands())
+	{
+		if (outlineIDTargetBound && command.State.Pass != RenderPass::SCENE)
+		{
+			context->OMSetRenderTargets(1, colorTarget, depthStencil);
+			outlineIDTargetBound = false;
+		}
+
+		if (changed(first || command.State.Stencil != state.Stencil))
+			SetStencilMode(command.State.Stencil);
+
+		if (changed(first || command.State.Shader != state.Shader))
+			SetShaderMode(command.State.Shader);
+
+		// The instanced shaders read their instances from t0
+		ID3D11ShaderResourceView* instanceView = nullptr;
+		if (command.State.Shader == ShaderMode::PHONG_INSTANCED || command.State.Shader == ShaderMode::IMPOSTOR)
+			instanceView = m_atomInstanceBufferView.Get();
+		else if (command.State.Shader == ShaderMode::PHONG_INSTANCED_CYLINDER)
+			instanceView = m_bondInstanceBufferView.Get();
+		else if (command.State.Shader == ShaderMode::PHONG_INSTANCED_ARROW)
+			instanceView = m_arrowInstanceBufferView.Get();
+
+		if (instanceView != nullptr && changed(instanceView != boundInstanceView))
+		{
+			ID3D11ShaderResourceView* const vsResources[] = { instanceView };
+			context->VSSetShaderResources(0, 1, vsResources);
+			boundInstanceView = instanceView;
+		}
+
+		RenderTopology commandTopology = RenderCommandList::Topology(command.Mesh);
+		if (changed(first || commandTopology != topology))
+		{
+			switch (commandTopology)
+			{
+			case RenderTopology::TRIANGLE_LIST:  context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST); break;
+			case RenderTopology::TRIANGLE_STRIP: context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP); break;
+			case RenderTopology::LINE_LIST:      context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_LINELIST); break;
+			}
+		}
 
-	DirectX::XMStoreFloat4x4(&m_modelViewProjectionBufferData.model, model);
-	DirectX::XMStoreFloat4x4(&m_modelViewProjectionBufferData.modelViewProjection, model * m_viewProjectionMatrix);
-	DirectX::XMStoreFloat4x4(&m_modelViewProjectionBufferData.inverseTransposeModel, XMMatrixTranspose(XMMatrixInverse(nullptr, model)));
+		// Vertex and index buffers (the impostor quad and full screen triangle have none)
+		if (command.Mesh != RenderMesh::IMPOSTOR_QUAD && command.Mesh != RenderMesh::FULLSCREEN_TRIANGLE &&
+			changed(!meshBound || command.Mesh != boundMesh || command.Level != boundLevel))
+		{
+			switch (command.Mesh)
+			{
+			case RenderMesh::BOX:
+			{
+				UINT stride = sizeof(VertexPositionNormal);
+				UINT offset = 0;
+				ID3D11Buffer* const boxVertexBuffers[] = { m_boxVertexBuffer.Get() };
+				context->IASetVertexBuffers(0, 1, boxVertexBuffers, &stride, &offset);
+				break;
+			}
+			case RenderMesh::SPHERE:			sphereMesh->Bind(command.Level); break;
+			case RenderMesh::CYLINDER:			cylinderMesh->Bind(command.Level); break;
+			case RenderMesh::ARROW_CYLINDER:	arrowMesh->BindCylinder(command.Level); break;
+			case RenderMesh::ARROW_CONE:		arrowMesh->BindCone(command.Level); break;
+			default: break;
+			}
 
-	// Prepare the constant buffer to send it to the graphics device.
-	context->UpdateSubresource1(m_modelViewProjectionBuffer.Get(), 0, NULL, &m_modelViewProjectionBufferData, 0, 0, 0);
+			meshBound = true;
+			boundMesh = command.Mesh;
+			boundLevel = command.Level;
+		}
 
-	// Send the constant buffer to the graphics device.
-	ID3D11Buffer* const boxConstantBuffers[] = { m_modelViewProjectionBuffer.Get() };
-	context->VSSetConstantBuffers1(0, 1, boxConstantBuffers, nullptr, nullptr);
+		state = command.State;
+		topology = commandTopology;
+		first = false;
 
-	this->SetMaterialProperties(&m_boxMaterialProperties);
+		// Non-instanced draws - store model, modelviewprojection, and inversetransposemodel matrices and write
+		// the constant buffer to the upload ring
+		if (command.Transform != RenderCommandList::NoTransform)
+		{
+			const RenderTransform& transform = transforms[command.Transform];
+			XMFLOAT4X4 stored(&transform.Model[0][0]);
+			XMMATRIX model = DirectX::XMLoadFloat4x4(&stored);
+
+			m_modelViewProjectionBufferData.model = stored;
+			DirectX::XMStoreFloat4x4(&m_modelViewProjectionBufferData.modelViewProjection, model * m_viewProjectionMatrix);
+			DirectX::XMStoreFloat4x4(&m_modelViewProjectionBufferData.inverseTransposeModel, XMMatrixTranspose(XMMatrixInverse(nullptr, model)));
+			m_modelViewProjectionBufferData.materialIndex = transform.MaterialIndex;
+			m_modelViewProjectionBufferData.outline = SelectionOutline::NONE;
+
+			uploadRing->VSSetConstants(0, m_modelViewProjectionBufferData);
+		}
+
+		++statistics.DrawCalls;
+
+		switch (command.Mesh)
+		{
+		case RenderMesh::BOX:
+			context->Draw(24, 0);
+			break;
 
-	// Draw the objects.
-	context->Draw(24, 0);
+		case RenderMesh::SPHERE:
+			if (command.Transform != RenderCommandList::NoTransform)
+			{
+				sphereMesh->Render(command.Level);
+				break;
+			}
+
+			m_instancedViewProjectionBufferData.firstInstance = command.FirstInstance;
+			uploadRing->VSSetConstants(0, m_instancedViewProjectionBufferData);
+			sphereMesh->RenderInstanced(command.InstanceCount, command.Level);
+			break;
+
+		case RenderMesh::CYLINDER:
+			if (command.Transform != RenderCommandList::NoTransform)
+			{
+				cylinderMesh->Render(command.Level);
+				break;
+			}
+
+			m_instancedViewProjectionBufferData.firstInstance = command.FirstInstance;
+			uploadRing->VSSetConstants(0, m_instancedViewProjectionBufferData);
+			cylinderMesh->RenderInstanced(command.InstanceCount, command.Level);
+			break;
+
+		case RenderMesh::ARROW_CYLINDER:
+		case RenderMesh::ARROW_CONE:
+			m_instancedArrowBufferData.firstInstance = command.FirstInstance;
+			m_instancedArrowBufferData.part = command.Mesh == RenderMesh::ARROW_CYLINDER ? 0 : 1;
+			uploadRing->VSSetConstants(0, m_instancedArrowBufferData);
+
+			if (command.Mesh == RenderMesh::ARROW_CYLINDER)
+				arrowMesh->RenderCylinderInstanced(command.InstanceCount, command.Level);
+			else
+				arrowMesh->RenderConeInstanced(command.InstanceCount, command.Level);
+			break;
+
+		case RenderMesh::IMPOSTOR_QUAD:
+		{
+			m_impostorBufferData.firstInstance = command.FirstInstance;
+
+			UploadRingBuffer::Range impostorRange = uploadRing->Upload(m_impostorBufferData);
+			uploadRing->VSSetConstantBuffers(0, 1, &impostorRange);
+			uploadRing->PSSetConstantBuffers(2, 1, &impostorRange);
+
+			context->DrawInstanced(4, command.InstanceCount, 0, 0);
+			break;
+		}
+
+		case RenderMesh::FULLSCREEN_TRIANGLE:
+		{
+			// Only the selection outline is drawn full screen. The IDs are read from t1 (t0 is the material table)
+			ID3D11ShaderResourceView* const outlineResources[] = { m_outlineIDResourceView.Get() };
+			context->PSSetShaderResources(1, 1, outlineResources);
+			uploadRing->PSSetConstants(0, m_selectionOutlineBufferData);
+
+			context->Draw(3, 0);
+			break;
+		}
+		}
+	}
+
+	if (m_outlineMode == OutlineMode::SCREEN_SPACE)
+	{
+		// Nothing but the scene was drawn - still leave the color target alone bound for the controls drawn after this one
+		if (outlineIDTargetBound)
+			context->OMSetRenderTargets(1, colorTarget, depthStencil);
+
+		// Unbind the IDs so the target can be bound for output next frame
+		ID3D11ShaderResourceView* const nullResources[] = { nullptr };
+		context->PSSetShaderResources(1, 1, nullResources);
+	}
+
+#if defined(_DEBUG)
+	// Report the counts when they change, so the output isn't flooded while the camera moves
+	if (statistics != m_frameStatistics)
+	{
+		std::ostringstream oss;
+		oss << "SimulationRenderer: " << statistics.Commands << " commands, " << statistics.DrawCalls << " draw calls, "
+			<< statistics.StateChanges << " state changes (" << statistics.RedundantStates << " redundant skipped)\n";
+		OutputDebugString(oss.str().c_str());
+	}
+#endif
+
+	m_frameStatistics = statistics;
 }
 
 OnMessageResult SimulationRenderer::OnLButtonDown(std::shared_ptr<MouseState> mouseState)
 {
 	float _x = m_deviceResources->DIPSToPixels(static_cast<float>(mouseState->X()));
 	float _y = m_deviceResources->DIPSToPixels(static_cast<float>(mouseState->Y()));
+
+	// CTRL + drag that does not start on an atom or bond group selects the atoms inside a rectangle (or a
+	// lasso if SHIFT is also down). CTRL + click on an atom/bond still switches it selected/unselected
+	if (m_moveLookController->CTRLIsDown() && SimulationManager::AtomHoveredOver() == nullptr && SimulationManager::BondHoveredOver() == nullptr)
+	{
+		m_selectionShape = m_moveLookController->ShiftIsDown() ? SelectionShape::LASSO : SelectionShape::RECTANGLE;
+		m_selectionPoints.assign(1, D2D1::Point2F(_x, _y));
+		return OnMessageResult::CAPTURE_MOUSE_AND_MESSAGE_HANDLED;
+	}
 	
 	// Make sure the move look controller is only updated when the user state allows it
 	//if (SimulationManager::GetUserState() != UserState::EDIT_BONDS)
@@ -855,6 +1462,14 @@ OnMessageResult SimulationRenderer::OnLButtonUp(std::shared_ptr<MouseState> mous
 	float _x = m_deviceResources->DIPSToPixels(static_cast<float>(mouseState->X()));
 	float _y = m_deviceResources->DIPSToPixels(static_cast<float>(mouseState->Y()));
 
+	if (m_selectionShape != SelectionShape::NONE)
+	{
+		SelectAtomsInSelectionShape();
+		m_selectionShape = SelectionShape::NONE;
+		m_selectionPoints.clear();
+		return OnMessageResult::CAPTURE_MOUSE_AND_MESSAGE_HANDLED;
+	}
+
 	m_moveLookController->OnLButtonUp(_x, _y);
 
 	// Inform the simulation manager in case we are clicking on an atom
@@ -882,6 +1497,25 @@ OnMessageResult SimulationRenderer::OnMouseMove(std::shared_ptr<MouseState> mous
 	float _x = m_deviceResources->DIPSToPixels(static_cast<float>(mouseState->X()));
 	float _y = m_deviceResources->DIPSToPixels(static_cast<float>(mouseState->Y()));
 
+	// While a selection shape is being dragged, the mouse only edits the shape
+	switch (m_selectionShape)
+	{
+	case SelectionShape::RECTANGLE:
+		// The rectangle is between the first point and the current mouse position
+		m_selectionPoints.resize(2);
+		m_selectionPoints[1] = D2D1::Point2F(_x, _y);
+		return OnMessageResult::CAPTURE_MOUSE_AND_MESSAGE_HANDLED;
+
+	case SelectionShape::LASSO:
+	{
+		// Only add a lasso point once the mouse has moved a few pixels to keep the polygon small
+		const D2D1_POINT_2F& last = m_selectionPoints.back();
+		if (std::abs(_x - last.x) + std::abs(_y - last.y) >= 3.0f)
+			m_selectionPoints.push_back(D2D1::Point2F(_x, _y));
+		return OnMessageResult::CAPTURE_MOUSE_AND_MESSAGE_HANDLED;
+	}
+	}
+
 	m_moveLookController->OnMouseMove(_x, _y);
 
 	// if the simulation is paused -> perform picking
@@ -930,6 +1564,9 @@ OnMessageResult SimulationRenderer::OnChar(char key)
 	case 'a': m_moveLookController->RotateLeft90(); break;
 	case 's': m_moveLookController->RotateDown90(); break;
 	case 'd': m_moveLookController->RotateRight90(); break;
+	case 'i': m_atomRenderMode = (m_atomRenderMode == AtomRenderMode::MESH) ? AtomRenderMode::IMPOSTOR : AtomRenderMode::MESH; break;
+	case 'e': ExportCurrentView(); break;
+	case 'o': SetOutlineMode(m_outlineMode == OutlineMode::STENCIL ? OutlineMode::SCREEN_SPACE : OutlineMode::STENCIL); break;
 	}
 
 	return OnMessageResult::CAPTURE_MOUSE_AND_MESSAGE_HANDLED;
@@ -947,6 +1584,56 @@ bool SimulationRenderer::MouseIsOver(int x, int y)
 		m_viewport.TopLeftY + m_viewport.Height >= _y;
 }
 
+void SimulationRenderer::UpdatePickingHierarchy(const std::vector<std::shared_ptr<Atom>>& atoms, const std::vector<std::shared_ptr<Bond>>& bonds,
+												std::vector<std::shared_ptr<Bond>>& pickableBonds)
+{
+	// Refit the hierarchy to the current atom spheres and bond capsules. Sphere i is atoms[i] and capsule i
+	// is pickableBonds[i]. Each bond is a capsule from the surface of one atom to the other that is wide
+	// enough to contain all of its cylinders
+	const float cylinderRadius = Constants::AtomicRadii[Element::HYDROGEN] / 3.0f;
+	const float separation = 0.015f;	// Must match Bond::BondStartPosition
+
+	m_pickingHierarchy.Clear();
+	for (const std::shared_ptr<Atom>& atom : atoms)
+	{
+		XMFLOAT3 position = atom->Position();
+		const float center[3] = { position.x, position.y, position.z };
+		m_pickingHierarchy.AddSphere(center, atom->Radius());
+	}
+
+	// Capsule index -> bond (bonds that are being deleted have no atoms and are skipped)
+	pickableBonds.clear();
+	pickableBonds.reserve(bonds.size());
+	for (const std::shared_ptr<Bond>& bond : bonds)
+	{
+		if (bond->Atom1() == nullptr || bond->Atom2() == nullptr)
+			continue;
+
+		XMFLOAT3 p1 = bond->Atom1()->Position();
+		XMFLOAT3 p2 = bond->Atom2()->Position();
+		float dx = p2.x - p1.x, dy = p2.y - p1.y, dz = p2.z - p1.z;
+		float length = std::sqrt(dx * dx + dy * dy + dz * dz);
+		if (length == 0.0f)
+			continue;
+
+		float r1 = 0.88f * bond->Atom1()->DisplayRadius() / length;
+		float r2 = 0.88f * bond->Atom2()->DisplayRadius() / length;
+		const float start[3] = { p1.x + dx * r1, p1.y + dy * r1, p1.z + dz * r1 };
+		const float end[3] = { p2.x - dx * r2, p2.y - dy * r2, p2.z - dz * r2 };
+
+		float offset = 0.0f;
+		switch (bond->GetBondType())
+		{
+		case BondType::DOUBLE: offset = separation; break;
+		case BondType::TRIPLE: offset = 1.5f * separation; break;
+		}
+
+		m_pickingHierarchy.AddCapsule(start, end, cylinderRadius + offset);
+		pickableBonds.push_back(bond);
+	}
+	m_pickingHierarchy.Update();
+}
+
 void SimulationRenderer::PerformPicking(float mouseX, float mouseY)
 {
 	/* Will update which atom the pointer is over
@@ -954,68 +1641,42 @@ void SimulationRenderer::PerformPicking(float mouseX, float mouseY)
 	*  when the simulation is paused
 	*/
 	std::vector<std::shared_ptr<Atom>> atoms = SimulationManager::Atoms();
-
-	XMFLOAT3 clickpointNear = XMFLOAT3(mouseX, mouseY, 0.0f);
-	XMFLOAT3 clickpointFar = XMFLOAT3(mouseX, mouseY, 1.0f);
-
-	XMVECTOR clickpointNearVector = XMLoadFloat3(&clickpointNear);
-	XMVECTOR clickpointFarVector = XMLoadFloat3(&clickpointFar);
-
-	float shortestDistance = FLT_MAX; // Set initial to the maximum possible float value
-	float distance = FLT_MAX;
-	
+	std::vector<std::shared_ptr<Bond>> pickableBonds;
+	UpdatePickingHierarchy(atoms, SimulationManager::Bonds(), pickableBonds);
+
+	// The picking ray starts at the eye and passes through the mouse position on the near plane (depth 1 - the
+	// far plane is at infinity, see CameraSpace). The near plane point is unprojected camera relative, so the
+	// direction doesn't depend on how far the camera is from the world origin
+	XMVECTOR nearPointVector = DirectX::XMVector3Unproject(
+		DirectX::XMVectorSet(mouseX, mouseY, 1.0f, 0.0f),
+		m_viewport.TopLeftX,
+		m_viewport.TopLeftY,
+		m_viewport.Width,
+		m_viewport.Height,
+		0,
+		1,
+		m_projectionMatrix,
+		CameraRelativeViewMatrix(),
+		DirectX::XMMatrixIdentity());
+
+	XMFLOAT3 rayOrigin, rayDirection;
+	DirectX::XMStoreFloat3(&rayOrigin, m_moveLookController->Position());
+	DirectX::XMStoreFloat3(&rayDirection, DirectX::XMVector3Normalize(nearPointVector));
+
+	const float origin[3] = { rayOrigin.x, rayOrigin.y, rayOrigin.z };
+	const float direction[3] = { rayDirection.x, rayDirection.y, rayDirection.z };
+
+	// The closest atom or bond along the ray is the one being hovered over
 	std::shared_ptr<Atom> atomHoveredOver = nullptr;
-
-	for (std::shared_ptr<Atom> atom : atoms)
-	{
-		if (atom->MouseIsOver(mouseX, mouseY, m_viewport, m_projectionMatrix, m_viewMatrix, distance))
-		{
-			if (distance < shortestDistance)
-			{
-				atomHoveredOver = atom;
-				shortestDistance = distance;
-			}
-		}
-	}
-
-	// Perform cylinder/bond checking 
-
-	float shortestBondDistance = FLT_MAX; // Set initial to the maximum possible float value
-	float bondDistance = FLT_MAX;
 	std::shared_ptr<Bond> bondHoveredOver = nullptr;
 
-	for (std::shared_ptr<Bond> bond :  SimulationManager::Bonds())
-	{
-		// if an intersection is found, the distance will be returned in the 'distance' variable
-		if (bond->MouseIsOver(mouseX, mouseY, m_viewport, m_projectionMatrix, m_viewMatrix, m_moveLookController->Position(), bondDistance))
-		{
-			if (bondDistance < shortestBondDistance)
-			{
-				bondHoveredOver = bond;
-				shortestBondDistance = bondDistance;
-			}
-		}
-	}
-
-	// If a bond and an atom are both being hovered over, then find the closest to the camera and use that one
-	if (bondHoveredOver != nullptr && atomHoveredOver != nullptr)
+	BoundingVolumeHierarchy::Hit hit;
+	if (m_pickingHierarchy.Intersect(origin, direction, hit))
 	{
-		XMVECTOR cameraVector = m_moveLookController->Position();
-		XMVECTOR bondCenterVector = bondHoveredOver->BondCenter();
-		XMFLOAT3 atomCenter = atomHoveredOver->Position();
-		XMVECTOR atomCenterVector = DirectX::XMLoadFloat3(&atomCenter);
-
-		XMFLOAT3 cameraToBondDistance;
-		DirectX::XMStoreFloat3(&cameraToBondDistance, DirectX::XMVector3Length(DirectX::XMVectorSubtract(cameraVector, bondCenterVector)));
-		
-		XMFLOAT3 cameraToAtomDistance;
-		DirectX::XMStoreFloat3(&cameraToAtomDistance, DirectX::XMVector3Length(DirectX::XMVectorSubtract(cameraVector, atomCenterVector)));
-
-		// Set the object not being hovered over to nullptr
-		if (std::abs(cameraToBondDistance.x) < std::abs(cameraToAtomDistance.x))
-			atomHoveredOver = nullptr;
+		if (hit.Type == BoundingVolumeHierarchy::PrimitiveType::SPHERE)
+			atomHoveredOver = atoms[hit.Index];
 		else
-			bondHoveredOver = nullptr;
+			bondHoveredOver = pickableBonds[hit.Index];
 	}
 
 	// Inform the SimulationManager - CAN be nullptr
@@ -1036,6 +1697,77 @@ void SimulationRenderer::PerformPicking(float mouseX, float mouseY)
 	SimulationManager::BondHoveredOver(bondHoveredOver);
 }
 
+void SimulationRenderer::SelectAtomsInSelectionShape()
+{
+	if (m_selectionPoints.size() < 2)
+		return;
+
+	// Bounding rectangle of the shape in pixels
+	float left = m_selectionPoints[0].x, right = left;
+	float top = m_selectionPoints[0].y, bottom = top;
+	for (const D2D1_POINT_2F& point : m_selectionPoints)
+	{
+		left = std::min(left, point.x);
+		right = std::max(right, point.x);
+		top = std::min(top, point.y);
+		bottom = std::max(bottom, point.y);
+	}
+
+	// Pixels -> normalized device coordinates (y up)
+	auto ndcX = [this](float x) { return 2.0f * (x - m_viewport.TopLeftX) / m_viewport.Width - 1.0f; };
+	auto ndcY = [this](float y) { return 1.0f - 2.0f * (y - m_viewport.TopLeftY) / m_viewport.Height; };
+
+	// Use the view and projection of the last rendered frame so the selection matches what is on screen. The
+	// picking hierarchy is in world space, so this uses the full view rather than the camera relative one
+	XMFLOAT4X4 viewProjection;
+	DirectX::XMStoreFloat4x4(&viewProjection, m_viewMatrix * m_projectionMatrix);
+	Frustum region = Frustum::FromViewProjection(viewProjection.m, ndcX(left), ndcY(bottom), ndcX(right), ndcY(top));
+
+	// The hierarchy only visits the nodes that overlap the part of the view inside the rectangle
+	std::vector<std::shared_ptr<Atom>> atoms = SimulationManager::Atoms();
+	std::vector<std::shared_ptr<Bond>> pickableBonds;
+	UpdatePickingHierarchy(atoms, SimulationManager::Bonds(), pickableBonds);
+
+	std::vector<uint32_t> candidates;
+	m_pickingHierarchy.QuerySphereCenters(region, candidates);
+
+	if (m_selectionShape == SelectionShape::RECTANGLE)
+	{
+		for (uint32_t index : candidates)
+			SimulationManager::SelectAtom(atoms[index]);
+		return;
+	}
+
+	// Lasso: project the atoms inside its bounding rectangle in one batch and keep the ones inside the polygon
+	const size_t count = candidates.size();
+	std::vector<float> x(count), y(count), z(count), screenX(count), screenY(count);
+	for (size_t iii = 0; iii < count; ++iii)
+	{
+		XMFLOAT3 position = atoms[candidates[iii]]->Position();
+		x[iii] = position.x;
+		y[iii] = position.y;
+		z[iii] = position.z;
+	}
+	IntersectionKernels::ProjectPoints(viewProjection.m, x.data(), y.data(), z.data(), count, screenX.data(), screenY.data());
+
+	std::vector<float> polygon;
+	polygon.reserve(2 * m_selectionPoints.size());
+	for (const D2D1_POINT_2F& point : m_selectionPoints)
+	{
+		polygon.push_back(ndcX(point.x));
+		polygon.push_back(ndcY(point.y));
+	}
+
+	std::vector<uint8_t> inside(count);
+	IntersectionKernels::PointsInPolygon(polygon.data(), m_selectionPoints.size(), screenX.data(), screenY.data(), count, inside.data());
+
+	for (size_t iii = 0; iii < count; ++iii)
+	{
+		if (inside[iii])
+			SimulationManager::SelectAtom(atoms[candidates[iii]]);
+	}
+}
+
 
 
 void SimulationRenderer::SetShaderMode(ShaderMode mode)
@@ -1049,15 +1781,127 @@ void SimulationRenderer::SetShaderMode(ShaderMode mode)
 		context->VSSetShader(m_phongVertexShader.Get(), nullptr, 0);
 		context->PSSetShader(m_phongPixelShader.Get(), nullptr, 0);
 		break;
+	case ShaderMode::PHONG_INSTANCED:
+		context->IASetInputLayout(m_phongInputLayout.Get());
+		context->VSSetShader(m_phongInstancedVertexShader.Get(), nullptr, 0);
+		context->PSSetShader(m_phongPixelShader.Get(), nullptr, 0);
+		break;
+	case ShaderMode::PHONG_INSTANCED_CYLINDER:
+		context->IASetInputLayout(m_phongInputLayout.Get());
+		context->VSSetShader(m_phongInstancedCylinderVertexShader.Get(), nullptr, 0);
+		context->PSSetShader(m_phongPixelShader.Get(), nullptr, 0);
+		break;
+	case ShaderMode::PHONG_INSTANCED_ARROW:
+		context->IASetInputLayout(m_phongInputLayout.Get());
+		context->VSSetShader(m_phongInstancedArrowVertexShader.Get(), nullptr, 0);
+		context->PSSetShader(m_phongPixelShader.Get(), nullptr, 0);
+		break;
+	case ShaderMode::IMPOSTOR:
+		context->IASetInputLayout(nullptr);
+		context->VSSetShader(m_impostorVertexShader.Get(), nullptr, 0);
+		context->PSSetShader(m_impostorPixelShader.Get(), nullptr, 0);
+		break;
 	case ShaderMode::SOLID:
 		context->IASetInputLayout(m_solidInputLayout.Get());
 		context->VSSetShader(m_solidVertexShader.Get(), nullptr, 0);
 		context->PSSetShader(m_solidPixelShader.Get(), nullptr, 0);
 		break;
+	case ShaderMode::SELECTION_OUTLINE:
+		context->IASetInputLayout(nullptr);
+		context->VSSetShader(m_fullScreenTriangleVertexShader.Get(), nullptr, 0);
+		context->PSSetShader(m_selectionOutlinePixelShader.Get(), nullptr, 0);
+		break;
 	}
 }
 
 void SimulationRenderer::SetStencilMode(StencilMode mode)
+{
+	unsigned int index = static_cast<unsigned int>(mode);
+	m_deviceResources->D3DDeviceContext()->OMSetDepthStencilState(m_depthStencilStates[index].Get(), m_stencilReferenceValues[index]);
+}
+
+void SimulationRenderer::CreateOutlineIDTarget(ID3D11RenderTargetView* target)
+{
+	// Match the color target (the back buffer, which changes size with the window, or the export target) -
+	// targets bound together must be the same size
+	ComPtr<ID3D11Resource> targetResource;
+	target->GetResource(targetResource.ReleaseAndGetAddressOf());
+
+	ComPtr<ID3D11Texture2D> targetTexture;
+	ThrowIfFailed(targetResource.As(&targetTexture));
+
+	D3D11_TEXTURE2D_DESC targetDesc;
+	targetTexture->GetDesc(&targetDesc);
+
+	if (m_outlineIDTexture != nullptr && targetDesc.Width == m_outlineIDWidth && targetDesc.Height == m_outlineIDHeight)
+		return;
+
+	m_outlineIDWidth = targetDesc.Width;
+	m_outlineIDHeight = targetDesc.Height;
+
+	// One byte per pixel is plenty for the handful of outline IDs
+	CD3D11_TEXTURE2D_DESC desc(
+		DXGI_FORMAT_R8_UINT,
+		m_outlineIDWidth,
+		m_outlineIDHeight,
+		1,		// Array size
+		1,		// Mip levels
+		D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE
+	);
+
+	ID3D11Device5* device = m_deviceResources->D3DDevice();
+	ThrowIfFailed(device->CreateTexture2D(&desc, nullptr, m_outlineIDTexture.ReleaseAndGetAddressOf()));
+	ThrowIfFailed(device->CreateRenderTargetView(m_outlineIDTexture.Get(), nullptr, m_outlineIDTargetView.ReleaseAndGetAddressOf()));
+	ThrowIfFailed(device->CreateShaderResourceView(m_outlineIDTexture.Get(), nullptr, m_outlineIDResourceView.ReleaseAndGetAddressOf()));
+}
+
+void SimulationRenderer::CreateExportTargets(unsigned int width, unsigned int height)
+{
+	if (m_exportTexture != nullptr && width == m_exportWidth && height == m_exportHeight)
+		return;
+
+	m_exportWidth = width;
+	m_exportHeight = height;
+
+	ID3D11Device5* device = m_deviceResources->D3DDevice();
+
+	// RGBA rather than the BGRA of the swap chain, so the pixels are read back in the layout FrameWriter expects
+	CD3D11_TEXTURE2D_DESC colorDesc(DXGI_FORMAT_R8G8B8A8_UNORM, width, height, 1, 1, D3D11_BIND_RENDER_TARGET);
+	ThrowIfFailed(device->CreateTexture2D(&colorDesc, nullptr, m_exportTexture.ReleaseAndGetAddressOf()));
+	ThrowIfFailed(device->CreateRenderTargetView(m_exportTexture.Get(), nullptr, m_exportTargetView.ReleaseAndGetAddressOf()));
+
+	// Same format as the window's depth stencil buffer (see DeviceResources) - the stencil outlines need the stencil bits
+	CD3D11_TEXTURE2D_DESC depthStencilDesc(DXGI_FORMAT_D32_FLOAT_S8X24_UINT, width, height, 1, 1, D3D11_BIND_DEPTH_STENCIL);
+	ComPtr<ID3D11Texture2D> depthStencil;
+	ThrowIfFailed(device->CreateTexture2D(&depthStencilDesc, nullptr, depthStencil.ReleaseAndGetAddressOf()));
+
+	CD3D11_DEPTH_STENCIL_VIEW_DESC depthStencilViewDesc(D3D11_DSV_DIMENSION_TEXTURE2D, DXGI_FORMAT_D32_FLOAT_S8X24_UINT);
+	ThrowIfFailed(device->CreateDepthStencilView(depthStencil.Get(), &depthStencilViewDesc, m_exportDepthStencilView.ReleaseAndGetAddressOf()));
+
+	CD3D11_TEXTURE2D_DESC stagingDesc(DXGI_FORMAT_R8G8B8A8_UNORM, width, height, 1, 1, 0, D3D11_USAGE_STAGING, D3D11_CPU_ACCESS_READ);
+	for (ComPtr<ID3D11Texture2D>& staging : m_exportStagingTextures)
+		ThrowIfFailed(device->CreateTexture2D(&stagingDesc, nullptr, staging.ReleaseAndGetAddressOf()));
+}
+
+void SimulationRenderer::ReadBackExportTile(unsigned int slot, const FrameTile& tile, unsigned int frameWidth, std::vector<uint32_t>& frame)
+{
+	ID3D11DeviceContext4* context = m_deviceResources->D3DDeviceContext();
+
+	// Waits for the copy - by now the next tile has been queued, so the GPU has work while we wait
+	D3D11_MAPPED_SUBRESOURCE mapped;
+	ThrowIfFailed(context->Map(m_exportStagingTextures[slot].Get(), 0, D3D11_MAP_READ, 0, &mapped));
+
+	const uint8_t* source = static_cast<const uint8_t*>(mapped.pData);
+	for (unsigned int row = 0; row < tile.Height; ++row)
+	{
+		std::memcpy(&frame[static_cast<size_t>(tile.Y + row) * frameWidth + tile.X],
+			source + static_cast<size_t>(row) * mapped.RowPitch, tile.Width * sizeof(uint32_t));
+	}
+
+	context->Unmap(m_exportStagingTextures[slot].Get(), 0);
+}
+
+void SimulationRenderer::CreateDepthStencilState(StencilMode mode)
 {
 	D3D11_DEPTH_STENCIL_DESC dsDesc = CD3D11_DEPTH_STENCIL_DESC{ CD3D11_DEFAULT{} };
 
@@ -1086,6 +1930,9 @@ void SimulationRenderer::SetStencilMode(StencilMode mode)
 	*/
 
 
+	// Reverse Z (see CameraSpace) - nearer is a larger depth value
+	dsDesc.DepthFunc = D3D11_COMPARISON_GREATER;
+
 	// This value will be the one that is used as the "source" stencil value that is compared
 	// against the existing stencil value. We set it to 0 by default because that is what the
 	// entire stencil buffered is set to (see ContentWindow->Render()).
@@ -1096,11 +1943,11 @@ void SimulationRenderer::SetStencilMode(StencilMode mode)
 		// When we want to write to the stencil buffer, we want to set the stencil buffer value to 1
 		referenceValue = 1;
 
-		// Use compare_less_equal because an atom may be rendered twice BEFORE drawing the outline, 
+		// Use compare_greater_equal because an atom may be rendered twice BEFORE drawing the outline, 
 		// and it is the second draw that will set the stencil buffer value to 1. So we need the second
-		// draw to pass the depth test, which would fail if we just used compare_less because we are
+		// draw to pass the depth test, which would fail if we just used compare_greater because we are
 		// draw the same object to the same location
-		dsDesc.DepthFunc = D3D11_COMPARISON_LESS_EQUAL;
+		dsDesc.DepthFunc = D3D11_COMPARISON_GREATER_EQUAL;
 
 		// Enable stencil testing - write to entire stencil buffer
 		dsDesc.StencilEnable = TRUE;
@@ -1156,41 +2003,18 @@ void SimulationRenderer::SetStencilMode(StencilMode mode)
 		dsDesc.BackFace.StencilPassOp = D3D11_STENCIL_OP_KEEP;
 
 	}
+	else if (mode == StencilMode::DISABLED)
+	{
+		// Full screen passes cover every pixel at the near plane - don't test or write depth (stencil testing
+		// is already off by default)
+		dsDesc.DepthEnable = FALSE;
+		dsDesc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ZERO;
+	}
 
-	ID3D11Device5* device = m_deviceResources->D3DDevice();
-	ID3D11DeviceContext4* context = m_deviceResources->D3DDeviceContext();
-
-	ThrowIfFailed(device->CreateDepthStencilState(&dsDesc, m_d3dDepthStencilState.ReleaseAndGetAddressOf()));
-	context->OMSetDepthStencilState(m_d3dDepthStencilState.Get(), referenceValue);
-}
-
-void SimulationRenderer::SetMaterialProperties(std::shared_ptr<Atom> atom)
-{
-	// Set the material to that of the corresponding atom type
-	SetMaterialProperties(m_phongMaterialProperties[atom->ElementType()]);
-}
-
-void SimulationRenderer::SetMaterialProperties(DirectXColor color)
-{
-	ID3D11DeviceContext4* context = m_deviceResources->D3DDeviceContext();
-
-	// Create a new solid material and store the passed in color values
-	SolidMaterialProperties* material = new SolidMaterialProperties();
-	DirectX::XMStoreFloat4(&material->Color, color);
-
-	context->UpdateSubresource(m_solidMaterialPropertiesConstantBuffer.Get(), 0, nullptr, material, 0, 0);
-	ID3D11Buffer* const psConstantBuffers[] = { m_solidMaterialPropertiesConstantBuffer.Get() };
-	context->PSSetConstantBuffers1(0, 1, psConstantBuffers, nullptr, nullptr);	
-
-	delete material;
-}
-
-void SimulationRenderer::SetMaterialProperties(PhongMaterialProperties* material)
-{
-	ID3D11DeviceContext4* context = m_deviceResources->D3DDeviceContext();
+	unsigned int index = static_cast<unsigned int>(mode);
+	m_stencilReferenceValues[index] = referenceValue;
 
-	context->UpdateSubresource(m_phongMaterialPropertiesConstantBuffer.Get(), 0, nullptr, material, 0, 0);
-	ID3D11Buffer* const psConstantBuffers[] = { m_phongMaterialPropertiesConstantBuffer.Get(), m_lightPropertiesConstantBuffer.Get() };
-	context->PSSetConstantBuffers1(0, 2, psConstantBuffers, nullptr, nullptr);
+	ID3D11Device5* device = m_deviceResources->D3DDevice();
+	ThrowIfFailed(device->CreateDepthStencilState(&dsDesc, m_depthStencilStates[index].ReleaseAndGetAddressOf()));
 }
 
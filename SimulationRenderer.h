@@ -1,28 +1,53 @@
 #pragma once
 #include "pch.h"
 
+#include "BoundingVolumeHierarchy.h"
+#include "CameraSpace.h"
 #include "Control.h"
+#include "FrameExport.h"
+#include "Frustum.h"
 #include "HLSLStructures.h"
+#include "MaterialTable.h"
 #include "MoveLookController.h"
+#include "RenderCommandList.h"
+#include "RenderScheduler.h"
+#include "SceneRecorder.h"
 #include "SimulationManager.h"
 
 #include <memory>
+#include <string>
 #include <vector>
 #include <sstream>
 
 typedef DirectX::XMVECTORF32 DirectXColor;
 
-enum class StencilMode
+// How hovered/selected atoms and bonds are outlined
+enum class OutlineMode
+{
+	STENCIL,		// Stencil mask, then a slightly larger solid mesh per outlined object. Visible through other objects
+	SCREEN_SPACE	// The scene writes an outline ID per pixel and one full screen pass draws every outline
+};
+
+// Shape being dragged out to group select atoms (CTRL + drag for a rectangle, CTRL + SHIFT + drag for a lasso)
+enum class SelectionShape
 {
 	NONE,
-	WRITE,
-	MASK
+	RECTANGLE,
+	LASSO
 };
 
-enum class ShaderMode
+// Offline export of the scene as seen from the current camera (see SimulationRenderer::ExportFrames)
+struct FrameExportSettings
 {
-	PHONG,
-	SOLID
+	std::string		Path;						// Without the extension (see FrameFileFormat)
+	FrameFileFormat	Format = FrameFileFormat::IMAGE_SEQUENCE;
+	unsigned int	Width = 3840;
+	unsigned int	Height = 2160;
+	unsigned int	FrameCount = 1;
+	unsigned int	FramesPerSecond = 30;		// RAW_VIDEO only
+	double			TimeStep = 0.0;				// Simulation steps between frames - 0 exports the current state every frame
+	unsigned int	StepsPerFrame = 1;
+	unsigned int	MaxTileSize = 2048;			// Larger frames are rendered in tiles (see SplitFrame)
 };
 
 class SimulationRenderer : public Control
@@ -41,9 +66,11 @@ public:
 
 	void Update(StepTimer const& stepTimer) override;
 
-	// Don't override Render2D() because there is no 2D rendering needed here
 	bool Render3D() override;
 
+	// 2D rendering is only used to draw the selection rectangle/lasso while it is being dragged
+	bool Render2D() override;
+
 	void OnLayoutResize() override { CreateWindowSizeDependentResources(); }
 	void OnMarginChanged() override { CreateWindowSizeDependentResources(); }
 
@@ -63,6 +90,24 @@ public:
 
 	bool CTRLIsDown() { return m_moveLookController->CTRLIsDown(); }
 
+	AtomRenderMode GetAtomRenderMode() { return m_atomRenderMode; }
+	void SetAtomRenderMode(AtomRenderMode mode) { m_atomRenderMode = mode; }
+
+	OutlineMode GetOutlineMode() { return m_outlineMode; }
+	void SetOutlineMode(OutlineMode mode) { m_outlineMode = mode; }
+
+	// Draw calls and pipeline state changes of the last frame (see SubmitCommands)
+	const RenderStatistics& FrameStatistics() const { return m_frameStatistics; }
+
+	// Render FrameCount frames offscreen at the requested resolution and write them with a FrameWriter,
+	// stepping the simulation between frames. Blocks until the last frame is written. Returns false if
+	// the output couldn't be created or written
+	bool ExportFrames(const FrameExportSettings& settings);
+
+	// Export a single frame of the current view with the default settings to simulation_export_00000.ppm in
+	// the working directory ('e' key)
+	void ExportCurrentView();
+
 private:
 	void CreateDeviceDependentResources();
 	void CreateWindowSizeDependentResources();
@@ -71,39 +116,58 @@ private:
 	void CreateVertexShaderAndInputLayout();
 	void CreatePixelShader();
 	void CreateBuffers();
+	void CreateInstanceBuffer(unsigned int stride, unsigned int capacity, Microsoft::WRL::ComPtr<ID3D11Buffer>& buffer, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>& view);
+	void UploadInstances(const void* data, unsigned int stride, unsigned int count, unsigned int& capacity, Microsoft::WRL::ComPtr<ID3D11Buffer>& buffer, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>& view);
 	void CreateBox();
+	void CreateDepthStencilState(StencilMode mode);
+	void CreateOutlineIDTarget(ID3D11RenderTargetView* target);
+	void CreateExportTargets(unsigned int width, unsigned int height);
+	void ReadBackExportTile(unsigned int slot, const FrameTile& tile, unsigned int frameWidth, std::vector<uint32_t>& frame);
 
+	void UpdatePickingHierarchy(const std::vector<std::shared_ptr<Atom>>& atoms, const std::vector<std::shared_ptr<Bond>>& bonds,
+								std::vector<std::shared_ptr<Bond>>& pickableBonds);
 	void PerformPicking(float mouseX, float mouseY);
+	void SelectAtomsInSelectionShape();
 
 	// Pipeline Modification functions
 	void SetShaderMode(ShaderMode mode);
 	void SetStencilMode(StencilMode mode);
 
-	void SetMaterialProperties(std::shared_ptr<Atom> atom); // Set pixel shader buffer to use atom specific material
-	void SetMaterialProperties(DirectXColor color);			// Set pixel shader buffer to use a solid color
-	void SetMaterialProperties(PhongMaterialProperties* material); // Pass a material pointer in directly (used for setting arrow material)
-
-	// Render steps
+	// Render steps - everything but DrawBackground records into m_scene, whose commands SubmitCommands then draws
 	void DrawBackground();
 	void DrawAtoms();
-	void DrawAtomVelocityArrows();
 	void DrawBonds();
-	void DrawBox();
 
 	// Draw Helper functions
 	void Draw(std::shared_ptr<Atom> atom);
 	void DrawIfNotNull(std::shared_ptr<Atom> atom) { if (atom != nullptr) Draw(atom); }
-	void DrawOutline(std::shared_ptr<Atom> atom, DirectXColor color, float width);
-	void DrawOutlineIfNotNull(std::shared_ptr<Atom> atom, DirectXColor color, float width) { if (atom != nullptr) DrawOutline(atom, color, width); }
+	void DrawOutline(std::shared_ptr<Atom> atom, uint32_t material, float width);
+	void DrawOutlineIfNotNull(std::shared_ptr<Atom> atom, uint32_t material, float width) { if (atom != nullptr) DrawOutline(atom, material, width); }
 
 	void Draw(std::shared_ptr<Bond> bond);
 	void DrawIfNotNull(std::shared_ptr<Bond> bond) { if (bond != nullptr) Draw(bond); }
-	void DrawOutline(std::shared_ptr<Bond> bond, DirectXColor color, float width);
-	void DrawOutlineIfNotNull(std::shared_ptr<Bond> bond, DirectXColor color, float width) { if (bond != nullptr) DrawOutline(bond, color, width); }
+	void DrawOutline(std::shared_ptr<Bond> bond, uint32_t material, float width);
+	void DrawOutlineIfNotNull(std::shared_ptr<Bond> bond, uint32_t material, float width) { if (bond != nullptr) DrawOutline(bond, material, width); }
 
 
 	void DrawStencilMask();
 	void DrawHoveredAndSelectedAtomsAndBonds();
+	void DrawScreenSpaceOutline();
+
+	// Whether the user state and modifier keys call for these to be outlined (the hovered atom and the
+	// selected atoms and bonds always are)
+	bool PrimarySelectedAtomIsOutlined();
+	bool HoveredBondIsOutlined();
+	bool PrimarySelectedBondIsOutlined();
+
+	// Record the draws of the frame into m_scene and sort them
+	void RecordFrame();
+
+	// The view matrix without its translation - the view of the camera relative space (see CameraSpace)
+	DirectX::XMMATRIX CameraRelativeViewMatrix() const;
+
+	// D3D11 backend for the command list
+	void SubmitCommands(ID3D11RenderTargetView* target, ID3D11DepthStencilView* depthStencil, const D3D11_VIEWPORT& viewport);
 
 	Microsoft::WRL::ComPtr<ID2D1SolidColorBrush> m_backgroundColorBrush;
 
@@ -125,41 +189,101 @@ private:
 	Microsoft::WRL::ComPtr<ID3D11PixelShader>	m_phongPixelShader;
 	Microsoft::WRL::ComPtr<ID3D11InputLayout>	m_phongInputLayout;
 
+	Microsoft::WRL::ComPtr<ID3D11VertexShader>	m_phongInstancedVertexShader;			// Uses m_phongInputLayout (same vertex input)
+	Microsoft::WRL::ComPtr<ID3D11VertexShader>	m_phongInstancedCylinderVertexShader;	// Uses m_phongInputLayout (same vertex input)
+	Microsoft::WRL::ComPtr<ID3D11VertexShader>	m_phongInstancedArrowVertexShader;		// Uses m_phongInputLayout (same vertex input)
+
+	Microsoft::WRL::ComPtr<ID3D11VertexShader>	m_impostorVertexShader;				// No input layout - vertices are generated from SV_VertexID
+	Microsoft::WRL::ComPtr<ID3D11PixelShader>	m_impostorPixelShader;
+
 	Microsoft::WRL::ComPtr<ID3D11VertexShader>	m_solidVertexShader;
 	Microsoft::WRL::ComPtr<ID3D11PixelShader>	m_solidPixelShader;
 	Microsoft::WRL::ComPtr<ID3D11InputLayout>	m_solidInputLayout;
 
-	Microsoft::WRL::ComPtr<ID3D11Buffer>		m_modelViewProjectionBuffer;
+	Microsoft::WRL::ComPtr<ID3D11VertexShader>	m_fullScreenTriangleVertexShader;	// No input layout - vertices are generated from SV_VertexID
+	Microsoft::WRL::ComPtr<ID3D11PixelShader>	m_selectionOutlinePixelShader;
+
 	ModelViewProjectionConstantBuffer			m_modelViewProjectionBufferData;
 	DirectX::XMMATRIX							m_viewMatrix;
 	DirectX::XMMATRIX							m_projectionMatrix;
 	DirectX::XMMATRIX							m_viewProjectionMatrix;
 
+	// The draws of the current frame and the instances they refer to (everything is drawn relative to the eye,
+	// see CameraSpace), and the state block the Draw helpers record with (set by each render step the way it
+	// would set the pipeline state)
+	SceneRecorder								m_scene;
+	RenderStateBlock							m_recordingState;
+	RenderStatistics							m_frameStatistics;
+	float										m_pixelsPerUnit;		// Screen radius (pixels) of a unit sphere at distance 1 - used to pick the level of detail
+
+	// Instanced atom and bond rendering
+	Microsoft::WRL::ComPtr<ID3D11Buffer>			m_atomInstanceBuffer;
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_atomInstanceBufferView;
+	unsigned int									m_atomInstanceBufferCapacity;
+	Microsoft::WRL::ComPtr<ID3D11Buffer>			m_bondInstanceBuffer;
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_bondInstanceBufferView;
+	unsigned int									m_bondInstanceBufferCapacity;
+	Microsoft::WRL::ComPtr<ID3D11Buffer>			m_arrowInstanceBuffer;
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_arrowInstanceBufferView;
+	unsigned int									m_arrowInstanceBufferCapacity;
+	InstancedViewProjectionConstantBuffer			m_instancedViewProjectionBufferData;
+	InstancedArrowConstantBuffer					m_instancedArrowBufferData;
+	AtomRenderMode									m_atomRenderMode;
+	ImpostorConstantBuffer							m_impostorBufferData;
+
+	// Screen space outlines - the scene writes the SelectionOutline ID of every pixel to this target (SV_TARGET1),
+	// which the outline pass then reads. Sized to the color target, so the viewport coordinates can be used directly
+	OutlineMode										m_outlineMode;
+	Microsoft::WRL::ComPtr<ID3D11Texture2D>			m_outlineIDTexture;
+	Microsoft::WRL::ComPtr<ID3D11RenderTargetView>	m_outlineIDTargetView;
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_outlineIDResourceView;
+	UINT											m_outlineIDWidth;
+	UINT											m_outlineIDHeight;
+	SelectionOutlineConstantBuffer					m_selectionOutlineBufferData;
+
+	// Offline export - one tile sized target plus two staging copies, so one tile is read back while the
+	// next is rendered
+	Microsoft::WRL::ComPtr<ID3D11Texture2D>			m_exportTexture;
+	Microsoft::WRL::ComPtr<ID3D11RenderTargetView>	m_exportTargetView;
+	Microsoft::WRL::ComPtr<ID3D11DepthStencilView>	m_exportDepthStencilView;
+	Microsoft::WRL::ComPtr<ID3D11Texture2D>			m_exportStagingTextures[2];
+	unsigned int									m_exportWidth;
+	unsigned int									m_exportHeight;
+
 
 	// Light Properties
 	LightProperties								m_lightProperties;
-	Microsoft::WRL::ComPtr<ID3D11Buffer>		m_lightPropertiesConstantBuffer;
 
-	// MaterialProperties
-	Microsoft::WRL::ComPtr<ID3D11Buffer>		m_phongMaterialPropertiesConstantBuffer;
-	std::vector<PhongMaterialProperties*>		m_phongMaterialProperties;
-	std::unique_ptr<PhongMaterialProperties>	m_velocityArrowMaterial;
+	// Material table - the element materials are at the index of their element type, the others are looked up by index
+	std::unique_ptr<MaterialTable>				m_materials;
+	uint32_t									m_velocityArrowMaterial;
+	uint32_t									m_boxMaterial;
+	uint32_t									m_hoveredOutlineMaterial;			// Solid outline colors
+	uint32_t									m_primarySelectedOutlineMaterial;
+	uint32_t									m_groupSelectedOutlineMaterial;
 
-	Microsoft::WRL::ComPtr<ID3D11Buffer>		m_solidMaterialPropertiesConstantBuffer;
 
 
 	// Box Resources
 	Microsoft::WRL::ComPtr<ID3D11Buffer>		m_boxVertexBuffer;
-	PhongMaterialProperties						m_boxMaterialProperties;
-	Microsoft::WRL::ComPtr<ID3D11Buffer>		m_boxMaterialPropertiesConstantBuffer;
 
-	// Pipeline configuration
-	Microsoft::WRL::ComPtr<ID3D11DepthStencilState> m_d3dDepthStencilState;
+	// Pipeline configuration - one depth stencil state per StencilMode, created up front so switching mode
+	// doesn't create a new state object
+	Microsoft::WRL::ComPtr<ID3D11DepthStencilState> m_depthStencilStates[4];
+	UINT											m_stencilReferenceValues[4];
 
 
 
 	std::shared_ptr<CylinderMesh> m_testCylinder;
+
+	// Mouse picking
+	BoundingVolumeHierarchy m_pickingHierarchy;
 	XMVECTOR m_rayOrigin;
 	XMVECTOR m_rayEnd;
 	bool m_hoveredOver;
+
+	// Rubber band / lasso selection (points are in pixels)
+	SelectionShape								m_selectionShape;
+	std::vector<D2D1_POINT_2F>					m_selectionPoints;
+	Microsoft::WRL::ComPtr<ID2D1SolidColorBrush> m_selectionBrush;
 };
\ No newline at end of file
@@ -277,6 +277,7 @@ void Slider::SetMin(float min)
 	{
 		m_sliderValue = m_sliderMin;
 		m_textInput->SetText(m_sliderValue);
+		Invalidate();
 
 		// Slider Value changed, so call the changed method
 		ValueChangedMethod(m_sliderValue);
@@ -290,6 +291,7 @@ void Slider::SetMax(float max)
 	{
 		m_sliderValue = m_sliderMax;
 		m_textInput->SetText(m_sliderValue);
+		Invalidate();
 
 		// Slider Value changed, so call the changed method
 		ValueChangedMethod(m_sliderValue);
@@ -305,6 +307,9 @@ void Slider::SetValue(float value)
 	// Set the text
 	m_textInput->SetText(m_sliderValue);
 
+	// The value may have been set by another control, so the slider has to redraw itself
+	Invalidate();
+
 	// Call the value changed method
 	ValueChangedMethod(m_sliderValue);
 }
\ No newline at end of file
@@ -0,0 +1,697 @@
+#include "SoftwareRasterizer.h"
+#include "CameraSpace.h"
+#include "FrameExport.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	struct ClipVertex
+	{
+		float	X, Y, Z, W;
+		float	R, G, B;
+	};
+
+	// Row vector times a row-major matrix
+	inline void TransformPoint(const float m[4][4], const float p[3], float out[4])
+	{
+		for (int column = 0; column < 4; ++column)
+			out[column] = p[0] * m[0][column] + p[1] * m[1][column] + p[2] * m[2][column] + m[3][column];
+	}
+
+	inline void Normalize(float v[3])
+	{
+		float length = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+		if (length > 0.0f)
+		{
+			v[0] /= length;
+			v[1] /= length;
+			v[2] /= length;
+		}
+	}
+
+	// Rotation of pi around the axis halfway between +z and 'direction' (see InstancedCylinderVertexShader)
+	inline void RotateZToDirection(const float v[3], const float direction[3], float out[3])
+	{
+		float halfway[3] = { direction[0], direction[1], direction[2] + 1.0f };
+		float lengthSquared = halfway[0] * halfway[0] + halfway[1] * halfway[1] + halfway[2] * halfway[2];
+		if (lengthSquared > 1e-12f)
+		{
+			float inverseLength = 1.0f / std::sqrt(lengthSquared);
+			halfway[0] *= inverseLength;
+			halfway[1] *= inverseLength;
+			halfway[2] *= inverseLength;
+		}
+		else
+		{
+			halfway[0] = 1.0f;
+			halfway[1] = halfway[2] = 0.0f;
+		}
+
+		float d = 2.0f * (halfway[0] * v[0] + halfway[1] * v[1] + halfway[2] * v[2]);
+		out[0] = d * halfway[0] - v[0];
+		out[1] = d * halfway[1] - v[1];
+		out[2] = d * halfway[2] - v[2];
+	}
+
+	// How the object space vertices of one draw (or one instance of a draw) get to world space. This is
+	// the model matrix of a non-instanced draw or what the instanced vertex shaders build from an instance
+	struct ObjectTransform
+	{
+		enum class Kind { MATRIX, SPHERE, CYLINDER };
+
+		Kind		Type = Kind::MATRIX;
+		float		Model[4][4] = {};
+		float		Normal[3][3] = {};		// Cofactors of the upper 3x3 of Model - the inverse transpose up to scale
+
+		// SPHERE: position * scale + offset. CYLINDER: rotate(position * scale + (0, 0, offsetZ)) + offset
+		float		Scale[3] = { 1.0f, 1.0f, 1.0f };
+		float		Offset[3] = {};
+		float		OffsetZ = 0.0f;
+		float		Direction[3] = { 0.0f, 0.0f, 1.0f };
+
+		void SetMatrix(const float model[4][4])
+		{
+			Type = Kind::MATRIX;
+			std::copy(&model[0][0], &model[0][0] + 16, &Model[0][0]);
+
+			const float (*m)[4] = Model;
+			Normal[0][0] = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+			Normal[0][1] = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+			Normal[0][2] = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+			Normal[1][0] = m[0][2] * m[2][1] - m[0][1] * m[2][2];
+			Normal[1][1] = m[0][0] * m[2][2] - m[0][2] * m[2][0];
+			Normal[1][2] = m[0][1] * m[2][0] - m[0][0] * m[2][1];
+			Normal[2][0] = m[0][1] * m[1][2] - m[0][2] * m[1][1];
+			Normal[2][1] = m[0][2] * m[1][0] - m[0][0] * m[1][2];
+			Normal[2][2] = m[0][0] * m[1][1] - m[0][1] * m[1][0];
+		}
+
+		void Apply(const MeshVertex& vertex, float position[3], float normal[3]) const
+		{
+			const float* p = vertex.Position;
+			const float* n = vertex.Normal;
+
+			switch (Type)
+			{
+			case Kind::MATRIX:
+			{
+				float world[4];
+				TransformPoint(Model, p, world);
+				position[0] = world[0];
+				position[1] = world[1];
+				position[2] = world[2];
+				for (int column = 0; column < 3; ++column)
+					normal[column] = n[0] * Normal[0][column] + n[1] * Normal[1][column] + n[2] * Normal[2][column];
+				break;
+			}
+			case Kind::SPHERE:
+				for (int iii = 0; iii < 3; ++iii)
+				{
+					position[iii] = p[iii] * Scale[iii] + Offset[iii];
+					normal[iii] = n[iii];
+				}
+				break;
+
+			case Kind::CYLINDER:
+			{
+				const float local[3] = { p[0] * Scale[0], p[1] * Scale[1], p[2] * Scale[2] + OffsetZ };
+				RotateZToDirection(local, Direction, position);
+				position[0] += Offset[0];
+				position[1] += Offset[1];
+				position[2] += Offset[2];
+
+				// Inverse transpose of rotation * scale = rotation * inverse scale
+				const float scaledNormal[3] = { n[0] / Scale[0], n[1] / Scale[1], n[2] / Scale[2] };
+				RotateZToDirection(scaledNormal, Direction, normal);
+				break;
+			}
+			}
+
+			Normalize(normal);
+		}
+	};
+
+	inline uint32_t PackColor(float r, float g, float b, float a)
+	{
+		auto channel = [](float value) { return static_cast<uint32_t>(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f); };
+		return channel(r) | (channel(g) << 8) | (channel(b) << 16) | (channel(a) << 24);
+	}
+
+	// Intersection of the edge a-b with the near plane (z = w with reverse Z, see CameraSpace)
+	inline ClipVertex ClipEdge(const ClipVertex& a, const ClipVertex& b)
+	{
+		float t = (a.W - a.Z) / ((a.W - a.Z) - (b.W - b.Z));
+		return ClipVertex{
+			a.X + t * (b.X - a.X), a.Y + t * (b.Y - a.Y), a.Z + t * (b.Z - a.Z), a.W + t * (b.W - a.W),
+			a.R + t * (b.R - a.R), a.G + t * (b.G - a.G), a.B + t * (b.B - a.B)
+		};
+	}
+}
+
+
+SoftwareRasterizer::SoftwareRasterizer(unsigned int width, unsigned int height, unsigned int threadCount) :
+	m_width(0),
+	m_height(0),
+	m_tilesX(0),
+	m_tilesY(0),
+	m_frameStatistics(),
+	m_threadPool(threadCount)
+{
+	// The same tessellation as the D3D11 meshes (see MeshManager::CreateMeshes)
+	for (unsigned int level = 0; level < MeshLevelOfDetail::LevelCount; ++level)
+	{
+		m_spheres[level] = MeshGeometry::Sphere(MeshLevelOfDetail::SphereSegments[level]);
+		m_cylinders[level] = MeshGeometry::Cylinder(MeshLevelOfDetail::CylinderSlices[level]);
+		m_cones[level] = MeshGeometry::Cone(MeshLevelOfDetail::ConeSlices[level]);
+	}
+
+	// Edges of the unit cube - scaled to the simulation box by the model matrix (see SimulationRenderer::CreateBox)
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		for (int corner = 0; corner < 4; ++corner)
+		{
+			MeshVertex start = {};
+			start.Position[(axis + 1) % 3] = (corner & 1) ? 0.5f : -0.5f;
+			start.Position[(axis + 2) % 3] = (corner & 2) ? 0.5f : -0.5f;
+			start.Position[axis] = -0.5f;
+
+			MeshVertex end = start;
+			end.Position[axis] = 0.5f;
+
+			m_boxLines.push_back(start);
+			m_boxLines.push_back(end);
+		}
+	}
+
+	Resize(width, height);
+}
+
+void SoftwareRasterizer::Resize(unsigned int width, unsigned int height)
+{
+	m_width = width;
+	m_height = height;
+	m_tilesX = (width + TileSize - 1) / TileSize;
+	m_tilesY = (height + TileSize - 1) / TileSize;
+
+	m_pixels.assign(static_cast<size_t>(width) * height, 0);
+	m_depth.assign(static_cast<size_t>(width) * height, CameraSpace::ClearDepth);
+	m_stencil.assign(static_cast<size_t>(width) * height, 0);
+	m_tileBins.resize(static_cast<size_t>(m_tilesX) * m_tilesY);
+}
+
+void SoftwareRasterizer::Clear(const float color[4])
+{
+	std::fill(m_pixels.begin(), m_pixels.end(), PackColor(color[0], color[1], color[2], color[3]));
+	std::fill(m_depth.begin(), m_depth.end(), CameraSpace::ClearDepth);
+	std::fill(m_stencil.begin(), m_stencil.end(), static_cast<uint8_t>(0));
+}
+
+void SoftwareRasterizer::Submit(const RenderCommandList& commands, const SoftwareScene& scene)
+{
+	const std::vector<RenderCommand>& list = commands.Commands();
+
+	// Count the state changes the way the D3D11 backend does, so the statistics can be compared
+	RenderStatistics statistics = {};
+	statistics.Commands = static_cast<uint32_t>(list.size());
+
+	auto changed = [&statistics](bool different) {
+		if (different)
+			++statistics.StateChanges;
+		else
+			++statistics.RedundantStates;
+	};
+
+	// 1: Geometry - one work item per instance, split into chunks of equal work
+	m_firstItem.resize(list.size() + 1);
+	size_t items = 0;
+	for (size_t iii = 0; iii < list.size(); ++iii)
+	{
+		const RenderCommand& command = list[iii];
+		m_firstItem[iii] = items;
+
+		changed(iii == 0 || command.State.Stencil != list[iii - 1].State.Stencil);
+		changed(iii == 0 || command.State.Shader != list[iii - 1].State.Shader);
+		changed(iii == 0 || command.Mesh != list[iii - 1].Mesh || command.Level != list[iii - 1].Level);
+
+		// The full screen selection outline reads the outline IDs of the D3D11 backend - there is nothing to draw here
+		if (command.Mesh == RenderMesh::FULLSCREEN_TRIANGLE)
+			continue;
+
+		++statistics.DrawCalls;
+		items += command.Transform != RenderCommandList::NoTransform ? 1 : command.InstanceCount;
+	}
+	m_firstItem[list.size()] = items;
+
+	const size_t chunkCount = std::max<size_t>(1, std::min<size_t>(items, 4 * m_threadPool.ThreadCount()));
+	m_chunkPrimitives.resize(chunkCount);
+
+	m_threadPool.ParallelFor(chunkCount, [&](size_t chunk) {
+		m_chunkPrimitives[chunk].clear();
+		ProcessChunk(commands, scene, items * chunk / chunkCount, items * (chunk + 1) / chunkCount, m_chunkPrimitives[chunk]);
+	});
+
+	// 2: Binning - in chunk order, so every bin is in command order
+	m_primitives.clear();
+	for (const std::vector<Primitive>& primitives : m_chunkPrimitives)
+		m_primitives.insert(m_primitives.end(), primitives.begin(), primitives.end());
+
+	for (std::vector<uint32_t>& bin : m_tileBins)
+		bin.clear();
+
+	for (uint32_t iii = 0; iii < m_primitives.size(); ++iii)
+	{
+		const Primitive& primitive = m_primitives[iii];
+		int tileX0 = std::max(static_cast<int>(primitive.MinX) / static_cast<int>(TileSize), 0);
+		int tileY0 = std::max(static_cast<int>(primitive.MinY) / static_cast<int>(TileSize), 0);
+		int tileX1 = std::min(static_cast<int>(primitive.MaxX) / static_cast<int>(TileSize), static_cast<int>(m_tilesX) - 1);
+		int tileY1 = std::min(static_cast<int>(primitive.MaxY) / static_cast<int>(TileSize), static_cast<int>(m_tilesY) - 1);
+
+		for (int tileY = tileY0; tileY <= tileY1; ++tileY)
+		{
+			for (int tileX = tileX0; tileX <= tileX1; ++tileX)
+				m_tileBins[static_cast<size_t>(tileY) * m_tilesX + tileX].push_back(iii);
+		}
+	}
+
+	// 3: Rasterization - every tile is independent
+	m_threadPool.ParallelFor(m_tileBins.size(), [this](size_t tile) { RasterizeTile(static_cast<unsigned int>(tile)); });
+
+	m_frameStatistics = statistics;
+}
+
+void SoftwareRasterizer::ProcessChunk(const RenderCommandList& commands, const SoftwareScene& scene, size_t firstItem, size_t lastItem,
+									  std::vector<Primitive>& primitives) const
+{
+	if (firstItem >= lastItem)
+		return;
+
+	const std::vector<RenderCommand>& list = commands.Commands();
+	const std::vector<RenderTransform>& transforms = commands.Transforms();
+
+	// The command that holds the first item of the chunk
+	size_t commandIndex = static_cast<size_t>(std::upper_bound(m_firstItem.begin(), m_firstItem.end() - 1, firstItem) - m_firstItem.begin()) - 1;
+
+	const float width = static_cast<float>(m_width);
+	const float height = static_cast<float>(m_height);
+
+	std::vector<ClipVertex> vertices;
+	ObjectTransform transform;
+
+	for (size_t item = firstItem; item < lastItem && commandIndex < list.size(); ++commandIndex)
+	{
+		const RenderCommand& command = list[commandIndex];
+		size_t commandEnd = m_firstItem[commandIndex + 1];
+		if (item >= commandEnd)
+			continue;
+
+		unsigned int level = std::min<unsigned int>(command.Level, MeshLevelOfDetail::LevelCount - 1);
+
+		const MeshVertex* meshVertices = nullptr;
+		const uint16_t* meshIndices = nullptr;
+		size_t indexCount = 0;
+		bool lines = false;
+
+		switch (command.Mesh)
+		{
+		case RenderMesh::BOX:
+			meshVertices = m_boxLines.data();
+			indexCount = m_boxLines.size();
+			lines = true;
+			break;
+		case RenderMesh::SPHERE:
+		case RenderMesh::IMPOSTOR_QUAD:		// Impostors are drawn as the most detailed sphere
+		{
+			const MeshData& mesh = m_spheres[command.Mesh == RenderMesh::IMPOSTOR_QUAD ? 0 : level];
+			meshVertices = mesh.Vertices.data();
+			meshIndices = mesh.Indices.data();
+			indexCount = mesh.Indices.size();
+			break;
+		}
+		case RenderMesh::CYLINDER:
+		case RenderMesh::ARROW_CYLINDER:
+			meshVertices = m_cylinders[level].Vertices.data();
+			meshIndices = m_cylinders[level].Indices.data();
+			indexCount = m_cylinders[level].Indices.size();
+			break;
+		case RenderMesh::ARROW_CONE:
+			meshVertices = m_cones[level].Vertices.data();
+			meshIndices = m_cones[level].Indices.data();
+			indexCount = m_cones[level].Indices.size();
+			break;
+		default:
+			item = commandEnd;
+			continue;
+		}
+
+		for (; item < lastItem && item < commandEnd; ++item)
+		{
+			size_t instance = command.FirstInstance + (item - m_firstItem[commandIndex]);
+			uint32_t materialIndex = 0;
+
+			// Build the transform the vertex shader of the command would use
+			if (command.Transform != RenderCommandList::NoTransform)
+			{
+				const RenderTransform& renderTransform = transforms[command.Transform];
+				transform.SetMatrix(renderTransform.Model);
+				materialIndex = renderTransform.MaterialIndex;
+			}
+			else if (command.State.Shader == ShaderMode::PHONG_INSTANCED || command.State.Shader == ShaderMode::IMPOSTOR)
+			{
+				if (instance >= scene.AtomCount)
+					continue;
+
+				const AtomInstance& atom = scene.Atoms[instance];
+				transform.Type = ObjectTransform::Kind::SPHERE;
+				std::fill(transform.Scale, transform.Scale + 3, atom.Radius);
+				std::copy(atom.Position, atom.Position + 3, transform.Offset);
+				materialIndex = atom.MaterialIndex;
+			}
+			else if (command.State.Shader == ShaderMode::PHONG_INSTANCED_CYLINDER)
+			{
+				if (instance >= scene.BondCount)
+					continue;
+
+				const BondCylinderInstance& bond = scene.Bonds[instance];
+				float length = std::sqrt(bond.Axis[0] * bond.Axis[0] + bond.Axis[1] * bond.Axis[1] + bond.Axis[2] * bond.Axis[2]);
+				if (length == 0.0f)
+					continue;
+
+				transform.Type = ObjectTransform::Kind::CYLINDER;
+				transform.Scale[0] = transform.Scale[1] = bond.Radius;
+				transform.Scale[2] = length;
+				transform.OffsetZ = 0.0f;
+				for (int iii = 0; iii < 3; ++iii)
+				{
+					transform.Direction[iii] = bond.Axis[iii] / length;
+					transform.Offset[iii] = bond.Start[iii];
+				}
+				materialIndex = bond.MaterialAndOutline & 0x00FFFFFF;
+			}
+			else if (command.State.Shader == ShaderMode::PHONG_INSTANCED_ARROW)
+			{
+				if (instance >= scene.ArrowCount)
+					continue;
+
+				// See InstancedArrowVertexShader
+				const VelocityArrowInstance& arrow = scene.Arrows[instance];
+				float speed = std::sqrt(arrow.Velocity[0] * arrow.Velocity[0] + arrow.Velocity[1] * arrow.Velocity[1] + arrow.Velocity[2] * arrow.Velocity[2]);
+				if (speed == 0.0f)
+					continue;
+
+				float shaftLength = speed / 100.0f;
+				bool head = command.Mesh == RenderMesh::ARROW_CONE;
+
+				transform.Type = ObjectTransform::Kind::CYLINDER;
+				transform.Scale[0] = transform.Scale[1] = (head ? 2.0f : 1.0f) * scene.ArrowWidth;
+				transform.Scale[2] = head ? VelocityArrowPacker::HeadLength : shaftLength;
+				transform.OffsetZ = head ? shaftLength : 0.0f;
+				for (int iii = 0; iii < 3; ++iii)
+				{
+					transform.Direction[iii] = arrow.Velocity[iii] / speed;
+					transform.Offset[iii] = arrow.Position[iii] + transform.Direction[iii] * (arrow.Radius - 0.005f);
+				}
+				materialIndex = scene.ArrowMaterial;
+			}
+			else
+			{
+				continue;
+			}
+
+			SoftwareMaterial material = { { 1.0f, 0.0f, 1.0f, 1.0f }, true };
+			if (materialIndex < scene.MaterialCount)
+				material = scene.Materials[materialIndex];
+
+			// Vertex shading - a head light with a little ambient, or the flat color for solid draws and lines
+			bool unlit = material.Unlit || lines || command.State.Shader == ShaderMode::SOLID;
+
+			vertices.resize(indexCount);
+			for (size_t iii = 0; iii < indexCount; ++iii)
+			{
+				const MeshVertex& meshVertex = meshVertices[meshIndices != nullptr ? meshIndices[iii] : iii];
+
+				float position[3] = {};
+				float normal[3] = {};
+				transform.Apply(meshVertex, position, normal);
+
+				float intensity = 1.0f;
+				if (!unlit)
+				{
+					float toEye[3] = { scene.Eye[0] - position[0], scene.Eye[1] - position[1], scene.Eye[2] - position[2] };
+					Normalize(toEye);
+					intensity = 0.2f + 0.8f * std::max(0.0f, normal[0] * toEye[0] + normal[1] * toEye[1] + normal[2] * toEye[2]);
+				}
+
+				float clip[4];
+				TransformPoint(scene.ViewProjection, position, clip);
+				vertices[iii] = ClipVertex{ clip[0], clip[1], clip[2], clip[3],
+					material.Color[0] * intensity, material.Color[1] * intensity, material.Color[2] * intensity };
+			}
+
+			// Clip against the near plane, then project to the screen
+			const size_t vertexCount = lines ? 2 : 3;
+			for (size_t first = 0; first + vertexCount <= vertices.size(); first += vertexCount)
+			{
+				const ClipVertex* v = &vertices[first];
+
+				// Trivially outside one of the other planes
+				bool outside = false;
+				for (int plane = 0; plane < 5 && !outside; ++plane)
+				{
+					outside = true;
+					for (size_t iii = 0; iii < vertexCount && outside; ++iii)
+					{
+						switch (plane)
+						{
+						case 0: outside = v[iii].X < -v[iii].W; break;
+						case 1: outside = v[iii].X > v[iii].W; break;
+						case 2: outside = v[iii].Y < -v[iii].W; break;
+						case 3: outside = v[iii].Y > v[iii].W; break;
+						case 4: outside = v[iii].Z < 0.0f; break;		// Far plane - never with an infinite projection
+						}
+					}
+				}
+				if (outside)
+					continue;
+
+				// Sutherland-Hodgman against z <= w - a triangle becomes at most a quad
+				ClipVertex polygon[4];
+				size_t polygonCount = 0;
+				for (size_t iii = 0; iii < vertexCount; ++iii)
+				{
+					const ClipVertex& current = v[iii];
+					const ClipVertex& next = v[(iii + 1) % vertexCount];
+					bool currentInside = current.Z <= current.W;
+					bool nextInside = next.Z <= next.W;
+
+					if (currentInside)
+						polygon[polygonCount++] = current;
+					if (currentInside != nextInside && (vertexCount == 3 || iii == 0))
+						polygon[polygonCount++] = ClipEdge(current, next);
+				}
+
+				if (polygonCount < vertexCount)
+					continue;
+
+				ScreenVertex screen[4];
+				for (size_t iii = 0; iii < polygonCount; ++iii)
+				{
+					const ClipVertex& c = polygon[iii];
+					float inverseW = 1.0f / c.W;
+					screen[iii] = ScreenVertex{
+						(c.X * inverseW * 0.5f + 0.5f) * width,
+						(0.5f - c.Y * inverseW * 0.5f) * height,
+						c.Z * inverseW,
+						inverseW,
+						c.R * inverseW, c.G * inverseW, c.B * inverseW
+					};
+				}
+
+				// Fan the polygon into primitives
+				const size_t primitiveCount = lines ? 1 : polygonCount - 2;
+				for (size_t iii = 0; iii < primitiveCount; ++iii)
+				{
+					Primitive primitive;
+					primitive.Line = lines;
+					primitive.Stencil = command.State.Stencil;
+					primitive.Vertices[0] = screen[0];
+					primitive.Vertices[1] = screen[iii + 1];
+					primitive.Vertices[2] = lines ? screen[1] : screen[iii + 2];
+
+					if (!lines)
+					{
+						// Make every triangle counter clockwise on screen so the edge functions are positive inside
+						const ScreenVertex& a = primitive.Vertices[0];
+						const ScreenVertex& b = primitive.Vertices[1];
+						const ScreenVertex& c = primitive.Vertices[2];
+						float area = (b.X - a.X) * (c.Y - a.Y) - (b.Y - a.Y) * (c.X - a.X);
+						if (area == 0.0f)
+							continue;
+						if (area < 0.0f)
+							std::swap(primitive.Vertices[1], primitive.Vertices[2]);
+					}
+
+					primitive.MinX = std::min({ primitive.Vertices[0].X, primitive.Vertices[1].X, primitive.Vertices[2].X });
+					primitive.MinY = std::min({ primitive.Vertices[0].Y, primitive.Vertices[1].Y, primitive.Vertices[2].Y });
+					primitive.MaxX = std::max({ primitive.Vertices[0].X, primitive.Vertices[1].X, primitive.Vertices[2].X });
+					primitive.MaxY = std::max({ primitive.Vertices[0].Y, primitive.Vertices[1].Y, primitive.Vertices[2].Y });
+
+					if (primitive.MaxX < 0.0f || primitive.MaxY < 0.0f || primitive.MinX >= width || primitive.MinY >= height)
+						continue;
+
+					primitive.MinX = std::max(primitive.MinX, 0.0f);
+					primitive.MinY = std::max(primitive.MinY, 0.0f);
+					primitive.MaxX = std::min(primitive.MaxX, width - 1.0f);
+					primitive.MaxY = std::min(primitive.MaxY, height - 1.0f);
+
+					primitives.push_back(primitive);
+				}
+			}
+		}
+	}
+}
+
+void SoftwareRasterizer::RasterizeTile(unsigned int tile)
+{
+	int x0 = static_cast<int>((tile % m_tilesX) * TileSize);
+	int y0 = static_cast<int>((tile / m_tilesX) * TileSize);
+	int x1 = std::min(x0 + static_cast<int>(TileSize), static_cast<int>(m_width));
+	int y1 = std::min(y0 + static_cast<int>(TileSize), static_cast<int>(m_height));
+
+	for (uint32_t index : m_tileBins[tile])
+	{
+		const Primitive& primitive = m_primitives[index];
+		if (primitive.Line)
+			RasterizeLine(primitive, x0, y0, x1, y1);
+		else
+			RasterizeTriangle(primitive, x0, y0, x1, y1);
+	}
+}
+
+void SoftwareRasterizer::RasterizeTriangle(const Primitive& primitive, int x0, int y0, int x1, int y1)
+{
+	const ScreenVertex& a = primitive.Vertices[0];
+	const ScreenVertex& b = primitive.Vertices[1];
+	const ScreenVertex& c = primitive.Vertices[2];
+
+	// Pixels whose center is inside the bounding box, limited to the tile
+	int minX = std::max(x0, static_cast<int>(std::ceil(primitive.MinX - 0.5f)));
+	int minY = std::max(y0, static_cast<int>(std::ceil(primitive.MinY - 0.5f)));
+	int maxX = std::min(x1 - 1, static_cast<int>(std::floor(primitive.MaxX - 0.5f)));
+	int maxY = std::min(y1 - 1, static_cast<int>(std::floor(primitive.MaxY - 0.5f)));
+	if (minX > maxX || minY > maxY)
+		return;
+
+	float area = (b.X - a.X) * (c.Y - a.Y) - (b.Y - a.Y) * (c.X - a.X);
+	float inverseArea = 1.0f / area;
+
+	// Edge functions at the first pixel center and their steps along x and y. Each one is the (scaled)
+	// barycentric weight of the vertex opposite the edge
+	auto edge = [](const ScreenVertex& from, const ScreenVertex& to, float x, float y) {
+		return (to.X - from.X) * (y - from.Y) - (to.Y - from.Y) * (x - from.X);
+	};
+
+	float startX = minX + 0.5f;
+	float startY = minY + 0.5f;
+	float rowA = edge(b, c, startX, startY);
+	float rowB = edge(c, a, startX, startY);
+	float rowC = edge(a, b, startX, startY);
+	const float stepXA = -(c.Y - b.Y), stepYA = c.X - b.X;
+	const float stepXB = -(a.Y - c.Y), stepYB = a.X - c.X;
+	const float stepXC = -(b.Y - a.Y), stepYC = b.X - a.X;
+
+	for (int y = minY; y <= maxY; ++y)
+	{
+		float weightA = rowA, weightB = rowB, weightC = rowC;
+		size_t index = static_cast<size_t>(y) * m_width + minX;
+
+		for (int x = minX; x <= maxX; ++x, ++index)
+		{
+			if (weightA >= 0.0f && weightB >= 0.0f && weightC >= 0.0f)
+			{
+				float u = weightA * inverseArea;
+				float v = weightB * inverseArea;
+				float w = weightC * inverseArea;
+
+				float depth = u * a.Z + v * b.Z + w * c.Z;
+				float inverseW = u * a.InverseW + v * b.InverseW + w * c.InverseW;
+				float r = (u * a.R + v * b.R + w * c.R) / inverseW;
+				float g = (u * a.G + v * b.G + w * c.G) / inverseW;
+				float bl = (u * a.B + v * b.B + w * c.B) / inverseW;
+
+				WritePixel(index, depth, r, g, bl, primitive.Stencil);
+			}
+
+			weightA += stepXA;
+			weightB += stepXB;
+			weightC += stepXC;
+		}
+
+		rowA += stepYA;
+		rowB += stepYB;
+		rowC += stepYC;
+	}
+}
+
+void SoftwareRasterizer::RasterizeLine(const Primitive& primitive, int x0, int y0, int x1, int y1)
+{
+	const ScreenVertex& a = primitive.Vertices[0];
+	const ScreenVertex& b = primitive.Vertices[1];
+
+	// One sample per pixel along the major axis
+	float dx = b.X - a.X;
+	float dy = b.Y - a.Y;
+	int steps = std::max(1, static_cast<int>(std::ceil(std::max(std::fabs(dx), std::fabs(dy)))));
+
+	for (int step = 0; step <= steps; ++step)
+	{
+		float t = static_cast<float>(step) / steps;
+		int x = static_cast<int>(std::floor(a.X + t * dx));
+		int y = static_cast<int>(std::floor(a.Y + t * dy));
+		if (x < x0 || x >= x1 || y < y0 || y >= y1)
+			continue;
+
+		float depth = a.Z + t * (b.Z - a.Z);
+		float inverseW = a.InverseW + t * (b.InverseW - a.InverseW);
+		WritePixel(static_cast<size_t>(y) * m_width + x, depth,
+			(a.R + t * (b.R - a.R)) / inverseW, (a.G + t * (b.G - a.G)) / inverseW, (a.B + t * (b.B - a.B)) / inverseW,
+			primitive.Stencil);
+	}
+}
+
+void SoftwareRasterizer::WritePixel(size_t index, float depth, float r, float g, float b, StencilMode stencil)
+{
+	// The depth stencil states of SimulationRenderer::CreateDepthStencilState (reverse Z)
+	switch (stencil)
+	{
+	case StencilMode::NONE:
+		if (depth < 0.0f || depth > 1.0f || depth <= m_depth[index])
+			return;
+		m_depth[index] = depth;
+		break;
+
+	case StencilMode::WRITE:
+		// The mask is written whether or not the depth test passes, so outlines show through other objects
+		m_stencil[index] = 1;
+		if (depth < 0.0f || depth > 1.0f || depth < m_depth[index])
+			return;
+		m_depth[index] = depth;
+		break;
+
+	case StencilMode::MASK:
+		if (m_stencil[index] != 0)
+			return;
+		break;
+
+	case StencilMode::DISABLED:
+		break;
+	}
+
+	m_pixels[index] = PackColor(r, g, b, 1.0f);
+}
+
+bool SoftwareRasterizer::SavePPM(const std::string& path) const
+{
+	return FrameWriter::WritePPM(path, m_pixels.data(), m_width, m_height);
+}
\ No newline at end of file
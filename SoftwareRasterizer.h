@@ -0,0 +1,139 @@
+#pragma once
+
+#include "AtomInstancePacker.h"
+#include "BondGeometry.h"
+#include "MeshGeometry.h"
+#include "RenderCommandList.h"
+#include "ThreadPool.h"
+#include "VelocityArrowPacker.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Color of one entry of the material table. Lit materials are shaded with a head light (diffuse plus a
+// little ambient), unlit ones are drawn flat - use the Diffuse color of Phong materials and the Emissive
+// color of MaterialTable::AddSolidColor materials
+struct SoftwareMaterial
+{
+	float	Color[4];
+	bool	Unlit;
+};
+
+// Everything the commands of a frame refer to besides the command list itself - the same data the D3D11
+// backend uploads (see SimulationRenderer::SubmitCommands). Matrices are row-major for row vectors (the
+// same layout as XMFLOAT4X4) with a reverse Z projection, and the instance arrays are the output of the
+// packers - in the same (camera relative, see CameraSpace) space as ViewProjection and Eye
+struct SoftwareScene
+{
+	float							ViewProjection[4][4];
+	float							Eye[3];
+
+	const AtomInstance*				Atoms = nullptr;
+	size_t							AtomCount = 0;
+	const BondCylinderInstance*		Bonds = nullptr;
+	size_t							BondCount = 0;
+	const VelocityArrowInstance*	Arrows = nullptr;
+	size_t							ArrowCount = 0;
+	float							ArrowWidth = 0.0f;		// See ArrowMesh::Width
+	uint32_t						ArrowMaterial = 0;
+
+	const SoftwareMaterial*			Materials = nullptr;
+	size_t							MaterialCount = 0;
+};
+
+// CPU backend for the render command list - renders the spheres, cylinders, arrows and box of a frame
+// into an RGBA buffer with depth and stencil, so the scene traversal (the packers and the command
+// recording) can be run, compared against golden images and timed without a D3D11 device.
+//
+// A frame is drawn in three steps:
+//		1. Geometry - the commands are split into chunks of equal work (one instance is one unit) and the
+//		   chunks are transformed, clipped against the near plane and shaded per vertex in parallel
+//		2. Binning - the screen is divided into TileSize x TileSize tiles and every primitive is added to
+//		   the bins of the tiles its bounding box covers, in command order
+//		3. Rasterization - the tiles are rasterized in parallel. Each tile is owned by a single worker and
+//		   walks its bin in order, so depth and stencil behave as they do on the GPU
+//
+// Shading is a simple Gouraud head light rather than the Phong lighting of the shaders, impostors are
+// drawn as sphere meshes and the full screen selection outline pass is skipped - the images are meant to
+// be compared against images from this backend, not against the D3D11 one.
+class SoftwareRasterizer
+{
+public:
+	static constexpr unsigned int TileSize = 64;
+
+	// threadCount = 0 -> one worker per hardware thread
+	SoftwareRasterizer(unsigned int width, unsigned int height, unsigned int threadCount = 0);
+
+	void Resize(unsigned int width, unsigned int height);
+
+	// Clear color is RGBA in [0, 1]. Depth is cleared to CameraSpace::ClearDepth and stencil to 0 (see ContentWindow::Render)
+	void Clear(const float color[4]);
+
+	// Draw the commands in order - call RenderCommandList::Sort first to draw them the way the D3D11
+	// backend does
+	void Submit(const RenderCommandList& commands, const SoftwareScene& scene);
+
+	unsigned int Width() const { return m_width; }
+	unsigned int Height() const { return m_height; }
+
+	// Top-down rows of RGBA8 pixels (R in the lowest byte) and the matching depth values
+	const std::vector<uint32_t>& Pixels() const { return m_pixels; }
+	const std::vector<float>& Depth() const { return m_depth; }
+
+	// Commands, draws and state changes of the last Submit, counted the way the D3D11 backend counts them
+	const RenderStatistics& FrameStatistics() const { return m_frameStatistics; }
+	size_t PrimitiveCount() const { return m_primitives.size(); }
+
+	// Binary PPM (no alpha), which almost any image viewer or diff tool can open
+	bool SavePPM(const std::string& path) const;
+
+private:
+	// Vertex in screen space. Color is divided by w so it can be interpolated perspective correctly
+	struct ScreenVertex
+	{
+		float	X, Y, Z;
+		float	InverseW;
+		float	R, G, B;
+	};
+
+	struct Primitive
+	{
+		ScreenVertex	Vertices[3];		// Lines only use the first two
+		bool			Line;
+		StencilMode		Stencil;
+		float			MinX, MinY, MaxX, MaxY;
+	};
+
+	void ProcessChunk(const RenderCommandList& commands, const SoftwareScene& scene, size_t firstItem, size_t lastItem,
+					  std::vector<Primitive>& primitives) const;
+	void RasterizeTile(unsigned int tile);
+	void RasterizeTriangle(const Primitive& primitive, int x0, int y0, int x1, int y1);
+	void RasterizeLine(const Primitive& primitive, int x0, int y0, int x1, int y1);
+	void WritePixel(size_t index, float depth, float r, float g, float b, StencilMode stencil);
+
+	unsigned int				m_width;
+	unsigned int				m_height;
+	unsigned int				m_tilesX;
+	unsigned int				m_tilesY;
+
+	std::vector<uint32_t>		m_pixels;
+	std::vector<float>			m_depth;
+	std::vector<uint8_t>		m_stencil;
+
+	// Unit meshes for each level of detail (see MeshManager::CreateMeshes) and the box line list
+	MeshData					m_spheres[MeshLevelOfDetail::LevelCount];
+	MeshData					m_cylinders[MeshLevelOfDetail::LevelCount];
+	MeshData					m_cones[MeshLevelOfDetail::LevelCount];
+	std::vector<MeshVertex>		m_boxLines;
+
+	// Reused from frame to frame
+	std::vector<size_t>					m_firstItem;		// Work item of the first instance of each command
+	std::vector<std::vector<Primitive>>	m_chunkPrimitives;
+	std::vector<Primitive>				m_primitives;
+	std::vector<std::vector<uint32_t>>	m_tileBins;
+
+	RenderStatistics			m_frameStatistics;
+	ThreadPool					m_threadPool;
+};
\ No newline at end of file
@@ -1,9 +1,13 @@
-cbuffer CBuf : register(b0)
+#include "PhongLighting.hlsli"
+
+struct SolidPixelShaderInput
 {
-	float4 color;
+	float4 position : SV_Position;
+	nointerpolation uint materialIndex : MATERIAL;
 };
 
-float4 main() : SV_TARGET
+// Solid colors are stored in the material table as the emissive color (see MaterialTable::AddSolidColor)
+float4 main(SolidPixelShaderInput input) : SV_TARGET
 {
-	return color;
+	return Materials[input.materialIndex].Emissive;
 }
\ No newline at end of file
@@ -21,6 +21,9 @@ cbuffer ModelViewProjectionConstantBuffer : register(b0)
 	matrix model;
 	matrix modelViewProjection;
 	matrix inverseTransposeModel;
+	uint materialIndex;
+	uint outline;
+	uint2 padding;
 };
 
 
@@ -30,10 +33,17 @@ struct VertexShaderInput
 	float3 normal : NORMAL;
 };
 
+// Must match SolidPixelShaderInput in SolidPixelShader
+struct SolidPixelShaderInput
+{
+	float4 position : SV_Position;
+	nointerpolation uint materialIndex : MATERIAL;
+};
+
 
 // Simple shader to do vertex processing on the GPU.
 //float4 main(float3 position : POSITION) : SV_Position
-float4 main(VertexShaderInput input) : SV_Position
+SolidPixelShaderInput main(VertexShaderInput input)
 {
 	/*
 	PixelShaderInput output;
@@ -43,5 +53,9 @@ float4 main(VertexShaderInput input) : SV_Position
 	output.positionWS = mul(model, position);                               // World space position
 	output.normalWS = mul((float3x3)inverseTransposeModel, input.normal); // compute the world space normal
 	*/
-	return mul(modelViewProjection, float4(input.position, 1.0f));
+	SolidPixelShaderInput output;
+	output.position = mul(modelViewProjection, float4(input.position, 1.0f));
+	output.materialIndex = materialIndex;
+
+	return output;
 }
\ No newline at end of file
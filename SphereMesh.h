@@ -3,6 +3,7 @@
 
 #include "DeviceResources.h"
 #include "HLSLStructures.h"
+#include "MeshBuffers.h"
 
 #include <memory>
 #include <vector>
@@ -20,45 +21,47 @@ class SphereMesh
 private:
 	std::shared_ptr<DeviceResources>		m_deviceResources;
 
-	Microsoft::WRL::ComPtr<ID3D11Buffer>	m_vertexBuffer;
-	Microsoft::WRL::ComPtr<ID3D11Buffer>	m_indexBuffer;
-	uint32_t								m_indexCount;
+	// One set of buffers per level of detail (level 0 is the most detailed)
+	MeshBuffers								m_levels[MeshLevelOfDetail::LevelCount];
 
-	Microsoft::WRL::ComPtr<ID3D11Buffer>	m_modelViewProjectionBuffer;
-	ModelViewProjectionConstantBuffer		m_modelViewProjectionBufferData;
-
-	DirectX::XMMATRIX m_modelMatrix;
-
-	void CreateModelViewProjectionBuffer();
-	void CreateAndLoadVertexAndIndexBuffers();
+public:
+	// 'levels' holds the unit sphere mesh for each level of detail (see MeshManager::CreateMeshes)
+	SphereMesh(const std::shared_ptr<DeviceResources>& deviceResources, const std::vector<MeshData>& levels);
 
-	
+	// Model matrix of a sphere of the given radius centered at 'position'
+	static DirectX::XMMATRIX ModelMatrix(DirectX::XMFLOAT3 position, float radius);
 
-public:
-	SphereMesh(const std::shared_ptr<DeviceResources>& deviceResources);
+	// IASetVertexBuffers and IASetIndexBuffer for the given level of detail. Binding is separate from drawing
+	// so consecutive draws of the same level only bind once (see SimulationRenderer::SubmitCommands)
+	void Bind(unsigned int level = 0);
 
-	/* Render must be passed the following:
-		1. XMFLOAT3 position       - position of the atom   -> used for translating to compute the model matrix
-		2. float    radius         - radius of the atom     -> used for scaling to compute the model matrix
-		3. XMMATRIX viewProjection - view projection matrix -> used for computing the final modelviewprojection matrix
+	/* Render draws a single sphere at the given level of detail
 
 		Upstream:
-		1. Simulation Render should have already
+		1. The caller (see SimulationRenderer::SubmitCommands) should have already
+				Bind                   <- The same level
 				IASetInputLayout
-				IASetPrimitiveTopology <- Only true as long as we are always rendered triangle lists
+				IASetPrimitiveTopology
 				VSSetShader
 				PSSetShader
-				PSSetConstantBuffers1  <- This will require a lookup for each atom to make sure the correct material is used
+				PSSetShaderResources   <- The material table (see MaterialTable)
+				VSSetConstantBuffers1  <- The model matrices and material index
 
 		Responsilities:
 		1. Render will perform the following
-				IASetVertexBuffers
-				ISSetIndexBuffer
-				VSSetConstantBuffers1
 				DrawIndexed
 	*/
-	void Render(DirectX::XMFLOAT3 position, float radius, DirectX::XMMATRIX viewProjection);
+	void Render(unsigned int level = 0);
 
-	DirectX::XMMATRIX ModelMatrix() { return m_modelMatrix; }
+	/* RenderInstanced draws 'instanceCount' spheres at the given level of detail with a single DrawIndexedInstanced call
 
+		Upstream:
+		1. The caller must have already bound the level (see Bind), set the instanced vertex shader, bound the
+		   instance buffer and set the constant buffer holding the view projection matrix and the first instance
+
+		Responsilities:
+		1. RenderInstanced will perform the following
+				DrawIndexedInstanced
+	*/
+	void RenderInstanced(unsigned int instanceCount, unsigned int level = 0);
 };
\ No newline at end of file
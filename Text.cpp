@@ -51,6 +51,8 @@ void Text::TextChanged()
 
 	// Update Screen Translation ---
 	m_screenTranslation = D2D1::Matrix3x2F::Translation(rect.left, rect.top);
+
+	Invalidate();
 }
 
 void Text::Pop()
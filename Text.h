@@ -22,7 +22,7 @@ public:
 	void OnLayoutResize() override { TextChanged(); }
 	void OnMarginChanged() override { TextChanged(); }
 
-	void SetTextTheme(std::string name) { m_textTheme = std::static_pointer_cast<TextTheme>(ThemeManager::GetTheme(name)); }
+	void SetTextTheme(std::string name) { m_textTheme = std::static_pointer_cast<TextTheme>(ThemeManager::GetTheme(name)); Invalidate(); }
 	void SetText(std::wstring text) { m_text = text; TextChanged(); }
 	void SetText(std::string text) { m_text = std::wstring(text.begin(), text.end()); TextChanged(); }
 
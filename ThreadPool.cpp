@@ -0,0 +1,127 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+
+ThreadPool::ThreadPool(unsigned int threadCount) :
+	m_activeJobs(0),
+	m_stopping(false)
+{
+	if (threadCount == 0)
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+	m_threads.reserve(threadCount);
+	for (unsigned int iii = 0; iii < threadCount; ++iii)
+		m_threads.emplace_back(&ThreadPool::WorkerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_jobAvailable.notify_all();
+
+	for (std::thread& thread : m_threads)
+		thread.join();
+}
+
+void ThreadPool::Submit(std::function<void()> job)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_jobs.push(std::move(job));
+		++m_activeJobs;
+	}
+	m_jobAvailable.notify_one();
+}
+
+void ThreadPool::Wait()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_allJobsDone.wait(lock, [this] { return m_activeJobs == 0; });
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& function)
+{
+	if (count == 0)
+		return;
+
+	// Each worker pulls the next index from a shared counter rather than taking a fixed slice, so a
+	// few slow items do not leave the other workers idle.
+	//
+	// Completion is tracked per call rather than with the pool-wide m_activeJobs: a nested call made from
+	// a worker would otherwise wait for the job it is running in. The calling thread also pulls indices
+	// itself, so the call finishes even if none of the jobs it submitted get a worker (ex. every worker
+	// is blocked in a nested ParallelFor). Jobs that only start after every index was handed out touch
+	// nothing but the shared state, which they keep alive themselves.
+	struct CallState
+	{
+		std::atomic<size_t>		Next{ 0 };
+		size_t					Running = 0;	// Jobs that have started and not finished
+		std::mutex				Mutex;
+		std::condition_variable	Done;
+	};
+
+	std::shared_ptr<CallState> state = std::make_shared<CallState>();
+	const std::function<void(size_t)>* functionPointer = &function;
+
+	size_t workers = std::min(count - 1, m_threads.size());
+	for (size_t iii = 0; iii < workers; ++iii)
+	{
+		Submit([state, count, functionPointer]()
+		{
+			{
+				std::lock_guard<std::mutex> lock(state->Mutex);
+				++state->Running;
+			}
+
+			// Only dereference the function while indices remain - the caller is still inside ParallelFor then
+			for (size_t index = state->Next++; index < count; index = state->Next++)
+				(*functionPointer)(index);
+
+			{
+				std::lock_guard<std::mutex> lock(state->Mutex);
+				if (--state->Running == 0)
+					state->Done.notify_all();
+			}
+		});
+	}
+
+	for (size_t index = state->Next++; index < count; index = state->Next++)
+		function(index);
+
+	// Every index has been handed out. Wait for the jobs still working on theirs
+	std::unique_lock<std::mutex> lock(state->Mutex);
+	state->Done.wait(lock, [&state] { return state->Running == 0; });
+}
+
+void ThreadPool::WorkerLoop()
+{
+	while (true)
+	{
+		std::function<void()> job;
+
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_jobAvailable.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+
+			if (m_stopping && m_jobs.empty())
+				return;
+
+			job = std::move(m_jobs.front());
+			m_jobs.pop();
+		}
+
+		job();
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (--m_activeJobs == 0)
+				m_allJobsDone.notify_all();
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool of worker threads. Work is submitted as std::function<void()> jobs and Wait()
+// blocks until every submitted job has finished. ParallelFor is the common case: it splits an
+// index range into one job per worker and hands out indices dynamically, so many small, uneven
+// jobs (e.g. one simulation each) still keep every core busy.
+//
+// ParallelFor only waits for its own indices and the calling thread works through them too, so it
+// can be nested (called from inside another ParallelFor or a submitted job) without deadlocking even
+// when every worker is busy. Wait() waits for the whole pool and must not be called from a job.
+class ThreadPool
+{
+public:
+	// threadCount = 0 -> one worker per hardware thread
+	ThreadPool(unsigned int threadCount = 0);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	void Submit(std::function<void()> job);
+	void Wait();	// Not from inside a job - it would wait for itself
+
+	// Call function(index) for every index in [0, count) and wait for all of them to finish. Safe to
+	// call from inside a job
+	void ParallelFor(size_t count, const std::function<void(size_t)>& function);
+
+	unsigned int ThreadCount() const { return static_cast<unsigned int>(m_threads.size()); }
+
+private:
+	void WorkerLoop();
+
+	std::vector<std::thread>			m_threads;
+	std::queue<std::function<void()>>	m_jobs;
+
+	std::mutex				m_mutex;
+	std::condition_variable	m_jobAvailable;
+	std::condition_variable	m_allJobsDone;
+	size_t					m_activeJobs;	// Queued + currently running
+	bool					m_stopping;
+};
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include "UploadRingAllocator.h"
+
+
+UploadRingAllocator::UploadRingAllocator(size_t capacity, size_t alignment) :
+	m_capacity(capacity),
+	m_alignment(alignment),
+	m_head(0),
+	m_used(0),
+	m_frameBytes(0),
+	m_nextFrame(0)
+{
+}
+
+void UploadRingAllocator::Reset(size_t capacity)
+{
+	m_capacity = capacity;
+	m_head = 0;
+	m_used = 0;
+	m_frameBytes = 0;
+	m_frames.clear();
+}
+
+bool UploadRingAllocator::Allocate(size_t size, size_t& offset)
+{
+	size_t aligned = AlignedSize(size);
+	if (aligned == 0 || aligned > m_capacity)
+		return false;
+
+	// Nothing is in use, so start from the beginning rather than skipping the end of the ring
+	if (m_used == 0)
+		m_head = 0;
+
+	// Skip the end of the ring if the allocation does not fit before it. The free space is the part of the ring
+	// between the head and the oldest byte in use, so this fits as long as the skipped bytes fit as well
+	size_t skipped = (m_head + aligned > m_capacity) ? m_capacity - m_head : 0;
+	if (m_used + skipped + aligned > m_capacity)
+		return false;
+
+	if (skipped > 0)
+		m_head = 0;
+
+	offset = m_head;
+	m_head += aligned;
+	if (m_head == m_capacity)
+		m_head = 0;
+
+	m_used += skipped + aligned;
+	m_frameBytes += skipped + aligned;
+	return true;
+}
+
+uint64_t UploadRingAllocator::EndFrame()
+{
+	m_frames.push_back({ m_nextFrame, m_frameBytes });
+	m_frameBytes = 0;
+	return m_nextFrame++;
+}
+
+void UploadRingAllocator::RetireFrame(uint64_t frame)
+{
+	while (!m_frames.empty() && m_frames.front().Id <= frame)
+	{
+		m_used -= m_frames.front().Bytes;
+		m_frames.pop_front();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+// Bookkeeping for a ring buffer that per-draw data (constant buffers) is sub-allocated from every frame.
+// The allocator only hands out offsets - UploadRingBuffer owns the actual D3D buffer.
+//
+// Allocations are made in the current frame and stay in use (by the GPU) until that frame is retired.
+// EndFrame closes the current frame and returns its id; RetireFrame(id) is called once the GPU has finished
+// that frame and releases its space. Allocate fails (returns false) when the ring is full of frames that
+// are still in flight - the caller then waits for the GPU and retires a frame, or moves to a bigger buffer.
+//
+// Allocations never straddle the end of the ring; the unused space at the end is skipped and counted as
+// part of the frame that skipped it.
+class UploadRingAllocator
+{
+public:
+	// D3D11.1 constant buffer offsets must be a multiple of 16 constants (256 bytes)
+	static constexpr size_t DefaultAlignment = 256;
+
+	explicit UploadRingAllocator(size_t capacity = 0, size_t alignment = DefaultAlignment);
+
+	// Forget every allocation and frame and start over with a ring of 'capacity' bytes
+	void Reset(size_t capacity);
+
+	// Sub-allocate 'size' bytes (rounded up to the alignment) in the current frame
+	bool Allocate(size_t size, size_t& offset);
+
+	// Close the current frame. Returns the id to pass to RetireFrame
+	uint64_t EndFrame();
+
+	// The GPU has finished with frame 'frame' and every frame before it
+	void RetireFrame(uint64_t frame);
+
+	size_t AlignedSize(size_t size) const { return (size + m_alignment - 1) / m_alignment * m_alignment; }
+
+	size_t Capacity() const { return m_capacity; }
+	size_t Alignment() const { return m_alignment; }
+	size_t UsedBytes() const { return m_used; }
+	size_t FramesInFlight() const { return m_frames.size(); }
+
+private:
+	struct Frame
+	{
+		uint64_t	Id;
+		size_t		Bytes;		// Bytes allocated (and skipped) during the frame
+	};
+
+	size_t				m_capacity;
+	size_t				m_alignment;
+	size_t				m_head;			// Next free byte
+	size_t				m_used;			// Bytes owned by the current frame and the frames in flight
+	size_t				m_frameBytes;	// Bytes owned by the current frame
+	uint64_t			m_nextFrame;
+	std::deque<Frame>	m_frames;		// Closed frames the GPU may still be reading, oldest first
+};
\ No newline at end of file
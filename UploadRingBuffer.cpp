@@ -0,0 +1,150 @@
+#include "UploadRingBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+
+UploadRingBuffer::UploadRingBuffer(ID3D11Device* device, ID3D11DeviceContext1* context, size_t capacity) :
+	m_device(device),
+	m_context(context),
+	m_discardOnNextMap(true)
+{
+	// Without these features every upload would need its own buffer (or a DISCARD that loses the ranges
+	// already bound this frame)
+	D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+	ThrowIfFailed(m_device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options)));
+	if (!options.ConstantBufferOffsetting || !options.MapNoOverwriteOnDynamicConstantBuffer)
+		ThrowIfFailed(DXGI_ERROR_UNSUPPORTED);
+
+	CreateBuffer(capacity);
+}
+
+void UploadRingBuffer::CreateBuffer(size_t capacity)
+{
+	capacity = m_allocator.AlignedSize(capacity);
+
+	CD3D11_BUFFER_DESC bufferDesc(
+		static_cast<UINT>(capacity),
+		D3D11_BIND_CONSTANT_BUFFER,
+		D3D11_USAGE_DYNAMIC,
+		D3D11_CPU_ACCESS_WRITE
+	);
+	ThrowIfFailed(
+		m_device->CreateBuffer(
+			&bufferDesc,
+			nullptr,
+			m_buffer.ReleaseAndGetAddressOf()
+		)
+	);
+
+	// The old buffer (if any) stays alive for as long as the context still uses it, so the frames in flight
+	// no longer need tracking
+	m_allocator.Reset(capacity);
+	for (auto& frameQuery : m_frameQueries)
+		m_freeQueries.push_back(frameQuery.second);
+	m_frameQueries.clear();
+
+	m_discardOnNextMap = true;
+}
+
+UploadRingBuffer::Range UploadRingBuffer::Upload(const void* data, size_t size)
+{
+	size_t offset = 0;
+	while (!m_allocator.Allocate(size, offset))
+	{
+		// The ring is full - wait for the GPU to finish the oldest frame. If no frame is in flight, this frame
+		// alone needs more than the whole ring
+		if (m_frameQueries.empty())
+			CreateBuffer(std::max(2 * m_allocator.Capacity(), 2 * m_allocator.AlignedSize(size)));
+		else
+			RetireFrames(true);
+	}
+
+	D3D11_MAPPED_SUBRESOURCE mapped;
+	ThrowIfFailed(
+		m_context->Map(m_buffer.Get(), 0, m_discardOnNextMap ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mapped)
+	);
+	std::memcpy(static_cast<unsigned char*>(mapped.pData) + offset, data, size);
+	m_context->Unmap(m_buffer.Get(), 0);
+	m_discardOnNextMap = false;
+
+	return { m_buffer.Get(), static_cast<UINT>(offset / 16), static_cast<UINT>(m_allocator.AlignedSize(size) / 16) };
+}
+
+void UploadRingBuffer::VSSetConstantBuffers(UINT startSlot, UINT count, const Range* ranges)
+{
+	ID3D11Buffer* buffers[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT];
+	UINT firstConstants[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT];
+	UINT numConstants[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT];
+	for (UINT iii = 0; iii < count; ++iii)
+	{
+		buffers[iii] = ranges[iii].Buffer;
+		firstConstants[iii] = ranges[iii].FirstConstant;
+		numConstants[iii] = ranges[iii].NumConstants;
+	}
+	m_context->VSSetConstantBuffers1(startSlot, count, buffers, firstConstants, numConstants);
+}
+
+void UploadRingBuffer::PSSetConstantBuffers(UINT startSlot, UINT count, const Range* ranges)
+{
+	ID3D11Buffer* buffers[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT];
+	UINT firstConstants[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT];
+	UINT numConstants[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT];
+	for (UINT iii = 0; iii < count; ++iii)
+	{
+		buffers[iii] = ranges[iii].Buffer;
+		firstConstants[iii] = ranges[iii].FirstConstant;
+		numConstants[iii] = ranges[iii].NumConstants;
+	}
+	m_context->PSSetConstantBuffers1(startSlot, count, buffers, firstConstants, numConstants);
+}
+
+void UploadRingBuffer::EndFrame()
+{
+	Microsoft::WRL::ComPtr<ID3D11Query> query;
+	if (m_freeQueries.empty())
+	{
+		CD3D11_QUERY_DESC queryDesc(D3D11_QUERY_EVENT);
+		ThrowIfFailed(m_device->CreateQuery(&queryDesc, query.ReleaseAndGetAddressOf()));
+	}
+	else
+	{
+		query = m_freeQueries.back();
+		m_freeQueries.pop_back();
+	}
+
+	m_context->End(query.Get());
+	m_frameQueries.emplace_back(m_allocator.EndFrame(), query);
+
+	// Release the space of every frame the GPU has already finished
+	RetireFrames(false);
+}
+
+void UploadRingBuffer::RetireFrames(bool waitForOldest)
+{
+	while (!m_frameQueries.empty())
+	{
+		ID3D11Query* query = m_frameQueries.front().second.Get();
+
+		HRESULT hr;
+		if (waitForOldest)
+		{
+			// Let GetData flush the command buffer so the query is guaranteed to complete
+			while ((hr = m_context->GetData(query, nullptr, 0, 0)) == S_FALSE)
+				;
+			waitForOldest = false;
+		}
+		else
+		{
+			hr = m_context->GetData(query, nullptr, 0, D3D11_ASYNC_GETDATA_DONOTFLUSH);
+		}
+
+		// S_FALSE = still in flight. Anything else (including a removed device) means the GPU is done with it
+		if (hr == S_FALSE)
+			return;
+
+		m_allocator.RetireFrame(m_frameQueries.front().first);
+		m_freeQueries.push_back(m_frameQueries.front().second);
+		m_frameQueries.pop_front();
+	}
+}
\ No newline at end of file
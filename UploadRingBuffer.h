@@ -0,0 +1,75 @@
+#pragma once
+#include "pch.h"
+#include "DirectXHelper.h"
+
+#include "UploadRingAllocator.h"
+
+#include <deque>
+#include <utility>
+#include <vector>
+
+
+/*
+	One large dynamic constant buffer that per-draw constants (model/view/projection matrices, materials,
+	first instance, ...) are written into, instead of each object owning a small constant buffer that is
+	rewritten with UpdateSubresource before every draw.
+
+	Every Upload writes to a fresh 256 byte aligned range of the buffer (Map with NO_OVERWRITE, so the
+	driver never has to rename or stall) and the range is bound with VSSetConstantBuffers1/
+	PSSetConstantBuffers1 offsets. Ranges belong to the frame they were uploaded in; EndFrame issues an
+	event query so the space is reused once the GPU has finished the frame. If the ring fills up, Upload
+	waits for the oldest frame, and if a single frame needs more than the whole ring the buffer is replaced
+	by one twice the size.
+
+	NOTE: A Range is only valid in the frame it was uploaded in and its Buffer pointer does not hold a
+	      reference. Bind it right after uploading - it can be bound again later in the same frame, but an
+	      Upload that grows the ring replaces the buffer it points into.
+
+	Requires the D3D11.1 ConstantBufferOffsetting and MapNoOverwriteOnDynamicConstantBuffer features
+	(always present on Windows 10 drivers)
+*/
+class UploadRingBuffer
+{
+public:
+	struct Range
+	{
+		ID3D11Buffer*	Buffer;
+		UINT			FirstConstant;	// In 16 byte constants
+		UINT			NumConstants;
+	};
+
+	UploadRingBuffer(ID3D11Device* device, ID3D11DeviceContext1* context, size_t capacity = 1024 * 1024);
+
+	// Copy 'size' bytes into the ring
+	Range Upload(const void* data, size_t size);
+	template<typename T>
+	Range Upload(const T& data) { return Upload(&data, sizeof(T)); }
+
+	// Bind previously uploaded ranges to consecutive constant buffer slots
+	void VSSetConstantBuffers(UINT startSlot, UINT count, const Range* ranges);
+	void PSSetConstantBuffers(UINT startSlot, UINT count, const Range* ranges);
+
+	// Upload and bind in one step
+	template<typename T>
+	void VSSetConstants(UINT slot, const T& data) { Range range = Upload(data); VSSetConstantBuffers(slot, 1, &range); }
+	template<typename T>
+	void PSSetConstants(UINT slot, const T& data) { Range range = Upload(data); PSSetConstantBuffers(slot, 1, &range); }
+
+	// Call once per frame (DeviceResources::Present does this)
+	void EndFrame();
+
+private:
+	void CreateBuffer(size_t capacity);
+	void RetireFrames(bool waitForOldest);
+
+	Microsoft::WRL::ComPtr<ID3D11Device>			m_device;
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext1>	m_context;
+	Microsoft::WRL::ComPtr<ID3D11Buffer>			m_buffer;
+	bool											m_discardOnNextMap;	// First Map of a new buffer
+
+	UploadRingAllocator								m_allocator;
+
+	// Event query for each frame in flight (oldest first) and a pool of finished queries
+	std::deque<std::pair<uint64_t, Microsoft::WRL::ComPtr<ID3D11Query>>>	m_frameQueries;
+	std::vector<Microsoft::WRL::ComPtr<ID3D11Query>>						m_freeQueries;
+};
\ No newline at end of file
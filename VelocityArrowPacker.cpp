@@ -0,0 +1,74 @@
+#include "VelocityArrowPacker.h"
+#include "CameraSpace.h"
+#include "Frustum.h"
+#include "MeshGeometry.h"
+
+#include <cmath>
+
+
+void VelocityArrowPacker::Rebase(const double origin[3])
+{
+	if (!m_instances.empty())
+		CameraSpace::Rebase(origin, m_instances[0].Position, sizeof(VelocityArrowInstance), m_instances.size());
+}
+
+void VelocityArrowPacker::Cull(const Frustum& frustum)
+{
+	if (m_instances.empty())
+		return;
+
+	// Bound each arrow by a sphere around the atom that reaches past the tip (the shaft is |v| / 100 long
+	// and the head is added on top) - written as x, y, z, radius so the frustum can test them all at once
+	m_bounds.resize(4 * m_instances.size());
+	for (size_t iii = 0; iii < m_instances.size(); ++iii)
+	{
+		const VelocityArrowInstance& instance = m_instances[iii];
+		float speed = std::sqrt(instance.Velocity[0] * instance.Velocity[0] +
+								instance.Velocity[1] * instance.Velocity[1] +
+								instance.Velocity[2] * instance.Velocity[2]);
+
+		m_bounds[4 * iii + 0] = instance.Position[0];
+		m_bounds[4 * iii + 1] = instance.Position[1];
+		m_bounds[4 * iii + 2] = instance.Position[2];
+		m_bounds[4 * iii + 3] = instance.Radius + speed / 100.0f + HeadLength;
+	}
+
+	m_visible.resize(m_instances.size());
+	frustum.IntersectsSpheres(m_bounds.data(), 4 * sizeof(float), m_instances.size(), m_visible.data());
+
+	// Compact each batch in place. Batches are in instance order, so the write position never passes the read position
+	uint32_t write = 0;
+	size_t batchWrite = 0;
+	for (const VelocityArrowBatch& batch : m_batches)
+	{
+		uint32_t first = write;
+		for (uint32_t read = batch.FirstInstance; read < batch.FirstInstance + batch.InstanceCount; ++read)
+		{
+			if (m_visible[read])
+				m_instances[write++] = m_instances[read];
+		}
+
+		if (write > first)
+			m_batches[batchWrite++] = { batch.MaterialIndex, first, write - first, batch.Level };
+	}
+
+	m_instances.resize(write);
+	m_batches.resize(batchWrite);
+}
+
+void VelocityArrowPacker::AssignLevels(const float eye[3], float pixelsPerUnit)
+{
+	m_levels.resize(m_instances.size());
+	for (size_t iii = 0; iii < m_instances.size(); ++iii)
+	{
+		const VelocityArrowInstance& instance = m_instances[iii];
+		float dx = instance.Position[0] - eye[0];
+		float dy = instance.Position[1] - eye[1];
+		float dz = instance.Position[2] - eye[2];
+		float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+		m_levels[iii] = MeshLevelOfDetail::SelectLevel(MeshLevelOfDetail::ScreenRadius(instance.Radius, distance, pixelsPerUnit));
+	}
+
+	MeshLevelOfDetail::SplitBatches(m_instances, m_batches, m_levels, m_scratchInstances, m_scratchBatches);
+}
\ No newline at end of file
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class Frustum;
+
+// Per-arrow data for instanced velocity arrows. This is the element type of the structured buffer read by
+// InstancedArrowVertexShader.hlsl, so the layout must match VelocityArrowInstance in that file exactly.
+// The vertex shader builds the orientation and length of the arrow from the velocity, so nothing but the
+// atom is uploaded per arrow.
+struct VelocityArrowInstance
+{
+	float		Position[3];		// Atom center - the arrow starts on its surface
+	float		Radius;				// Atom radius
+	float		Velocity[3];		// Direction of the arrow, |Velocity| / 100 is the length of the shaft
+	uint32_t	Padding;			// Keep the stride a multiple of 16 bytes
+};
+static_assert(sizeof(VelocityArrowInstance) == 32, "VelocityArrowInstance must match the HLSL structured buffer stride");
+
+// A contiguous range of arrows that share a level of detail and are drawn with one DrawIndexedInstanced per
+// part of the arrow (shaft and head)
+struct VelocityArrowBatch
+{
+	uint32_t	MaterialIndex;
+	uint32_t	FirstInstance;
+	uint32_t	InstanceCount;
+	uint32_t	Level;				// Arrow level of detail (see MeshLevelOfDetail)
+};
+
+// Packs the velocity arrows of every atom that shows one into a single instance array. Like
+// AtomInstancePacker the vectors are reused from frame to frame, so packing does not allocate once the
+// capacity has grown to fit the largest simulation.
+//
+// Pack is a template so it works for any atom type (or pointer to one) with Position() and Velocity()
+// returning .x/.y/.z, Radius() and VelocityArrowIsVisible().
+class VelocityArrowPacker
+{
+public:
+	// Every arrow uses materialIndex. Atoms that hide their arrow or are not moving are skipped
+	template<typename TAtomPointer>
+	void Pack(const std::vector<TAtomPointer>& atoms, uint32_t materialIndex);
+
+	// Make the positions relative to 'origin' (see CameraSpace) - call before Cull
+	void Rebase(const double origin[3]);
+
+	// Remove the arrows that are entirely outside the frustum. Each arrow is bounded by a sphere around its
+	// atom that reaches past the tip of the head
+	void Cull(const Frustum& frustum);
+
+	// Pick a level of detail for each arrow from the radius of its atom on screen (the arrow sits on the
+	// atom, so it uses the same level as the atom) and split the batches so each one uses a single level.
+	// See AtomInstancePacker::AssignLevels
+	void AssignLevels(const float eye[3], float pixelsPerUnit);
+
+	const std::vector<VelocityArrowInstance>& Instances() const { return m_instances; }
+	const std::vector<VelocityArrowBatch>& Batches() const { return m_batches; }
+
+	// Length of the arrow head along the velocity (matches InstancedArrowVertexShader)
+	static constexpr float HeadLength = 0.1f;
+
+private:
+	std::vector<VelocityArrowInstance>	m_instances;
+	std::vector<VelocityArrowBatch>		m_batches;
+	std::vector<float>					m_bounds;
+	std::vector<uint8_t>				m_visible;
+	std::vector<uint8_t>				m_levels;
+	std::vector<VelocityArrowInstance>	m_scratchInstances;
+	std::vector<VelocityArrowBatch>		m_scratchBatches;
+};
+
+template<typename TAtomPointer>
+void VelocityArrowPacker::Pack(const std::vector<TAtomPointer>& atoms, uint32_t materialIndex)
+{
+	m_instances.clear();
+	m_batches.clear();
+
+	for (const TAtomPointer& atom : atoms)
+	{
+		if (!atom->VelocityArrowIsVisible())
+			continue;
+
+		// There is nothing to draw for an atom that isn't moving
+		auto velocity = atom->Velocity();
+		if (velocity.x == 0.0f && velocity.y == 0.0f && velocity.z == 0.0f)
+			continue;
+
+		auto position = atom->Position();
+
+		VelocityArrowInstance instance;
+		instance.Position[0] = position.x;
+		instance.Position[1] = position.y;
+		instance.Position[2] = position.z;
+		instance.Radius = atom->Radius();
+		instance.Velocity[0] = velocity.x;
+		instance.Velocity[1] = velocity.y;
+		instance.Velocity[2] = velocity.z;
+		instance.Padding = 0;
+		m_instances.push_back(instance);
+	}
+
+	if (!m_instances.empty())
+		m_batches.push_back({ materialIndex, 0, static_cast<uint32_t>(m_instances.size()), 0 });
+}
\ No newline at end of file
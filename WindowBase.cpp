@@ -1,4 +1,6 @@
 #include "WindowBase.h"
+#include "RenderScheduler.h"
+#include "FrameTimeline.h"
 
 
 #include "WindowsMessageMap.h"
@@ -15,6 +17,31 @@ LRESULT WindowBase::HandleMsg(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
 	//static WindowsMessageMap mm;
 	//OutputDebugString(mm(msg, wParam, lParam).c_str());	
 
+	// Input, resizing and repainting can all change what is on screen, so they request a new frame
+	switch (msg)
+	{
+	case WM_LBUTTONDOWN:
+	case WM_LBUTTONUP:
+	case WM_LBUTTONDBLCLK:
+	case WM_MBUTTONDOWN:
+	case WM_MBUTTONUP:
+	case WM_RBUTTONDOWN:
+	case WM_RBUTTONUP:
+	case WM_MOUSEMOVE:
+	case WM_MOUSELEAVE:
+	case WM_MOUSEWHEEL:
+	case WM_CHAR:
+	case WM_KEYUP:
+	case WM_KEYDOWN:
+		// Input latency is measured from when the message was posted (GetMessageTime has the resolution of GetTickCount)
+		FrameTimeline::InputReceived(static_cast<double>(GetTickCount() - static_cast<DWORD>(GetMessageTime())));
+		[[fallthrough]];
+	case WM_PAINT:
+	case WM_SIZE:
+		RenderScheduler::Invalidate();
+		break;
+	}
+
 	switch (msg)
 	{
 	case WM_CREATE:			return OnCreate(hWnd, msg, wParam, lParam);
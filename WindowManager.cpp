@@ -1,4 +1,6 @@
 #include "WindowManager.h"
+#include "RenderScheduler.h"
+#include "FrameTimeline.h"
 
 // Have to define static member variables in .cpp file
 std::vector<std::shared_ptr<WindowBase>> WindowManager::m_windows;
@@ -51,9 +53,17 @@ void WindowManager::UpdateRenderPresent()
 	for (auto iii = m_windows.begin(); iii != m_windows.end(); ++iii)
 		iii->get()->Update();
 
+	// Only render and present when something has changed since the last frame
+	if (!RenderScheduler::FrameRequested())
+		return;
+
+	RenderScheduler::BeginFrame();
+
 	for (auto iii = m_windows.begin(); iii != m_windows.end(); ++iii)
 	{
 		if (iii->get()->Render())
 			iii->get()->Present();
 	}
+
+	FrameTimeline::EndFrame();
 }
@@ -0,0 +1,268 @@
+#include "TestHarness.h"
+
+#include "BoundingVolumeHierarchy.h"
+#include "Frustum.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <random>
+#include <vector>
+
+// The tree is checked against brute force over every primitive with the same kernels, on randomized
+// scenes that are refit (small moves) and rebuilt (large moves / primitive count changes)
+
+namespace
+{
+	std::mt19937 rng(54321);
+
+	float Uniform(float min, float max)
+	{
+		return min + (max - min) * static_cast<float>(rng() >> 8) * (1.0f / 16777216.0f);
+	}
+
+	struct Scene
+	{
+		std::vector<float> Spheres;		// x, y, z, radius
+		std::vector<float> Capsules;	// x1, y1, z1, x2, y2, z2, radius
+
+		size_t SphereCount() const { return Spheres.size() / 4; }
+		size_t CapsuleCount() const { return Capsules.size() / 7; }
+	};
+
+	Scene RandomScene(size_t sphereCount, size_t capsuleCount)
+	{
+		Scene scene;
+		for (size_t iii = 0; iii < sphereCount; ++iii)
+			scene.Spheres.insert(scene.Spheres.end(), { Uniform(-10.0f, 10.0f), Uniform(-10.0f, 10.0f), Uniform(-10.0f, 10.0f), Uniform(0.1f, 0.7f) });
+
+		for (size_t iii = 0; iii < capsuleCount; ++iii)
+		{
+			float x = Uniform(-10.0f, 10.0f), y = Uniform(-10.0f, 10.0f), z = Uniform(-10.0f, 10.0f);
+			scene.Capsules.insert(scene.Capsules.end(), { x, y, z, x + Uniform(-1.5f, 1.5f), y + Uniform(-1.5f, 1.5f), z + Uniform(-1.5f, 1.5f), Uniform(0.05f, 0.2f) });
+		}
+
+		return scene;
+	}
+
+	void Move(Scene& scene, float distance)
+	{
+		for (size_t iii = 0; iii < scene.SphereCount(); ++iii)
+			for (int axis = 0; axis < 3; ++axis)
+				scene.Spheres[4 * iii + axis] += Uniform(-distance, distance);
+
+		for (size_t iii = 0; iii < scene.CapsuleCount(); ++iii)
+		{
+			float offset[3] = { Uniform(-distance, distance), Uniform(-distance, distance), Uniform(-distance, distance) };
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				scene.Capsules[7 * iii + axis] += offset[axis];
+				scene.Capsules[7 * iii + 3 + axis] += offset[axis];
+			}
+		}
+	}
+
+	void Load(BoundingVolumeHierarchy& bvh, const Scene& scene)
+	{
+		bvh.Clear();
+		for (size_t iii = 0; iii < scene.SphereCount(); ++iii)
+			bvh.AddSphere(&scene.Spheres[4 * iii], scene.Spheres[4 * iii + 3]);
+		for (size_t iii = 0; iii < scene.CapsuleCount(); ++iii)
+			bvh.AddCapsule(&scene.Capsules[7 * iii], &scene.Capsules[7 * iii + 3], scene.Capsules[7 * iii + 6]);
+		bvh.Update();
+	}
+
+	bool BruteForceIntersect(const Scene& scene, const float origin[3], const float direction[3], BoundingVolumeHierarchy::Hit& hit)
+	{
+		hit.Distance = FLT_MAX;
+
+		// Spheres are stored in the tree as zero length capsules, which give exactly the RaySphere result
+		for (size_t iii = 0; iii < scene.SphereCount(); ++iii)
+		{
+			const float* s = &scene.Spheres[4 * iii];
+			float distance = IntersectionKernels::RaySphere(origin, direction, s[0], s[1], s[2], s[3]);
+			if (distance >= 0.0f && distance < hit.Distance)
+				hit = { BoundingVolumeHierarchy::PrimitiveType::SPHERE, static_cast<uint32_t>(iii), distance };
+		}
+
+		for (size_t iii = 0; iii < scene.CapsuleCount(); ++iii)
+		{
+			const float* c = &scene.Capsules[7 * iii];
+			float distance = IntersectionKernels::RayCapsule(origin, direction, c[0], c[1], c[2], c[3], c[4], c[5], c[6]);
+			if (distance >= 0.0f && distance < hit.Distance)
+				hit = { BoundingVolumeHierarchy::PrimitiveType::CAPSULE, static_cast<uint32_t>(iii), distance };
+		}
+
+		return hit.Distance != FLT_MAX;
+	}
+
+	void CheckRays(const BoundingVolumeHierarchy& bvh, const Scene& scene, int rays, int& hits)
+	{
+		for (int ray = 0; ray < rays; ++ray)
+		{
+			// Aim roughly at a random primitive so most rays hit something, some from inside the scene
+			float origin[3] = { Uniform(-15.0f, 15.0f), Uniform(-15.0f, 15.0f), Uniform(-15.0f, 15.0f) };
+			float target[3] = { Uniform(-10.0f, 10.0f), Uniform(-10.0f, 10.0f), Uniform(-10.0f, 10.0f) };
+			if (scene.SphereCount() > 0 && ray % 2 == 0)
+			{
+				const float* s = &scene.Spheres[4 * (rng() % scene.SphereCount())];
+				target[0] = s[0]; target[1] = s[1]; target[2] = s[2];
+			}
+
+			float direction[3] = { target[0] - origin[0], target[1] - origin[1], target[2] - origin[2] };
+			float length = std::sqrt(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+			if (length < 1e-3f)
+				continue;
+			for (float& component : direction)
+				component /= length;
+
+			// Axis aligned rays exercise the infinite inverse direction in the box test
+			if (ray % 7 == 0)
+			{
+				int axis = ray % 3;
+				direction[0] = direction[1] = direction[2] = 0.0f;
+				direction[axis] = 1.0f;
+			}
+
+			BoundingVolumeHierarchy::Hit expected, actual;
+			bool expectedHit = BruteForceIntersect(scene, origin, direction, expected);
+			bool actualHit = bvh.Intersect(origin, direction, actual);
+
+			CHECK_EQUAL(actualHit, expectedHit);
+			if (!expectedHit || !actualHit)
+				continue;
+
+			++hits;
+			CHECK_EQUAL(actual.Distance, expected.Distance);
+			CHECK(actual.Type == expected.Type);
+			CHECK_EQUAL(actual.Index, expected.Index);
+		}
+	}
+
+	// Perspective camera at (0, 0, -distance) looking down +z, in the row vector D3D convention Frustum expects
+	void ViewProjection(float distance, float m[4][4])
+	{
+		const float nearPlane = 0.1f, farPlane = 100.0f;
+		const float scale = 1.0f / std::tan(0.5f * 1.0f);
+		const float range = farPlane / (farPlane - nearPlane);
+
+		for (int row = 0; row < 4; ++row)
+			for (int column = 0; column < 4; ++column)
+				m[row][column] = 0.0f;
+
+		m[0][0] = scale;
+		m[1][1] = scale;
+		m[2][2] = range;
+		m[2][3] = 1.0f;
+		m[3][2] = distance * range - nearPlane * range;
+		m[3][3] = distance;
+	}
+
+	void CheckFrustum(const BoundingVolumeHierarchy& bvh, const Scene& scene, const Frustum& frustum, int& selected)
+	{
+		std::vector<uint32_t> actual;
+		bvh.QuerySphereCenters(frustum, actual);
+		std::sort(actual.begin(), actual.end());
+
+		std::vector<uint32_t> expected;
+		for (size_t iii = 0; iii < scene.SphereCount(); ++iii)
+		{
+			const float* s = &scene.Spheres[4 * iii];
+			if (frustum.IntersectsSphere(s[0], s[1], s[2], 0.0f))
+				expected.push_back(static_cast<uint32_t>(iii));
+		}
+
+		CHECK_EQUAL(actual.size(), expected.size());
+		CHECK(actual == expected);
+		selected += static_cast<int>(expected.size());
+	}
+}
+
+TEST_CASE(IntersectMatchesBruteForce)
+{
+	int hits = 0;
+	for (size_t sphereCount : { 0, 1, 7, 8, 9, 100, 700 })
+	{
+		Scene scene = RandomScene(sphereCount, sphereCount / 2);
+		BoundingVolumeHierarchy bvh;
+		Load(bvh, scene);
+
+		CHECK_EQUAL(bvh.PrimitiveCount(), scene.SphereCount() + scene.CapsuleCount());
+		CheckRays(bvh, scene, 300, hits);
+	}
+
+	CHECK(hits > 500);
+}
+
+TEST_CASE(IntersectAfterRefitAndRebuild)
+{
+	Scene scene = RandomScene(400, 200);
+	BoundingVolumeHierarchy bvh;
+	Load(bvh, scene);
+	size_t nodes = bvh.NodeCount();
+
+	int hits = 0;
+	for (int frame = 0; frame < 20; ++frame)
+	{
+		// Small moves only refit the boxes, the occasional large one makes the tree rebuild
+		Move(scene, frame % 5 == 4 ? 5.0f : 0.05f);
+		Load(bvh, scene);
+		CheckRays(bvh, scene, 100, hits);
+	}
+
+	// Same primitive count - the topology is reused or rebuilt to the same size
+	CHECK_EQUAL(bvh.NodeCount(), nodes);
+
+	// Adding primitives rebuilds the tree
+	Scene bigger = RandomScene(500, 200);
+	Load(bvh, bigger);
+	CheckRays(bvh, bigger, 200, hits);
+
+	CHECK(hits > 1000);
+}
+
+TEST_CASE(RayFromInsideSphere)
+{
+	Scene scene;
+	scene.Spheres = { 0.0f, 0.0f, 0.0f, 2.0f,  5.0f, 0.0f, 0.0f, 0.5f };
+
+	BoundingVolumeHierarchy bvh;
+	Load(bvh, scene);
+
+	const float origin[3] = { 0.5f, 0.0f, 0.0f };
+	const float direction[3] = { 1.0f, 0.0f, 0.0f };
+
+	BoundingVolumeHierarchy::Hit hit;
+	CHECK(bvh.Intersect(origin, direction, hit));
+	CHECK_EQUAL(hit.Index, 0u);
+	CHECK_CLOSE(hit.Distance, 1.5, 1e-6);
+}
+
+TEST_CASE(QuerySphereCentersMatchesBruteForce)
+{
+	int selected = 0;
+	for (size_t sphereCount : { 0, 5, 64, 1000 })
+	{
+		Scene scene = RandomScene(sphereCount, sphereCount / 4);
+		BoundingVolumeHierarchy bvh;
+		Load(bvh, scene);
+
+		float m[4][4];
+		ViewProjection(25.0f, m);
+
+		CheckFrustum(bvh, scene, Frustum::FromViewProjection(m), selected);
+
+		// Rubber band rectangles, including an empty and a degenerate (zero width) one
+		for (int rectangle = 0; rectangle < 50; ++rectangle)
+		{
+			float x1 = Uniform(-1.0f, 1.0f), x2 = Uniform(-1.0f, 1.0f);
+			float y1 = Uniform(-1.0f, 1.0f), y2 = Uniform(-1.0f, 1.0f);
+			if (rectangle == 0)
+				x2 = x1;
+
+			CheckFrustum(bvh, scene, Frustum::FromViewProjection(m, std::min(x1, x2), std::min(y1, y2), std::max(x1, x2), std::max(y1, y2)), selected);
+		}
+	}
+
+	CHECK(selected > 1000);
+}
@@ -0,0 +1,182 @@
+#include "TestHarness.h"
+
+#include "DirtyRegion.h"
+
+#include <random>
+#include <vector>
+
+namespace
+{
+	bool Equal(const DirtyRect& a, const DirtyRect& b)
+	{
+		return a.Left == b.Left && a.Top == b.Top && a.Right == b.Right && a.Bottom == b.Bottom;
+	}
+
+	bool Contains(const DirtyRegion& region, const DirtyRect& rect)
+	{
+		for (const DirtyRect& dirty : region.Rects())
+		{
+			if (dirty.Left <= rect.Left && dirty.Top <= rect.Top && dirty.Right >= rect.Right && dirty.Bottom >= rect.Bottom)
+				return true;
+		}
+		return false;
+	}
+
+	bool Disjoint(const DirtyRegion& region)
+	{
+		const std::vector<DirtyRect>& rects = region.Rects();
+		for (size_t iii = 0; iii < rects.size(); ++iii)
+			for (size_t jjj = iii + 1; jjj < rects.size(); ++jjj)
+				if (DirtyRegion::Overlaps(rects[iii], rects[jjj]))
+					return false;
+		return true;
+	}
+}
+
+TEST_CASE(EmptyRectsAreIgnored)
+{
+	DirtyRegion region;
+	region.Add(10.0f, 10.0f, 10.0f, 20.0f);
+	region.Add(10.0f, 10.0f, 20.0f, 10.0f);
+	region.Add(20.0f, 20.0f, 10.0f, 10.0f);
+
+	CHECK(region.Empty());
+	CHECK(!region.Intersects({ 0.0f, 0.0f, 100.0f, 100.0f }));
+}
+
+TEST_CASE(TouchingRectsAreNotMerged)
+{
+	DirtyRegion region;
+	region.Add(0.0f, 0.0f, 10.0f, 10.0f);
+	region.Add(10.0f, 0.0f, 20.0f, 10.0f);	// Shares the right edge
+	region.Add(0.0f, 10.0f, 10.0f, 20.0f);	// Shares the bottom edge
+	region.Add(10.0f, 10.0f, 20.0f, 20.0f);	// Shares a corner with the first
+
+	CHECK_EQUAL(region.Rects().size(), static_cast<size_t>(4));
+	CHECK(Disjoint(region));
+
+	// Touching the region is not intersecting it
+	DirtyRegion single;
+	single.Add(0.0f, 0.0f, 10.0f, 10.0f);
+	CHECK(!single.Intersects({ 10.0f, 0.0f, 20.0f, 10.0f }));
+	CHECK(!single.Intersects({ -5.0f, 10.0f, 5.0f, 15.0f }));
+	CHECK(single.Intersects({ 9.0f, 9.0f, 20.0f, 20.0f }));
+}
+
+TEST_CASE(OverlappingRectsMerge)
+{
+	DirtyRegion region;
+	region.Add(0.0f, 0.0f, 10.0f, 10.0f);
+	region.Add(5.0f, 5.0f, 15.0f, 15.0f);
+
+	CHECK_EQUAL(region.Rects().size(), static_cast<size_t>(1));
+	CHECK(Equal(region.Rects()[0], { 0.0f, 0.0f, 15.0f, 15.0f }));
+
+	// A control that is invalidated every frame doesn't grow the list
+	for (int iii = 0; iii < 100; ++iii)
+		region.Add(2.0f, 2.0f, 8.0f, 8.0f);
+	CHECK_EQUAL(region.Rects().size(), static_cast<size_t>(1));
+}
+
+TEST_CASE(ChainedMerges)
+{
+	// The new rect only overlaps A, but once merged with A it overlaps C as well
+	DirtyRegion region;
+	region.Add(0.0f, 0.0f, 10.0f, 10.0f);		// A
+	region.Add(8.0f, 12.0f, 12.0f, 20.0f);		// C
+	CHECK_EQUAL(region.Rects().size(), static_cast<size_t>(2));
+
+	region.Add(-5.0f, 9.0f, 1.0f, 13.0f);		// B
+	CHECK_EQUAL(region.Rects().size(), static_cast<size_t>(1));
+	CHECK(Equal(region.Rects()[0], { -5.0f, 0.0f, 12.0f, 20.0f }));
+
+	// A rect bridging two separate rects merges all three
+	DirtyRegion bridge;
+	bridge.Add(0.0f, 0.0f, 10.0f, 10.0f);
+	bridge.Add(20.0f, 0.0f, 30.0f, 10.0f);
+	bridge.Add(40.0f, 0.0f, 50.0f, 10.0f);
+	bridge.Add(5.0f, 4.0f, 45.0f, 6.0f);
+	CHECK_EQUAL(bridge.Rects().size(), static_cast<size_t>(1));
+	CHECK(Equal(bridge.Rects()[0], { 0.0f, 0.0f, 50.0f, 10.0f }));
+}
+
+TEST_CASE(MaxRectsMergesTheLeastWastefulPair)
+{
+	// MaxRects well separated rects, plus one right next to the first (only the 1 unit gap is wasted)
+	DirtyRegion region;
+	for (size_t iii = 0; iii < DirtyRegion::MaxRects; ++iii)
+		region.Add(100.0f * iii, 0.0f, 100.0f * iii + 10.0f, 10.0f);
+	CHECK_EQUAL(region.Rects().size(), DirtyRegion::MaxRects);
+
+	region.Add(11.0f, 0.0f, 21.0f, 10.0f);
+	CHECK_EQUAL(region.Rects().size(), DirtyRegion::MaxRects);
+	CHECK(Contains(region, { 0.0f, 0.0f, 21.0f, 10.0f }));
+	CHECK(Disjoint(region));
+
+	// The merged union can overlap another rect - it is re-added, so that one is merged in as well.
+	// The cheapest pair is the two 10x10 rects with a 2 unit gap; the tall rect fills that gap but
+	// is expensive to merge with either of them on its own
+	DirtyRegion swallow;
+	swallow.Add(0.0f, 0.0f, 10.0f, 10.0f);
+	swallow.Add(12.0f, 0.0f, 22.0f, 10.0f);
+	swallow.Add(10.0f, -50.0f, 12.0f, 60.0f);
+	CHECK_EQUAL(swallow.Rects().size(), static_cast<size_t>(3));
+
+	for (size_t iii = 3; iii <= DirtyRegion::MaxRects; ++iii)
+		swallow.Add(1000.0f * iii, 1000.0f, 1000.0f * iii + 1.0f, 1001.0f);
+
+	CHECK_EQUAL(swallow.Rects().size(), DirtyRegion::MaxRects - 1);
+	CHECK(Contains(swallow, { 0.0f, -50.0f, 22.0f, 60.0f }));
+	CHECK(Disjoint(swallow));
+}
+
+TEST_CASE(ClipShrinksAndDropsRects)
+{
+	DirtyRegion region;
+	region.Add(-10.0f, -10.0f, 10.0f, 10.0f);		// Partly outside
+	region.Add(50.0f, 50.0f, 60.0f, 60.0f);			// Inside
+	region.Add(200.0f, 0.0f, 300.0f, 10.0f);		// Entirely outside
+	region.Add(100.0f, 20.0f, 120.0f, 30.0f);		// Touches the right edge from outside
+
+	region.Clip({ 0.0f, 0.0f, 100.0f, 100.0f });
+
+	CHECK_EQUAL(region.Rects().size(), static_cast<size_t>(2));
+	CHECK(Contains(region, { 0.0f, 0.0f, 10.0f, 10.0f }));
+	CHECK(!Contains(region, { -1.0f, 0.0f, 10.0f, 10.0f }));
+	CHECK(Contains(region, { 50.0f, 50.0f, 60.0f, 60.0f }));
+
+	// Clipping to an empty rect drops everything
+	region.Clip({ 0.0f, 0.0f, 0.0f, 0.0f });
+	CHECK(region.Empty());
+}
+
+TEST_CASE(RandomRegionsStayDisjointAndCoverEveryRect)
+{
+	std::mt19937 rng(4242);
+	auto uniform = [&rng](float max) { return static_cast<float>(rng() % 1000) * max / 1000.0f; };
+
+	for (int trial = 0; trial < 200; ++trial)
+	{
+		DirtyRegion region;
+		std::vector<DirtyRect> added;
+
+		int count = 1 + static_cast<int>(rng() % 40);
+		for (int iii = 0; iii < count; ++iii)
+		{
+			float left = uniform(1000.0f), top = uniform(800.0f);
+			DirtyRect rect = { left, top, left + 1.0f + uniform(150.0f), top + 1.0f + uniform(60.0f) };
+			region.Add(rect);
+			added.push_back(rect);
+
+			CHECK(region.Rects().size() <= DirtyRegion::MaxRects);
+			CHECK(Disjoint(region));
+		}
+
+		// Merging only ever grows rects, so each added rect is inside exactly one of them
+		for (const DirtyRect& rect : added)
+		{
+			CHECK(Contains(region, rect));
+			CHECK(region.Intersects(rect));
+		}
+	}
+}
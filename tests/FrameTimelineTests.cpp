@@ -0,0 +1,98 @@
+#include "TestHarness.h"
+
+#include "FrameTimeline.h"
+
+TEST_CASE(PercentilesOfTheSamples)
+{
+	RollingSamples samples;
+	CHECK_EQUAL(samples.Count(), static_cast<size_t>(0));
+	CHECK_EQUAL(samples.Percentile(0.5f), 0.0f);
+
+	// 1 to 101 in a scrambled order
+	for (int iii = 0; iii < 101; ++iii)
+		samples.Add(static_cast<float>(1 + (iii * 37) % 101));
+
+	CHECK_EQUAL(samples.Count(), static_cast<size_t>(101));
+	CHECK_EQUAL(samples.Percentile(0.0f), 1.0f);
+	CHECK_EQUAL(samples.Percentile(0.5f), 51.0f);
+	CHECK_EQUAL(samples.Percentile(0.99f), 100.0f);
+	CHECK_EQUAL(samples.Percentile(1.0f), 101.0f);
+
+	// Out of range percentiles are clamped
+	CHECK_EQUAL(samples.Percentile(-1.0f), 1.0f);
+	CHECK_EQUAL(samples.Percentile(2.0f), 101.0f);
+
+	samples.Clear();
+	CHECK_EQUAL(samples.Count(), static_cast<size_t>(0));
+}
+
+TEST_CASE(OnlyTheLastWindowIsKept)
+{
+	RollingSamples samples;
+
+	// A spike that has left the window no longer shows up in p99
+	samples.Add(1000.0f);
+	for (size_t iii = 0; iii < RollingSamples::WindowSize; ++iii)
+		samples.Add(static_cast<float>(iii % 10));
+
+	CHECK_EQUAL(samples.Count(), RollingSamples::WindowSize);
+	CHECK_EQUAL(samples.Percentile(1.0f), 9.0f);
+	CHECK_EQUAL(samples.Percentile(0.0f), 0.0f);
+}
+
+TEST_CASE(IntervalsOnlyCoverBackToBackPresents)
+{
+	// FrameTimeline is static, so only look at the samples this test adds
+	size_t intervals = FrameTimeline::FrameInterval().Count();
+	size_t frames = FrameTimeline::FrameTime().Count();
+
+	// Two presented frames in a row - one interval
+	FrameTimeline::BeginFrame();
+	FrameTimeline::EndFrame();
+	FrameTimeline::BeginFrame();
+	FrameTimeline::EndFrame();
+	CHECK_EQUAL(FrameTimeline::FrameTime().Count(), frames + 2);
+	CHECK_EQUAL(FrameTimeline::FrameInterval().Count(), intervals + 1);
+
+	// App::Run waits for messages - the next present has no interval to the last one
+	FrameTimeline::Idle();
+	FrameTimeline::BeginFrame();
+	FrameTimeline::EndFrame();
+	CHECK_EQUAL(FrameTimeline::FrameInterval().Count(), intervals + 1);
+
+	// A pass through the loop that didn't present breaks the chain as well
+	FrameTimeline::BeginFrame();
+	FrameTimeline::BeginFrame();
+	FrameTimeline::EndFrame();
+	CHECK_EQUAL(FrameTimeline::FrameInterval().Count(), intervals + 1);
+
+	FrameTimeline::BeginFrame();
+	FrameTimeline::EndFrame();
+	CHECK_EQUAL(FrameTimeline::FrameInterval().Count(), intervals + 2);
+	CHECK_EQUAL(FrameTimeline::FrameTime().Count(), frames + 5);
+}
+
+TEST_CASE(StagesAreSummedOverTheFrame)
+{
+	size_t inputs = FrameTimeline::InputLatency().Count();
+
+	FrameTimeline::BeginFrame();
+	FrameTimeline::InputReceived(50.0);
+	FrameTimeline::InputReceived(10.0);
+	for (int step = 0; step < 3; ++step)
+	{
+		FrameTimeline::BeginStage(FrameStage::SIMULATION_STEP);
+		FrameTimeline::EndStage(FrameStage::SIMULATION_STEP);
+	}
+	FrameTimeline::EndFrame();
+
+	// One sample per frame, however many times the stage ran, and the latency is from the oldest input
+	CHECK_EQUAL(FrameTimeline::InputLatency().Count(), inputs + 1);
+	CHECK(FrameTimeline::InputLatency().Percentile(1.0f) >= 50.0f);
+	CHECK(FrameTimeline::CpuStage(FrameStage::SIMULATION_STEP).Percentile(0.0f) >= 0.0f);
+
+	// No input, no latency sample
+	FrameTimeline::BeginFrame();
+	FrameTimeline::EndFrame();
+	CHECK_EQUAL(FrameTimeline::InputLatency().Count(), inputs + 1);
+}
@@ -0,0 +1,488 @@
+#include "TestHarness.h"
+
+#include "AtomInstancePacker.h"
+#include "BondGeometry.h"
+#include "CameraSpace.h"
+#include "Frustum.h"
+#include "TestScene.h"
+#include "VelocityArrowPacker.h"
+
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+// The planes are checked against projecting points straight to clip space with the view-projection matrix
+// (in double), for synthetic cameras with a translated and rotated view. The batch test and the culling of
+// the packers are checked against the scalar sphere test
+
+namespace
+{
+	std::mt19937 rng(4242);
+
+	float Uniform(float min, float max)
+	{
+		return min + (max - min) * static_cast<float>(rng() >> 8) * (1.0f / 16777216.0f);
+	}
+
+	// Screen rectangle in normalized device coordinates (see Frustum::FromViewProjection)
+	struct Rect
+	{
+		float Left, Bottom, Right, Top;
+	};
+
+	const Rect FullScreen = { -1.0f, -1.0f, 1.0f, 1.0f };
+	const Rect SubRects[3] = { { -0.5f, -0.25f, 0.75f, 0.5f }, { -1.0f, 0.2f, -0.2f, 1.0f }, { 0.1f, -0.9f, 0.3f, -0.7f } };
+
+	// Every camera looks at this point
+	const float Target[3] = { -1.0f, 0.5f, 0.0f };
+
+	// Right handed look-at (like XMMatrixLookAtRH), row-major for row vectors
+	void LookAt(const float eye[3], const float target[3], float view[4][4])
+	{
+		float z[3] = { eye[0] - target[0], eye[1] - target[1], eye[2] - target[2] };
+		float length = std::sqrt(z[0] * z[0] + z[1] * z[1] + z[2] * z[2]);
+		for (float& component : z)
+			component /= length;
+
+		float x[3] = { z[2], 0.0f, -z[0] };		// cross((0, 1, 0), z)
+		length = std::sqrt(x[0] * x[0] + x[1] * x[1] + x[2] * x[2]);
+		for (float& component : x)
+			component /= length;
+
+		const float y[3] = { z[1] * x[2] - z[2] * x[1], z[2] * x[0] - z[0] * x[2], z[0] * x[1] - z[1] * x[0] };
+
+		std::memset(view, 0, sizeof(float) * 16);
+		for (int row = 0; row < 3; ++row)
+		{
+			view[row][0] = x[row];
+			view[row][1] = y[row];
+			view[row][2] = z[row];
+		}
+		view[3][0] = -(x[0] * eye[0] + x[1] * eye[1] + x[2] * eye[2]);
+		view[3][1] = -(y[0] * eye[0] + y[1] * eye[1] + y[2] * eye[2]);
+		view[3][2] = -(z[0] * eye[0] + z[1] * eye[1] + z[2] * eye[2]);
+		view[3][3] = 1.0f;
+	}
+
+	// Right handed perspective with a finite far plane and the usual depth (like XMMatrixPerspectiveFovRH)
+	void Perspective(float fovAngleY, float aspectRatio, float nearPlane, float farPlane, float projection[4][4])
+	{
+		float yScale = 1.0f / std::tan(0.5f * fovAngleY);
+
+		std::memset(projection, 0, sizeof(float) * 16);
+		projection[0][0] = yScale / aspectRatio;
+		projection[1][1] = yScale;
+		projection[2][2] = farPlane / (nearPlane - farPlane);
+		projection[2][3] = -1.0f;
+		projection[3][2] = nearPlane * farPlane / (nearPlane - farPlane);
+	}
+
+	void Multiply(const float a[4][4], const float b[4][4], float result[4][4])
+	{
+		for (int row = 0; row < 4; ++row)
+			for (int column = 0; column < 4; ++column)
+				result[row][column] = a[row][0] * b[0][column] + a[row][1] * b[1][column] + a[row][2] * b[2][column] + a[row][3] * b[3][column];
+	}
+
+	struct Camera
+	{
+		float	Eye[3];
+		float	ViewProjection[4][4];
+	};
+
+	// Off axis eye looking at a point that isn't the origin, so the planes have a rotation and a translation
+	Camera MakeCamera(bool reverseZ)
+	{
+		Camera camera = { { 3.0f, 2.0f, 8.0f }, {} };
+
+		float view[4][4], projection[4][4];
+		LookAt(camera.Eye, Target, view);
+		if (reverseZ)
+			CameraSpace::ReverseZPerspective(0.8f, 1.5f, 0.1f, projection);
+		else
+			Perspective(0.8f, 1.5f, 0.1f, 30.0f, projection);
+
+		Multiply(view, projection, camera.ViewProjection);
+		return camera;
+	}
+
+	// Value of each clip condition of 'rect' for a point, in Frustum::Plane order. The point is inside the
+	// frustum when all of them are >= 0
+	void ClipConditions(const float m[4][4], const Rect& rect, const double p[3], double conditions[6])
+	{
+		double clip[4];
+		for (int column = 0; column < 4; ++column)
+			clip[column] = p[0] * m[0][column] + p[1] * m[1][column] + p[2] * m[2][column] + m[3][column];
+
+		conditions[Frustum::LEFT]		= clip[0] - rect.Left * clip[3];
+		conditions[Frustum::RIGHT]		= rect.Right * clip[3] - clip[0];
+		conditions[Frustum::BOTTOM]		= clip[1] - rect.Bottom * clip[3];
+		conditions[Frustum::TOP]		= rect.Top * clip[3] - clip[1];
+		conditions[Frustum::NEAR_PLANE]	= clip[2];
+		conditions[Frustum::FAR_PLANE]	= clip[3] - clip[2];
+	}
+
+	// Points spread evenly over the unit sphere (Fibonacci lattice)
+	std::vector<double> UnitSpherePoints(int count)
+	{
+		std::vector<double> points;
+		const double goldenAngle = 3.14159265358979 * (3.0 - std::sqrt(5.0));
+		for (int iii = 0; iii < count; ++iii)
+		{
+			double y = 1.0 - 2.0 * (iii + 0.5) / count;
+			double ring = std::sqrt(1.0 - y * y);
+			points.push_back(ring * std::cos(goldenAngle * iii));
+			points.push_back(y);
+			points.push_back(ring * std::sin(goldenAngle * iii));
+		}
+		return points;
+	}
+
+	enum class Expected { VISIBLE, CULLED, EITHER };
+
+	// Ground truth for a sphere from clip space alone. A sphere is visible if a point of the slightly smaller
+	// sphere projects inside the clip volume, and culled if every point of the slightly larger sphere fails
+	// the same clip condition. Spheres in between (around the corners and edges, where the plane test is
+	// conservative) may go either way
+	Expected Classify(const float m[4][4], const Rect& rect, const float sphere[4], const std::vector<double>& unitPoints)
+	{
+		bool anyInside = false;
+		bool outside[6] = { true, true, true, true, true, true };
+
+		for (size_t iii = 0; iii < unitPoints.size(); iii += 3)
+		{
+			double inner[3], outer[3];
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				inner[axis] = sphere[axis] + 0.98 * sphere[3] * unitPoints[iii + axis];
+				outer[axis] = sphere[axis] + 1.02 * sphere[3] * unitPoints[iii + axis];
+			}
+
+			double conditions[6];
+			ClipConditions(m, rect, inner, conditions);
+			bool inside = true;
+			for (double condition : conditions)
+				inside &= condition >= 0.0;
+			anyInside |= inside;
+
+			ClipConditions(m, rect, outer, conditions);
+			for (int plane = 0; plane < 6; ++plane)
+				outside[plane] &= conditions[plane] < 0.0;
+		}
+
+		if (anyInside)
+			return Expected::VISIBLE;
+		for (bool planeOutside : outside)
+		{
+			if (planeOutside)
+				return Expected::CULLED;
+		}
+		return Expected::EITHER;
+	}
+
+	void RandomSphere(const float eye[3], float sphere[4])
+	{
+		// Half anywhere around the eye - in front, behind and beyond the finite far plane - and half near the
+		// line of sight, so small sub-rectangles still see some of them
+		if (rng() % 2 == 0)
+		{
+			sphere[0] = eye[0] + Uniform(-40.0f, 40.0f);
+			sphere[1] = eye[1] + Uniform(-40.0f, 40.0f);
+			sphere[2] = eye[2] + Uniform(-40.0f, 40.0f);
+		}
+		else
+		{
+			float distance = Uniform(0.0f, 4.0f);
+			for (int axis = 0; axis < 3; ++axis)
+				sphere[axis] = eye[axis] + (Target[axis] - eye[axis]) * distance + Uniform(-6.0f, 6.0f);
+		}
+		sphere[3] = Uniform(0.01f, 3.0f);
+	}
+
+	void CheckAgainstClipSpace(const Camera& camera, const Rect& rect, bool checkFarPlane)
+	{
+		Frustum frustum = Frustum::FromViewProjection(camera.ViewProjection, rect.Left, rect.Bottom, rect.Right, rect.Top);
+		const std::vector<double> unitPoints = UnitSpherePoints(400);
+
+		int visible = 0, culled = 0, wrong = 0;
+		for (int iii = 0; iii < 4000; ++iii)
+		{
+			float sphere[4];
+			RandomSphere(camera.Eye, sphere);
+
+			Expected expected = Classify(camera.ViewProjection, rect, sphere, unitPoints);
+			bool intersects = frustum.IntersectsSphere(sphere[0], sphere[1], sphere[2], sphere[3]);
+			if (expected == Expected::VISIBLE)
+			{
+				++visible;
+				wrong += intersects ? 0 : 1;
+			}
+			else if (expected == Expected::CULLED)
+			{
+				++culled;
+				wrong += intersects ? 1 : 0;
+			}
+		}
+
+		CHECK_EQUAL(wrong, 0);
+
+		// Enough of both for the comparison to mean something
+		CHECK(visible > 50);
+		CHECK(culled > 1000);
+
+		// Points on the clip boundary are on the planes, and the planes are normalized: a point moved one unit
+		// along a plane's normal is one unit further from it
+		double conditions[6];
+		const double center[3] = { 0.0, 0.0, 0.0 };
+		ClipConditions(camera.ViewProjection, rect, center, conditions);
+		for (int plane = 0; plane < 6; ++plane)
+		{
+			if (plane == Frustum::FAR_PLANE && !checkFarPlane)
+				continue;
+
+			float d0 = frustum.Distance(plane, 0.0f, 0.0f, 0.0f);
+			CHECK_EQUAL(d0 >= 0.0f, conditions[plane] >= 0.0);
+
+			const float step[3] = { Uniform(-1.0f, 1.0f), Uniform(-1.0f, 1.0f), Uniform(-1.0f, 1.0f) };
+			float length = std::sqrt(step[0] * step[0] + step[1] * step[1] + step[2] * step[2]);
+			float d1 = frustum.Distance(plane, step[0], step[1], step[2]);
+			CHECK(std::abs(d1 - d0) <= length * 1.0001f);
+		}
+	}
+}
+
+TEST_CASE(PlanesMatchClipSpace)
+{
+	Camera camera = MakeCamera(false);
+	CheckAgainstClipSpace(camera, FullScreen, true);
+}
+
+TEST_CASE(ReverseZPlanesMatchClipSpace)
+{
+	Camera camera = MakeCamera(true);
+	CheckAgainstClipSpace(camera, FullScreen, false);
+
+	// The far plane is at infinity, so nothing in front of the eye is too far away to be seen. Behind the
+	// eye is still culled
+	Frustum frustum = Frustum::FromViewProjection(camera.ViewProjection);
+	for (float distance : { 1.0f, 1e3f, 1e6f })
+	{
+		float x = camera.Eye[0] + (Target[0] - camera.Eye[0]) * distance;
+		float y = camera.Eye[1] + (Target[1] - camera.Eye[1]) * distance;
+		float z = camera.Eye[2] + (Target[2] - camera.Eye[2]) * distance;
+		CHECK(frustum.IntersectsSphere(x, y, z, 0.01f));
+
+		x = camera.Eye[0] - (Target[0] - camera.Eye[0]) * distance;
+		y = camera.Eye[1] - (Target[1] - camera.Eye[1]) * distance;
+		z = camera.Eye[2] - (Target[2] - camera.Eye[2]) * distance;
+		CHECK(!frustum.IntersectsSphere(x, y, z, 0.01f));
+	}
+}
+
+TEST_CASE(SubRectanglesMatchClipSpace)
+{
+	for (bool reverseZ : { false, true })
+	{
+		Camera camera = MakeCamera(reverseZ);
+		for (const Rect& rect : SubRects)
+			CheckAgainstClipSpace(camera, rect, !reverseZ);
+	}
+}
+
+TEST_CASE(BatchMatchesScalarTest)
+{
+	// Spheres inside larger records, like the packed instance arrays the packers cull
+	struct Record
+	{
+		float		Sphere[4];
+		uint32_t	Payload[3];
+	};
+
+	for (bool reverseZ : { false, true })
+	{
+		Camera camera = MakeCamera(reverseZ);
+		Frustum frustum = Frustum::FromViewProjection(camera.ViewProjection, -0.5f, -0.25f, 0.75f, 0.5f);
+
+		std::vector<Record> records(1001);
+		for (Record& record : records)
+		{
+			RandomSphere(camera.Eye, record.Sphere);
+			record.Payload[0] = record.Payload[1] = record.Payload[2] = 0xFFFFFFFF;
+		}
+
+		std::vector<uint8_t> visible(records.size(), 2);
+		size_t count = frustum.IntersectsSpheres(records[0].Sphere, sizeof(Record), records.size(), visible.data());
+
+		size_t expectedCount = 0;
+		for (size_t iii = 0; iii < records.size(); ++iii)
+		{
+			const float* sphere = records[iii].Sphere;
+			bool expected = frustum.IntersectsSphere(sphere[0], sphere[1], sphere[2], sphere[3]);
+			CHECK_EQUAL(visible[iii], static_cast<uint8_t>(expected ? 1 : 0));
+			expectedCount += expected ? 1 : 0;
+		}
+		CHECK_EQUAL(count, expectedCount);
+		CHECK(count > 0 && count < records.size());
+
+		// Tightly packed spheres and an empty batch
+		std::vector<float> packed;
+		for (const Record& record : records)
+			packed.insert(packed.end(), record.Sphere, record.Sphere + 4);
+		std::vector<uint8_t> packedVisible(records.size(), 2);
+		CHECK_EQUAL(frustum.IntersectsSpheres(packed.data(), 4 * sizeof(float), records.size(), packedVisible.data()), count);
+		CHECK(packedVisible == visible);
+		CHECK_EQUAL(frustum.IntersectsSpheres(packed.data(), 4 * sizeof(float), 0, nullptr), static_cast<size_t>(0));
+	}
+}
+
+namespace
+{
+	// Atoms of a few elements spread around the camera, a third of them with a velocity arrow
+	std::vector<std::shared_ptr<TestScene::Atom>> RandomAtoms(const float eye[3], size_t count)
+	{
+		std::vector<std::shared_ptr<TestScene::Atom>> atoms;
+		for (size_t iii = 0; iii < count; ++iii)
+		{
+			auto atom = std::make_shared<TestScene::Atom>();
+			atom->Center = { eye[0] + Uniform(-15.0f, 15.0f), eye[1] + Uniform(-15.0f, 15.0f), eye[2] + Uniform(-15.0f, 15.0f) };
+			atom->Speed = { Uniform(-300.0f, 300.0f), Uniform(-300.0f, 300.0f), Uniform(-300.0f, 300.0f) };
+			atom->Element = 1 + static_cast<int>(rng() % 5);
+			atom->ArrowIsVisible = iii % 3 == 0;
+			atoms.push_back(atom);
+		}
+		return atoms;
+	}
+
+	// Cull keeps the visible instances of each batch in order, packs the batches back to back and drops the
+	// ones that end up empty. 'Bounds' returns the bounding sphere the packer tests an instance with
+	template<typename TInstance, typename TBatch, typename TBounds>
+	void CheckCompaction(const Frustum& frustum, const std::vector<TInstance>& before, const std::vector<TBatch>& batchesBefore,
+						 const std::vector<TInstance>& after, const std::vector<TBatch>& batchesAfter, TBounds bounds)
+	{
+		std::vector<TInstance> expected;
+		std::vector<TBatch> expectedBatches;
+		for (const TBatch& batch : batchesBefore)
+		{
+			uint32_t first = static_cast<uint32_t>(expected.size());
+			for (uint32_t iii = batch.FirstInstance; iii < batch.FirstInstance + batch.InstanceCount; ++iii)
+			{
+				float sphere[4];
+				bounds(before[iii], sphere);
+				if (frustum.IntersectsSphere(sphere[0], sphere[1], sphere[2], sphere[3]))
+					expected.push_back(before[iii]);
+			}
+
+			uint32_t count = static_cast<uint32_t>(expected.size()) - first;
+			if (count > 0)
+				expectedBatches.push_back({ batch.MaterialIndex, first, count, batch.Level });
+		}
+
+		CHECK_EQUAL(after.size(), expected.size());
+		CHECK(std::memcmp(after.data(), expected.data(), sizeof(TInstance) * std::min(after.size(), expected.size())) == 0);
+
+		CHECK_EQUAL(batchesAfter.size(), expectedBatches.size());
+		for (size_t iii = 0; iii < batchesAfter.size() && iii < expectedBatches.size(); ++iii)
+		{
+			CHECK_EQUAL(batchesAfter[iii].MaterialIndex, expectedBatches[iii].MaterialIndex);
+			CHECK_EQUAL(batchesAfter[iii].FirstInstance, expectedBatches[iii].FirstInstance);
+			CHECK_EQUAL(batchesAfter[iii].InstanceCount, expectedBatches[iii].InstanceCount);
+			CHECK_EQUAL(batchesAfter[iii].Level, expectedBatches[iii].Level);
+		}
+
+		// Something was culled and something was kept
+		CHECK(after.size() > 0 && after.size() < before.size());
+	}
+}
+
+TEST_CASE(AtomCullingCompactsBatches)
+{
+	Camera camera = MakeCamera(true);
+	Frustum frustum = Frustum::FromViewProjection(camera.ViewProjection);
+
+	AtomInstancePacker packer;
+	packer.Pack(RandomAtoms(camera.Eye, 500));
+	std::vector<AtomInstance> before = packer.Instances();
+	std::vector<AtomInstanceBatch> batchesBefore = packer.Batches();
+	CHECK_EQUAL(batchesBefore.size(), static_cast<size_t>(5));
+
+	packer.Cull(frustum);
+	CheckCompaction(frustum, before, batchesBefore, packer.Instances(), packer.Batches(),
+		[](const AtomInstance& instance, float sphere[4]) { std::memcpy(sphere, instance.Position, sizeof(float) * 4); });
+
+	// Culling everything removes every batch
+	const float behind[4][4] = { { 1.0f, 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, -1.0f } };
+	packer.Cull(Frustum::FromViewProjection(behind));
+	CHECK(packer.Instances().empty());
+	CHECK(packer.Batches().empty());
+}
+
+TEST_CASE(BondCullingCompactsBatches)
+{
+	Camera camera = MakeCamera(true);
+	Frustum frustum = Frustum::FromViewProjection(camera.ViewProjection);
+
+	// Bonds between neighbouring atoms of the random set
+	std::vector<std::shared_ptr<TestScene::Atom>> atoms = RandomAtoms(camera.Eye, 301);
+	BondGeometry bonds;
+	bonds.Clear();
+	for (size_t iii = 0; iii + 1 < atoms.size(); iii += 2)
+	{
+		const TestScene::Atom& a = *atoms[iii];
+		const TestScene::Atom& b = *atoms[iii + 1];
+		const float position1[3] = { a.Center.x, a.Center.y, a.Center.z };
+		const float position2[3] = { b.Center.x, b.Center.y, b.Center.z };
+		bonds.AddBond(position1, a.Radius(), a.Element, position2, b.Radius(), b.Element, 1 + iii % 3);
+	}
+	bonds.Generate(camera.Eye, TestScene::CylinderRadius);
+
+	std::vector<BondCylinderInstance> before = bonds.Instances();
+	std::vector<BondCylinderBatch> batchesBefore = bonds.Batches();
+
+	bonds.Cull(frustum);
+	CheckCompaction(frustum, before, batchesBefore, bonds.Instances(), bonds.Batches(),
+		[](const BondCylinderInstance& instance, float sphere[4])
+		{
+			// Sphere around the middle of the cylinder that encloses both end caps
+			float half[3] = { instance.Axis[0] * 0.5f, instance.Axis[1] * 0.5f, instance.Axis[2] * 0.5f };
+			for (int axis = 0; axis < 3; ++axis)
+				sphere[axis] = instance.Start[axis] + half[axis];
+			sphere[3] = std::sqrt(half[0] * half[0] + half[1] * half[1] + half[2] * half[2]) + instance.Radius;
+		});
+
+	// Conservative - a cylinder with an end inside the frustum is never culled
+	for (const BondCylinderInstance& instance : before)
+	{
+		if (!frustum.IntersectsSphere(instance.Start[0], instance.Start[1], instance.Start[2], 0.0f))
+			continue;
+
+		bool kept = false;
+		for (const BondCylinderInstance& survivor : bonds.Instances())
+			kept |= std::memcmp(&survivor, &instance, sizeof(instance)) == 0;
+		CHECK(kept);
+	}
+}
+
+TEST_CASE(ArrowCullingCompactsBatches)
+{
+	Camera camera = MakeCamera(true);
+	Frustum frustum = Frustum::FromViewProjection(camera.ViewProjection);
+
+	VelocityArrowPacker arrows;
+	arrows.Pack(RandomAtoms(camera.Eye, 600), TestScene::ArrowMaterial);
+	std::vector<VelocityArrowInstance> before = arrows.Instances();
+	std::vector<VelocityArrowBatch> batchesBefore = arrows.Batches();
+	CHECK_EQUAL(before.size(), static_cast<size_t>(200));
+
+	arrows.Cull(frustum);
+	CheckCompaction(frustum, before, batchesBefore, arrows.Instances(), arrows.Batches(),
+		[](const VelocityArrowInstance& instance, float sphere[4])
+		{
+			// Around the atom, reaching past the tip of the head
+			float speed = std::sqrt(instance.Velocity[0] * instance.Velocity[0] + instance.Velocity[1] * instance.Velocity[1] +
+									instance.Velocity[2] * instance.Velocity[2]);
+			std::memcpy(sphere, instance.Position, sizeof(float) * 3);
+			sphere[3] = instance.Radius + speed / 100.0f + VelocityArrowPacker::HeadLength;
+		});
+}
@@ -0,0 +1,102 @@
+#include "GoldenTrajectory.h"
+#include "HardSphereDynamics.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// Headless golden trajectory check. Runs a fixed-seed box of hard spheres in every UpdateMode,
+// records the state hashes (see GoldenTrajectory) and compares them against the reference files
+// checked in under tests/golden. Any change to the physics that alters the results - even in the
+// last bit of a single velocity - shows up as the first checkpoint where the runs diverge.
+//
+// Usage: golden_trajectory <golden directory> [--update]
+//	--update	rewrite the reference files from this run instead of comparing (only do this when a
+//				change in the results is intended)
+
+namespace
+{
+	const unsigned int	AtomCount = 64;
+	const unsigned int	Seed = 20240613;
+	const float			MaxSpeed = 1.0f;
+	const float			BoxSize = 4.0f;
+	const double		TimeStep = 1.0 / 60.0;
+	const unsigned int	Steps = 600;
+	const unsigned int	Interval = 10;
+
+	struct Run
+	{
+		const char*	Name;
+		UpdateMode	Mode;
+	};
+
+	const Run Runs[] = {
+		{ "discrete",		UpdateMode::DISCRETE },
+		{ "continuous",		UpdateMode::CONTINUOUS },
+		{ "event_driven",	UpdateMode::EVENT_DRIVEN }
+	};
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		std::cerr << "Usage: golden_trajectory <golden directory> [--update]" << std::endl;
+		return 2;
+	}
+
+	std::string directory = argv[1];
+	bool update = argc > 2 && std::strcmp(argv[2], "--update") == 0;
+
+	int failures = 0;
+
+	for (const Run& run : Runs)
+	{
+		HardSphereDynamics dynamics;
+		dynamics.SetUpdateMode(run.Mode);
+		dynamics.State().BoxDimensions = Float3{ BoxSize, BoxSize, BoxSize };
+		dynamics.State().AddRandom(AtomCount, Seed, MaxSpeed);
+
+		GoldenTrajectory trajectory = GoldenTrajectory::Record(dynamics, TimeStep, Steps, Interval);
+
+		std::string path = directory + "/" + run.Name + ".golden";
+
+		if (update)
+		{
+			std::ofstream file(path);
+			trajectory.Save(file);
+			if (!file)
+			{
+				std::cerr << run.Name << ": could not write " << path << std::endl;
+				++failures;
+				continue;
+			}
+
+			std::cout << run.Name << ": wrote " << trajectory.Checkpoints.size() << " checkpoints to " << path << std::endl;
+			continue;
+		}
+
+		GoldenTrajectory golden;
+		std::ifstream file(path);
+		if (!golden.Load(file))
+		{
+			std::cerr << run.Name << ": could not read " << path << " (run with --update to create it)" << std::endl;
+			++failures;
+			continue;
+		}
+
+		int mismatch = golden.FirstMismatch(trajectory);
+		if (mismatch != -1)
+		{
+			std::cerr << run.Name << ": diverged from " << path << " at checkpoint " << mismatch
+					  << " (step " << mismatch * Interval << ")" << std::endl;
+			++failures;
+			continue;
+		}
+
+		std::cout << run.Name << ": " << trajectory.Checkpoints.size() << " checkpoints match" << std::endl;
+	}
+
+	return failures == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,267 @@
+#include "TestHarness.h"
+
+#include "EventDrivenEngine.h"
+#include "HardSphereDynamics.h"
+
+namespace
+{
+	HardSphereDynamics MakeBox(UpdateMode mode, unsigned int count, unsigned int seed)
+	{
+		HardSphereDynamics dynamics;
+		dynamics.SetUpdateMode(mode);
+		dynamics.State().BoxDimensions = Float3{ 4.0f, 4.0f, 4.0f };
+		dynamics.State().AddRandom(count, seed, 1.0f);
+		return dynamics;
+	}
+
+	bool InsideBox(const HardSphereState& state, float tolerance)
+	{
+		for (size_t iii = 0; iii < state.Count(); ++iii)
+		{
+			const Float3& p = state.Positions[iii];
+			float r = state.Radii[iii] - tolerance;
+			if (std::abs(p.x) + r > state.BoxDimensions.x / 2.0f ||
+				std::abs(p.y) + r > state.BoxDimensions.y / 2.0f ||
+				std::abs(p.z) + r > state.BoxDimensions.z / 2.0f)
+				return false;
+		}
+
+		return true;
+	}
+}
+
+TEST_CASE(AddRandomIsSortedAndDeterministic)
+{
+	HardSphereDynamics a = MakeBox(UpdateMode::CONTINUOUS, 64, 7);
+	HardSphereDynamics b = MakeBox(UpdateMode::CONTINUOUS, 64, 7);
+	HardSphereDynamics c = MakeBox(UpdateMode::CONTINUOUS, 64, 8);
+
+	CHECK(a.State().Count() > 0);
+	CHECK_EQUAL(a.StateHash(), b.StateHash());
+	CHECK(a.StateHash() != c.StateHash());
+
+	for (size_t iii = 1; iii < a.State().Count(); ++iii)
+		CHECK(a.State().Elements[iii - 1] <= a.State().Elements[iii]);
+}
+
+TEST_CASE(ContinuousConservesEnergyAndStaysInBox)
+{
+	HardSphereDynamics dynamics = MakeBox(UpdateMode::CONTINUOUS, 64, 11);
+
+	dynamics.Step(1.0 / 60.0);
+	double initialEnergy = dynamics.Observables().KineticEnergy;
+
+	for (int step = 0; step < 300; ++step)
+		dynamics.Step(1.0 / 60.0);
+
+	CHECK_CLOSE(dynamics.Observables().KineticEnergy, initialEnergy, 1e-3 * initialEnergy);
+	CHECK(InsideBox(dynamics.State(), 1e-4f));
+}
+
+TEST_CASE(EventDrivenConservesEnergyAndStaysInBox)
+{
+	HardSphereDynamics dynamics = MakeBox(UpdateMode::EVENT_DRIVEN, 64, 13);
+
+	dynamics.Step(1.0 / 60.0);
+	double initialEnergy = dynamics.Observables().KineticEnergy;
+
+	for (int step = 0; step < 300; ++step)
+		dynamics.Step(1.0 / 60.0);
+
+	CHECK_CLOSE(dynamics.Observables().KineticEnergy, initialEnergy, 1e-3 * initialEnergy);
+	CHECK(InsideBox(dynamics.State(), 1e-4f));
+	CHECK_CLOSE(dynamics.Time(), 301.0 / 60.0, 1e-9);
+	CHECK_EQUAL(dynamics.Observables().AtomCount, static_cast<unsigned int>(dynamics.State().Count()));
+}
+
+TEST_CASE(EventQueueStaysBounded)
+{
+	HardSphereState state;
+	state.BoxDimensions = Float3{ 4.0f, 4.0f, 4.0f };
+	state.AddRandom(64, 17, 1.0f);
+
+	EventDrivenEngine engine;
+	engine.Initialize(state);
+
+	size_t largest = 0;
+	for (int step = 0; step < 2000; ++step)
+	{
+		engine.Advance(1.0 / 60.0);
+		largest = std::max(largest, engine.QueuedEventCount());
+	}
+
+	// Without pruning the stale predictions the queue grows with every event processed
+	CHECK(engine.CollisionCount() > 0);
+	CHECK(largest * 4 < static_cast<size_t>(engine.EventCount()));
+}
+
+TEST_CASE(InvalidatePicksUpEdits)
+{
+	HardSphereDynamics dynamics = MakeBox(UpdateMode::EVENT_DRIVEN, 16, 19);
+	dynamics.Step(1.0 / 60.0);
+
+	// Stop every sphere - once the engine is rebuilt from the edited state nothing moves
+	for (Float3& v : dynamics.State().Velocities)
+		v = Float3{ 0.0f, 0.0f, 0.0f };
+	dynamics.Invalidate();
+
+	uint64_t before = dynamics.StateHash();
+	dynamics.Step(1.0 / 60.0);
+
+	CHECK_EQUAL(dynamics.StateHash(), before);
+	CHECK_EQUAL(dynamics.Observables().KineticEnergy, 0.0);
+}
+namespace
+{
+	// Two spheres closing head on along x. At 'speed' each one moves further than the gap between them
+	// (and the other sphere) in a single large step, so a step that only checks the end positions lets
+	// them pass through each other
+	HardSphereDynamics MakeHeadOnPair(UpdateMode mode, float speed)
+	{
+		HardSphereDynamics dynamics;
+		dynamics.SetUpdateMode(mode);
+		dynamics.State().BoxDimensions = Float3{ 100.0f, 100.0f, 100.0f };
+		dynamics.State().Insert(1, Float3{ -1.0f, 0.0f, 0.0f }, Float3{ speed, 0.0f, 0.0f }, 0.1f, 1.0f);
+		dynamics.State().Insert(2, Float3{ 1.0f, 0.0f, 0.0f }, Float3{ -speed, 0.0f, 0.0f }, 0.1f, 1.0f);
+		return dynamics;
+	}
+
+	bool NoPairOverlaps(const HardSphereState& state, float tolerance)
+	{
+		for (size_t iii = 0; iii < state.Count(); ++iii)
+		{
+			for (size_t jjj = iii + 1; jjj < state.Count(); ++jjj)
+			{
+				float dx = state.Positions[iii].x - state.Positions[jjj].x;
+				float dy = state.Positions[iii].y - state.Positions[jjj].y;
+				float dz = state.Positions[iii].z - state.Positions[jjj].z;
+				float minDistance = state.Radii[iii] + state.Radii[jjj] - tolerance;
+				if (dx * dx + dy * dy + dz * dz < minDistance * minDistance)
+					return false;
+			}
+		}
+
+		return true;
+	}
+
+	const double LargeTimeSteps[2] = { 10.0 / 60.0, 100.0 / 60.0 };
+	const UpdateMode SweptModes[2] = { UpdateMode::CONTINUOUS, UpdateMode::EVENT_DRIVEN };
+}
+
+TEST_CASE(HeadOnPairBouncesAtLargeTimeSteps)
+{
+	for (UpdateMode mode : SweptModes)
+	{
+		for (double timeDelta : LargeTimeSteps)
+		{
+			// Each sphere covers 2 units in the smaller step - the spheres are 1.8 apart and 0.2 wide
+			HardSphereDynamics dynamics = MakeHeadOnPair(mode, 12.0f);
+			dynamics.Step(timeDelta);
+
+			// Equal masses swap velocities, so the spheres are moving apart on the side they started on
+			const HardSphereState& state = dynamics.State();
+			CHECK(state.Positions[0].x < state.Positions[1].x);
+			CHECK_CLOSE(state.Velocities[0].x, -12.0f, 1e-4f);
+			CHECK_CLOSE(state.Velocities[1].x, 12.0f, 1e-4f);
+
+			// They met at x = 0 after (0.9 / 12) and have moved apart since
+			float expected = 0.1f + 12.0f * static_cast<float>(timeDelta - 0.9 / 12.0);
+			CHECK_CLOSE(state.Positions[0].x, -expected, 1e-3f);
+			CHECK_CLOSE(state.Positions[1].x, expected, 1e-3f);
+			CHECK(NoPairOverlaps(state, 1e-4f));
+		}
+	}
+}
+
+TEST_CASE(ThinWallIsNotTunnelledThrough)
+{
+	for (UpdateMode mode : SweptModes)
+	{
+		for (double timeDelta : LargeTimeSteps)
+		{
+			// A box barely wider than the sphere, crossed many times over in one step
+			HardSphereDynamics dynamics;
+			dynamics.SetUpdateMode(mode);
+			dynamics.State().BoxDimensions = Float3{ 0.5f, 0.5f, 0.5f };
+			dynamics.State().Insert(1, Float3{ 0.0f, 0.0f, 0.0f }, Float3{ 30.0f, -20.0f, 10.0f }, 0.2f, 1.0f);
+
+			for (int step = 0; step < 10; ++step)
+			{
+				dynamics.Step(timeDelta);
+				CHECK(InsideBox(dynamics.State(), 1e-4f));
+			}
+
+			// Wall bounces only flip the sign of a component
+			const Float3& v = dynamics.State().Velocities[0];
+			CHECK_CLOSE(std::abs(v.x), 30.0f, 1e-4f);
+			CHECK_CLOSE(std::abs(v.y), 20.0f, 1e-4f);
+			CHECK_CLOSE(std::abs(v.z), 10.0f, 1e-4f);
+		}
+	}
+}
+
+TEST_CASE(FastSpheresNeverOverlapAtLargeTimeSteps)
+{
+	for (UpdateMode mode : SweptModes)
+	{
+		for (double timeDelta : LargeTimeSteps)
+		{
+			// Up to 20 units per step in a 4 unit box - every sphere hits the walls and its neighbours many times
+			HardSphereDynamics dynamics = MakeBox(mode, 32, 23);
+			for (Float3& v : dynamics.State().Velocities)
+				v = Float3{ v.x * 12.0f, v.y * 12.0f, v.z * 12.0f };
+			dynamics.Invalidate();
+
+			dynamics.Step(timeDelta);
+			double initialEnergy = dynamics.Observables().KineticEnergy;
+
+			for (int step = 0; step < 10; ++step)
+			{
+				dynamics.Step(timeDelta);
+				CHECK(NoPairOverlaps(dynamics.State(), 1e-3f));
+				CHECK(InsideBox(dynamics.State(), 1e-3f));
+			}
+
+			CHECK_CLOSE(dynamics.Observables().KineticEnergy, initialEnergy, 1e-3 * initialEnergy);
+		}
+	}
+}
+
+TEST_CASE(ContinuousMatchesEventDrivenAtALargeTimeStep)
+{
+	// Both modes resolve every impact of the step at its time of impact, so from the same seed they follow
+	// the same trajectory (up to rounding) through a step that spans several collisions. Hard spheres are
+	// chaotic - rounding differences grow with every collision - so the step is kept to a dozen or so
+	const double timeDelta = 100.0 / 60.0;
+
+	HardSphereState state;
+	state.BoxDimensions = Float3{ 4.0f, 4.0f, 4.0f };
+	state.AddRandom(32, 29, 1.0f);
+	for (Float3& v : state.Velocities)
+		v = Float3{ v.x * 6.0f, v.y * 6.0f, v.z * 6.0f };
+
+	EventDrivenEngine engine;
+	engine.Initialize(state);
+	engine.Advance(timeDelta);
+	CHECK(engine.CollisionCount() >= 10);
+
+	HardSphereDynamics continuous, eventDriven;
+	continuous.SetUpdateMode(UpdateMode::CONTINUOUS);
+	eventDriven.SetUpdateMode(UpdateMode::EVENT_DRIVEN);
+	continuous.State() = state;
+	eventDriven.State() = state;
+	continuous.Step(timeDelta);
+	eventDriven.Step(timeDelta);
+
+	const float tolerance = 2e-3f;
+	for (size_t iii = 0; iii < state.Count(); ++iii)
+	{
+		CHECK_CLOSE(continuous.State().Positions[iii].x, eventDriven.State().Positions[iii].x, tolerance);
+		CHECK_CLOSE(continuous.State().Positions[iii].y, eventDriven.State().Positions[iii].y, tolerance);
+		CHECK_CLOSE(continuous.State().Positions[iii].z, eventDriven.State().Positions[iii].z, tolerance);
+		CHECK_CLOSE(continuous.State().Velocities[iii].x, eventDriven.State().Velocities[iii].x, tolerance);
+		CHECK_CLOSE(continuous.State().Velocities[iii].y, eventDriven.State().Velocities[iii].y, tolerance);
+		CHECK_CLOSE(continuous.State().Velocities[iii].z, eventDriven.State().Velocities[iii].z, tolerance);
+	}
+	CHECK_CLOSE(continuous.Observables().KineticEnergy, eventDriven.Observables().KineticEnergy, 1e-4 * eventDriven.Observables().KineticEnergy);
+}
@@ -0,0 +1,420 @@
+#include "TestHarness.h"
+
+#include "IntersectionKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// The packet kernels are checked against the single primitive versions (bit for bit) and against
+// straightforward double precision references on randomized inputs
+
+namespace
+{
+	std::mt19937 rng(12345);
+
+	float Uniform(float min, float max)
+	{
+		return min + (max - min) * static_cast<float>(rng() >> 8) * (1.0f / 16777216.0f);
+	}
+
+	void RandomDirection(float direction[3])
+	{
+		float length;
+		do
+		{
+			direction[0] = Uniform(-1.0f, 1.0f);
+			direction[1] = Uniform(-1.0f, 1.0f);
+			direction[2] = Uniform(-1.0f, 1.0f);
+			length = std::sqrt(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+		} while (length < 0.1f || length > 1.0f);
+
+		for (int axis = 0; axis < 3; ++axis)
+			direction[axis] /= length;
+	}
+
+	bool SameBits(float a, float b)
+	{
+		return std::memcmp(&a, &b, sizeof(float)) == 0;
+	}
+
+	// Reference: first t >= 0 on the ray inside the sphere, found in double. Returns -1 for a miss.
+	// 'margin' is set to how far the ray is from grazing the sphere, so near-tangent rays can be skipped
+	double ReferenceRaySphere(const float o[3], const float d[3], double cx, double cy, double cz, double r, double& margin)
+	{
+		double ocx = o[0] - cx, ocy = o[1] - cy, ocz = o[2] - cz;
+		double b = ocx * d[0] + ocy * d[1] + ocz * d[2];
+		double c = ocx * ocx + ocy * ocy + ocz * ocz - r * r;
+		double discriminant = b * b - c;
+
+		margin = std::abs(discriminant);
+		if (discriminant < 0.0)
+			return -1.0;
+
+		double tNear = -b - std::sqrt(discriminant);
+		double tFar = -b + std::sqrt(discriminant);
+		margin = std::min(margin, std::abs(tFar));
+		if (tNear >= 0.0)
+			return tNear;
+		return tFar >= 0.0 ? tFar : -1.0;
+	}
+
+	double SegmentDistance(const double p[3], const double a[3], const double b[3])
+	{
+		double ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+		double ap[3] = { p[0] - a[0], p[1] - a[1], p[2] - a[2] };
+		double lengthSquared = ab[0] * ab[0] + ab[1] * ab[1] + ab[2] * ab[2];
+		double s = lengthSquared > 0.0 ? (ap[0] * ab[0] + ap[1] * ab[1] + ap[2] * ab[2]) / lengthSquared : 0.0;
+		s = std::clamp(s, 0.0, 1.0);
+
+		double dx = ap[0] - s * ab[0], dy = ap[1] - s * ab[1], dz = ap[2] - s * ab[2];
+		return std::sqrt(dx * dx + dy * dy + dz * dz);
+	}
+
+	// Brute force reference: march along the ray to the first sample inside the capsule, then bisect.
+	// Returns -1 for a miss. 'margin' is the closest the sampled ray gets to the capsule surface
+	double ReferenceRayCapsule(const float o[3], const float d[3], const float a[3], const float b[3], float radius, double& margin)
+	{
+		const double a64[3] = { a[0], a[1], a[2] };
+		const double b64[3] = { b[0], b[1], b[2] };
+		auto distanceAt = [&](double t)
+		{
+			double p[3] = { o[0] + t * d[0], o[1] + t * d[1], o[2] + t * d[2] };
+			return SegmentDistance(p, a64, b64) - radius;
+		};
+
+		const double length = 30.0;
+		const int samples = 30000;
+
+		margin = std::abs(distanceAt(0.0));
+		double previous = 0.0;
+		for (int iii = 0; iii <= samples; ++iii)
+		{
+			double t = length * iii / samples;
+			double distance = distanceAt(t);
+			margin = std::min(margin, std::abs(distance));
+
+			if (distance <= 0.0)
+			{
+				// Origin already inside - the kernel reports exits, which isn't what is being checked here
+				if (iii == 0)
+				{
+					margin = 0.0;
+					return 0.0;
+				}
+
+				double low = previous, high = t;
+				for (int step = 0; step < 60; ++step)
+				{
+					double middle = 0.5 * (low + high);
+					(distanceAt(middle) <= 0.0 ? high : low) = middle;
+				}
+				return high;
+			}
+			previous = t;
+		}
+		return -1.0;
+	}
+}
+
+TEST_CASE(RaySpheresMatchScalarAndReference)
+{
+	const size_t count = 203;	// Not a multiple of the packet size so the remainder loop runs too
+	std::vector<float> x(count), y(count), z(count), radius(count), distances(count);
+
+	int compared = 0;
+	for (int trial = 0; trial < 200; ++trial)
+	{
+		for (size_t iii = 0; iii < count; ++iii)
+		{
+			x[iii] = Uniform(-5.0f, 5.0f);
+			y[iii] = Uniform(-5.0f, 5.0f);
+			z[iii] = Uniform(-5.0f, 5.0f);
+			radius[iii] = Uniform(0.05f, 1.5f);
+		}
+
+		float origin[3] = { Uniform(-6.0f, 6.0f), Uniform(-6.0f, 6.0f), Uniform(-6.0f, 6.0f) };
+		float direction[3];
+		RandomDirection(direction);
+
+		IntersectionKernels::RaySpheres(origin, direction, { x.data(), y.data(), z.data(), radius.data() }, count, distances.data());
+
+		for (size_t iii = 0; iii < count; ++iii)
+		{
+			CHECK(SameBits(distances[iii], IntersectionKernels::RaySphere(origin, direction, x[iii], y[iii], z[iii], radius[iii])));
+
+			double margin;
+			double expected = ReferenceRaySphere(origin, direction, x[iii], y[iii], z[iii], radius[iii], margin);
+			if (margin < 1e-3)
+				continue;
+
+			++compared;
+			if (expected < 0.0)
+				CHECK(distances[iii] < 0.0f);
+			else
+				CHECK_CLOSE(distances[iii], expected, 1e-3);
+		}
+	}
+
+	CHECK(compared > 30000);
+}
+
+TEST_CASE(RaySphereFromInsideReturnsExit)
+{
+	const float origin[3] = { 0.25f, -0.1f, 0.3f };
+	for (int trial = 0; trial < 1000; ++trial)
+	{
+		float direction[3];
+		RandomDirection(direction);
+
+		double margin;
+		double expected = ReferenceRaySphere(origin, direction, 0.0, 0.0, 0.0, 1.0, margin);
+		float distance = IntersectionKernels::RaySphere(origin, direction, 0.0f, 0.0f, 0.0f, 1.0f);
+
+		CHECK(distance > 0.0f);
+		CHECK_CLOSE(distance, expected, 1e-5);
+	}
+
+	// Sphere entirely behind the origin
+	const float behind[3] = { 0.0f, 0.0f, 5.0f };
+	const float forward[3] = { 0.0f, 0.0f, 1.0f };
+	CHECK(IntersectionKernels::RaySphere(behind, forward, 0.0f, 0.0f, 0.0f, 1.0f) < 0.0f);
+}
+
+TEST_CASE(RayCapsulesMatchScalarAndReference)
+{
+	const size_t count = 37;
+	std::vector<float> x1(count), y1(count), z1(count), x2(count), y2(count), z2(count), radius(count), distances(count);
+
+	int compared = 0;
+	for (int trial = 0; trial < 100; ++trial)
+	{
+		for (size_t iii = 0; iii < count; ++iii)
+		{
+			x1[iii] = Uniform(-4.0f, 4.0f);
+			y1[iii] = Uniform(-4.0f, 4.0f);
+			z1[iii] = Uniform(-4.0f, 4.0f);
+
+			// Every few capsules have zero length (both ends at the same point)
+			bool zeroLength = iii % 5 == 0;
+			x2[iii] = zeroLength ? x1[iii] : x1[iii] + Uniform(-2.0f, 2.0f);
+			y2[iii] = zeroLength ? y1[iii] : y1[iii] + Uniform(-2.0f, 2.0f);
+			z2[iii] = zeroLength ? z1[iii] : z1[iii] + Uniform(-2.0f, 2.0f);
+			radius[iii] = Uniform(0.05f, 0.8f);
+		}
+
+		float origin[3] = { Uniform(-6.0f, 6.0f), Uniform(-6.0f, 6.0f), Uniform(-6.0f, 6.0f) };
+		float direction[3];
+		RandomDirection(direction);
+
+		const CapsuleArrays capsules = { x1.data(), y1.data(), z1.data(), x2.data(), y2.data(), z2.data(), radius.data() };
+		IntersectionKernels::RayCapsules(origin, direction, capsules, count, distances.data());
+
+		for (size_t iii = 0; iii < count; ++iii)
+		{
+			CHECK(SameBits(distances[iii], IntersectionKernels::RayCapsule(origin, direction,
+				x1[iii], y1[iii], z1[iii], x2[iii], y2[iii], z2[iii], radius[iii])));
+
+			const float a[3] = { x1[iii], y1[iii], z1[iii] };
+			const float b[3] = { x2[iii], y2[iii], z2[iii] };
+			double margin;
+			double expected = ReferenceRayCapsule(origin, direction, a, b, radius[iii], margin);
+			if (margin < 2e-3)
+				continue;
+
+			++compared;
+			if (expected < 0.0)
+				CHECK(distances[iii] < 0.0f);
+			else
+				CHECK_CLOSE(distances[iii], expected, 2e-3);
+		}
+	}
+
+	CHECK(compared > 2000);
+}
+
+TEST_CASE(ZeroLengthCapsuleIsSphere)
+{
+	for (int trial = 0; trial < 2000; ++trial)
+	{
+		float origin[3] = { Uniform(-3.0f, 3.0f), Uniform(-3.0f, 3.0f), Uniform(-3.0f, 3.0f) };
+		float direction[3];
+		RandomDirection(direction);
+
+		float cx = Uniform(-1.0f, 1.0f), cy = Uniform(-1.0f, 1.0f), cz = Uniform(-1.0f, 1.0f), r = Uniform(0.1f, 1.0f);
+
+		float capsule = IntersectionKernels::RayCapsule(origin, direction, cx, cy, cz, cx, cy, cz, r);
+		float sphere = IntersectionKernels::RaySphere(origin, direction, cx, cy, cz, r);
+
+		// Misses only have to agree on the sign (a sphere behind the origin gives its negative exit distance)
+		if (sphere >= 0.0f)
+			CHECK(SameBits(capsule, sphere));
+		else
+			CHECK(capsule < 0.0f);
+	}
+}
+
+TEST_CASE(ClosestIgnoresMisses)
+{
+	const float distances[] = { -1.0f, 3.0f, -1.0f, 0.5f, 2.0f };
+	CHECK_EQUAL(IntersectionKernels::Closest(distances, 5), static_cast<size_t>(3));
+	CHECK_EQUAL(IntersectionKernels::Closest(distances, 1), static_cast<size_t>(1));
+
+	const float misses[] = { -1.0f, -1.0f };
+	CHECK_EQUAL(IntersectionKernels::Closest(misses, 2), static_cast<size_t>(2));
+}
+
+TEST_CASE(ProjectPointsMatchesReference)
+{
+	// Row vector convention: clip = (x, y, z, 1) * M
+	float m[4][4];
+	for (int row = 0; row < 4; ++row)
+		for (int column = 0; column < 4; ++column)
+			m[row][column] = Uniform(-1.0f, 1.0f);
+	m[2][3] = 1.0f;		// w is mostly z, so some points end up behind the eye
+	m[3][3] = 0.5f;
+
+	const size_t count = 1000;
+	std::vector<float> x(count), y(count), z(count), ndcX(count), ndcY(count);
+	for (size_t iii = 0; iii < count; ++iii)
+	{
+		x[iii] = Uniform(-5.0f, 5.0f);
+		y[iii] = Uniform(-5.0f, 5.0f);
+		z[iii] = Uniform(-5.0f, 5.0f);
+	}
+
+	IntersectionKernels::ProjectPoints(m, x.data(), y.data(), z.data(), count, ndcX.data(), ndcY.data());
+
+	int behind = 0;
+	for (size_t iii = 0; iii < count; ++iii)
+	{
+		double clipX = x[iii] * static_cast<double>(m[0][0]) + y[iii] * static_cast<double>(m[1][0]) + z[iii] * static_cast<double>(m[2][0]) + m[3][0];
+		double clipY = x[iii] * static_cast<double>(m[0][1]) + y[iii] * static_cast<double>(m[1][1]) + z[iii] * static_cast<double>(m[2][1]) + m[3][1];
+		double clipW = x[iii] * static_cast<double>(m[0][3]) + y[iii] * static_cast<double>(m[1][3]) + z[iii] * static_cast<double>(m[2][3]) + m[3][3];
+
+		// Too close to the eye plane to compare
+		if (std::abs(clipW) < 1e-2)
+			continue;
+
+		if (clipW <= 0.0)
+		{
+			++behind;
+			CHECK(ndcX[iii] >= 1.0e29f && ndcY[iii] >= 1.0e29f);
+			continue;
+		}
+
+		CHECK_CLOSE(ndcX[iii], clipX / clipW, 1e-3 * std::max(1.0, std::abs(clipX / clipW)));
+		CHECK_CLOSE(ndcY[iii], clipY / clipW, 1e-3 * std::max(1.0, std::abs(clipY / clipW)));
+	}
+
+	CHECK(behind > 0);
+}
+
+namespace
+{
+	// Reference even-odd test in double. 'margin' is the distance from the point to the nearest edge
+	bool ReferenceInside(const std::vector<float>& polygon, double px, double py, double& margin)
+	{
+		size_t vertexCount = polygon.size() / 2;
+		bool inside = false;
+		margin = 1e30;
+
+		for (size_t edge = 0; edge < vertexCount; ++edge)
+		{
+			size_t next = (edge + 1) % vertexCount;
+			double x1 = polygon[2 * edge], y1 = polygon[2 * edge + 1];
+			double x2 = polygon[2 * next], y2 = polygon[2 * next + 1];
+
+			double dx = x2 - x1, dy = y2 - y1;
+			double lengthSquared = dx * dx + dy * dy;
+			double s = lengthSquared > 0.0 ? std::clamp(((px - x1) * dx + (py - y1) * dy) / lengthSquared, 0.0, 1.0) : 0.0;
+			margin = std::min(margin, std::hypot(px - (x1 + s * dx), py - (y1 + s * dy)));
+
+			// Also skip points level with a vertex, where the crossing count depends on the tie-break
+			margin = std::min(margin, std::abs(py - y1));
+
+			if ((y1 > py) != (y2 > py) && px < x1 + (py - y1) * dx / dy)
+				inside = !inside;
+		}
+
+		return inside;
+	}
+
+	std::vector<uint8_t> Classify(const std::vector<float>& polygon, const std::vector<float>& x, const std::vector<float>& y)
+	{
+		std::vector<uint8_t> inside(x.size(), 2);
+		IntersectionKernels::PointsInPolygon(polygon.data(), polygon.size() / 2, x.data(), y.data(), x.size(), inside.data());
+		return inside;
+	}
+}
+
+TEST_CASE(PointsInPolygonMatchesReference)
+{
+	const size_t count = 2000;
+	std::vector<float> x(count), y(count);
+
+	int compared = 0;
+	for (int trial = 0; trial < 50; ++trial)
+	{
+		// Random lasso - usually self intersecting, which exercises the even-odd rule
+		size_t vertexCount = 3 + rng() % 20;
+		std::vector<float> polygon(2 * vertexCount);
+		for (float& coordinate : polygon)
+			coordinate = Uniform(-1.0f, 1.0f);
+
+		for (size_t iii = 0; iii < count; ++iii)
+		{
+			x[iii] = Uniform(-1.2f, 1.2f);
+			y[iii] = Uniform(-1.2f, 1.2f);
+		}
+
+		std::vector<uint8_t> inside = Classify(polygon, x, y);
+		for (size_t iii = 0; iii < count; ++iii)
+		{
+			double margin;
+			bool expected = ReferenceInside(polygon, x[iii], y[iii], margin);
+			if (margin < 1e-4)
+				continue;
+
+			++compared;
+			CHECK_EQUAL(static_cast<int>(inside[iii]), expected ? 1 : 0);
+		}
+	}
+
+	CHECK(compared > 90000);
+}
+
+TEST_CASE(PointsInDegeneratePolygons)
+{
+	std::vector<float> x = { 0.0f, 0.5f, -0.5f, 2.0f };
+	std::vector<float> y = { 0.0f, 0.5f, 0.25f, 2.0f };
+
+	// No vertices, one vertex, and a single segment (there and back) contain nothing
+	for (const std::vector<float>& polygon : { std::vector<float>{}, std::vector<float>{ 0.0f, 0.0f }, std::vector<float>{ -1.0f, -1.0f, 1.0f, 1.0f } })
+	{
+		for (uint8_t inside : Classify(polygon, x, y))
+			CHECK_EQUAL(static_cast<int>(inside), 0);
+	}
+
+	// Collinear vertices enclose no area
+	for (uint8_t inside : Classify({ -1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f }, x, y))
+		CHECK_EQUAL(static_cast<int>(inside), 0);
+
+	// Repeated vertices and horizontal edges don't change the result
+	std::vector<uint8_t> square = Classify({ -1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f }, x, y);
+	CHECK_EQUAL(static_cast<int>(square[0]), 1);
+	CHECK_EQUAL(static_cast<int>(square[1]), 1);
+	CHECK_EQUAL(static_cast<int>(square[2]), 1);
+	CHECK_EQUAL(static_cast<int>(square[3]), 0);
+
+	// Bow tie: the two lobes are inside, the crossing point region between them isn't double counted
+	std::vector<float> bx = { -0.5f, 0.5f, 0.0f, 0.0f };
+	std::vector<float> by = { 0.0f, 0.0f, 0.5f, -0.5f };
+	std::vector<uint8_t> bowTie = Classify({ -1.0f, -1.0f, 1.0f, 1.0f, 1.0f, -1.0f, -1.0f, 1.0f }, bx, by);
+	CHECK_EQUAL(static_cast<int>(bowTie[0]), 1);
+	CHECK_EQUAL(static_cast<int>(bowTie[1]), 1);
+	CHECK_EQUAL(static_cast<int>(bowTie[2]), 0);
+	CHECK_EQUAL(static_cast<int>(bowTie[3]), 0);
+}
@@ -0,0 +1,233 @@
+#include "TestHarness.h"
+
+#include "MeshGeometry.h"
+
+#include <array>
+#include <cmath>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace
+{
+	// Vertices are duplicated along the seams (and at the poles of the sphere), so edges are compared by
+	// position rather than by index
+	using Point = std::array<long, 3>;
+
+	Point Key(const MeshVertex& vertex)
+	{
+		return { std::lround(vertex.Position[0] * 1e4f), std::lround(vertex.Position[1] * 1e4f), std::lround(vertex.Position[2] * 1e4f) };
+	}
+
+	// How many triangles use each edge
+	std::map<std::pair<Point, Point>, int> EdgeUses(const MeshData& mesh)
+	{
+		std::map<std::pair<Point, Point>, int> uses;
+		for (size_t iii = 0; iii < mesh.Indices.size(); iii += 3)
+		{
+			for (int corner = 0; corner < 3; ++corner)
+			{
+				Point a = Key(mesh.Vertices[mesh.Indices[iii + corner]]);
+				Point b = Key(mesh.Vertices[mesh.Indices[iii + (corner + 1) % 3]]);
+				++uses[a < b ? std::make_pair(a, b) : std::make_pair(b, a)];
+			}
+		}
+		return uses;
+	}
+
+	float Length(const float v[3])
+	{
+		return std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+	}
+
+	// Every index is in range, no triangle is degenerate and every normal has unit length
+	void CheckWellFormed(const MeshData& mesh)
+	{
+		CHECK_EQUAL(mesh.Indices.size() % 3, static_cast<size_t>(0));
+
+		size_t outOfRange = 0, degenerate = 0, badNormals = 0;
+		for (uint16_t index : mesh.Indices)
+			outOfRange += index < mesh.Vertices.size() ? 0 : 1;
+
+		for (size_t iii = 0; iii + 2 < mesh.Indices.size() && outOfRange == 0; iii += 3)
+		{
+			const float* a = mesh.Vertices[mesh.Indices[iii]].Position;
+			const float* b = mesh.Vertices[mesh.Indices[iii + 1]].Position;
+			const float* c = mesh.Vertices[mesh.Indices[iii + 2]].Position;
+			const float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+			const float ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+			const float cross[3] = { ab[1] * ac[2] - ab[2] * ac[1], ab[2] * ac[0] - ab[0] * ac[2], ab[0] * ac[1] - ab[1] * ac[0] };
+			degenerate += Length(cross) > 1e-6f ? 0 : 1;
+		}
+
+		for (const MeshVertex& vertex : mesh.Vertices)
+			badNormals += std::abs(Length(vertex.Normal) - 1.0f) < 1e-5f ? 0 : 1;
+
+		CHECK_EQUAL(outOfRange, static_cast<size_t>(0));
+		CHECK_EQUAL(degenerate, static_cast<size_t>(0));
+		CHECK_EQUAL(badNormals, static_cast<size_t>(0));
+	}
+
+	struct Batch
+	{
+		uint32_t	MaterialIndex;
+		uint32_t	FirstInstance;
+		uint32_t	InstanceCount;
+		uint32_t	Level;
+	};
+}
+
+TEST_CASE(SphereLevels)
+{
+	const size_t triangles[MeshLevelOfDetail::LevelCount] = { 624, 224, 80, 24 };
+	for (unsigned int level = 0; level < MeshLevelOfDetail::LevelCount; ++level)
+	{
+		MeshData mesh = MeshGeometry::Sphere(MeshLevelOfDetail::SphereSegments[level]);
+		CHECK_EQUAL(mesh.TriangleCount(), triangles[level]);
+		CheckWellFormed(mesh);
+
+		// A unit sphere - the normal is the position
+		for (const MeshVertex& vertex : mesh.Vertices)
+		{
+			CHECK_CLOSE(Length(vertex.Position), 1.0f, 1e-5f);
+			for (int axis = 0; axis < 3; ++axis)
+				CHECK_EQUAL(vertex.Normal[axis], vertex.Position[axis]);
+		}
+
+		// Closed - every edge is shared by exactly two triangles
+		for (const auto& edge : EdgeUses(mesh))
+			CHECK_EQUAL(edge.second, 2);
+	}
+}
+
+TEST_CASE(CylinderLevels)
+{
+	const size_t triangles[MeshLevelOfDetail::LevelCount] = { 80, 32, 16, 10 };
+	for (unsigned int level = 0; level < MeshLevelOfDetail::LevelCount; ++level)
+	{
+		unsigned int slices = MeshLevelOfDetail::CylinderSlices[level];
+		MeshData mesh = MeshGeometry::Cylinder(slices);
+		CHECK_EQUAL(mesh.TriangleCount(), triangles[level]);
+		CHECK_EQUAL(mesh.Vertices.size(), static_cast<size_t>(2 * slices));
+		CheckWellFormed(mesh);
+
+		// Bottom ring then top ring, radius 1. Neither ring's normals have a z component
+		for (size_t iii = 0; iii < mesh.Vertices.size(); ++iii)
+		{
+			const MeshVertex& vertex = mesh.Vertices[iii];
+			CHECK_EQUAL(vertex.Position[2], iii < slices ? 0.0f : 1.0f);
+			CHECK_CLOSE(std::hypot(vertex.Position[0], vertex.Position[1]), 1.0f, 1e-5f);
+			CHECK_EQUAL(vertex.Normal[0], vertex.Position[0]);
+			CHECK_EQUAL(vertex.Normal[1], vertex.Position[1]);
+			CHECK_EQUAL(vertex.Normal[2], 0.0f);
+		}
+
+		// An open tube - the side edges are shared by two triangles and the edges of the two end rings by one
+		int ringEdges = 0;
+		for (const auto& edge : EdgeUses(mesh))
+		{
+			bool ring = edge.first.first[2] == edge.first.second[2];
+			CHECK_EQUAL(edge.second, ring ? 1 : 2);
+			ringEdges += ring ? 1 : 0;
+		}
+		CHECK_EQUAL(ringEdges, static_cast<int>(2 * slices));
+	}
+
+	// The index list starts with the first slice - two triangles up to the top ring
+	MeshData mesh = MeshGeometry::Cylinder(5);
+	const uint16_t firstSlice[6] = { 0, 1, 6, 0, 5, 6 };
+	for (int iii = 0; iii < 6; ++iii)
+		CHECK_EQUAL(mesh.Indices[iii], firstSlice[iii]);
+}
+
+TEST_CASE(ConeLevels)
+{
+	const size_t triangles[MeshLevelOfDetail::LevelCount] = { 80, 32, 16, 10 };
+	for (unsigned int level = 0; level < MeshLevelOfDetail::LevelCount; ++level)
+	{
+		unsigned int slices = MeshLevelOfDetail::ConeSlices[level];
+		MeshData mesh = MeshGeometry::Cone(slices);
+		CHECK_EQUAL(mesh.TriangleCount(), triangles[level]);
+		CHECK_EQUAL(mesh.Vertices.size(), static_cast<size_t>(slices + 2));
+		CheckWellFormed(mesh);
+
+		// Base center, base ring, tip
+		CHECK_EQUAL(mesh.Vertices[0].Normal[2], -1.0f);
+		CHECK_EQUAL(mesh.Vertices[slices + 1].Position[2], 0.5f);
+		for (unsigned int iii = 1; iii <= slices; ++iii)
+			CHECK_CLOSE(std::hypot(mesh.Vertices[iii].Position[0], mesh.Vertices[iii].Position[1]), 1.0f, 1e-5f);
+
+		// Closed by the base disk
+		for (const auto& edge : EdgeUses(mesh))
+			CHECK_EQUAL(edge.second, 2);
+	}
+
+	// The index list starts with the first slice - the base triangle, then the side up to the tip
+	MeshData mesh = MeshGeometry::Cone(5);
+	const uint16_t firstSlice[6] = { 0, 1, 2, 6, 1, 2 };
+	for (int iii = 0; iii < 6; ++iii)
+		CHECK_EQUAL(mesh.Indices[iii], firstSlice[iii]);
+}
+
+TEST_CASE(ScreenRadiusAndLevelThresholds)
+{
+	CHECK_CLOSE(MeshLevelOfDetail::ScreenRadius(0.5f, 10.0f, 800.0f), 40.0f, 1e-4f);
+	CHECK_CLOSE(MeshLevelOfDetail::ScreenRadius(0.5f, 20.0f, 800.0f), 20.0f, 1e-4f);
+
+	// From inside the object (or touching it) it covers the screen
+	CHECK_EQUAL(MeshLevelOfDetail::ScreenRadius(2.0f, 1.0f, 800.0f), 800.0f);
+	CHECK_EQUAL(MeshLevelOfDetail::ScreenRadius(2.0f, 2.0f, 800.0f), 800.0f);
+
+	// Each threshold is the smallest radius that still uses its level
+	CHECK_EQUAL(MeshLevelOfDetail::SelectLevel(1000.0f), static_cast<uint8_t>(0));
+	CHECK_EQUAL(MeshLevelOfDetail::SelectLevel(40.0f), static_cast<uint8_t>(0));
+	CHECK_EQUAL(MeshLevelOfDetail::SelectLevel(39.99f), static_cast<uint8_t>(1));
+	CHECK_EQUAL(MeshLevelOfDetail::SelectLevel(12.0f), static_cast<uint8_t>(1));
+	CHECK_EQUAL(MeshLevelOfDetail::SelectLevel(11.99f), static_cast<uint8_t>(2));
+	CHECK_EQUAL(MeshLevelOfDetail::SelectLevel(4.0f), static_cast<uint8_t>(2));
+	CHECK_EQUAL(MeshLevelOfDetail::SelectLevel(3.99f), static_cast<uint8_t>(3));
+	CHECK_EQUAL(MeshLevelOfDetail::SelectLevel(0.0f), static_cast<uint8_t>(3));
+
+	// Smaller on screen never picks a more detailed level
+	uint8_t previous = 0;
+	for (float radius = 100.0f; radius >= 0.0f; radius -= 0.25f)
+	{
+		uint8_t level = MeshLevelOfDetail::SelectLevel(radius);
+		CHECK(level >= previous);
+		previous = level;
+	}
+}
+
+TEST_CASE(SplitBatchesGroupsEachBatchByLevel)
+{
+	// Two materials, the instance value is its original position
+	std::vector<int> instances = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+	std::vector<Batch> batches = { { 7, 0, 6, 0 }, { 3, 6, 4, 0 } };
+	const std::vector<uint8_t> levels = { 2, 0, 2, 3, 0, 2, 1, 1, 1, 1 };
+
+	std::vector<int> scratch;
+	std::vector<Batch> scratchBatches;
+	MeshLevelOfDetail::SplitBatches(instances, batches, levels, scratch, scratchBatches);
+
+	// Each batch is split in level order (skipping the levels it has no instances of) and keeps the order of
+	// its instances within a level. The batches stay in their original order
+	const std::vector<int> expectedInstances = { 1, 4, 0, 2, 5, 3, 6, 7, 8, 9 };
+	CHECK(instances == expectedInstances);
+
+	const Batch expectedBatches[4] = { { 7, 0, 2, 0 }, { 7, 2, 3, 2 }, { 7, 5, 1, 3 }, { 3, 6, 4, 1 } };
+	CHECK_EQUAL(batches.size(), static_cast<size_t>(4));
+	for (size_t iii = 0; iii < batches.size() && iii < 4; ++iii)
+	{
+		CHECK_EQUAL(batches[iii].MaterialIndex, expectedBatches[iii].MaterialIndex);
+		CHECK_EQUAL(batches[iii].FirstInstance, expectedBatches[iii].FirstInstance);
+		CHECK_EQUAL(batches[iii].InstanceCount, expectedBatches[iii].InstanceCount);
+		CHECK_EQUAL(batches[iii].Level, expectedBatches[iii].Level);
+	}
+
+	// Nothing to split
+	std::vector<int> empty;
+	std::vector<Batch> noBatches;
+	MeshLevelOfDetail::SplitBatches(empty, noBatches, std::vector<uint8_t>(), scratch, scratchBatches);
+	CHECK(empty.empty());
+	CHECK(noBatches.empty());
+}
@@ -0,0 +1,176 @@
+#include "TestScene.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Headless golden image check of the scene traversal. Records a fixed scene with SceneRecorder (the
+// recording half of SimulationRenderer), rasterizes it with SoftwareRasterizer and compares the image
+// against the reference checked in under tests/golden. Then times recording and rasterizing the frame.
+//
+// Usage: golden_scene <golden directory> [--update]
+//	--update	rewrite the reference image from this run instead of comparing (only do this when a
+//				change in the image is intended)
+//
+// On a mismatch the rendered image is written to scene_actual.ppm in the working directory so it can be
+// compared with the reference in any image viewer.
+
+namespace
+{
+	const int			TimedFrames = 20;
+	const double		Eye[3] = { 2.6, 2.2, 5.2 };
+	const float			Background[4] = { 0.39f, 0.58f, 0.93f, 1.0f };		// CornflowerBlue, like SimulationRenderer
+
+	// The rasterizer is not bit-exact across compilers and floating point settings, so a pixel only counts as
+	// different when a channel is off by more than ChannelTolerance, and the image only fails when more than
+	// MaxDifferentPixels (per mille) of its pixels are different
+	const int			ChannelTolerance = 8;
+	const int			MaxDifferentPixels = 5;
+
+	// Binary PPM as written by FrameWriter::WritePPM, into RGBA8 pixels (see SoftwareRasterizer::Pixels)
+	bool ReadPPM(const std::string& path, unsigned int& width, unsigned int& height, std::vector<uint32_t>& pixels)
+	{
+		std::ifstream file(path, std::ios::binary);
+		std::string magic;
+		unsigned int maxValue = 0;
+		if (!(file >> magic >> width >> height >> maxValue) || magic != "P6" || maxValue != 255)
+			return false;
+		file.get();
+
+		std::vector<unsigned char> rgb(static_cast<size_t>(width) * height * 3);
+		if (!file.read(reinterpret_cast<char*>(rgb.data()), rgb.size()))
+			return false;
+
+		pixels.resize(static_cast<size_t>(width) * height);
+		for (size_t iii = 0; iii < pixels.size(); ++iii)
+			pixels[iii] = rgb[3 * iii] | (rgb[3 * iii + 1] << 8) | (rgb[3 * iii + 2] << 16) | 0xFF000000u;
+		return true;
+	}
+
+	size_t DifferentPixels(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b)
+	{
+		size_t different = 0;
+		for (size_t iii = 0; iii < a.size(); ++iii)
+		{
+			for (int shift = 0; shift < 24; shift += 8)
+			{
+				int difference = static_cast<int>((a[iii] >> shift) & 0xFF) - static_cast<int>((b[iii] >> shift) & 0xFF);
+				if (std::abs(difference) > ChannelTolerance)
+				{
+					++different;
+					break;
+				}
+			}
+		}
+		return different;
+	}
+
+	double Milliseconds(std::chrono::steady_clock::duration duration)
+	{
+		return std::chrono::duration<double, std::milli>(duration).count();
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		std::cerr << "Usage: golden_scene <golden directory> [--update]" << std::endl;
+		return 2;
+	}
+
+	std::string path = std::string(argv[1]) + "/scene.ppm";
+	bool update = argc > 2 && std::strcmp(argv[2], "--update") == 0;
+
+	TestScene::Scene scene = TestScene::Create();
+	SceneCamera camera = TestScene::Camera(Eye);
+
+	SceneRecorder recorder;
+	TestScene::Record(recorder, scene, camera);
+
+	SoftwareRasterizer rasterizer(TestScene::Width, TestScene::Height);
+	rasterizer.Clear(Background);
+	rasterizer.Submit(recorder.Commands(), TestScene::Software(recorder, scene));
+
+	// Every tile is owned by one worker, so the image must not depend on the number of threads
+	SoftwareRasterizer singleThreaded(TestScene::Width, TestScene::Height, 1);
+	singleThreaded.Clear(Background);
+	singleThreaded.Submit(recorder.Commands(), TestScene::Software(recorder, scene));
+
+	int failures = 0;
+	if (singleThreaded.Pixels() != rasterizer.Pixels())
+	{
+		std::cerr << "scene: the single threaded image differs from the multithreaded one" << std::endl;
+		++failures;
+	}
+
+	if (update)
+	{
+		if (!rasterizer.SavePPM(path))
+		{
+			std::cerr << "scene: could not write " << path << std::endl;
+			return 1;
+		}
+		std::cout << "scene: wrote " << path << std::endl;
+	}
+	else
+	{
+		unsigned int width = 0, height = 0;
+		std::vector<uint32_t> golden;
+		if (!ReadPPM(path, width, height, golden))
+		{
+			std::cerr << "scene: could not read " << path << " (run with --update to create it)" << std::endl;
+			return 1;
+		}
+
+		if (width != rasterizer.Width() || height != rasterizer.Height())
+		{
+			std::cerr << "scene: " << path << " is " << width << "x" << height << ", expected "
+					  << rasterizer.Width() << "x" << rasterizer.Height() << std::endl;
+			++failures;
+		}
+		else
+		{
+			size_t different = DifferentPixels(golden, rasterizer.Pixels());
+			if (different * 1000 > golden.size() * MaxDifferentPixels)
+			{
+				rasterizer.SavePPM("scene_actual.ppm");
+				std::cerr << "scene: " << different << " of " << golden.size() << " pixels differ from " << path
+						  << " (wrote scene_actual.ppm)" << std::endl;
+				++failures;
+			}
+			else
+			{
+				std::cout << "scene: matches " << path << " (" << different << " pixels differ)" << std::endl;
+			}
+		}
+	}
+
+	// Timing - the best of TimedFrames, so a busy machine only makes the numbers noisier, not larger
+	double record = 1e30, rasterize = 1e30;
+	for (int frame = 0; frame < TimedFrames; ++frame)
+	{
+		auto start = std::chrono::steady_clock::now();
+		TestScene::Record(recorder, scene, camera);
+		auto recorded = std::chrono::steady_clock::now();
+		rasterizer.Clear(Background);
+		rasterizer.Submit(recorder.Commands(), TestScene::Software(recorder, scene));
+		auto rasterized = std::chrono::steady_clock::now();
+
+		record = std::min(record, Milliseconds(recorded - start));
+		rasterize = std::min(rasterize, Milliseconds(rasterized - recorded));
+	}
+
+	const RenderStatistics& statistics = rasterizer.FrameStatistics();
+	std::cout << "scene: " << scene.Atoms.size() << " atoms, " << scene.Bonds.size() << " bonds, "
+			  << statistics.Commands << " commands, " << statistics.DrawCalls << " draw calls, "
+			  << rasterizer.PrimitiveCount() << " primitives" << std::endl;
+	std::cout << "scene: record " << record << " ms, rasterize " << rasterize << " ms (best of " << TimedFrames << ")" << std::endl;
+
+	return failures == 0 ? 0 : 1;
+}
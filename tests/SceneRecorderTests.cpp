@@ -0,0 +1,307 @@
+#include "TestHarness.h"
+
+#include "TestScene.h"
+
+#include <cmath>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace
+{
+	const double Eye[3] = { 0.0, 0.0, 10.0 };
+
+	// A carbon and an oxygen atom joined by a double bond, with a velocity arrow on the carbon. Everything is
+	// about 10 units from the eye, so it all uses the coarsest level of detail
+	TestScene::Scene SmallScene()
+	{
+		TestScene::Scene scene;
+		scene.Materials = TestScene::Materials();
+
+		auto carbon = std::make_shared<TestScene::Atom>(TestScene::Atom{ { -1.0f, 0.0f, 0.0f }, { 50.0f, 0.0f, 0.0f }, 6, true });
+		auto oxygen = std::make_shared<TestScene::Atom>(TestScene::Atom{ { 1.0f, 0.0f, 0.0f }, { 0.0f, 50.0f, 0.0f }, 8, false });
+
+		// Oxygen first, so the atoms are only grouped by element because the packer does it
+		scene.Atoms = { oxygen, carbon };
+		scene.Bonds = { std::make_shared<TestScene::Bond>(TestScene::Bond{ carbon, oxygen, 2 }) };
+		return scene;
+	}
+
+	struct ExpectedCommand
+	{
+		ShaderMode		Shader;
+		RenderMesh		Mesh;
+		uint8_t			Level;
+		uint32_t		FirstInstance;
+		uint32_t		InstanceCount;
+		bool			Transform;
+	};
+
+	void CheckCommands(const RenderCommandList& commands, const std::vector<ExpectedCommand>& expected)
+	{
+		CHECK_EQUAL(commands.Commands().size(), expected.size());
+		if (commands.Commands().size() != expected.size())
+			return;
+
+		for (size_t iii = 0; iii < expected.size(); ++iii)
+		{
+			const RenderCommand& command = commands.Commands()[iii];
+			CHECK(command.State.Pass == RenderPass::SCENE);
+			CHECK(command.State.Stencil == StencilMode::NONE);
+			CHECK(command.State.Shader == expected[iii].Shader);
+			CHECK(command.Mesh == expected[iii].Mesh);
+			CHECK_EQUAL(command.Level, expected[iii].Level);
+			CHECK_EQUAL(command.Transform != RenderCommandList::NoTransform, expected[iii].Transform);
+			if (!expected[iii].Transform)
+			{
+				CHECK_EQUAL(command.FirstInstance, expected[iii].FirstInstance);
+				CHECK_EQUAL(command.InstanceCount, expected[iii].InstanceCount);
+			}
+		}
+	}
+
+	bool KeysAreSorted(const RenderCommandList& commands)
+	{
+		for (size_t iii = 1; iii < commands.Commands().size(); ++iii)
+		{
+			if (commands.Commands()[iii - 1].Key > commands.Commands()[iii].Key)
+				return false;
+		}
+		return true;
+	}
+}
+
+TEST_CASE(SmallSceneCommandSequence)
+{
+	TestScene::Scene scene = SmallScene();
+	SceneRecorder recorder;
+	TestScene::Record(recorder, scene, TestScene::Camera(Eye));
+
+	// Recorded as box, atoms, arrows, bonds - sorted by shader, so the bonds move in front of the arrows.
+	// Instanced draws of the same shader and mesh keep the order the packers wrote them in (by material)
+	CheckCommands(recorder.Commands(), {
+		{ ShaderMode::PHONG,					RenderMesh::BOX,			0, 0, 1, true },
+		{ ShaderMode::PHONG_INSTANCED,			RenderMesh::SPHERE,			3, 0, 1, false },	// Carbon
+		{ ShaderMode::PHONG_INSTANCED,			RenderMesh::SPHERE,			3, 1, 1, false },	// Oxygen
+		{ ShaderMode::PHONG_INSTANCED_CYLINDER,	RenderMesh::CYLINDER,		3, 0, 2, false },	// Carbon half of both cylinders
+		{ ShaderMode::PHONG_INSTANCED_CYLINDER,	RenderMesh::CYLINDER,		3, 2, 2, false },	// Oxygen half
+		{ ShaderMode::PHONG_INSTANCED_ARROW,		RenderMesh::ARROW_CYLINDER,	3, 0, 1, false },
+		{ ShaderMode::PHONG_INSTANCED_ARROW,		RenderMesh::ARROW_CONE,		3, 0, 1, false }
+	});
+	CHECK(KeysAreSorted(recorder.Commands()));
+
+	CHECK_EQUAL(recorder.Atoms().Instances().size(), static_cast<size_t>(2));
+	CHECK_EQUAL(recorder.Atoms().Instances()[0].MaterialIndex, 6u);
+	CHECK_EQUAL(recorder.Atoms().Instances()[1].MaterialIndex, 8u);
+	CHECK_EQUAL(recorder.Arrows().Instances().size(), static_cast<size_t>(1));
+
+	// The box is scaled to the box dimensions and rebased on the eye
+	const RenderTransform& box = recorder.Commands().Transforms()[recorder.Commands().Commands()[0].Transform];
+	CHECK_EQUAL(box.Model[0][0], TestScene::BoxSize);
+	CHECK_EQUAL(box.Model[3][2], -10.0f);
+	CHECK_EQUAL(box.MaterialIndex, TestScene::BoxMaterial);
+
+	// Stencil, shader and mesh are checked for every command:
+	//		box				stencil, shader, mesh changed
+	//		carbon			shader, mesh changed
+	//		oxygen			nothing changed
+	//		carbon half		shader, mesh changed
+	//		oxygen half		nothing changed
+	//		arrow shaft		shader, mesh changed
+	//		arrow head		mesh changed
+	SoftwareRasterizer rasterizer(TestScene::Width, TestScene::Height, 1);
+	rasterizer.Submit(recorder.Commands(), TestScene::Software(recorder, scene));
+
+	const RenderStatistics& statistics = rasterizer.FrameStatistics();
+	CHECK_EQUAL(statistics.Commands, 7u);
+	CHECK_EQUAL(statistics.DrawCalls, 7u);
+	CHECK_EQUAL(statistics.StateChanges, 10u);
+	CHECK_EQUAL(statistics.RedundantStates, 11u);
+}
+
+TEST_CASE(ImpostorsAreOneDraw)
+{
+	TestScene::Scene scene = SmallScene();
+	SceneRecorder recorder;
+	TestScene::Record(recorder, scene, TestScene::Camera(Eye), AtomRenderMode::IMPOSTOR);
+
+	CheckCommands(recorder.Commands(), {
+		{ ShaderMode::PHONG,					RenderMesh::BOX,			0, 0, 1, true },
+		{ ShaderMode::PHONG_INSTANCED_CYLINDER,	RenderMesh::CYLINDER,		3, 0, 2, false },
+		{ ShaderMode::PHONG_INSTANCED_CYLINDER,	RenderMesh::CYLINDER,		3, 2, 2, false },
+		{ ShaderMode::PHONG_INSTANCED_ARROW,		RenderMesh::ARROW_CYLINDER,	3, 0, 1, false },
+		{ ShaderMode::PHONG_INSTANCED_ARROW,		RenderMesh::ARROW_CONE,		3, 0, 1, false },
+		{ ShaderMode::IMPOSTOR,					RenderMesh::IMPOSTOR_QUAD,	0, 0, 2, false }
+	});
+	CHECK(KeysAreSorted(recorder.Commands()));
+}
+
+TEST_CASE(OutlinePassesFollowTheScene)
+{
+	// Record the stencil outlines straight into the commands the way SimulationRenderer does
+	TestScene::Scene scene = SmallScene();
+	SceneRecorder recorder;
+
+	const float boxDimensions[3] = { TestScene::BoxSize, TestScene::BoxSize, TestScene::BoxSize };
+	recorder.Begin(TestScene::Camera(Eye));
+
+	const RenderStateBlock outline = { RenderPass::OUTLINE, ShaderMode::SOLID, StencilMode::MASK };
+	const RenderStateBlock mask = { RenderPass::STENCIL_MASK, ShaderMode::PHONG, StencilMode::WRITE };
+	float model[4][4] = { { 0.1f, 0.0f, 0.0f, 0.0f }, { 0.0f, 0.1f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.1f, 0.0f }, { 0.0f, 0.0f, 0.0f, 1.0f } };
+	for (uint32_t material : { 30u, 10u, 20u })
+	{
+		recorder.Commands().Draw(outline, RenderMesh::SPHERE, 0, model, material);
+		recorder.Commands().Draw(mask, RenderMesh::SPHERE, 0, model, material);
+	}
+
+	recorder.DrawAtoms(scene.Atoms, AtomRenderMode::MESH);
+	recorder.DrawBox(boxDimensions, TestScene::BoxMaterial);
+	recorder.End();
+
+	const std::vector<RenderCommand>& commands = recorder.Commands().Commands();
+	CHECK_EQUAL(commands.size(), static_cast<size_t>(9));
+	if (commands.size() != 9)
+		return;
+
+	// Scene, then the stencil mask sorted by material, then the outlines in the order they were recorded
+	const RenderPass passes[9] = { RenderPass::SCENE, RenderPass::SCENE, RenderPass::SCENE, RenderPass::STENCIL_MASK, RenderPass::STENCIL_MASK,
+								   RenderPass::STENCIL_MASK, RenderPass::OUTLINE, RenderPass::OUTLINE, RenderPass::OUTLINE };
+	const uint32_t materials[6] = { 10, 20, 30, 30, 10, 20 };
+	for (size_t iii = 0; iii < commands.size(); ++iii)
+	{
+		CHECK(commands[iii].State.Pass == passes[iii]);
+		if (iii >= 3)
+			CHECK_EQUAL(recorder.Commands().Transforms()[commands[iii].Transform].MaterialIndex, materials[iii - 3]);
+	}
+	CHECK(commands[0].Mesh == RenderMesh::BOX);
+
+	// The screen space outline is one full screen command after everything else, which the software backend
+	// counts but doesn't draw
+	recorder.Begin(TestScene::Camera(Eye));
+	recorder.DrawScreenSpaceOutline();
+	recorder.DrawAtoms(scene.Atoms, AtomRenderMode::MESH);
+	recorder.End();
+
+	CHECK_EQUAL(recorder.Commands().Commands().size(), static_cast<size_t>(3));
+	CHECK(recorder.Commands().Commands().back().Mesh == RenderMesh::FULLSCREEN_TRIANGLE);
+
+	SoftwareRasterizer rasterizer(TestScene::Width, TestScene::Height, 1);
+	rasterizer.Submit(recorder.Commands(), TestScene::Software(recorder, scene));
+	CHECK_EQUAL(rasterizer.FrameStatistics().Commands, 3u);
+	CHECK_EQUAL(rasterizer.FrameStatistics().DrawCalls, 2u);
+}
+
+TEST_CASE(FixedSceneIsGroupedByState)
+{
+	TestScene::Scene scene = TestScene::Create();
+	const double eye[3] = { 2.6, 2.2, 5.2 };
+
+	SceneRecorder recorder;
+	TestScene::Record(recorder, scene, TestScene::Camera(eye));
+
+	const std::vector<RenderCommand>& commands = recorder.Commands().Commands();
+	CHECK(KeysAreSorted(recorder.Commands()));
+
+	// Every shader and every mesh/level is bound exactly once
+	std::set<std::pair<RenderMesh, uint8_t>> meshes;
+	size_t shaderChanges = 0, meshChanges = 0;
+	uint32_t atoms = 0, cylinders = 0;
+	for (size_t iii = 0; iii < commands.size(); ++iii)
+	{
+		const RenderCommand& command = commands[iii];
+		if (iii == 0 || command.State.Shader != commands[iii - 1].State.Shader)
+			++shaderChanges;
+		if (iii == 0 || command.Mesh != commands[iii - 1].Mesh || command.Level != commands[iii - 1].Level)
+			++meshChanges;
+		meshes.insert({ command.Mesh, command.Level });
+
+		if (command.Mesh == RenderMesh::SPHERE)
+			atoms += command.InstanceCount;
+		if (command.Mesh == RenderMesh::CYLINDER)
+			cylinders += command.InstanceCount;
+	}
+
+	CHECK_EQUAL(shaderChanges, static_cast<size_t>(4));
+	CHECK_EQUAL(meshChanges, meshes.size());
+
+	// Every atom and bond is in view, and each bond is 2 halves of 1, 2 or 3 cylinders
+	uint32_t bondCylinders = 0;
+	for (const std::shared_ptr<TestScene::Bond>& bond : scene.Bonds)
+		bondCylinders += 2 * bond->Type;
+
+	CHECK_EQUAL(atoms, static_cast<uint32_t>(scene.Atoms.size()));
+	CHECK_EQUAL(cylinders, bondCylinders);
+
+	SoftwareRasterizer rasterizer(TestScene::Width, TestScene::Height, 1);
+	rasterizer.Submit(recorder.Commands(), TestScene::Software(recorder, scene));
+
+	const RenderStatistics& statistics = rasterizer.FrameStatistics();
+	CHECK_EQUAL(statistics.Commands, static_cast<uint32_t>(commands.size()));
+	CHECK_EQUAL(statistics.DrawCalls, static_cast<uint32_t>(commands.size()));
+	CHECK_EQUAL(statistics.StateChanges, static_cast<uint32_t>(1 + shaderChanges + meshChanges));
+	CHECK_EQUAL(statistics.StateChanges + statistics.RedundantStates, static_cast<uint32_t>(3 * commands.size()));
+}
+
+TEST_CASE(CommandsDoNotDependOnTheDistanceFromTheOrigin)
+{
+	// The same scene and camera moved far from the world origin records the same draws, because everything
+	// is rebased on the eye in double before it is rounded to float (see CameraSpace)
+	TestScene::Scene nearScene = SmallScene();
+	TestScene::Scene farScene = SmallScene();
+	const float offset = 65536.0f;
+	for (const std::shared_ptr<TestScene::Atom>& atom : farScene.Atoms)
+		atom->Center.x += offset;
+
+	// Only the eye moves - the view keeps looking down -z
+	SceneCamera nearCamera = TestScene::Camera(Eye);
+	SceneCamera farCamera = nearCamera;
+	farCamera.Eye[0] += offset;
+
+	SceneRecorder nearRecorder, farRecorder;
+	TestScene::Record(nearRecorder, nearScene, nearCamera);
+	TestScene::Record(farRecorder, farScene, farCamera);
+
+	const std::vector<RenderCommand>& nearCommands = nearRecorder.Commands().Commands();
+	const std::vector<RenderCommand>& farCommands = farRecorder.Commands().Commands();
+	CHECK_EQUAL(farCommands.size(), nearCommands.size());
+	for (size_t iii = 0; iii < nearCommands.size() && iii < farCommands.size(); ++iii)
+	{
+		CHECK(farCommands[iii].Mesh == nearCommands[iii].Mesh);
+		CHECK_EQUAL(farCommands[iii].InstanceCount, nearCommands[iii].InstanceCount);
+	}
+
+	CHECK_EQUAL(farRecorder.Atoms().Instances().size(), nearRecorder.Atoms().Instances().size());
+	for (size_t iii = 0; iii < nearRecorder.Atoms().Instances().size(); ++iii)
+	{
+		for (int axis = 0; axis < 3; ++axis)
+			CHECK_EQUAL(farRecorder.Atoms().Instances()[iii].Position[axis], nearRecorder.Atoms().Instances()[iii].Position[axis]);
+	}
+}
+
+TEST_CASE(FarPlaneContainsTheBox)
+{
+	const float boxDimensions[3] = { 3.0f, 4.0f, 12.0f };
+
+	// From the center of the box the farthest points are its corners
+	const double center[3] = { 0.0, 0.0, 0.0 };
+	CHECK_CLOSE(SceneRecorder::FarPlane(center, boxDimensions), 6.5f, 1e-5f);
+
+	// Every corner is inside the far plane from anywhere, so no depth is clamped
+	const double eye[3] = { 7.0, -2.0, 10.0 };
+	float farPlane = SceneRecorder::FarPlane(eye, boxDimensions);
+	for (int corner = 0; corner < 8; ++corner)
+	{
+		double distance = 0.0;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			double offset = ((corner >> axis) & 1 ? 0.5 : -0.5) * boxDimensions[axis] - eye[axis];
+			distance += offset * offset;
+		}
+		CHECK(std::sqrt(distance) <= farPlane);
+	}
+
+	// An empty box seen from its center still has a far plane to divide by
+	const float noBox[3] = { 0.0f, 0.0f, 0.0f };
+	CHECK(SceneRecorder::FarPlane(center, noBox) > 0.0f);
+}
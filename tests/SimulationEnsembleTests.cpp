@@ -0,0 +1,85 @@
+#include "TestHarness.h"
+
+#include "SimulationEnsemble.h"
+
+#include <vector>
+
+namespace
+{
+	const unsigned int	MemberCount = 12;
+	const double		TimeStep = 1.0 / 60.0;
+	const unsigned int	Steps = 120;
+
+	// Members differ in seed, size and update mode so they take uneven amounts of time
+	void Configure(HardSphereDynamics& simulation, unsigned int index)
+	{
+		simulation.SetUpdateMode(index % 2 == 0 ? UpdateMode::CONTINUOUS : UpdateMode::EVENT_DRIVEN);
+		simulation.State().BoxDimensions = Float3{ 4.0f, 4.0f, 4.0f };
+		simulation.State().AddRandom(16 + 8 * (index % 4), 100 + index, 2.0f);
+	}
+
+	std::vector<uint64_t> RunEnsemble(unsigned int threadCount)
+	{
+		SimulationEnsemble ensemble(threadCount);
+		ensemble.AddSimulations(MemberCount, Configure);
+		ensemble.Run(TimeStep, Steps);
+
+		std::vector<uint64_t> hashes(ensemble.Size());
+		ensemble.ForEach([&hashes](HardSphereDynamics& simulation, unsigned int index) { hashes[index] = simulation.StateHash(); });
+		return hashes;
+	}
+}
+
+TEST_CASE(MembersDoNotDependOnTheThreadCount)
+{
+	std::vector<uint64_t> single = RunEnsemble(1);
+	std::vector<uint64_t> parallel = RunEnsemble(4);
+
+	CHECK_EQUAL(single.size(), static_cast<size_t>(MemberCount));
+	CHECK_EQUAL(parallel.size(), static_cast<size_t>(MemberCount));
+	for (size_t iii = 0; iii < single.size() && iii < parallel.size(); ++iii)
+		CHECK_EQUAL(parallel[iii], single[iii]);
+
+	// Each member is the same run as the simulation stepped on its own
+	for (unsigned int iii = 0; iii < MemberCount && iii < parallel.size(); ++iii)
+	{
+		HardSphereDynamics simulation;
+		Configure(simulation, iii);
+		for (unsigned int step = 0; step < Steps; ++step)
+			simulation.Step(TimeStep);
+
+		CHECK_EQUAL(parallel[iii], simulation.StateHash());
+	}
+
+	// Different seeds give different members
+	CHECK(single[0] != single[2]);
+}
+
+TEST_CASE(ObservablesAreInEnsembleOrder)
+{
+	SimulationEnsemble ensemble(4);
+	CHECK_EQUAL(ensemble.ThreadCount(), 4u);
+
+	ensemble.AddSimulations(MemberCount, Configure);
+	ensemble.Run(TimeStep, 1);
+
+	std::vector<SimulationObservables> observables = ensemble.Observables();
+	CHECK_EQUAL(observables.size(), static_cast<size_t>(MemberCount));
+	for (unsigned int iii = 0; iii < MemberCount && iii < observables.size(); ++iii)
+	{
+		CHECK_EQUAL(observables[iii].AtomCount, static_cast<unsigned int>(ensemble.At(iii).State().Count()));
+		CHECK_EQUAL(observables[iii].KineticEnergy, ensemble.At(iii).Observables().KineticEnergy);
+	}
+
+	// Adding more members keeps the ones already there and numbers the new ones after them
+	std::vector<unsigned int> indices(3, 0);
+	ensemble.AddSimulations(3, [&indices](HardSphereDynamics&, unsigned int index) { indices[index - MemberCount] = index; });
+	CHECK_EQUAL(ensemble.Size(), MemberCount + 3);
+	for (unsigned int iii = 0; iii < 3; ++iii)
+		CHECK_EQUAL(indices[iii], MemberCount + iii);
+	CHECK_EQUAL(ensemble.At(MemberCount).State().Count(), static_cast<size_t>(0));
+	CHECK_CLOSE(ensemble.At(0).Time(), TimeStep, 1e-12);
+
+	ensemble.Clear();
+	CHECK_EQUAL(ensemble.Size(), 0u);
+}
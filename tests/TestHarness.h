@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Minimal test harness for the portable (no Windows/DirectX) modules. Each test file is its own
+// executable (see CMakeLists.txt) linked against TestMain.cpp, which runs every TEST_CASE in the
+// file and returns non-zero if any CHECK failed.
+//
+//	TEST_CASE(RingWrapsAround)
+//	{
+//		CHECK(ring.Allocate(64, 16, offset));
+//		CHECK_EQUAL(offset, 0u);
+//	}
+class TestRegistry
+{
+public:
+	struct TestCase
+	{
+		const char*				Name;
+		std::function<void()>	Function;
+	};
+
+	static std::vector<TestCase>& Tests() { static std::vector<TestCase> tests; return tests; }
+
+	static int& Failures() { static int failures = 0; return failures; }
+
+	static void Fail(const char* file, int line, const std::string& message)
+	{
+		std::cerr << file << "(" << line << "): " << message << std::endl;
+		++Failures();
+	}
+};
+
+struct TestRegistrar
+{
+	TestRegistrar(const char* name, std::function<void()> function) { TestRegistry::Tests().push_back({ name, std::move(function) }); }
+};
+
+#define TEST_CASE(name)															\
+	static void name();															\
+	static TestRegistrar name##_registrar(#name, name);							\
+	static void name()
+
+#define CHECK(condition)														\
+	do {																		\
+		if (!(condition))														\
+			TestRegistry::Fail(__FILE__, __LINE__, "CHECK(" #condition ") failed");	\
+	} while (false)
+
+#define CHECK_EQUAL(actual, expected)											\
+	do {																		\
+		auto actualValue_ = (actual);											\
+		auto expectedValue_ = (expected);										\
+		if (!(actualValue_ == expectedValue_))									\
+			TestRegistry::Fail(__FILE__, __LINE__, "CHECK_EQUAL(" #actual ", " #expected ") failed: got " +	\
+							   std::to_string(actualValue_) + ", expected " + std::to_string(expectedValue_));	\
+	} while (false)
+
+#define CHECK_CLOSE(actual, expected, tolerance)								\
+	do {																		\
+		double actualValue_ = (actual);											\
+		double expectedValue_ = (expected);										\
+		if (!(std::abs(actualValue_ - expectedValue_) <= (tolerance)))			\
+			TestRegistry::Fail(__FILE__, __LINE__, "CHECK_CLOSE(" #actual ", " #expected ") failed: got " +	\
+							   std::to_string(actualValue_) + ", expected " + std::to_string(expectedValue_));	\
+	} while (false)
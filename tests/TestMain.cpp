@@ -0,0 +1,16 @@
+#include "TestHarness.h"
+
+
+int main()
+{
+	for (const TestRegistry::TestCase& test : TestRegistry::Tests())
+	{
+		int failuresBefore = TestRegistry::Failures();
+		test.Function();
+
+		std::cout << (TestRegistry::Failures() == failuresBefore ? "[ PASS ] " : "[ FAIL ] ") << test.Name << std::endl;
+	}
+
+	std::cout << TestRegistry::Tests().size() << " test(s), " << TestRegistry::Failures() << " failure(s)" << std::endl;
+	return TestRegistry::Failures() == 0 ? 0 : 1;
+}
\ No newline at end of file
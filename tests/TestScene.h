@@ -0,0 +1,193 @@
+#pragma once
+
+#include "CameraSpace.h"
+#include "Constants.h"
+#include "SceneRecorder.h"
+#include "SoftwareRasterizer.h"
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+// A fixed scene for the scene recorder and software rasterizer tests - a lattice of atoms of every
+// element with some velocity arrows and single/double/triple bonds inside the simulation box, seen
+// from a camera that is off the box's axes. Atom and bond only provide what the packers read (see
+// AtomInstancePacker, VelocityArrowPacker and BondGeometry)
+namespace TestScene
+{
+	struct Vector3
+	{
+		float x, y, z;
+	};
+
+	struct Atom
+	{
+		Vector3		Center;
+		Vector3		Speed;
+		int			Element;
+		bool		ArrowIsVisible;
+
+		Vector3 Position() const { return Center; }
+		Vector3 Velocity() const { return Speed; }
+		float Radius() const { return Constants::AtomicRadii[Element]; }
+		float DisplayRadius() const { return Radius(); }
+		int ElementType() const { return Element; }
+		bool VelocityArrowIsVisible() const { return ArrowIsVisible; }
+	};
+
+	struct Bond
+	{
+		std::shared_ptr<Atom>	First;
+		std::shared_ptr<Atom>	Second;
+		int						Type;		// 1, 2 or 3 cylinders
+
+		const std::shared_ptr<Atom>& Atom1() const { return First; }
+		const std::shared_ptr<Atom>& Atom2() const { return Second; }
+		int GetBondType() const { return Type; }
+	};
+
+	const unsigned int	Width = 320;
+	const unsigned int	Height = 240;
+	const float			BoxSize = 3.0f;
+	const float			CylinderRadius = Constants::AtomicRadii[1] / 3.0f;	// See SimulationRenderer::DrawBonds
+
+	// Material table: the element materials are at the index of their element type (see
+	// SimulationRenderer::CreateStaticResources), followed by the velocity arrow and the box
+	const uint32_t		ArrowMaterial = 11;
+	const uint32_t		BoxMaterial = 12;
+
+	struct Scene
+	{
+		std::vector<std::shared_ptr<Atom>>	Atoms;
+		std::vector<std::shared_ptr<Bond>>	Bonds;
+		std::vector<SoftwareMaterial>		Materials;
+	};
+
+	inline std::vector<SoftwareMaterial> Materials()
+	{
+		std::vector<SoftwareMaterial> materials;
+
+		// Diffuse colors of the element materials
+		const float colors[11][3] = {
+			{ 0.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 1.0f }, { 1.0f, 0.6f, 0.6f }, { 1.0f, 0.6f, 0.6f }, { 1.0f, 1.0f, 0.0f },
+			{ 1.0f, 0.8f, 0.8f }, { 0.8f, 0.8f, 0.8f }, { 0.0f, 0.0f, 1.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.2f, 1.0f },
+			{ 0.0f, 1.0f, 1.0f }
+		};
+		for (const float* color : colors)
+			materials.push_back({ { color[0], color[1], color[2], 1.0f }, false });
+
+		materials.push_back({ { 1.0f, 1.0f, 1.0f, 1.0f }, false });		// Velocity arrows
+		materials.push_back({ { 0.0f, 0.0f, 0.0f, 1.0f }, true });		// Box
+
+		return materials;
+	}
+
+	// 'size' x 'size' x 'size' atoms spread over the box. Every atom is bonded to its neighbour along x,
+	// cycling through single, double and triple bonds, and every third atom shows its velocity arrow
+	inline Scene Create(int size = 6)
+	{
+		Scene scene;
+
+		const float spacing = BoxSize / size;
+		for (int iii = 0; iii < size; ++iii)
+		{
+			for (int jjj = 0; jjj < size; ++jjj)
+			{
+				for (int kkk = 0; kkk < size; ++kkk)
+				{
+					int index = static_cast<int>(scene.Atoms.size());
+
+					auto atom = std::make_shared<Atom>();
+					atom->Center = { (kkk + 0.5f) * spacing - 0.5f * BoxSize, (jjj + 0.5f) * spacing - 0.5f * BoxSize, (iii + 0.5f) * spacing - 0.5f * BoxSize };
+					atom->Speed = { 10.0f * ((index % 5) - 2), 10.0f * ((index % 3) - 1), 15.0f };
+					atom->Element = 1 + index % 10;
+					atom->ArrowIsVisible = index % 3 == 0;
+					scene.Atoms.push_back(atom);
+
+					if (kkk > 0)
+						scene.Bonds.push_back(std::make_shared<Bond>(Bond{ scene.Atoms[index - 1], atom, 1 + index % 3 }));
+				}
+			}
+		}
+
+		scene.Materials = Materials();
+		return scene;
+	}
+
+	// Camera at 'eye' looking at the center of the box, in the camera relative space the recorder draws in
+	// (the view has no translation, see CameraSpace)
+	inline SceneCamera Camera(const double eye[3], unsigned int width = Width, unsigned int height = Height)
+	{
+		SceneCamera camera = {};
+		camera.Eye[0] = eye[0];
+		camera.Eye[1] = eye[1];
+		camera.Eye[2] = eye[2];
+
+		// Right handed look-at (like XMMatrixLookAtRH) without the translation
+		float z[3] = { static_cast<float>(eye[0]), static_cast<float>(eye[1]), static_cast<float>(eye[2]) };
+		float length = std::sqrt(z[0] * z[0] + z[1] * z[1] + z[2] * z[2]);
+		for (float& component : z)
+			component /= length;
+
+		float x[3] = { z[2], 0.0f, -z[0] };		// cross((0, 1, 0), z)
+		length = std::sqrt(x[0] * x[0] + x[1] * x[1] + x[2] * x[2]);
+		for (float& component : x)
+			component /= length;
+
+		const float y[3] = { z[1] * x[2] - z[2] * x[1], z[2] * x[0] - z[0] * x[2], z[0] * x[1] - z[1] * x[0] };
+
+		for (int row = 0; row < 3; ++row)
+		{
+			camera.View[row][0] = x[row];
+			camera.View[row][1] = y[row];
+			camera.View[row][2] = z[row];
+		}
+		camera.View[3][3] = 1.0f;
+
+		const float fovAngleY = 3.14159265f / 4.0f;
+		CameraSpace::ReverseZPerspective(fovAngleY, static_cast<float>(width) / height, 0.01f, camera.Projection);
+		camera.PixelsPerUnit = height / (2.0f * std::tan(fovAngleY / 2.0f));
+
+		const float boxDimensions[3] = { BoxSize, BoxSize, BoxSize };
+		camera.FarPlane = SceneRecorder::FarPlane(eye, boxDimensions);
+
+		return camera;
+	}
+
+	// Record the whole scene the way SimulationRenderer::RecordFrame does (without outlines)
+	inline void Record(SceneRecorder& recorder, const Scene& scene, const SceneCamera& camera, AtomRenderMode mode = AtomRenderMode::MESH)
+	{
+		const float boxDimensions[3] = { BoxSize, BoxSize, BoxSize };
+
+		recorder.Begin(camera);
+		recorder.DrawBox(boxDimensions, BoxMaterial);
+		recorder.DrawAtoms(scene.Atoms, mode);
+		recorder.DrawVelocityArrows(scene.Atoms, ArrowMaterial);
+		recorder.DrawBonds(scene.Bonds, CylinderRadius);
+		recorder.End();
+	}
+
+	// The data the commands of 'recorder' refer to, for SoftwareRasterizer::Submit
+	inline SoftwareScene Software(const SceneRecorder& recorder, const Scene& scene)
+	{
+		SoftwareScene software;
+		for (int row = 0; row < 4; ++row)
+			for (int column = 0; column < 4; ++column)
+				software.ViewProjection[row][column] = recorder.ViewProjection()[row][column];
+
+		// Camera relative, so the eye is at the origin
+		software.Eye[0] = software.Eye[1] = software.Eye[2] = 0.0f;
+
+		software.Atoms = recorder.Atoms().Instances().data();
+		software.AtomCount = recorder.Atoms().Instances().size();
+		software.Bonds = recorder.Bonds().Instances().data();
+		software.BondCount = recorder.Bonds().Instances().size();
+		software.Arrows = recorder.Arrows().Instances().data();
+		software.ArrowCount = recorder.Arrows().Instances().size();
+		software.ArrowWidth = CylinderRadius;		// See ArrowMesh::Width
+		software.ArrowMaterial = ArrowMaterial;
+		software.Materials = scene.Materials.data();
+		software.MaterialCount = scene.Materials.size();
+		return software;
+	}
+}
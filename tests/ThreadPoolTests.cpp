@@ -0,0 +1,89 @@
+#include "TestHarness.h"
+
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <vector>
+
+TEST_CASE(ParallelForVisitsEveryIndexOnce)
+{
+	ThreadPool pool(4);
+	std::vector<std::atomic<int>> visits(1000);
+
+	pool.ParallelFor(visits.size(), [&visits](size_t index) { ++visits[index]; });
+
+	for (std::atomic<int>& count : visits)
+		CHECK_EQUAL(count.load(), 1);
+}
+
+TEST_CASE(ParallelForEmptyAndSingle)
+{
+	ThreadPool pool(2);
+	int calls = 0;
+
+	pool.ParallelFor(0, [&calls](size_t) { ++calls; });
+	CHECK_EQUAL(calls, 0);
+
+	pool.ParallelFor(1, [&calls](size_t) { ++calls; });
+	CHECK_EQUAL(calls, 1);
+}
+
+TEST_CASE(NestedParallelForDoesNotDeadlock)
+{
+	// Every worker ends up blocked in an inner ParallelFor, so the inner calls can only finish
+	// because the calling thread works through its own indices
+	for (unsigned int threads : { 1u, 2u, 4u })
+	{
+		ThreadPool pool(threads);
+		std::atomic<size_t> total(0);
+
+		pool.ParallelFor(16, [&pool, &total](size_t outer)
+		{
+			pool.ParallelFor(16, [&pool, &total, outer](size_t inner)
+			{
+				pool.ParallelFor(4, [&total, outer, inner](size_t innermost) { total += outer * 64 + inner * 4 + innermost; });
+			});
+		});
+
+		// Sum of 0 .. 16 * 16 * 4 - 1
+		CHECK_EQUAL(total.load(), static_cast<size_t>(1024 * 1023 / 2));
+	}
+}
+
+TEST_CASE(ParallelForInsideSubmittedJob)
+{
+	ThreadPool pool(2);
+	std::atomic<int> total(0);
+
+	for (int iii = 0; iii < 4; ++iii)
+	{
+		pool.Submit([&pool, &total]()
+		{
+			pool.ParallelFor(100, [&total](size_t) { ++total; });
+		});
+	}
+
+	pool.Wait();
+	CHECK_EQUAL(total.load(), 400);
+}
+
+TEST_CASE(ConcurrentParallelForCalls)
+{
+	// Two threads sharing a pool only wait for their own work
+	ThreadPool pool(3);
+	std::atomic<int> first(0), second(0);
+
+	std::thread other([&pool, &second]()
+	{
+		for (int iii = 0; iii < 50; ++iii)
+			pool.ParallelFor(64, [&second](size_t) { ++second; });
+	});
+
+	for (int iii = 0; iii < 50; ++iii)
+		pool.ParallelFor(64, [&first](size_t) { ++first; });
+
+	other.join();
+
+	CHECK_EQUAL(first.load(), 50 * 64);
+	CHECK_EQUAL(second.load(), 50 * 64);
+}
@@ -0,0 +1,259 @@
+#include "TestHarness.h"
+
+#include "UploadRingAllocator.h"
+
+#include <deque>
+#include <random>
+#include <vector>
+
+TEST_CASE(AllocationsAreAlignedAndSequential)
+{
+	UploadRingAllocator ring(4096, 256);
+	size_t offset = 1;
+
+	CHECK(ring.Allocate(1, offset));
+	CHECK_EQUAL(offset, static_cast<size_t>(0));
+	CHECK(ring.Allocate(256, offset));
+	CHECK_EQUAL(offset, static_cast<size_t>(256));
+	CHECK(ring.Allocate(257, offset));
+	CHECK_EQUAL(offset, static_cast<size_t>(512));
+
+	CHECK_EQUAL(ring.UsedBytes(), static_cast<size_t>(1024));
+	CHECK_EQUAL(ring.AlignedSize(257), static_cast<size_t>(512));
+}
+
+TEST_CASE(ZeroAndOversizedAllocationsFail)
+{
+	UploadRingAllocator ring(1024, 256);
+	size_t offset = 0;
+
+	CHECK(!ring.Allocate(0, offset));
+	CHECK(!ring.Allocate(1025, offset));
+	CHECK_EQUAL(ring.UsedBytes(), static_cast<size_t>(0));
+
+	// An empty ring never has capacity (it hasn't been Reset yet)
+	UploadRingAllocator empty;
+	CHECK(!empty.Allocate(1, offset));
+}
+
+TEST_CASE(WrapAroundSkipsTheEndOfTheRing)
+{
+	UploadRingAllocator ring(1024, 256);
+	size_t offset = 0;
+
+	CHECK(ring.Allocate(512, offset));
+	uint64_t frame0 = ring.EndFrame();
+
+	CHECK(ring.Allocate(256, offset));
+	CHECK_EQUAL(offset, static_cast<size_t>(512));
+	uint64_t frame1 = ring.EndFrame();
+
+	ring.RetireFrame(frame0);
+	CHECK_EQUAL(ring.UsedBytes(), static_cast<size_t>(256));
+
+	// 512 bytes don't fit in the 256 left before the end, so those are skipped and the allocation
+	// starts at 0. The skipped bytes belong to this frame
+	CHECK(ring.Allocate(512, offset));
+	CHECK_EQUAL(offset, static_cast<size_t>(0));
+	CHECK_EQUAL(ring.UsedBytes(), static_cast<size_t>(1024));
+
+	// Full - the 256 bytes after this allocation are still in use by frame 1
+	CHECK(!ring.Allocate(1, offset));
+
+	uint64_t frame2 = ring.EndFrame();
+	ring.RetireFrame(frame1);
+	CHECK_EQUAL(ring.UsedBytes(), static_cast<size_t>(768));
+
+	// Retiring the frame that skipped the end also releases the skipped bytes
+	ring.RetireFrame(frame2);
+	CHECK_EQUAL(ring.UsedBytes(), static_cast<size_t>(0));
+	CHECK_EQUAL(ring.FramesInFlight(), static_cast<size_t>(0));
+}
+
+TEST_CASE(SkipThatDoesNotFitFails)
+{
+	UploadRingAllocator ring(1024, 256);
+	size_t offset = 0;
+
+	CHECK(ring.Allocate(256, offset));
+	ring.EndFrame();
+	CHECK(ring.Allocate(512, offset));
+	CHECK_EQUAL(offset, static_cast<size_t>(256));
+
+	// 512 more would only fit by skipping the last 256 bytes and starting at 0, which is still in use
+	CHECK(!ring.Allocate(512, offset));
+	CHECK_EQUAL(ring.UsedBytes(), static_cast<size_t>(768));
+
+	// The last 256 bytes are still available without skipping
+	CHECK(ring.Allocate(256, offset));
+	CHECK_EQUAL(offset, static_cast<size_t>(768));
+}
+
+TEST_CASE(RetireFrameReleasesEveryEarlierFrame)
+{
+	UploadRingAllocator ring(4096, 256);
+	size_t offset = 0;
+
+	std::vector<uint64_t> frames;
+	for (int iii = 0; iii < 4; ++iii)
+	{
+		CHECK(ring.Allocate(256, offset));
+		frames.push_back(ring.EndFrame());
+	}
+
+	CHECK(frames[1] > frames[0] && frames[2] > frames[1] && frames[3] > frames[2]);
+	CHECK_EQUAL(ring.FramesInFlight(), static_cast<size_t>(4));
+
+	// Retiring frame 2 implies frames 0 and 1 are done as well
+	ring.RetireFrame(frames[2]);
+	CHECK_EQUAL(ring.FramesInFlight(), static_cast<size_t>(1));
+	CHECK_EQUAL(ring.UsedBytes(), static_cast<size_t>(256));
+
+	// Retiring an older frame again changes nothing
+	ring.RetireFrame(frames[0]);
+	CHECK_EQUAL(ring.FramesInFlight(), static_cast<size_t>(1));
+	CHECK_EQUAL(ring.UsedBytes(), static_cast<size_t>(256));
+
+	// The current (not yet ended) frame is never released
+	CHECK(ring.Allocate(256, offset));
+	ring.RetireFrame(frames[3] + 100);
+	CHECK_EQUAL(ring.FramesInFlight(), static_cast<size_t>(0));
+	CHECK_EQUAL(ring.UsedBytes(), static_cast<size_t>(256));
+}
+
+TEST_CASE(FullRingFailsUntilAFrameIsRetired)
+{
+	UploadRingAllocator ring(1024, 256);
+	size_t offset = 0;
+
+	std::vector<uint64_t> frames;
+	for (int iii = 0; iii < 4; ++iii)
+	{
+		CHECK(ring.Allocate(256, offset));
+		frames.push_back(ring.EndFrame());
+	}
+
+	CHECK(!ring.Allocate(1, offset));
+	CHECK_EQUAL(ring.UsedBytes(), static_cast<size_t>(1024));
+
+	ring.RetireFrame(frames[0]);
+	CHECK(ring.Allocate(1, offset));
+	CHECK_EQUAL(offset, static_cast<size_t>(0));
+	CHECK(!ring.Allocate(1, offset));
+}
+
+TEST_CASE(EmptyRingStartsOverAtZero)
+{
+	UploadRingAllocator ring(1024, 256);
+	size_t offset = 0;
+
+	CHECK(ring.Allocate(768, offset));
+	ring.RetireFrame(ring.EndFrame());
+
+	// Nothing in use, so a 512 byte allocation starts at 0 instead of skipping the last 256 bytes
+	CHECK(ring.Allocate(512, offset));
+	CHECK_EQUAL(offset, static_cast<size_t>(0));
+	CHECK_EQUAL(ring.UsedBytes(), static_cast<size_t>(512));
+}
+
+TEST_CASE(ResetForgetsEverything)
+{
+	UploadRingAllocator ring(1024, 256);
+	size_t offset = 0;
+
+	CHECK(ring.Allocate(512, offset));
+	uint64_t before = ring.EndFrame();
+	CHECK(ring.Allocate(256, offset));
+
+	ring.Reset(2048);
+	CHECK_EQUAL(ring.Capacity(), static_cast<size_t>(2048));
+	CHECK_EQUAL(ring.UsedBytes(), static_cast<size_t>(0));
+	CHECK_EQUAL(ring.FramesInFlight(), static_cast<size_t>(0));
+
+	CHECK(ring.Allocate(2048, offset));
+	CHECK_EQUAL(offset, static_cast<size_t>(0));
+
+	// Frame ids keep increasing across a Reset, so retiring a frame from before it doesn't touch the new ones
+	uint64_t after = ring.EndFrame();
+	CHECK(after > before);
+	ring.RetireFrame(before);
+	CHECK_EQUAL(ring.FramesInFlight(), static_cast<size_t>(1));
+	CHECK_EQUAL(ring.UsedBytes(), static_cast<size_t>(2048));
+}
+
+TEST_CASE(RandomFramesNeverOverlap)
+{
+	// Simulate a renderer with up to 3 frames in flight and check that no live allocation ever overlaps
+	// another, and that UsedBytes matches the allocations (plus skipped bytes) still alive
+	struct Allocation { size_t Offset; size_t Size; };
+	struct LiveFrame { uint64_t Id; std::vector<Allocation> Allocations; };
+
+	std::mt19937 rng(99);
+	UploadRingAllocator ring(64 * 256, 256);
+
+	std::deque<LiveFrame> inFlight;
+	int allocations = 0, failures = 0;
+
+	for (int frame = 0; frame < 2000; ++frame)
+	{
+		LiveFrame current;
+		int count = static_cast<int>(rng() % 24);
+		for (int iii = 0; iii < count; ++iii)
+		{
+			size_t size = 1 + rng() % 2048;
+			size_t offset = 0;
+			if (!ring.Allocate(size, offset))
+			{
+				++failures;
+				continue;
+			}
+
+			++allocations;
+			Allocation allocation = { offset, ring.AlignedSize(size) };
+			CHECK(offset % 256 == 0);
+			CHECK(offset + allocation.Size <= ring.Capacity());
+
+			auto overlaps = [&allocation](const Allocation& other)
+			{
+				return allocation.Offset < other.Offset + other.Size && other.Offset < allocation.Offset + allocation.Size;
+			};
+
+			for (const Allocation& other : current.Allocations)
+				CHECK(!overlaps(other));
+			for (const LiveFrame& live : inFlight)
+				for (const Allocation& other : live.Allocations)
+					CHECK(!overlaps(other));
+
+			current.Allocations.push_back(allocation);
+		}
+
+		current.Id = ring.EndFrame();
+		inFlight.push_back(current);
+
+		// The GPU finishes frames in order, sometimes several at once
+		while (inFlight.size() > 3 || (!inFlight.empty() && rng() % 3 == 0))
+		{
+			ring.RetireFrame(inFlight.front().Id);
+			inFlight.pop_front();
+		}
+
+		size_t live = 0;
+		for (const LiveFrame& liveFrame : inFlight)
+			for (const Allocation& allocation : liveFrame.Allocations)
+				live += allocation.Size;
+
+		CHECK(ring.UsedBytes() >= live);
+		CHECK(ring.UsedBytes() <= ring.Capacity());
+		CHECK_EQUAL(ring.FramesInFlight(), inFlight.size());
+	}
+
+	while (!inFlight.empty())
+	{
+		ring.RetireFrame(inFlight.front().Id);
+		inFlight.pop_front();
+	}
+
+	CHECK_EQUAL(ring.UsedBytes(), static_cast<size_t>(0));
+	CHECK(allocations > 5000);
+	CHECK(failures > 0);
+}